@@ -3,6 +3,9 @@
 #include "string.h"
 
 PAINT Paint;
+#if EPD_PAINT_STATS
+uint32_t Paint_SetPixelCount = 0;
+#endif
 
 
 /*******************************************************************
@@ -23,6 +26,13 @@ void Paint_NewImage(uint8_t *image,uint16_t Width,uint16_t Height,uint16_t Rotat
 	Paint.heightMemory = Height;
 	Paint.widthByte = (Width % 8 == 0)? (Width / 8 ): (Width / 8 + 1);
 	Paint.heightByte = Height;
+#if EPD_FRAME_CONTROLLER_ORDER
+	Paint.colStep = Height;
+	Paint.lineStep = 1;
+#else
+	Paint.colStep = 1;
+	Paint.lineStep = Paint.widthByte;
+#endif
 	Paint.rotate = Rotate;
 	if (Rotate == 0 || Rotate == 180)
 	{
@@ -43,16 +53,8 @@ void Paint_NewImage(uint8_t *image,uint16_t Width,uint16_t Height,uint16_t Rotat
 *******************************************************************/
 void Paint_Clear(uint8_t Color)
 {
-	uint16_t X,Y;
-	uint32_t Addr;
-	for (Y = 0; Y < Paint.heightByte; Y++)
-	{
-		for (X = 0; X < Paint.widthByte; X++)
-		{
-			Addr = X + Y * Paint.widthByte; // 8 pixel =  1 byte
-			Paint.Image[Addr] = Color;
-		}
-  }
+	// 8 pixel = 1 byte, buffer is contiguous
+	memset(Paint.Image, Color, (uint32_t)Paint.widthByte * Paint.heightByte);
 }
 
 
@@ -69,6 +71,9 @@ void Paint_SetPixel(uint16_t Xpoint,uint16_t Ypoint,uint16_t Color)
 	uint32_t Addr;
 	uint8_t Rdata;
 
+#if EPD_PAINT_STATS
+	Paint_SetPixelCount++;
+#endif
 	// Range check: prevent out-of-bounds access
 	// For rotation 180, Xpoint can be up to EPD_W - 1 (799), but after offset it becomes 807
 	// So we need to clamp Xpoint before applying offset
@@ -126,7 +131,7 @@ void Paint_SetPixel(uint16_t Xpoint,uint16_t Ypoint,uint16_t Color)
 	// Final range check before array access
 	if (X >= Paint.widthMemory || Y >= Paint.heightMemory) return;
 
-	Addr=X/8+Y*Paint.widthByte;
+	Addr=(uint32_t)(X/8)*Paint.colStep+(uint32_t)Y*Paint.lineStep;
 	if (Addr >= Paint.widthByte * Paint.heightByte) return;  // Additional safety check
 
     Rdata=Paint.Image[Addr];
@@ -141,6 +146,263 @@ void Paint_SetPixel(uint16_t Xpoint,uint16_t Ypoint,uint16_t Color)
 }
 
 
+/*******************************************************************
+    函数说明：不透明位图绘制 (置位=黑, 清零=白)
+    接口说明：x,y    逻辑坐标左上角
+              width  位图宽度 (每行按(width+7)/8字节, 高位在左)
+              height 位图高度
+              bitmap 位图数据
+    返回值：  无
+    说明：Rotation 180时每行只解析一次旋转与拼缝偏移, 把行数据按位反转
+          后以移位/掩码整字节写入缓冲区; 其它方向逐点绘制
+*******************************************************************/
+namespace
+{
+constexpr uint16_t kSeamX = 396;     // First logical column on the master chip
+constexpr uint16_t kSeamOffset = 8;  // Gap between the two SSD1683 windows
+constexpr uint16_t kMaxBlitBytes = 100;
+
+// Bit-reversed and inverted: bitmap 1 (black) becomes frame-buffer 0
+struct BlitTable
+{
+	uint8_t v[256];
+	BlitTable()
+	{
+		for (int i = 0; i < 256; i++)
+		{
+			uint8_t r = 0;
+			for (int b = 0; b < 8; b++)
+			{
+				if (i & (1 << b)) r |= 0x80 >> b;
+			}
+			v[i] = ~r;
+		}
+	}
+};
+const BlitTable kBlitRevInv;
+
+// Write frame-buffer bits [xa, xb] of one line from the mirrored row stream.
+// Destination bit X reads stream bit X + delta; stream byte i lives at tmp[i + 1].
+// Byte B of the line is line[B * step] (Paint.colStep).
+void blitSpan(uint8_t *line, uint32_t step, int32_t xa, int32_t xb, int32_t delta, const uint8_t *tmp)
+{
+	for (int32_t B = xa >> 3; B <= (xb >> 3); B++)
+	{
+		const int32_t s = B * 8 + delta + 8;
+		const uint8_t r = s & 7;
+		const int32_t i = s >> 3;
+		const uint8_t value = r ? (uint8_t)((tmp[i] << r) | (tmp[i + 1] >> (8 - r))) : tmp[i];
+
+		const int32_t lo = (B * 8 < xa) ? (xa & 7) : 0;
+		const int32_t hi = (B * 8 + 7 > xb) ? (xb & 7) : 7;
+		const uint8_t mask = (uint8_t)((0xFF >> lo) & (0xFF << (7 - hi)));
+		uint8_t &dst = line[(uint32_t)B * step];
+		dst = (mask == 0xFF) ? value : (uint8_t)((dst & ~mask) | (value & mask));
+	}
+}
+} // namespace
+
+void Paint_DrawBitmap(uint16_t x, uint16_t y, uint16_t width, uint16_t height, const uint8_t *bitmap)
+{
+	const uint16_t widthByte = (width + 7) / 8;
+	if (Paint.Image == nullptr || width == 0) return;
+
+	if (Paint.rotate != 180 || widthByte > kMaxBlitBytes || Paint.widthMemory <= kSeamX + kSeamOffset)
+	{
+		for (uint16_t row = 0; row < height; row++)
+		{
+			for (uint16_t col = 0; col < width; col++)
+			{
+				const bool black = bitmap[row * widthByte + col / 8] & (0x80 >> (col % 8));
+				Paint_SetPixel(x + col, y + row, black ? BLACK : WHITE);
+			}
+		}
+		return;
+	}
+
+	// Resolve the two runs (left of the seam, right of the seam) once
+	const int32_t last = (int32_t)x + width - 1;
+	const int32_t pad = widthByte * 8 - width;
+	struct Run { int32_t xa, xb, delta; } runs[2];
+	uint8_t runCount = 0;
+	const int32_t bounds[2][3] = {
+		// logical start, logical end, X = K - px
+		{x, last < kSeamX - 1 ? last : kSeamX - 1, Paint.widthMemory - 1},
+		{x > kSeamX ? x : kSeamX, last < Paint.widthMemory - kSeamOffset - 1 ? last : Paint.widthMemory - kSeamOffset - 1,
+		 Paint.widthMemory - kSeamOffset - 1},
+	};
+	for (uint8_t k = 0; k < 2; k++)
+	{
+		const int32_t pa = bounds[k][0], pb = bounds[k][1], K = bounds[k][2];
+		if (pa > pb) continue;
+		const int32_t X0 = K - x - (width - 1); // Frame-buffer X of mirrored bit 0
+		runs[runCount].xa = K - pb;
+		runs[runCount].xb = K - pa;
+		runs[runCount].delta = pad - X0;
+		runCount++;
+	}
+	if (runCount == 0) return;
+
+	uint8_t tmp[kMaxBlitBytes + 2];
+	tmp[0] = 0;
+	tmp[widthByte + 1] = 0;
+	for (uint16_t row = 0; row < height; row++)
+	{
+		if (y + row >= Paint.heightMemory) break;
+		const uint8_t *src = bitmap + row * widthByte;
+		for (uint16_t i = 0; i < widthByte; i++)
+		{
+			tmp[i + 1] = kBlitRevInv.v[src[widthByte - 1 - i]];
+		}
+		uint8_t *line = Paint.Image + (uint32_t)(Paint.heightMemory - 1 - (y + row)) * Paint.lineStep;
+		for (uint8_t k = 0; k < runCount; k++)
+		{
+			blitSpan(line, Paint.colStep, runs[k].xa, runs[k].xb, runs[k].delta, tmp);
+		}
+	}
+}
+
+
+/*******************************************************************
+    函数说明：矩形填充 (整字节写入, 不逐点调用Paint_SetPixel)
+    接口说明：Xstart,Ystart 逻辑坐标起点
+              Xend,Yend     逻辑坐标终点 (含端点)
+              Color         填充颜色 (BLACK为黑, 其它为白)
+    返回值：  无
+    说明：按当前旋转方向把逻辑矩形换算成缓冲区矩形, 拼缝两侧各一块;
+          每行两端不满一字节的部分用掩码写入, 中间整字节用memset
+          (按32位字写入); 控制器RAM顺序时每个字节列的行连续, 按列memset.
+          被裁掉的像素与Paint_SetPixel一致
+*******************************************************************/
+namespace
+{
+// Fill frame-buffer bits [xa, xb] of one line: masked edge bytes, memset in between
+void fillSpan(uint8_t *line, uint32_t xa, uint32_t xb, uint8_t value)
+{
+	const uint32_t first = xa >> 3;
+	const uint32_t last = xb >> 3;
+	const uint8_t headMask = 0xFF >> (xa & 7);
+	const uint8_t tailMask = (uint8_t)(0xFF << (7 - (xb & 7)));
+	if (first == last)
+	{
+		const uint8_t mask = headMask & tailMask;
+		line[first] = (uint8_t)((line[first] & ~mask) | (value & mask));
+		return;
+	}
+	uint32_t fullStart = first;
+	uint32_t fullEnd = last + 1;
+	if (headMask != 0xFF)
+	{
+		line[first] = (uint8_t)((line[first] & ~headMask) | (value & headMask));
+		fullStart++;
+	}
+	if (tailMask != 0xFF)
+	{
+		line[last] = (uint8_t)((line[last] & ~tailMask) | (value & tailMask));
+		fullEnd--;
+	}
+	if (fullEnd > fullStart) memset(line + fullStart, value, fullEnd - fullStart);
+}
+
+// Frame-buffer rectangle, inclusive, already clipped
+void fillBufferRect(int32_t X0, int32_t X1, int32_t Y0, int32_t Y1, uint8_t value)
+{
+	if (Paint.lineStep == 1)
+	{
+		// Controller order: the lines of a byte column are contiguous
+		const uint32_t lines = Y1 - Y0 + 1;
+		for (int32_t B = X0 >> 3; B <= (X1 >> 3); B++)
+		{
+			const int32_t lo = (B * 8 < X0) ? (X0 & 7) : 0;
+			const int32_t hi = (B * 8 + 7 > X1) ? (X1 & 7) : 7;
+			const uint8_t mask = (uint8_t)((0xFF >> lo) & (0xFF << (7 - hi)));
+			uint8_t *column = Paint.Image + (uint32_t)B * Paint.colStep + Y0;
+			if (mask == 0xFF)
+			{
+				memset(column, value, lines);
+				continue;
+			}
+			for (uint32_t i = 0; i < lines; i++)
+			{
+				column[i] = (uint8_t)((column[i] & ~mask) | (value & mask));
+			}
+		}
+		return;
+	}
+
+	const uint32_t lastX = Paint.widthMemory - 1;
+	if (X0 == 0 && (uint32_t)X1 == lastX && Paint.widthMemory == Paint.widthByte * 8)
+	{
+		// Whole lines are contiguous
+		memset(Paint.Image + (uint32_t)Y0 * Paint.widthByte, value, (uint32_t)(Y1 - Y0 + 1) * Paint.widthByte);
+		return;
+	}
+	for (int32_t Y = Y0; Y <= Y1; Y++)
+	{
+		fillSpan(Paint.Image + (uint32_t)Y * Paint.widthByte, X0, X1, value);
+	}
+}
+} // namespace
+
+void Paint_FillRect(uint16_t Xstart,uint16_t Ystart,uint16_t Xend,uint16_t Yend,uint16_t Color)
+{
+	if (Paint.Image == nullptr) return;
+	if (Xstart > Xend) { const uint16_t t = Xstart; Xstart = Xend; Xend = t; }
+	if (Ystart > Yend) { const uint16_t t = Ystart; Ystart = Yend; Yend = t; }
+	// Same bounds as Paint_SetPixel: logical X < widthMemory, Y < heightMemory for every rotation
+	if (Xstart >= Paint.widthMemory || Ystart >= Paint.heightMemory) return;
+	if (Xend >= Paint.widthMemory) Xend = Paint.widthMemory - 1;
+	if (Yend >= Paint.heightMemory) Yend = Paint.heightMemory - 1;
+
+	const int32_t W = Paint.widthMemory, H = Paint.heightMemory;
+	const bool seamOnX = (Paint.rotate == 0 || Paint.rotate == 180);
+	// The seam coordinate is X for 0/180 and Y for 90/270; it shifts by kSeamOffset from kSeamX on
+	const int32_t s0 = seamOnX ? Xstart : Ystart;
+	const int32_t s1 = seamOnX ? Xend : Yend;
+	const int32_t sBound = seamOnX ? W : H;
+	const uint8_t value = (Color == BLACK) ? 0x00 : 0xFF;
+
+	for (uint8_t k = 0; k < 2; k++)
+	{
+		const int32_t offset = k ? kSeamOffset : 0;
+		int32_t a = k ? (s0 > kSeamX ? s0 : kSeamX) : s0;
+		int32_t b = k ? s1 : (s1 < kSeamX - 1 ? s1 : kSeamX - 1);
+		if (b + offset >= sBound) b = sBound - 1 - offset;
+		if (a > b) continue;
+		a += offset;
+		b += offset;
+
+		// Logical rectangle of this run (seam offset applied) -> frame-buffer rectangle
+		const int32_t px0 = seamOnX ? a : Xstart, px1 = seamOnX ? b : Xend;
+		const int32_t py0 = seamOnX ? Ystart : a, py1 = seamOnX ? Yend : b;
+		int32_t X0, X1, Y0, Y1;
+		switch (Paint.rotate)
+		{
+		case 0:
+			X0 = px0; X1 = px1; Y0 = py0; Y1 = py1;
+			break;
+		case 90:
+			X0 = W - 1 - py1; X1 = W - 1 - py0; Y0 = px0; Y1 = px1;
+			break;
+		case 180:
+			X0 = W - 1 - px1; X1 = W - 1 - px0; Y0 = H - 1 - py1; Y1 = H - 1 - py0;
+			break;
+		case 270:
+			X0 = py0; X1 = py1; Y0 = H - 1 - px1; Y1 = H - 1 - px0;
+			break;
+		default:
+			return;
+		}
+		if (X0 < 0) X0 = 0;
+		if (Y0 < 0) Y0 = 0;
+		if (X1 > W - 1) X1 = W - 1;
+		if (Y1 > H - 1) Y1 = H - 1;
+		if (X0 > X1 || Y0 > Y1) continue;
+		fillBufferRect(X0, X1, Y0, Y1, value);
+	}
+}
+
+
 /*******************************************************************
     函数说明：划线函数
     接口说明：Xstart 像素x起始坐标参数
@@ -164,32 +426,9 @@ void EPD_DrawLine(uint16_t Xstart,uint16_t Ystart,uint16_t Xend,uint16_t Yend,ui
   XAddway = Xstart < Xend ? 1 : -1;
   YAddway = Ystart < Yend ? 1 : -1;
 
-  // Handle special cases: horizontal and vertical lines
-  if (dy == 0) {
-    // Horizontal line
-    if (Xstart <= Xend) {
-      for (Xpoint = Xstart; Xpoint <= Xend; Xpoint++) {
-        Paint_SetPixel(Xpoint, Ypoint, Color);
-      }
-    } else {
-      for (Xpoint = Xstart; Xpoint >= Xend; Xpoint--) {
-        Paint_SetPixel(Xpoint, Ypoint, Color);
-      }
-    }
-    return;
-  }
-
-  if (dx == 0) {
-    // Vertical line
-    if (Ystart <= Yend) {
-      for (Ypoint = Ystart; Ypoint <= Yend; Ypoint++) {
-        Paint_SetPixel(Xpoint, Ypoint, Color);
-      }
-    } else {
-      for (Ypoint = Ystart; Ypoint >= Yend; Ypoint--) {
-        Paint_SetPixel(Xpoint, Ypoint, Color);
-      }
-    }
+  // Handle special cases: horizontal and vertical lines are one-pixel rectangles
+  if (dy == 0 || dx == 0) {
+    Paint_FillRect(Xstart, Ystart, Xend, Yend, Color);
     return;
   }
 
@@ -225,7 +464,6 @@ void EPD_DrawLine(uint16_t Xstart,uint16_t Ystart,uint16_t Xend,uint16_t Yend,ui
 *******************************************************************/
 void EPD_DrawRectangle(uint16_t Xstart,uint16_t Ystart,uint16_t Xend,uint16_t Yend,uint16_t Color,uint8_t mode)
 {
-	uint16_t i;
 	// Clamp coordinates to valid range to prevent out-of-bounds access
 	// EPD_W is 800, but Paint_SetPixel adds offset for X >= 396, so limit Xend to EPD_W - 1
 	// For rotation 180, X = widthMemory - Xpoint - 1, so Xpoint must be < widthMemory
@@ -236,10 +474,8 @@ void EPD_DrawRectangle(uint16_t Xstart,uint16_t Ystart,uint16_t Xend,uint16_t Ye
 
     if (mode)
 			{
-				for (i = Ystart; i < Yend; i++)
-				{
-          EPD_DrawLine(Xstart,i,Xend,i,Color);
-        }
+				// Rows Ystart..Yend-1, columns Xstart..Xend
+				if (Yend > Ystart) Paint_FillRect(Xstart, Ystart, Xend, Yend - 1, Color);
       }
 	  else
 	  {
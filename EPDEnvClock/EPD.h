@@ -13,7 +13,9 @@ typedef struct {
 	uint16_t rotate;
 	uint16_t widthByte;
 	uint16_t heightByte;
-	
+	uint16_t colStep;   //相邻字节列的地址间隔 (行优先为1)
+	uint16_t lineStep;  //相邻行的地址间隔 (控制器RAM顺序为1, 见EPD_FRAME_CONTROLLER_ORDER)
+
 }PAINT;
 extern PAINT Paint;
 
@@ -26,10 +28,20 @@ Rotaion:270-270度方向
 *******************/
 #define Rotation 180  
 
+//绘图统计: 主机基准测试(bench/)统计Paint_SetPixel调用次数, 固件默认关闭
+#ifndef EPD_PAINT_STATS
+#define EPD_PAINT_STATS 0
+#endif
+#if EPD_PAINT_STATS
+extern uint32_t Paint_SetPixelCount;
+#endif
+
 
 void Paint_NewImage(uint8_t *image,uint16_t Width,uint16_t Height,uint16_t Rotate,uint16_t Color); 					 //创建画布控制显示方向
 void Paint_SetPixel(uint16_t Xpoint,uint16_t Ypoint,uint16_t Color);
 void Paint_Clear(uint8_t Color);
+void Paint_DrawBitmap(uint16_t x,uint16_t y,uint16_t width,uint16_t height,const uint8_t *bitmap);  //不透明位图(按行,高位在左)
+void Paint_FillRect(uint16_t Xstart,uint16_t Ystart,uint16_t Xend,uint16_t Yend,uint16_t Color);  //矩形填充(含端点, 整字节写入)
 void EPD_DrawLine(uint16_t Xstart,uint16_t Ystart,uint16_t Xend,uint16_t Yend,uint16_t Color);
 void EPD_DrawRectangle(uint16_t Xstart,uint16_t Ystart,uint16_t Xend,uint16_t Yend,uint16_t Color,uint8_t mode);  //画矩形
 void EPD_DrawCircle(uint16_t X_Center,uint16_t Y_Center,uint16_t Radius,uint16_t Color,uint8_t mode);        //画圆
@@ -12,7 +12,13 @@
 #include "deep_sleep_manager.h"
 #include "logger.h"
 #include "sensor_logger.h"
+#include "sensor_record.h"
+#include "storage_manager.h"
 #include "parallel_tasks.h"
+#include "boot_profiler.h"
+#include "energy_model.h"
+#include "i2c_bus.h"
+#include "power_manager.h"
 
 namespace
 {
@@ -82,6 +88,369 @@ bool checkButton(int pin)
   return false;
 }
 
+// Inputs of the sensor log/upload step, captured before the display update
+struct SensorLogContext
+{
+  bool sensorReady = false;
+  int32_t measuredDriftMs = 0;
+  bool driftMeasured = false;
+  int64_t measuredCumulativeCompMs = 0;
+  time_t minLogTime = 0; // Start of the rendered minute (0 = not pre-rendered)
+  bool flushLog = false; // Write staged readings to SD this boot (low battery)
+};
+
+SensorLogContext g_sensorLogContext;
+bool g_postDrawStarted = false;
+// Upload retries can take several seconds each; give up well before the next minute
+constexpr unsigned long kPostDrawTimeoutMs = 30000;
+// Readings per upload request (6 hours; a normal boot has far fewer unsent)
+constexpr int kUploadBatchReadings = 360;
+// Extra catch-up batches stop after this long, leaving room under kPostDrawTimeoutMs
+constexpr unsigned long kCatchUpBudgetMs = 15000;
+// Below this battery percent (and not charging) only one batch is sent per boot
+constexpr float kCatchUpMinBatteryPercent = 30.0f;
+
+// SensorReadingVisitor: write one reading as a JSON array element
+bool writeBatchReading(const char *json, void *context)
+{
+  bool &first = *static_cast<bool *>(context);
+  if (!first && !NetworkManager_WriteBatchData(",", 1))
+  {
+    return false;
+  }
+  first = false;
+  return NetworkManager_WriteBatchData(json, strlen(json));
+}
+
+// Stream the planned readings from SD to the server as one JSON array
+// Memory use is the uploader's chunk buffer, independent of the number of readings
+bool uploadPlannedReadingsJson(const SensorLogUploadPlan &plan)
+{
+  if (!NetworkManager_BeginBatchUpload())
+  {
+    return false;
+  }
+
+  bool first = true;
+  const bool written = NetworkManager_WriteBatchData("[", 1) &&
+                       SensorLogger_ForEachPlannedReading(plan, writeBatchReading, &first) &&
+                       NetworkManager_WriteBatchData("]", 1);
+  if (!written)
+  {
+    // Never finish a truncated array; the server would reject it anyway
+    NetworkManager_AbortBatchUpload();
+    return false;
+  }
+  return NetworkManager_EndBatchUpload();
+}
+
+#if SENSOR_LOG_BINARY && SENSOR_UPLOAD_BINARY
+// Skip binary uploads for a day after the server rejected the content type
+constexpr time_t kBinaryUploadRetrySec = 24 * 60 * 60;
+
+struct BinaryBatchState
+{
+  SensorRecord previous; // Delta base (all-zero before the first record)
+};
+
+// SensorRecordVisitor: write one delta-encoded record (and this boot's profile)
+bool writeBatchRecord(const SensorRecord &record, const char *bootProfile, void *context)
+{
+  BinaryBatchState &state = *static_cast<BinaryBatchState *>(context);
+  uint8_t item[kSensorBatchMaxItemBytes];
+  const size_t length = SensorRecord_EncodeBatchItem(record, state.previous, kSensorBatchEncodingDelta, item);
+  state.previous = record;
+  if (!NetworkManager_WriteBatchData(item, length))
+  {
+    return false;
+  }
+  if (bootProfile != nullptr)
+  {
+    const size_t profileLength = strlen(bootProfile) < 255 ? strlen(bootProfile) : 255;
+    const uint8_t tag[2] = {kSensorBatchTagBootProfile, (uint8_t)profileLength};
+    return NetworkManager_WriteBatchData(tag, sizeof(tag)) &&
+           NetworkManager_WriteBatchData(bootProfile, profileLength);
+  }
+  return true;
+}
+
+// Stream the planned records as an application/x-epdenv-batch body
+// httpStatus receives the response code so a 415 can fall back to JSON
+bool uploadPlannedReadingsBinary(const SensorLogUploadPlan &plan, int &httpStatus)
+{
+  httpStatus = 0;
+  if (!NetworkManager_BeginBatchUpload(kSensorBatchContentType))
+  {
+    return false;
+  }
+
+  SensorBatchHeader header;
+  SensorBatchHeader_Init(header, kSensorBatchEncodingDelta);
+  BinaryBatchState state;
+  memset(&state.previous, 0, sizeof(state.previous));
+
+  const bool written = NetworkManager_WriteBatchData(&header, sizeof(header)) &&
+                       SensorLogger_ForEachPlannedRecord(plan, writeBatchRecord, &state);
+  if (!written)
+  {
+    NetworkManager_AbortBatchUpload();
+    return false;
+  }
+  return NetworkManager_EndBatchUpload(&httpStatus);
+}
+#endif
+
+// Upload the planned readings, preferring the compact binary batch when the server accepts it
+bool uploadPlannedReadings(const SensorLogUploadPlan &plan)
+{
+#if SENSOR_LOG_BINARY && SENSOR_UPLOAD_BINARY
+  RTCState &rtcState = DeepSleepManager_GetRTCState();
+  time_t now;
+  time(&now);
+  const bool recentlyRejected = rtcState.binaryUploadRejectedTime != 0 &&
+                                now >= rtcState.binaryUploadRejectedTime &&
+                                now - rtcState.binaryUploadRejectedTime < kBinaryUploadRetrySec;
+  if (!recentlyRejected)
+  {
+    int httpStatus = 0;
+    if (uploadPlannedReadingsBinary(plan, httpStatus))
+    {
+      return true;
+    }
+    if (httpStatus != 415)
+    {
+      return false;
+    }
+    // Older server without the binary decoder: use JSON and retry binary tomorrow
+    LOGW(LogTag::SETUP, "Server rejected binary batch (415), falling back to JSON");
+    rtcState.binaryUploadRejectedTime = now;
+  }
+#endif
+  return uploadPlannedReadingsJson(plan);
+}
+
+// Upload one plan, retrying up to 3 times on failure
+bool uploadPlanWithRetry(const SensorLogUploadPlan &plan)
+{
+  for (int attempt = 1; attempt <= 3; attempt++)
+  {
+    if (ParallelTasks_PostDrawCancelled())
+    {
+      LOGW(LogTag::SETUP, "Post-draw stage cancelled, upload continues on a later boot");
+      return false;
+    }
+    if (attempt > 1)
+    {
+      LOGI(LogTag::SETUP, "Retry attempt %d/3...", attempt);
+      delay(1000); // Wait 1 second before retry
+    }
+
+    if (uploadPlannedReadings(plan))
+    {
+      LOGI(LogTag::SETUP, "Batch data sent successfully");
+      return true;
+    }
+  }
+  return false;
+}
+
+// Whether another catch-up batch fits this boot: WiFi time is the dominant battery cost,
+// so stop at the time budget, and on a low battery unless it is charging
+bool catchUpAllowed(unsigned long uploadStartMs)
+{
+  if (millis() - uploadStartMs >= kCatchUpBudgetMs)
+  {
+    return false;
+  }
+  return g_batteryCharging || g_batteryPercent < 0.0f || g_batteryPercent >= kCatchUpMinBatteryPercent;
+}
+
+// Append the reading to the sensor log and send unsent readings to the server
+void logAndUploadSensorData(const SensorLogContext &ctx)
+{
+  // The previous wake cycle's estimate goes into this boot's record
+  EnergyModel_AccountPreviousWake();
+
+  // Log sensor values to the sensor log
+  if (ctx.sensorReady && SensorManager_IsInitialized())
+  {
+    struct tm timeinfo;
+    if (getLocalTime(&timeinfo))
+    {
+      // Get Unix timestamp
+      // When the record is written during a pre-boundary refresh, stamp it with the
+      // minute on screen rather than the last instant of the previous minute
+      // A pipelined reading was measured during the last sleep; stamp it with that time
+      time_t unixTimestamp;
+      time(&unixTimestamp);
+      if (SensorManager_IsFromPreviousWake() && SensorManager_GetMeasurementTime() < unixTimestamp)
+      {
+        unixTimestamp = SensorManager_GetMeasurementTime();
+      }
+      else if (unixTimestamp < ctx.minLogTime)
+      {
+        unixTimestamp = ctx.minLogTime;
+      }
+
+      // Get RTC drift - now measured every boot (not just at hourly sync)
+      // measuredDriftMs and driftMeasured were set earlier by parallel tasks
+      // For hourly sync: drift is from DeepSleepManager (system clock was corrected)
+      // For drift-only measurement: drift is from NTPClient (system clock unchanged)
+      int32_t rtcDriftMs = ctx.measuredDriftMs;
+      bool driftValid = ctx.driftMeasured;
+
+      // Get cumulative compensation (saved before MarkNtpSynced reset) and current drift rate
+      RTCState &logRtcState = DeepSleepManager_GetRTCState();
+      int64_t cumulativeCompMs = ctx.measuredCumulativeCompMs;
+      float driftRateMsPerMin = logRtcState.driftRateMsPerMin;
+
+      float temp = SensorManager_GetTemperature();
+      float humidity = SensorManager_GetHumidity();
+      uint16_t co2 = SensorManager_GetCO2();
+      float batteryVoltage = g_batteryVoltage;
+      float batteryPercent = g_batteryPercent;                 // Linear percent for display
+      float batteryMax17048Percent = g_batteryMax17048Percent; // MAX17048 for reference
+      float batteryChargeRate = g_batteryChargeRate;
+      bool batteryCharging = g_batteryCharging;
+
+      if (SensorLogger_LogValues(unixTimestamp, rtcDriftMs, cumulativeCompMs, driftRateMsPerMin, driftValid, temp, humidity, co2, batteryVoltage, batteryPercent, batteryMax17048Percent, batteryChargeRate, batteryCharging, EnergyModel_GetPreviousWakeUAh()))
+      {
+        LOGI(LogTag::SETUP, "Sensor values logged successfully");
+      }
+      else
+      {
+        LOGW(LogTag::SETUP, "Failed to log sensor values");
+      }
+
+      // Readings are staged in RTC memory; on a low battery a brownout would lose them
+      if (ctx.flushLog && !SensorLogger_Flush())
+      {
+        LOGW(LogTag::SETUP, "Failed to flush staged sensor readings");
+      }
+
+      // Send batch data to server if WiFi is connected
+      // Note: WiFi stays connected because we use delay() instead of light_sleep() when WiFi is active
+      if (networkState.wifiConnected)
+      {
+        RTCState &rtcState = DeepSleepManager_GetRTCState();
+
+        time_t now;
+        time(&now);
+
+        // First boot: get recent 120 readings and set lastUploadedTime to now
+        bool isFirstUpload = (rtcState.lastUploadedTime == 0);
+        time_t queryTime = rtcState.lastUploadedTime;
+
+        if (isFirstUpload)
+        {
+          // On first boot, only get last 2 hours of data (approx 120 readings)
+          queryTime = now - 7200;
+          LOGI(LogTag::SETUP, "First upload - getting recent readings only");
+        }
+
+        // The cursor only matches lastUploadedTime; the first upload scans by time instead
+        UploadCursor queryCursor = isFirstUpload ? UploadCursor() : rtcState.uploadCursor;
+
+        // Send oldest-first batches; after an outage keep catching up while the budget allows
+        // JSON formatting and TLS/HTTP run at the compute clock
+        PowerComputeScope compute;
+        const unsigned long uploadStartMs = millis();
+        int batches = 0;
+        bool attempted = false;
+        bool more = true;
+        while (more)
+        {
+          if (batches > 0 && !catchUpAllowed(uploadStartMs))
+          {
+            LOGI(LogTag::SETUP, "Backlog remains, continuing catch-up on a later boot");
+            break;
+          }
+
+          SensorLogUploadPlan plan;
+          int count = SensorLogger_PlanUpload(queryTime, queryCursor, plan, kUploadBatchReadings);
+          if (count == 0)
+          {
+            if (batches > 0)
+            {
+              break;
+            }
+            if (isFirstUpload)
+            {
+              // No recent data, but still update lastUploadedTime to avoid re-checking old logs
+              rtcState.lastUploadedTime = now;
+              rtcState.uploadCursor = UploadCursor();
+              DeepSleepManager_SaveLastUploadedTime(rtcState.lastUploadedTime);
+              LOGI(LogTag::SETUP, "No recent data, initialized last uploaded time to %ld", (long)now);
+            }
+            else
+            {
+              LOGI(LogTag::SETUP, "No new data to send (last uploaded: %ld)", (long)rtcState.lastUploadedTime);
+            }
+            break;
+          }
+
+          LOGI(LogTag::SETUP, "Found %d unsent readings%s", count, plan.more ? " (backlog, catching up)" : "");
+          attempted = true;
+          if (!uploadPlanWithRetry(plan))
+          {
+            LOGW(LogTag::SETUP, "Failed to send batch data after 3 attempts");
+            break;
+          }
+          batches++;
+
+          // On first upload, set to current time to skip old backlog
+          // On normal upload, set to the latest uploaded timestamp
+          // The cursor points past the newest uploaded line in both cases
+          rtcState.lastUploadedTime = isFirstUpload ? now : plan.latestTimestamp;
+          rtcState.uploadCursor = plan.latestCursor;
+          DeepSleepManager_SaveLastUploadedTime(rtcState.lastUploadedTime, rtcState.uploadCursor);
+          LOGI(LogTag::SETUP, "Updated last uploaded time to %ld", (long)rtcState.lastUploadedTime);
+
+          more = plan.more && !isFirstUpload;
+          queryTime = rtcState.lastUploadedTime;
+          queryCursor = rtcState.uploadCursor;
+        }
+
+        if (attempted)
+        {
+          PROFILE_MARK(Upload);
+        }
+      }
+      else
+      {
+        LOGI(LogTag::SETUP, "WiFi not connected, skipping server upload");
+      }
+    }
+    else
+    {
+      LOGW(LogTag::SETUP, "Cannot log sensor values: time not available");
+    }
+  }
+}
+
+// Work that is not an input of the frame (see the boot graph in setup())
+void postBootWork(const SensorLogContext &ctx)
+{
+  DisplayManager_ReadBatteryDetails();
+  DeepSleepManager_SaveDeferredState();
+  logAndUploadSensorData(ctx);
+}
+
+// Post-draw stage (Core 0): runs while the EPD waveform is in progress
+void postDrawWork(void *arg)
+{
+  postBootWork(*static_cast<SensorLogContext *>(arg));
+  if (!ParallelTasks_PostDrawCancelled())
+  {
+    Logger_FlushToSD(); // Cancelled: loop() flushes before sleep
+  }
+}
+
+void onRefreshStarted()
+{
+  g_postDrawStarted = ParallelTasks_StartPostDraw(postDrawWork, &g_sensorLogContext);
+}
+
 bool checkAnyButton()
 {
   return checkButton(HOME_KEY) || checkButton(EXIT_KEY) ||
@@ -92,6 +461,7 @@ bool checkAnyButton()
 
 void setup()
 {
+  BootProfiler_Begin();
   Serial.begin(115200);
 
   // Release I2C pins hold if they were held during deep sleep
@@ -101,11 +471,18 @@ void setup()
 
   // Initialize logger (default: DEBUG level, BOTH timestamp mode)
   Logger_Init(LogLevel::DEBUG, TimestampMode::BOTH);
+  // Storage mounts on first file access (either core), so create its lock before any task
+  StorageManager_Init();
+  // Same for the I2C bus locks (sensor task, main task and post-draw task share the buses)
+  I2CBus_Init();
+  // Waits run at the low clock from here on; compute sections raise it (power_manager.h)
+  PowerManager_Init();
 
   LOGI(LogTag::SETUP, "=== EPD Clock with SCD41 Sensor ===");
 
   // Initialize deep sleep manager first (checks if wake from sleep)
   DeepSleepManager_Init();
+  PROFILE_MARK(DeepSleepInit);
   bool wakeFromSleep = DeepSleepManager_IsWakeFromSleep();
 
   // If woke from GPIO (button press), treat as cold boot for full display init
@@ -145,23 +522,37 @@ void setup()
     LOGI(LogTag::SETUP, "Woke from GPIO (button press on pin %d)", wakeupPin);
   }
 
-  // Initialize display manager with wakeFromSleep flag
-  // This determines if we do full init or minimal wake-up
-  DisplayManager_Init(wakeFromSleep);
+  // === Boot graph ===
+  // The draw waits only on its real inputs; everything else runs after the refresh starts:
+  //
+  //   DeepSleepManager_Init (time restore) --+--> WiFi decision --> network task --+
+  //   battery voltage (WiFi gate, status) ---+                                     |
+  //                                          +--> sensor read ---------------------+--> draw --> refresh
+  //                                          +--> panel init (EPD wake + frame) ---+      |
+  //                                                                                       v
+  //   deferred (postBootWork): fuel gauge percent/rate, drift files, sensor log + upload, log flush
+  //
+  // On wake, panel init runs on this core while the WiFi/sensor tasks run. A cold boot
+  // initializes the panel first so the setup status can be shown while it waits.
+  if (!wakeFromSleep)
+  {
+    DisplayManager_Init(false);
+  }
 
   // === Parallel WiFi/NTP + Sensor Reading ===
   // Run WiFi/NTP sync and sensor reading in parallel using dual cores
   // This reduces startup time from ~18s to ~13s and enables single screen update
 
-  // Determine if full NTP sync is needed (top of hour) vs drift measurement only
+  // Determine if full NTP sync is needed (on the hour, adaptive interval) vs drift measurement only
   bool needFullNtpSync = DeepSleepManager_ShouldSyncWiFiNtp();
 
-  // TEMPORARY DIAGNOSTIC FEATURE (Dec 2025):
+  // DIAGNOSTIC FEATURE (Dec 2025):
   // Measure NTP drift every boot for RTC drift analysis.
   // This increases battery consumption by ~50% due to WiFi every boot.
   // To enable: set measureDriftOnly = !needFullNtpSync
+  // Normal operation relies on the adaptive NTP schedule (deep_sleep_manager.h) instead.
   // See docs/RTC_DEEP_SLEEP.md for details.
-  bool measureDriftOnly = false; // Disabled - only sync hourly to save battery
+  bool measureDriftOnly = false; // Disabled - the adaptive schedule decides when WiFi runs
 
   bool skipWifiDueToLowBattery = false;
 
@@ -209,15 +600,11 @@ void setup()
     }
   }
 
-  // Show status before starting tasks
+  // Show status before starting tasks (cold boot only; on wake this would cost a refresh)
   bool needWifi = needFullNtpSync || measureDriftOnly;
-  if (needWifi)
-  {
-    DisplayManager_DrawSetupStatus("WiFi + Sensor...");
-  }
-  else
+  if (!wakeFromSleep)
   {
-    DisplayManager_DrawSetupStatus("Reading Sensor...");
+    DisplayManager_DrawSetupStatus(needWifi ? "WiFi + Sensor..." : "Reading Sensor...");
   }
 
   unsigned long taskStartTime = millis();
@@ -234,6 +621,12 @@ void setup()
     LOGI("Setup", "Starting parallel tasks (WiFi + Sensor)");
     ParallelTasks_StartWiFiAndSensor(wakeFromSleep, needFullNtpSync, measureDriftOnly);
 
+    // Panel init overlaps the WiFi connect
+    if (wakeFromSleep)
+    {
+      DisplayManager_Init(true);
+    }
+
     // Wait for both tasks to complete (20 second timeout)
     bool parallelSuccess = ParallelTasks_WaitForCompletion(20000);
 
@@ -282,6 +675,11 @@ void setup()
     networkState.ntpSynced = false;
     Logger_SetNtpSynced(true); // RTC time is still valid
 
+    if (wakeFromSleep)
+    {
+      DisplayManager_Init(true);
+    }
+
     // Initialize and read sensor (single-core, uses light_sleep)
     if (SensorManager_Begin(wakeFromSleep))
     {
@@ -291,6 +689,7 @@ void setup()
       // Read sensor with light_sleep (keepWifiAlive=false)
       if (SensorManager_ReadBlocking(6000, false))
       {
+        PROFILE_MARK(SensorWait);
         sensorReady = true;
         LOGI(LogTag::SENSOR, "Sensor reading completed: T=%.1f, H=%.1f, CO2=%d",
              SensorManager_GetTemperature(),
@@ -313,6 +712,11 @@ void setup()
          taskDuration, sensorReady ? 1 : 0);
   }
 
+  if (sensorReady)
+  {
+    DeepSleepManager_NoteTemperature(SensorManager_GetTemperature());
+  }
+
   // Handle case where WiFi was skipped due to low battery
   if (skipWifiDueToLowBattery)
   {
@@ -321,7 +725,7 @@ void setup()
     Logger_SetNtpSynced(false);
   }
 
-  // Initialize sensor logger (after SD card is initialized by DeepSleepManager_Init)
+  // Initialize sensor logger (the SD card is mounted when staged readings are written)
   SensorLogger_Init();
 
   // === Safety: Wait if minute hasn't changed yet (only after processing) ===
@@ -333,6 +737,7 @@ void setup()
   // - positive: we're AFTER the boundary (late)
   float drawOffsetSec = 0.0f;
   float waitedSeconds = 0.0f;   // How long we waited for minute to change
+  float arrivalOffsetSec = 0.0f; // Offset when ready to draw, before any wait
   // EPD partial update takes ~0.65-0.75s (EPD_Display + PartUpdate).
   // Start updating this much BEFORE the minute boundary so the visible flip lands on the boundary.
   constexpr float kEpdLeadTimeSec = 0.70f;
@@ -380,13 +785,19 @@ void setup()
         }
 
         // Wait only until we're within the EPD lead-time window.
+        // Light sleep + esp_timer one-shot starts the draw on the target instead of a 1 ms tick
         int32_t waitMs = msUntilNextMinute - kEpdLeadTimeMs;
         if (waitMs > 0)
         {
           waitedSeconds = (float)waitMs / 1000.0f; // Record wait time for adjustment
           LOGI(LogTag::SETUP, "Still same minute (%d), waiting %d ms (lead %d ms) for boundary...",
                currentMinute, waitMs, kEpdLeadTimeMs);
-          delay((unsigned long)waitMs);
+          const int64_t boundaryUs = (int64_t)(nowSec - timeinfo.tm_sec + 60) * 1000000LL;
+          const int64_t targetUs = boundaryUs - (int64_t)kEpdLeadTimeMs * 1000LL;
+          struct timeval target;
+          target.tv_sec = (time_t)(targetUs / 1000000LL);
+          target.tv_usec = (suseconds_t)(targetUs % 1000000LL);
+          DeepSleepManager_WaitUntil(target, !networkState.wifiConnected);
         }
 
         // Recompute remaining ms to boundary after waiting, and pre-render the next minute.
@@ -411,6 +822,7 @@ void setup()
       }
       // Capture time offset with millisecond precision (right before display update)
       (void)computeOffsetSec(drawOffsetSec);
+      arrivalOffsetSec = drawOffsetSec - waitedSeconds;
     }
   }
   else
@@ -429,8 +841,27 @@ void setup()
   gettimeofday(&tvDisplayStart, NULL);
   (void)computeOffsetSec(displayStartOffsetSec);
 
+  g_sensorLogContext.sensorReady = sensorReady;
+  g_sensorLogContext.measuredDriftMs = measuredDriftMs;
+  g_sensorLogContext.driftMeasured = driftMeasured;
+  g_sensorLogContext.measuredCumulativeCompMs = measuredCumulativeCompMs;
+  g_sensorLogContext.flushLog = skipWifiDueToLowBattery;
+  if (overrideTimePtr != nullptr)
+  {
+    struct tm renderedMinute = *overrideTimePtr;
+    renderedMinute.tm_sec = 0;
+    g_sensorLogContext.minLogTime = mktime(&renderedMinute);
+  }
+  // WiFi boots overlap the upload with the refresh; otherwise the BUSY wait light sleeps
+  // and the (short) SD append runs afterwards
+  if (networkState.wifiConnected)
+  {
+    DisplayManager_SetRefreshStartedCallback(onRefreshStarted);
+  }
+
   DisplayManager_SetStatus("Running");
   const bool displayUpdated = DisplayManager_UpdateDisplay(networkState, true, overrideTimePtr);
+  DisplayManager_SetRefreshStartedCallback(nullptr);
 
   gettimeofday(&tvDisplayEnd, NULL);
   (void)computeOffsetSec(displayEndOffsetSec);
@@ -467,57 +898,45 @@ void setup()
     // Calculate actual delay considering measured NTP drift
     // Drift = NTP time - System time
     // Positive drift = system is behind (slow), so actual delay is larger
-    float actualOffsetAtDrawTime = drawOffsetSec;
+    float driftCorrectionSec = 0.0f;
     // Only apply drift correction when we measured drift WITHOUT setting the system clock.
     // For full NTP sync boots, the system clock has already been corrected.
     if (driftMeasured && !ntpSyncedThisBoot)
     {
-      actualOffsetAtDrawTime += (float)measuredDriftMs / 1000.0f;
-      LOGD(LogTag::SETUP, "Draw offset corrected for drift: %.3f + %.3f = %.3f sec",
-           drawOffsetSec, (float)measuredDriftMs / 1000.0f, actualOffsetAtDrawTime);
+      driftCorrectionSec = (float)measuredDriftMs / 1000.0f;
+      LOGD(LogTag::SETUP, "Draw offset corrected for drift: %.3f + %.3f sec", drawOffsetSec, driftCorrectionSec);
     }
 
-    // Goal: start drawing around -kEpdLeadTimeSec so the *visible* refresh lands on the boundary.
-    // Use smoothing formula: next = current + error * 0.5
-    // - If we waited for minute change -> woke too early -> decrease est proportionally
-    // - If offset != 0 -> adjust in both directions (early/late)
-    if (waitedSeconds > 0.1f) // We had to wait more than 100ms
+    // Jitter of the actual draw start against its target (what the histogram tracks)
+    DeepSleepManager_RecordDrawJitter((int32_t)lroundf((displayStartOffsetSec + driftCorrectionSec - targetOffsetSec) * 1000.0f));
+
+    // Goal: arrive WAKE_EARLY_MARGIN_MS before the draw target; DeepSleepManager_WaitUntil()
+    // then starts the draw on time. Smoothing: next = current + error * 0.5
+    // - arrived later than that -> increase the estimate
+    // - waited longer than the margin -> woke too early -> decrease it
+    const float arrivalTargetSec = targetOffsetSec - (float)WAKE_EARLY_MARGIN_MS / 1000.0f;
+    const float actualArrivalSec = arrivalOffsetSec + driftCorrectionSec;
+    const float error = actualArrivalSec - arrivalTargetSec;
+    constexpr float kDeadbandSec = 0.05f;
+    if (fabsf(error) > kDeadbandSec)
     {
-      // We woke too early - decrease estimated time proportionally
-      float adjustment = waitedSeconds * 0.5f;
-      float newEstimated = estimated - adjustment;
-      LOGI(LogTag::SETUP, "Processing time adjusted (%s): %.2f -> %.2f sec (waited %.3f sec)",
-           usedWifiThisBoot ? "wifi" : "no-wifi", estimated, newEstimated, waitedSeconds);
-      estimateRef = newEstimated;
-    }
-    else if (fabsf(actualOffsetAtDrawTime - targetOffsetSec) > 0.1f) // More than 100ms off target
-    {
-      // Smoothing: move halfway towards target
-      // error = actual - target
-      const float error = actualOffsetAtDrawTime - targetOffsetSec;
-      float adjustment = error * 0.5f;
-      float newEstimated = estimated + adjustment;
-      LOGI(LogTag::SETUP, "Processing time adjusted (%s): %.2f -> %.2f sec (draw offset: %.3f sec, target: %.3f sec)",
-           usedWifiThisBoot ? "wifi" : "no-wifi", estimated, newEstimated, actualOffsetAtDrawTime, targetOffsetSec);
+      float newEstimated = estimated + error * 0.5f;
+      LOGI(LogTag::SETUP, "Processing time adjusted (%s): %.2f -> %.2f sec (arrival: %.3f sec, target: %.3f sec, waited %.3f sec)",
+           usedWifiThisBoot ? "wifi" : "no-wifi", estimated, newEstimated, actualArrivalSec, arrivalTargetSec, waitedSeconds);
       estimateRef = newEstimated;
     }
     else
     {
-      LOGD(LogTag::SETUP, "Processing time optimal (%s): %.2f sec (draw offset: %.3f sec)",
-           usedWifiThisBoot ? "wifi" : "no-wifi", estimated, actualOffsetAtDrawTime);
+      LOGD(LogTag::SETUP, "Processing time optimal (%s): %.2f sec (arrival: %.3f sec)",
+           usedWifiThisBoot ? "wifi" : "no-wifi", estimated, actualArrivalSec);
     }
 
-    // Clamp to reasonable range: 1 to 20 seconds
-    if (estimateRef < 1.0f)
-    {
-      estimateRef = 1.0f;
-    }
-    else if (estimateRef > 20.0f)
-    {
-      estimateRef = 20.0f;
-    }
+    // Keep within the range DeepSleepManager_Init and the stored file accept (processing_time.h)
+    estimateRef = ProcessingTime_Clamp(estimateRef);
 
     // Persist if changed meaningfully (>=50ms) to survive power cycles
+    // RTC memory holds the live value; the copy on storage is refreshed on WiFi boots
+    // (which use the SD card for the upload anyway) so plain wakes need not mount it
     float change = estimateRef - estimated;
     if (change < 0)
     {
@@ -525,133 +944,32 @@ void setup()
     }
     if (change > 0.05f)
     {
+      rtcState.processingTimesUnsaved = true;
+    }
+    if (rtcState.processingTimesUnsaved && usedWifiThisBoot)
+    {
+      rtcState.processingTimesUnsaved = false;
       DeepSleepManager_SaveEstimatedProcessingTimes(rtcState.estimatedProcessingTimeNoWifi, rtcState.estimatedProcessingTimeWifi);
     }
   }
 
-  // Log sensor values to JSONL file
-  if (sensorReady && SensorManager_IsInitialized())
+  // === Post-draw I/O ===
+  // With WiFi the sensor log append + upload already ran on Core 0 during the refresh
+  if (g_postDrawStarted)
   {
-    struct tm timeinfo;
-    if (getLocalTime(&timeinfo))
-    {
-      // Get Unix timestamp
-      time_t unixTimestamp;
-      time(&unixTimestamp);
-
-      // Get RTC drift - now measured every boot (not just at hourly sync)
-      // measuredDriftMs and driftMeasured were set earlier by parallel tasks
-      // For hourly sync: drift is from DeepSleepManager (system clock was corrected)
-      // For drift-only measurement: drift is from NTPClient (system clock unchanged)
-      int32_t rtcDriftMs = measuredDriftMs;
-      bool driftValid = driftMeasured;
-
-      // Get cumulative compensation (saved before MarkNtpSynced reset) and current drift rate
-      RTCState &logRtcState = DeepSleepManager_GetRTCState();
-      int64_t cumulativeCompMs = measuredCumulativeCompMs;
-      float driftRateMsPerMin = logRtcState.driftRateMsPerMin;
-
-      float temp = SensorManager_GetTemperature();
-      float humidity = SensorManager_GetHumidity();
-      uint16_t co2 = SensorManager_GetCO2();
-      float batteryVoltage = g_batteryVoltage;
-      float batteryPercent = g_batteryPercent;                 // Linear percent for display
-      float batteryMax17048Percent = g_batteryMax17048Percent; // MAX17048 for reference
-      float batteryChargeRate = g_batteryChargeRate;
-      bool batteryCharging = g_batteryCharging;
-
-      if (SensorLogger_LogValues(timeinfo, unixTimestamp, rtcDriftMs, cumulativeCompMs, driftRateMsPerMin, driftValid, temp, humidity, co2, batteryVoltage, batteryPercent, batteryMax17048Percent, batteryChargeRate, batteryCharging))
-      {
-        LOGI(LogTag::SETUP, "Sensor values logged successfully");
-      }
-      else
-      {
-        LOGW(LogTag::SETUP, "Failed to log sensor values");
-      }
-
-      // Send batch data to server if WiFi is connected
-      // Note: WiFi stays connected because we use delay() instead of light_sleep() when WiFi is active
-      if (networkState.wifiConnected)
-      {
-        RTCState &rtcState = DeepSleepManager_GetRTCState();
-        String payload;
-        // Reserve memory to prevent reallocations (approx 200 bytes per record * 120 records = 24000 bytes)
-        // ESP32 has enough RAM for this
-        payload.reserve(24576);
-
-        time_t now;
-        time(&now);
-
-        // First boot: get recent 120 readings and set lastUploadedTime to now
-        bool isFirstUpload = (rtcState.lastUploadedTime == 0);
-        time_t queryTime = rtcState.lastUploadedTime;
-
-        if (isFirstUpload)
-        {
-          // On first boot, only get last 2 hours of data (approx 120 readings)
-          queryTime = now - 7200;
-          LOGI(LogTag::SETUP, "First upload - getting recent readings only");
-        }
-
-        time_t latestTimestamp = 0;
-        // Get up to 120 readings (2 hours worth) to handle upload failures gracefully
-        int count = SensorLogger_GetUnsentReadings(queryTime, payload, latestTimestamp, 120);
-
-        if (count > 0)
-        {
-          LOGI(LogTag::SETUP, "Found %d unsent readings", count);
-
-          // Retry up to 3 times on failure
-          bool uploadSuccess = false;
-          for (int attempt = 1; attempt <= 3 && !uploadSuccess; attempt++)
-          {
-            if (attempt > 1)
-            {
-              LOGI(LogTag::SETUP, "Retry attempt %d/3...", attempt);
-              delay(1000); // Wait 1 second before retry
-            }
-
-            if (NetworkManager_SendBatchData(payload))
-            {
-              uploadSuccess = true;
-              LOGI(LogTag::SETUP, "Batch data sent successfully");
-              // On first upload, set to current time to skip old backlog
-              // On normal upload, set to the latest uploaded timestamp
-              rtcState.lastUploadedTime = isFirstUpload ? now : latestTimestamp;
-              DeepSleepManager_SaveLastUploadedTime(rtcState.lastUploadedTime);
-              LOGI(LogTag::SETUP, "Updated last uploaded time to %ld", (long)rtcState.lastUploadedTime);
-            }
-          }
+    ParallelTasks_WaitForPostDraw(kPostDrawTimeoutMs);
+  }
+  else
+  {
+    postBootWork(g_sensorLogContext);
+  }
 
-          if (!uploadSuccess)
-          {
-            LOGW(LogTag::SETUP, "Failed to send batch data after 3 attempts");
-          }
-        }
-        else
-        {
-          if (isFirstUpload)
-          {
-            // No recent data, but still update lastUploadedTime to avoid re-checking old logs
-            rtcState.lastUploadedTime = now;
-            DeepSleepManager_SaveLastUploadedTime(rtcState.lastUploadedTime);
-            LOGI(LogTag::SETUP, "No recent data, initialized last uploaded time to %ld", (long)now);
-          }
-          else
-          {
-            LOGI(LogTag::SETUP, "No new data to send (last uploaded: %ld)", (long)rtcState.lastUploadedTime);
-          }
-        }
-      }
-      else
-      {
-        LOGI(LogTag::SETUP, "WiFi not connected, skipping server upload");
-      }
-    }
-    else
-    {
-      LOGW(LogTag::SETUP, "Cannot log sensor values: time not available");
-    }
+  // This boot's file I/O is done: flush the error log and power the SD card off now instead
+  // of at deep sleep. A later flush or a button redraw mounts it again on first access.
+  if (!ParallelTasks_PostDrawBusy())
+  {
+    Logger_FlushToSD();
+    StorageManager_PowerDown();
   }
 }
 
@@ -680,7 +998,14 @@ void loop()
   // Also, ASC (Automatic Self-Calibration) only works in idle mode
 
   // Flush any buffered ERROR/WARN logs to SD card before sleep
-  Logger_FlushToSD();
+  // (not while an overrun post-draw stage may still be writing to it)
+  if (!ParallelTasks_PostDrawBusy())
+  {
+    Logger_FlushToSD();
+  }
+
+  // Start the next reading now; the SCD41 measures while we sleep (SENSOR_PIPELINED_READ)
+  SensorManager_StartMeasurement();
 
   // Hold I2C pins high during deep sleep to prevent sensor reset
   DeepSleepManager_HoldI2CPins();
@@ -1,22 +1,214 @@
 #include "EPD_Init.h"
 #include "EPD.h"
 
+#include <string.h>
+#include <driver/gpio.h>
+#include <esp_sleep.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
 
+#include "frame_codec.h"
+#include "power_manager.h"
+
+namespace
+{
+constexpr uint32_t kRowBytes = EPD_W / 8;
+
+constexpr uint32_t kFrameBytes = kRowBytes * Gate_BITS;
+constexpr uint32_t kHalfColumns = Source_BYTES;
+
+// Column-ordered staging bands (DMA reads them directly). While one band is on the
+// wire the next one is gathered into the other buffer.
+constexpr uint32_t kBandColumns = 10;
+constexpr uint32_t kBandBytes = kBandColumns * Gate_BITS; // Below one DMA transaction (4092)
+WORD_ALIGNED_ATTR uint8_t EPD_BandBuffer[2][kBandBytes];
+
+// Mirror of what the master/slave 0x24/0xA4 RAMs currently hold (same layout
+// as ImageBW). Only trusted while EPD_ShadowValid is set.
+uint8_t EPD_Shadow[kFrameBytes];
+bool EPD_ShadowValid = false;
+
+// CRC32 of the shadow when the panel went to deep sleep. Deep sleep mode 1 keeps the
+// controller RAM and the panel supply (GPIO 7) is held on, so after the wake reset
+// 0x24/0xA4 still hold that frame; a restored frame with the same CRC re-seeds the shadow.
+// Cleared once read, so a boot that dies before EPD_DeepSleep() leaves it unset.
+RTC_DATA_ATTR uint32_t EPD_RetainedCrc = 0;
+RTC_DATA_ATTR bool EPD_RetainedValid = false;
+
+EPD_BusyWaitMode EPD_BusyMode = EPD_BUSY_WAIT_YIELD;
+// Task blocked in EPD_READBUSY (yield mode), notified by the BUSY falling edge
+TaskHandle_t volatile EPD_BusyWaiter = nullptr;
+
+void IRAM_ATTR EPD_BusyISR()
+{
+  TaskHandle_t waiter = EPD_BusyWaiter;
+  if (waiter == nullptr)
+    return;
+  BaseType_t woken = pdFALSE;
+  vTaskNotifyGiveFromISR(waiter, &woken);
+  if (woken)
+    portYIELD_FROM_ISR();
+}
+
+// Block on the BUSY falling-edge interrupt so other tasks (WiFi) keep running
+bool EPD_WaitBusyYield(uint32_t start)
+{
+  EPD_BusyWaiter = xTaskGetCurrentTaskHandle();
+  ulTaskNotifyTake(pdTRUE, 0); // Drop a stale edge from an earlier wait
+  attachInterrupt(digitalPinToInterrupt(BUSY), EPD_BusyISR, FALLING);
+  bool ready;
+  // Level is re-checked after arming, so an edge before attachInterrupt is not lost
+  while (!(ready = EPD_ReadBUSY == 0))
+  {
+    const uint32_t elapsed = millis() - start;
+    if (elapsed >= EPD_BUSY_TIMEOUT_MS)
+      break;
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(EPD_BUSY_TIMEOUT_MS - elapsed));
+  }
+  detachInterrupt(digitalPinToInterrupt(BUSY));
+  EPD_BusyWaiter = nullptr;
+  return ready;
+}
+
+// Light sleep until BUSY goes low (GPIO level wakeup) or the timeout expires
+bool EPD_WaitBusyLightSleep(uint32_t start)
+{
+  Serial.flush(); // UART output is garbled if we sleep with bytes in the FIFO
+  gpio_wakeup_enable((gpio_num_t)BUSY, GPIO_INTR_LOW_LEVEL);
+  esp_sleep_enable_gpio_wakeup();
+  bool ready;
+  while (!(ready = EPD_ReadBUSY == 0))
+  {
+    const uint32_t elapsed = millis() - start;
+    if (elapsed >= EPD_BUSY_TIMEOUT_MS)
+      break;
+    esp_sleep_enable_timer_wakeup((uint64_t)(EPD_BUSY_TIMEOUT_MS - elapsed) * 1000ULL);
+    PowerManager_LightSleep();
+  }
+  esp_sleep_disable_wakeup_source(ESP_SLEEP_WAKEUP_GPIO);
+  esp_sleep_disable_wakeup_source(ESP_SLEEP_WAKEUP_TIMER);
+  gpio_wakeup_disable((gpio_num_t)BUSY);
+  return ready;
+}
+} // namespace
+
+// Send byte-columns [colStart, colEnd) x lines [lineStart, lineEnd) of the
+// frame in controller order (every line of the first column, then the next
+// column, ...) as one burst. Whole columns of a controller-order frame go out
+// straight from the frame; otherwise they are gathered kBandColumns at a time,
+// overlapping the DMA transfer of the previous band.
+static void EPD_WriteColumns(const uint8_t *ImageBW, uint32_t colStart, uint32_t colEnd,
+                             uint32_t lineStart = 0, uint32_t lineEnd = Gate_BITS)
+{
+#if EPD_FRAME_CONTROLLER_ORDER
+  if (lineStart == 0 && lineEnd == Gate_BITS)
+  {
+    EPD_WR_DATA_Buffer(ImageBW + EPD_FRAME_INDEX(colStart, 0), (colEnd - colStart) * Gate_BITS);
+    return;
+  }
+#endif
+  uint8_t band = 0;
+  EPD_WR_DATA_Begin();
+  for (uint32_t bandStart = colStart; bandStart < colEnd; bandStart += kBandColumns)
+  {
+    const uint32_t bandEnd = bandStart + kBandColumns < colEnd ? bandStart + kBandColumns : colEnd;
+    uint8_t *dst = EPD_BandBuffer[band];
+    for (uint32_t col = bandStart; col < bandEnd; col++)
+    {
+      const uint8_t *src = ImageBW + EPD_FRAME_INDEX(col, lineStart);
+#if EPD_FRAME_CONTROLLER_ORDER
+      memcpy(dst, src, lineEnd - lineStart);
+      dst += lineEnd - lineStart;
+#else
+      for (uint32_t line = lineStart; line < lineEnd; line++)
+      {
+        *dst++ = *src;
+        src += kRowBytes;
+      }
+#endif
+    }
+    // Returns once the previous band is out, so the other buffer is free again
+    EPD_WR_DATA_Queue(EPD_BandBuffer[band], dst - EPD_BandBuffer[band]);
+    band ^= 1;
+  }
+  EPD_WR_DATA_End();
+}
+
+// Copy a byte-column x line rectangle of the frame into the RAM shadow
+static void EPD_ShadowCopy(const uint8_t *ImageBW, uint32_t colStart, uint32_t colEnd,
+                           uint32_t lineStart, uint32_t lineEnd)
+{
+#if EPD_FRAME_CONTROLLER_ORDER
+  for (uint32_t col = colStart; col < colEnd; col++)
+  {
+    const uint32_t offset = EPD_FRAME_INDEX(col, lineStart);
+    memcpy(EPD_Shadow + offset, ImageBW + offset, lineEnd - lineStart);
+  }
+#else
+  for (uint32_t line = lineStart; line < lineEnd; line++)
+  {
+    const uint32_t offset = EPD_FRAME_INDEX(colStart, line);
+    memcpy(EPD_Shadow + offset, ImageBW + offset, colEnd - colStart);
+  }
+#endif
+}
+
+// Send the same byte count times as one burst of band-sized segments
+static void EPD_WriteFill(uint8_t value, uint32_t count)
+{
+  memset(EPD_BandBuffer[0], value, kBandBytes);
+  EPD_WR_DATA_Begin();
+  while (count > 0)
+  {
+    const uint32_t chunk = count > kBandBytes ? kBandBytes : count;
+    EPD_WR_DATA_Queue(EPD_BandBuffer[0], chunk); // Only read, so it can be requeued right away
+    count -= chunk;
+  }
+  EPD_WR_DATA_End();
+}
 
 /*******************************************************************
     函数说明:判忙函数
     入口参数:无
-    说明:忙状态为1
+    返回值:true = 空闲, false = 超时 (EPD_BUSY_TIMEOUT_MS)
+    说明:忙状态为1; 等待方式由EPD_SetBusyWaitMode决定
 *******************************************************************/
-void EPD_READBUSY(void)
+bool EPD_READBUSY(void)
 {
-  while (1)
+  if (EPD_ReadBUSY == 0)
+  {
+    return true;
+  }
+
+  const uint32_t start = millis();
+  switch (EPD_BusyMode)
   {
-    if (EPD_ReadBUSY == 0)
+  case EPD_BUSY_WAIT_YIELD:
+    return EPD_WaitBusyYield(start);
+  case EPD_BUSY_WAIT_LIGHT_SLEEP:
+    return EPD_WaitBusyLightSleep(start);
+  default:
+    break;
+  }
+
+  while (EPD_ReadBUSY != 0)
+  {
+    if (millis() - start >= EPD_BUSY_TIMEOUT_MS)
     {
-      break;
+      return false;
     }
   }
+  return true;
+}
+
+/*******************************************************************
+    函数说明:判忙等待方式设置
+    入口参数:mode 见EPD_BusyWaitMode
+    说明:浅睡眠会暂停WiFi等外设, 仅在不需要它们时使用
+*******************************************************************/
+void EPD_SetBusyWaitMode(EPD_BusyWaitMode mode)
+{
+  EPD_BusyMode = mode;
 }
 /*******************************************************************
     函数说明:硬件复位函数
@@ -25,6 +217,7 @@ void EPD_READBUSY(void)
 *******************************************************************/
 void EPD_HW_RESET(void)
 {
+  EPD_ShadowValid = false; // RAM content is not trusted after a reset
   delay(10);
   EPD_RES_Clr();
   delay(10);
@@ -38,36 +231,56 @@ void EPD_HW_RESET(void)
     入口参数:无
     说明:更新显示内容到E-Paper
 *******************************************************************/
-void EPD_Update(void)
+bool EPD_Update(void)
+{
+  EPD_UpdateStart();
+  return EPD_READBUSY();
+}
+
+/*******************************************************************
+    函数说明:全刷启动函数
+    说明:只发出刷新命令不等待BUSY, 之后需调用EPD_READBUSY
+         (等待期间可并行处理其它工作)
+*******************************************************************/
+void EPD_UpdateStart(void)
 {
   EPD_WR_REG(0x22);
   EPD_WR_DATA8(0xF7);
   EPD_WR_REG(0x20);
-  EPD_READBUSY();
 }
 /*******************************************************************
     函数说明:局刷更新函数
     入口参数:无
     说明:E-Paper工作在局刷模式
 *******************************************************************/
-void EPD_PartUpdate(void)
+bool EPD_PartUpdate(void)
+{
+  EPD_PartUpdateStart();
+  return EPD_READBUSY();
+}
+
+/*******************************************************************
+    函数说明:局刷启动函数
+    说明:只发出刷新命令不等待BUSY, 之后需调用EPD_READBUSY
+         (等待期间可并行处理其它工作)
+*******************************************************************/
+void EPD_PartUpdateStart(void)
 {
   EPD_WR_REG(0x22);
   EPD_WR_DATA8(0xDC);
   EPD_WR_REG(0x20);
-  EPD_READBUSY();
 }
 /*******************************************************************
     函数说明:快刷更新函数
     入口参数:无
     说明:E-Paper工作在快刷模式
 *******************************************************************/
-void EPD_FastUpdate(void)
+bool EPD_FastUpdate(void)
 {
   EPD_WR_REG(0x22);
   EPD_WR_DATA8(0xC7);
   EPD_WR_REG(0x20);
-  EPD_READBUSY();
+  return EPD_READBUSY();
 }
 
 /*******************************************************************
@@ -84,6 +297,9 @@ void EPD_DeepSleep(void)
   EPD_WR_REG(0x10);
   EPD_WR_DATA8(0x01);
   delay(5);
+  EPD_RetainedValid = EPD_ShadowValid;
+  if (EPD_ShadowValid)
+    EPD_RetainedCrc = FrameCodec_Crc32(EPD_Shadow, sizeof(EPD_Shadow));
 }
 
 void EPD_Init(void)
@@ -123,153 +339,293 @@ void EPD_FastMode1Init(void)
   EPD_READBUSY();
 }
 
-void EPD_SetRAMMP(void)
+/*******************************************************************
+    函数说明:主芯片RAM窗口设置
+    入口参数:xStart/xEnd 字节列(0~0x31), yStart/yEnd 行地址(Y递减, 0x10F~0)
+*******************************************************************/
+void EPD_SetRAMMPWindow(uint8_t xStart, uint8_t xEnd, uint16_t yStart, uint16_t yEnd)
 {
   EPD_WR_REG(0x11);	 // Data Entry mode setting
   EPD_WR_DATA8(0x05);     // 1 –Y decrement, X increment
   EPD_WR_REG(0x44);	 						 // Set Ram X- address Start / End position
-  EPD_WR_DATA8(0x00);     						 // XStart, POR = 00h
-  EPD_WR_DATA8(0x31); //400/8-1
+  EPD_WR_DATA8(xStart);
+  EPD_WR_DATA8(xEnd);
   EPD_WR_REG(0x45);	 									// Set Ram Y- address  Start / End position
-  EPD_WR_DATA8(0x0f);
-  EPD_WR_DATA8(0x01);  //300-1
-  EPD_WR_DATA8(0x00);     									// YEnd L
-  EPD_WR_DATA8(0x00);
+  EPD_WR_DATA8(yStart & 0xFF);
+  EPD_WR_DATA8(yStart >> 8);
+  EPD_WR_DATA8(yEnd & 0xFF);
+  EPD_WR_DATA8(yEnd >> 8);
 }
 
-void EPD_SetRAMMA(void)
+void EPD_SetRAMMAAddr(uint8_t x, uint16_t y)
 {
   EPD_WR_REG(0x4e);
-  EPD_WR_DATA8(0x00);
+  EPD_WR_DATA8(x);
   EPD_WR_REG(0x4f);
-  EPD_WR_DATA8(0x0f);
-  EPD_WR_DATA8(0x01);
+  EPD_WR_DATA8(y & 0xFF);
+  EPD_WR_DATA8(y >> 8);
 }
 
-void EPD_SetRAMSP(void)
+/*******************************************************************
+    函数说明:从芯片RAM窗口设置
+    入口参数:xStart/xEnd 字节列(X递减, 0x31~0), yStart/yEnd 行地址(Y递减)
+*******************************************************************/
+void EPD_SetRAMSPWindow(uint8_t xStart, uint8_t xEnd, uint16_t yStart, uint16_t yEnd)
 {
   EPD_WR_REG(0x91);
   EPD_WR_DATA8(0x04);
   EPD_WR_REG(0xc4);	 // Set Ram X- address Start / End position
-  EPD_WR_DATA8(0x31);// XStart, POR = 00h
-  EPD_WR_DATA8(0x00);
+  EPD_WR_DATA8(xStart);
+  EPD_WR_DATA8(xEnd);
   EPD_WR_REG(0xc5);	 // Set Ram Y- address  Start / End position
-  EPD_WR_DATA8(0x0f);
-  EPD_WR_DATA8(0x01);
-  EPD_WR_DATA8(0x00);// YEnd L
-  EPD_WR_DATA8(0x00);
+  EPD_WR_DATA8(yStart & 0xFF);
+  EPD_WR_DATA8(yStart >> 8);
+  EPD_WR_DATA8(yEnd & 0xFF);
+  EPD_WR_DATA8(yEnd >> 8);
 }
 
-void EPD_SetRAMSA(void)
+void EPD_SetRAMSAAddr(uint8_t x, uint16_t y)
 {
   EPD_WR_REG(0xce);
-  EPD_WR_DATA8(0x31);
+  EPD_WR_DATA8(x);
   EPD_WR_REG(0xcf);
-  EPD_WR_DATA8(0x0f);
-  EPD_WR_DATA8(0x01);
+  EPD_WR_DATA8(y & 0xFF);
+  EPD_WR_DATA8(y >> 8);
+}
+
+void EPD_SetRAMMP(void)
+{
+  EPD_SetRAMMPWindow(0x00, 0x31, Gate_BITS - 1, 0x00); //400/8-1
+}
+
+void EPD_SetRAMMA(void)
+{
+  EPD_SetRAMMAAddr(0x00, Gate_BITS - 1);
+}
+
+void EPD_SetRAMSP(void)
+{
+  EPD_SetRAMSPWindow(0x31, 0x00, Gate_BITS - 1, 0x00);
+}
+
+void EPD_SetRAMSA(void)
+{
+  EPD_SetRAMSAAddr(0x31, Gate_BITS - 1);
 }
 
 void EPD_Clear_R26A6H(void)
 {
-  uint16_t i, j;
+  EPD_SetRAMMP();
   EPD_SetRAMMA();
   EPD_WR_REG(0x26);
-  for (i = 0; i < Gate_BITS; i++)
-  {
-    for (j = 0; j < Source_BYTES; j++)
-    {
-      EPD_WR_DATA8(0xFF);
-    }
-  }
+  EPD_WriteFill(0xFF, ALLSCREEN_BYTES);
+  EPD_SetRAMSP();
   EPD_SetRAMSA();
   EPD_WR_REG(0xA6);
-  for (i = 0; i < Gate_BITS; i++)
-  {
-    for (j = 0; j < Source_BYTES; j++)
-    {
-      EPD_WR_DATA8(0xFF);
-    }
-  }
+  EPD_WriteFill(0xFF, ALLSCREEN_BYTES);
 }
 
 void EPD_Display_Clear(void)
 {
-  uint16_t i, j;
   EPD_SetRAMMP();
   EPD_SetRAMMA();
   EPD_WR_REG(0x24);
-  for (i = 0; i < Gate_BITS; i++)
-  {
-    for (j = 0; j < Source_BYTES; j++)
-    {
-      EPD_WR_DATA8(0xFF);
-    }
-  }
+  EPD_WriteFill(0xFF, ALLSCREEN_BYTES);
   EPD_SetRAMMA();
   EPD_WR_REG(0x26);
-  for (i = 0; i < Gate_BITS; i++)
-  {
-    for (j = 0; j < Source_BYTES; j++)
-    {
-      EPD_WR_DATA8(0x00);
-    }
-  }
+  EPD_WriteFill(0x00, ALLSCREEN_BYTES);
   EPD_SetRAMSP();
   EPD_SetRAMSA();
   EPD_WR_REG(0xA4);
-  for (i = 0; i < Gate_BITS; i++)
-  {
-    for (j = 0; j < Source_BYTES; j++)
-    {
-      EPD_WR_DATA8(0xFF);
-    }
-  }
+  EPD_WriteFill(0xFF, ALLSCREEN_BYTES);
   EPD_SetRAMSA();
   EPD_WR_REG(0xA6);
-  for (i = 0; i < Gate_BITS; i++)
-  {
-    for (j = 0; j < Source_BYTES; j++)
-    {
-      EPD_WR_DATA8(0x00);
-    }
-  }
+  EPD_WriteFill(0x00, ALLSCREEN_BYTES);
+  memset(EPD_Shadow, WHITE, sizeof(EPD_Shadow));
+  EPD_ShadowValid = true;
 }
 
-
+/*******************************************************************
+    函数说明:全屏显示函数
+    入口参数:ImageBW 800x272帧缓冲 (布局见EPD_FRAME_CONTROLLER_ORDER)
+    说明:控制器RAM按列(Y方向)递增; 控制器RAM顺序的帧缓冲每半屏直接
+         以一次突发(一次CS拉低)经DMA写入主/从芯片, 行优先的帧缓冲先
+         按列重排到暂存区
+*******************************************************************/
 void EPD_Display(const uint8_t *ImageBW)
 {
-  uint32_t i;
-  uint8_t tempOriginal;
-  uint32_t tempcol = 0;
-  uint32_t templine = 0;
   EPD_SetRAMMP();
   EPD_SetRAMMA();
   EPD_WR_REG(0x24);
-  for (i = 0; i < ALLSCREEN_BYTES; i++)
-  {
-    tempOriginal = *(ImageBW + templine * Source_BYTES * 2 + tempcol);
-    templine++;
-    if (templine >= Gate_BITS)
-    {
-      tempcol++;
-      templine = 0;
-    }
-    EPD_WR_DATA8(tempOriginal);
-  }
+  EPD_WriteColumns(ImageBW, 0, kHalfColumns);
   EPD_SetRAMSP();
   EPD_SetRAMSA();
   EPD_WR_REG(0xa4);   //write RAM for black(0)/white (1)
-  for (i = 0; i < ALLSCREEN_BYTES; i++)
+  EPD_WriteColumns(ImageBW, kHalfColumns, 2 * kHalfColumns);
+  memcpy(EPD_Shadow, ImageBW, sizeof(EPD_Shadow));
+  EPD_ShadowValid = true;
+}
+
+/*******************************************************************
+    函数说明:旧画面恢复函数
+    入口参数:ImageBW 帧缓冲 (上一次显示的画面)
+    说明:只写入"上一帧"RAM (0x26/0xA6), 不刷新屏幕;
+         "当前帧"RAM (0x24/0xA4) 在休眠中保持不变, 若与该画面一致(CRC)
+         则直接作为镜像, 下一次EPD_DisplayChanged只写变化窗口;
+         这样唤醒后为一次整屏上传+一次窗口上传和一次局部刷新
+*******************************************************************/
+void EPD_DisplayPrevious(const uint8_t *ImageBW)
+{
+  EPD_SetRAMMP();
+  EPD_SetRAMMA();
+  EPD_WR_REG(0x26);
+  EPD_WriteColumns(ImageBW, 0, kHalfColumns);
+  EPD_SetRAMSP();
+  EPD_SetRAMSA();
+  EPD_WR_REG(0xA6);
+  EPD_WriteColumns(ImageBW, kHalfColumns, 2 * kHalfColumns);
+
+  // 0x24/0xA4 kept the frame they held before sleep; trust it only if it is this one
+  const bool retained = EPD_RetainedValid &&
+                        FrameCodec_Crc32(ImageBW, sizeof(EPD_Shadow)) == EPD_RetainedCrc;
+  EPD_RetainedValid = false;
+  if (retained)
+    memcpy(EPD_Shadow, ImageBW, sizeof(EPD_Shadow));
+  EPD_ShadowValid = retained;
+}
+
+/*******************************************************************
+    函数说明:窗口显示函数
+    入口参数:ImageBW 帧缓冲; x0,y0,x1,y1 帧缓冲坐标(含端点, x按字节列对齐)
+    说明:只把矩形范围写入对应芯片的RAM, 跨越两颗芯片时各写一次
+*******************************************************************/
+void EPD_DisplayRegion(const uint8_t *ImageBW, uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1)
+{
+  if (x1 >= EPD_W)
+    x1 = EPD_W - 1;
+  if (y1 >= EPD_H)
+    y1 = EPD_H - 1;
+  if (x0 > x1 || y0 > y1)
+    return;
+
+  const uint32_t colStart = x0 / 8;
+  const uint32_t colEnd = x1 / 8 + 1;
+  const uint32_t lineStart = y0;
+  const uint32_t lineEnd = y1 + 1;
+  // Buffer line l lives at RAM Y = 271 - l (both chips count Y downwards)
+  const uint16_t ramYStart = Gate_BITS - 1 - lineStart;
+  const uint16_t ramYEnd = Gate_BITS - 1 - (lineEnd - 1);
+
+  if (colStart < kHalfColumns)
   {
-    tempOriginal = *(ImageBW + templine * Source_BYTES * 2 + tempcol);
-    templine++;
-    if (templine >= Gate_BITS)
+    // Master: buffer column c -> RAM X = c (X increments)
+    const uint32_t end = colEnd < kHalfColumns ? colEnd : kHalfColumns;
+    EPD_SetRAMMPWindow(colStart, end - 1, ramYStart, ramYEnd);
+    EPD_SetRAMMAAddr(colStart, ramYStart);
+    EPD_WR_REG(0x24);
+    EPD_WriteColumns(ImageBW, colStart, end, lineStart, lineEnd);
+    EPD_ShadowCopy(ImageBW, colStart, end, lineStart, lineEnd);
+  }
+  if (colEnd > kHalfColumns)
+  {
+    // Slave: buffer column c -> RAM X = 99 - c (X decrements)
+    const uint32_t start = colStart > kHalfColumns ? colStart : kHalfColumns;
+    const uint8_t ramXStart = 2 * kHalfColumns - 1 - start;
+    const uint8_t ramXEnd = 2 * kHalfColumns - 1 - (colEnd - 1);
+    EPD_SetRAMSPWindow(ramXStart, ramXEnd, ramYStart, ramYEnd);
+    EPD_SetRAMSAAddr(ramXStart, ramYStart);
+    EPD_WR_REG(0xa4);
+    EPD_WriteColumns(ImageBW, start, colEnd, lineStart, lineEnd);
+    EPD_ShadowCopy(ImageBW, start, colEnd, lineStart, lineEnd);
+  }
+}
+
+/*******************************************************************
+    函数说明:差分显示函数
+    入口参数:ImageBW 帧缓冲
+    返回值:实际写入RAM的字节数 (0 = 与控制器RAM内容一致)
+    说明:与RAM镜像比较, 每颗芯片只写入变化部分的外接矩形;
+         镜像无效时(复位后等)退回全屏EPD_Display
+*******************************************************************/
+uint32_t EPD_DisplayChanged(const uint8_t *ImageBW)
+{
+  if (!EPD_ShadowValid)
+  {
+    EPD_Display(ImageBW);
+    return kFrameBytes;
+  }
+
+  uint32_t sent = 0;
+  for (uint32_t half = 0; half < 2; half++)
+  {
+    const uint32_t halfStart = half * kHalfColumns;
+    uint32_t minCol = kHalfColumns * 2, maxCol = 0;
+    uint32_t minLine = Gate_BITS, maxLine = 0;
+
+#if EPD_FRAME_CONTROLLER_ORDER
+    for (uint32_t col = halfStart; col < halfStart + kHalfColumns; col++)
     {
-      tempcol++;
-      templine = 0;
+      const uint8_t *a = ImageBW + EPD_FRAME_INDEX(col, 0);
+      const uint8_t *b = EPD_Shadow + EPD_FRAME_INDEX(col, 0);
+      if (memcmp(a, b, Gate_BITS) == 0)
+        continue;
+
+      uint32_t first = 0;
+      while (a[first] == b[first])
+        first++;
+      uint32_t last = Gate_BITS - 1;
+      while (a[last] == b[last])
+        last--;
+
+      if (first < minLine)
+        minLine = first;
+      if (last > maxLine)
+        maxLine = last;
+      if (col < minCol)
+        minCol = col;
+      maxCol = col;
     }
-    EPD_WR_DATA8(tempOriginal);
+#else
+    for (uint32_t line = 0; line < Gate_BITS; line++)
+    {
+      const uint8_t *a = ImageBW + line * kRowBytes + halfStart;
+      const uint8_t *b = EPD_Shadow + line * kRowBytes + halfStart;
+      if (memcmp(a, b, kHalfColumns) == 0)
+        continue;
+
+      uint32_t first = 0;
+      while (a[first] == b[first])
+        first++;
+      uint32_t last = kHalfColumns - 1;
+      while (a[last] == b[last])
+        last--;
+
+      if (halfStart + first < minCol)
+        minCol = halfStart + first;
+      if (halfStart + last > maxCol)
+        maxCol = halfStart + last;
+      if (line < minLine)
+        minLine = line;
+      maxLine = line;
+    }
+#endif
+
+    if (minLine > maxLine)
+      continue; // This chip is unchanged
+
+    EPD_DisplayRegion(ImageBW, minCol * 8, minLine, maxCol * 8 + 7, maxLine);
+    sent += (maxCol - minCol + 1) * (maxLine - minLine + 1);
   }
+  return sent;
+}
+
+/*******************************************************************
+    函数说明:使RAM镜像失效
+    说明:复位或以其它方式写RAM后调用, 下次EPD_DisplayChanged会全屏写入
+*******************************************************************/
+void EPD_InvalidateShadow(void)
+{
+  EPD_ShadowValid = false;
 }
 
 //Horizontal scanning, from right to left, from bottom to top
@@ -280,6 +636,8 @@ void EPD_WhiteScreen_ALL_Fast(const unsigned char *datas)
   unsigned int tempcol = 0;
   unsigned int templine = 0;
 
+  EPD_ShadowValid = false; // Writes inverted data, no longer matches a frame buffer
+
   EPD_WR_REG(0x11);
   EPD_WR_DATA8(0x05);
 
@@ -303,7 +661,7 @@ void EPD_WhiteScreen_ALL_Fast(const unsigned char *datas)
   EPD_WR_REG(0x24);   //write RAM for black(0)/white (1)
   for (i = 0; i < Source_BYTES * Gate_BITS; i++)
   {
-    tempOriginal = *(datas + templine * Source_BYTES * 2 + tempcol);
+    tempOriginal = datas[EPD_FRAME_INDEX(tempcol, templine)];
     templine++;
     if (templine >= Gate_BITS)
     {
@@ -346,7 +704,7 @@ void EPD_WhiteScreen_ALL_Fast(const unsigned char *datas)
   EPD_WR_REG(0xa4);   //write RAM for black(0)/white (1)
   for (i = 0; i < Source_BYTES * Gate_BITS; i++)
   {
-    tempOriginal = *(datas + templine * Source_BYTES * 2 + tempcol);
+    tempOriginal = datas[EPD_FRAME_INDEX(tempcol, templine)];
     templine++;
     if (templine >= Gate_BITS)
     {
@@ -21,14 +21,48 @@
 #define Gate_BITS  	 272
 #define ALLSCREEN_BYTES Source_BYTES*Gate_BITS
 
-void EPD_READBUSY(void);
+//帧缓冲布局 (ImageBW / Paint.Image, 800x272, 每字节8个横向像素)
+//  0: 行优先, 每行100字节
+//  1: 控制器RAM顺序, 按字节列存放 (每列272行), 主芯片50列在前, 从芯片50列在后;
+//     绘制时即完成重排, 全屏上传为两段连续突发
+#ifndef EPD_FRAME_CONTROLLER_ORDER
+#define EPD_FRAME_CONTROLLER_ORDER 1
+#endif
+//字节列col (0~99), 行line (0~271) 在帧缓冲中的下标
+#if EPD_FRAME_CONTROLLER_ORDER
+#define EPD_FRAME_INDEX(col, line) ((uint32_t)(col) * Gate_BITS + (uint32_t)(line))
+#else
+#define EPD_FRAME_INDEX(col, line) ((uint32_t)(line) * (EPD_W / 8) + (uint32_t)(col))
+#endif
+
+//判忙等待超时 (全刷约3s, 超时后放弃等待以免卡死)
+#ifndef EPD_BUSY_TIMEOUT_MS
+#define EPD_BUSY_TIMEOUT_MS 10000
+#endif
+
+//判忙等待方式
+typedef enum
+{
+  EPD_BUSY_WAIT_SPIN,        //轮询 (原实现)
+  EPD_BUSY_WAIT_YIELD,       //BUSY下降沿中断 + 任务通知, 等待期间让出CPU
+  EPD_BUSY_WAIT_LIGHT_SLEEP, //BUSY低电平GPIO唤醒的浅睡眠 (WiFi等需关闭)
+} EPD_BusyWaitMode;
+
+bool EPD_READBUSY(void);
+void EPD_SetBusyWaitMode(EPD_BusyWaitMode mode);
 void EPD_HW_RESET(void);
-void EPD_Update(void);
-void EPD_PartUpdate(void);
-void EPD_FastUpdate(void);
+bool EPD_Update(void);
+void EPD_UpdateStart(void);
+bool EPD_PartUpdate(void);
+void EPD_PartUpdateStart(void);
+bool EPD_FastUpdate(void);
 void EPD_DeepSleep(void);
 void EPD_Init(void);
 void EPD_FastMode1Init(void);
+void EPD_SetRAMMPWindow(uint8_t xStart, uint8_t xEnd, uint16_t yStart, uint16_t yEnd);
+void EPD_SetRAMMAAddr(uint8_t x, uint16_t y);
+void EPD_SetRAMSPWindow(uint8_t xStart, uint8_t xEnd, uint16_t yStart, uint16_t yEnd);
+void EPD_SetRAMSAAddr(uint8_t x, uint16_t y);
 void EPD_SetRAMMP(void);
 void EPD_SetRAMMA(void);
 void EPD_SetRAMSP(void);
@@ -36,5 +70,9 @@ void EPD_SetRAMSA(void);
 void EPD_Clear_R26A6H(void);
 void EPD_Display_Clear(void);
 void EPD_Display(const uint8_t *ImageBW);
+void EPD_DisplayPrevious(const uint8_t *ImageBW);
+void EPD_DisplayRegion(const uint8_t *ImageBW, uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1);
+uint32_t EPD_DisplayChanged(const uint8_t *ImageBW);
+void EPD_InvalidateShadow(void);
 void EPD_WhiteScreen_ALL_Fast(const unsigned char *datas);
 #endif
@@ -297,4 +297,54 @@ inline uint16_t calculateGlyphsWidth(const uint8_t* glyphs, uint8_t count, FontS
   return width;
 }
 
+// ============================================================
+// Fixed-point pair advances (folded at compile time)
+// ============================================================
+
+// Pen advance from one glyph to the next: advance width + spacing adjust + pair kerning,
+// in 16.16 fixed-point pixels. Indexed [left][right]; the renderer never scans the tables above.
+constexpr uint8_t kGlyphCount = 12;
+constexpr int kGlyphFixedShift = 16;
+constexpr int32_t kGlyphFixedHalf = 1 << (kGlyphFixedShift - 1);
+
+constexpr int32_t toGlyphFixed(double px) {
+  return (int32_t)(px * (1 << kGlyphFixedShift) + (px < 0.0 ? -0.5 : 0.5));
+}
+
+constexpr int16_t kerningUnits(const KerningPair *table, size_t size, uint8_t left, uint8_t right) {
+  return size == 0 ? 0
+       : (table->left == left && table->right == right) ? table->value
+       : kerningUnits(table + 1, size - 1, left, right);
+}
+
+constexpr int32_t pairAdvanceL(uint8_t left, uint8_t right) {
+  return toGlyphFixed((AdvanceWidths[left] + kerningUnits(KerningTableL, KerningTableL_SIZE, left, right)) * 181.5 / 1000.0 +
+                      kSpacingAdjustL);
+}
+
+constexpr int32_t pairAdvanceM(uint8_t left, uint8_t right) {
+  return toGlyphFixed((AdvanceWidths[left] + kerningUnits(KerningTableMS, KerningTableMS_SIZE, left, right)) * 90.8 / 1000.0 +
+                      kSpacingAdjustM);
+}
+
+#define GLYPH_PAIR_ROW(fn, left) \
+  {fn(left, 0), fn(left, 1), fn(left, 2), fn(left, 3), fn(left, 4), fn(left, 5), \
+   fn(left, 6), fn(left, 7), fn(left, 8), fn(left, 9), fn(left, 10), fn(left, 11)}
+
+constexpr int32_t GlyphPairAdvanceL[kGlyphCount][kGlyphCount] = {
+  GLYPH_PAIR_ROW(pairAdvanceL, 0), GLYPH_PAIR_ROW(pairAdvanceL, 1), GLYPH_PAIR_ROW(pairAdvanceL, 2),
+  GLYPH_PAIR_ROW(pairAdvanceL, 3), GLYPH_PAIR_ROW(pairAdvanceL, 4), GLYPH_PAIR_ROW(pairAdvanceL, 5),
+  GLYPH_PAIR_ROW(pairAdvanceL, 6), GLYPH_PAIR_ROW(pairAdvanceL, 7), GLYPH_PAIR_ROW(pairAdvanceL, 8),
+  GLYPH_PAIR_ROW(pairAdvanceL, 9), GLYPH_PAIR_ROW(pairAdvanceL, 10), GLYPH_PAIR_ROW(pairAdvanceL, 11),
+};
+
+constexpr int32_t GlyphPairAdvanceM[kGlyphCount][kGlyphCount] = {
+  GLYPH_PAIR_ROW(pairAdvanceM, 0), GLYPH_PAIR_ROW(pairAdvanceM, 1), GLYPH_PAIR_ROW(pairAdvanceM, 2),
+  GLYPH_PAIR_ROW(pairAdvanceM, 3), GLYPH_PAIR_ROW(pairAdvanceM, 4), GLYPH_PAIR_ROW(pairAdvanceM, 5),
+  GLYPH_PAIR_ROW(pairAdvanceM, 6), GLYPH_PAIR_ROW(pairAdvanceM, 7), GLYPH_PAIR_ROW(pairAdvanceM, 8),
+  GLYPH_PAIR_ROW(pairAdvanceM, 9), GLYPH_PAIR_ROW(pairAdvanceM, 10), GLYPH_PAIR_ROW(pairAdvanceM, 11),
+};
+
+#undef GLYPH_PAIR_ROW
+
 #endif // KERNING_TABLE_H
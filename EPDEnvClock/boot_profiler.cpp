@@ -0,0 +1,177 @@
+#include "boot_profiler.h"
+
+#include <esp_sleep.h>
+#include <esp_timer.h>
+#include <esp32/clk.h>
+
+namespace
+{
+constexpr uint32_t kBootProfileMagic = 0x50524F46; // "PROF"
+constexpr size_t kPhaseCount = static_cast<size_t>(BootPhase::Count);
+// ROM + bootloader normally take ~100-300 ms; anything else is a bad estimate
+constexpr int64_t kMaxPreTimerUs = 2000000;
+
+struct BootProfile
+{
+  uint32_t magic;
+  uint64_t sleepEnterRtcUs;  // esp_clk_rtc_time() when entering deep sleep
+  uint64_t sleepDurationUs;  // Programmed timer wakeup
+  uint32_t marksUs[kPhaseCount]; // Time since wakeup (0 = not reached)
+  uint32_t cpuTimeUs[kBootProfilerCpuSlots]; // Awake time per CPU clock
+  uint32_t preTimerUs;
+  uint32_t lightSleepUs;
+  uint32_t radioOnUs;
+};
+
+// Current boot's profile; still holds the previous boot's marks until Begin()
+RTC_DATA_ATTR BootProfile rtcProfile;
+
+BootProfilePrevious previous;
+bool previousValid = false;
+int64_t preTimerUs = 0; // Wakeup -> esp_timer start, added to every mark
+int64_t radioOnSinceUs = -1; // esp_timer time the radio was turned on (-1 = off)
+} // namespace
+
+void BootProfiler_Begin()
+{
+  const bool rtcValid = rtcProfile.magic == kBootProfileMagic;
+  previousValid = rtcValid;
+  if (rtcValid)
+  {
+    memcpy(previous.marksUs, rtcProfile.marksUs, sizeof(previous.marksUs));
+    memcpy(previous.cpuTimeUs, rtcProfile.cpuTimeUs, sizeof(previous.cpuTimeUs));
+    previous.preTimerUs = rtcProfile.preTimerUs;
+    previous.lightSleepUs = rtcProfile.lightSleepUs;
+    previous.radioOnUs = rtcProfile.radioOnUs;
+    previous.sleepUs = rtcProfile.sleepDurationUs;
+  }
+
+  // The RTC timer keeps running in deep sleep, so after a timer wakeup the time
+  // since wakeup is now - (sleep entry + sleep duration)
+  preTimerUs = 0;
+  const esp_sleep_wakeup_cause_t cause = esp_sleep_get_wakeup_cause();
+  if (rtcValid && rtcProfile.sleepEnterRtcUs != 0 && cause == ESP_SLEEP_WAKEUP_TIMER)
+  {
+    const int64_t sinceWakeUs =
+        (int64_t)(esp_clk_rtc_time() - rtcProfile.sleepEnterRtcUs - rtcProfile.sleepDurationUs);
+    const int64_t estimate = sinceWakeUs - esp_timer_get_time();
+    if (estimate > 0 && estimate < kMaxPreTimerUs)
+    {
+      preTimerUs = estimate;
+    }
+  }
+  else if (rtcValid && rtcProfile.sleepEnterRtcUs != 0 && cause != ESP_SLEEP_WAKEUP_UNDEFINED)
+  {
+    // Early (button) wakeup: the sleep ended before the programmed duration
+    const int64_t sleptUs = (int64_t)(esp_clk_rtc_time() - rtcProfile.sleepEnterRtcUs) - esp_timer_get_time();
+    previous.sleepUs = sleptUs > 0 && (uint64_t)sleptUs < rtcProfile.sleepDurationUs ? (uint64_t)sleptUs
+                                                                                       : rtcProfile.sleepDurationUs;
+  }
+  else
+  {
+    // Reset rather than a wakeup: no deep sleep followed the previous boot
+    previous.sleepUs = 0;
+  }
+
+  memset(&rtcProfile, 0, sizeof(rtcProfile));
+  rtcProfile.magic = kBootProfileMagic;
+  rtcProfile.preTimerUs = (uint32_t)preTimerUs;
+  PROFILE_MARK(RomBoot);
+}
+
+void BootProfiler_Mark(BootPhase phase)
+{
+  const size_t index = static_cast<size_t>(phase);
+  if (index >= kPhaseCount || rtcProfile.marksUs[index] != 0)
+  {
+    return;
+  }
+  rtcProfile.marksUs[index] = (uint32_t)(esp_timer_get_time() + preTimerUs);
+}
+
+void BootProfiler_AddCpuTime(uint16_t cpuMhz, uint32_t durationUs)
+{
+  uint8_t slot = 0;
+  while (slot + 1 < kBootProfilerCpuSlots && cpuMhz > kBootProfilerCpuMhz[slot])
+  {
+    slot++;
+  }
+  rtcProfile.cpuTimeUs[slot] += durationUs;
+}
+
+void BootProfiler_AddLightSleepTime(uint32_t durationUs)
+{
+  rtcProfile.lightSleepUs += durationUs;
+}
+
+void BootProfiler_SetRadio(bool on)
+{
+  const int64_t nowUs = esp_timer_get_time();
+  if (on && radioOnSinceUs < 0)
+  {
+    radioOnSinceUs = nowUs;
+  }
+  else if (!on && radioOnSinceUs >= 0)
+  {
+    rtcProfile.radioOnUs += (uint32_t)(nowUs - radioOnSinceUs);
+    radioOnSinceUs = -1;
+  }
+}
+
+uint32_t BootProfiler_GetPreviousCpuTimeMs(uint8_t slot)
+{
+  if (!previousValid || slot >= kBootProfilerCpuSlots)
+  {
+    return 0;
+  }
+  return previous.cpuTimeUs[slot] / 1000;
+}
+
+bool BootProfiler_GetPrevious(BootProfilePrevious &out)
+{
+  if (previousValid)
+  {
+    out = previous;
+  }
+  return previousValid;
+}
+
+void BootProfiler_PrepareSleep(uint64_t sleepDurationUs)
+{
+  BootProfiler_SetRadio(false);
+  rtcProfile.sleepDurationUs = sleepDurationUs;
+  rtcProfile.sleepEnterRtcUs = esp_clk_rtc_time();
+}
+
+bool BootProfiler_FormatPrevious(char *buffer, size_t bufferSize)
+{
+  if (!previousValid || bufferSize < 3)
+  {
+    return false;
+  }
+
+  size_t len = 0;
+  buffer[len++] = '[';
+  for (size_t i = 0; i < kPhaseCount; i++)
+  {
+    char entry[16];
+    int n;
+    if (previous.marksUs[i] == 0)
+    {
+      n = snprintf(entry, sizeof(entry), "%snull", i ? "," : "");
+    }
+    else
+    {
+      n = snprintf(entry, sizeof(entry), "%s%lu", i ? "," : "", (unsigned long)(previous.marksUs[i] / 1000));
+    }
+    if (n < 0 || len + n + 2 > bufferSize)
+    {
+      return false;
+    }
+    memcpy(buffer + len, entry, n);
+    len += n;
+  }
+  buffer[len++] = ']';
+  buffer[len] = '\0';
+  return true;
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <Arduino.h>
+
+// Boot phase profiler
+// Each mark stores the time since wakeup (esp_timer_get_time() plus the ROM/bootloader
+// time before esp_timer started) at which a phase finished. Marks live in RTC memory so
+// the previous boot's complete profile (including save/upload) can be logged next boot.
+
+// Boot phases, roughly in the order they complete (WiFi and sensor phases overlap)
+enum class BootPhase : uint8_t
+{
+  RomBoot = 0,   // Wakeup -> setup() entry (ROM, bootloader, app init)
+  DeepSleepInit, // DeepSleepManager_Init() done (RTC state, storage)
+  SdMount,       // SD card (or SPIFFS fallback) mounted, on the first file access (most wakes: never)
+  FrameLoad,     // Previous frame restored
+  WifiConnect,   // WiFi connected
+  NtpSync,       // NTP sync / drift measurement done
+  SensorWait,    // SCD41 measurement read
+  Draw,          // Frame buffer composed
+  EpdDisplay,    // Frame uploaded to EPD RAM
+  Refresh,       // EPD waveform finished (BUSY low)
+  Save,          // Frame buffer persisted
+  Upload,        // Batch upload finished
+  Count
+};
+
+#define PROFILE_MARK(phase) BootProfiler_Mark(BootPhase::phase)
+
+// Call first thing in setup(): keeps the previous boot's marks and starts a new profile
+void BootProfiler_Begin();
+
+// Record the end of a phase (first mark wins, so a phase cannot be counted twice)
+void BootProfiler_Mark(BootPhase phase);
+
+// Call right before esp_deep_sleep_start() so the next boot can measure ROM boot time
+void BootProfiler_PrepareSleep(uint64_t sleepDurationUs);
+
+// CPU clocks whose awake time is accounted (power_manager.*); other clocks use the nearest slot
+constexpr uint8_t kBootProfilerCpuSlots = 3;
+constexpr uint16_t kBootProfilerCpuMhz[kBootProfilerCpuSlots] = {80, 160, 240};
+
+// Add awake time spent at a CPU clock to this boot's profile
+void BootProfiler_AddCpuTime(uint16_t cpuMhz, uint32_t durationUs);
+
+// Add time spent in light sleep (PowerManager_LightSleep(); not counted as CPU time)
+void BootProfiler_AddLightSleepTime(uint32_t durationUs);
+
+// Radio on/off edges (WiFi.mode(WIFI_STA) / WIFI_OFF); PrepareSleep() closes an open interval
+void BootProfiler_SetRadio(bool on);
+
+// Previous boot's time at kBootProfilerCpuMhz[slot] in ms (0 if unavailable)
+uint32_t BootProfiler_GetPreviousCpuTimeMs(uint8_t slot);
+
+// Previous wake cycle: the previous boot's profile and the deep sleep that followed it
+struct BootProfilePrevious
+{
+  uint32_t marksUs[static_cast<size_t>(BootPhase::Count)]; // 0 = not reached
+  uint32_t cpuTimeUs[kBootProfilerCpuSlots];
+  uint32_t preTimerUs;     // Wakeup -> esp_timer start (not in cpuTimeUs)
+  uint32_t lightSleepUs;
+  uint32_t radioOnUs;
+  uint64_t sleepUs;        // Deep sleep that ended with this boot
+};
+
+// Returns false if no previous profile is available (cold boot)
+bool BootProfiler_GetPrevious(BootProfilePrevious &previous);
+
+// Previous boot's profile as a compact JSON array of ms since wakeup, one entry per
+// BootPhase (null = phase not reached), e.g. [310,342,...]
+// Returns false if no previous profile is available
+bool BootProfiler_FormatPrevious(char *buffer, size_t bufferSize);
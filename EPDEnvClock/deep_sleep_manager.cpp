@@ -1,18 +1,24 @@
 #include "deep_sleep_manager.h"
+#include "EPD_Init.h"
 #include "spi.h"
 
 #include <WiFi.h>
 #include <esp_sleep.h>
 #include <esp_timer.h>
 #include <esp32/clk.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
 #include <time.h>
-#include <SPI.h>
 #include <SPIFFS.h>
 #include <SD.h>
 #include <sys/time.h>
 #include "logger.h"
+#include "frame_codec.h"
+#include "boot_profiler.h"
+#include "power_manager.h"
 #include "fuel_gauge_manager.h"
 #include "sensor_manager.h"
+#include "storage_manager.h"
 
 // Arduino/ESP32 toolchain sometimes misses the prototype in C++ translation units
 extern "C" int settimeofday(const struct timeval *tv, const struct timezone *tz);
@@ -25,33 +31,233 @@ namespace
 // RTC memory attribute ensures this persists across deep sleep
 RTC_DATA_ATTR RTCState rtcState;
 
-// SD card pin configuration (SPI interface)
-// Using HSPI bus (separate from EPD display which uses bit-banging SPI)
-// Based on official 5.79" E-Paper example from CrowPanel
-// EPD uses bit-banging SPI on pins 11, 12, 45, 46, 47, 48
-// SD card uses hardware HSPI on different pins
-constexpr int SD_MOSI_PIN = 40;  // SD card MOSI
-constexpr int SD_MISO_PIN = 13;  // SD card MISO
-constexpr int SD_SCK_PIN = 39;   // SD card SCK
-constexpr int SD_CS_PIN = 10;    // SD card CS
-constexpr int SD_POWER_PIN = 42; // SD card power enable
-
-// Create an instance of SPIClass for SD card SPI communication (HSPI bus)
-SPIClass SD_SPI = SPIClass(HSPI);
-
 // We use SD card for image storage (or SPIFFS as fallback)
 // SD card has much better write endurance than SPIFFS Flash memory
 constexpr char kFrameBufferFile[] = "/frame.bin";
 constexpr char kLastUploadedTimeFile[] = "/last_uploaded.txt";
 constexpr char kDriftRateFile[] = "/drift_rate.txt";
+constexpr char kDriftModelFile[] = "/drift_model.txt";
 constexpr char kProcessingTimeFile[] = "/processing_time.txt";
 
-bool sdCardAvailable = false;
-bool spiffsMounted = false;
+// Frame buffer encoding (see frame_codec.h)
+// The codec scans the frame column by column. A controller-order ImageBW already
+// is, so it is scanned linearly; a row-major one has an 800px / 8 row stride.
+// The stride is stored in the header and tells frames of the two layouts apart.
+#if EPD_FRAME_CONTROLLER_ORDER
+constexpr uint16_t kFrameRowBytes = (EPD_W / 8) * EPD_H;
+#else
+constexpr uint16_t kFrameRowBytes = EPD_W / 8;
+#endif
+// Encoded frames larger than this are stored raw (a typical clock face is ~4.5 KB)
+constexpr size_t kFrameScratchSize = 8192;
+uint8_t frameScratch[kFrameScratchSize];
+
+// RTC-retained frame (FrameTier::Rtc): the common wake path restores the
+// display from here without powering up storage. Sized to leave room for
+// RTCState and the ULP reserve in the 8 KB RTC slow memory.
+constexpr size_t kRtcFrameCapacity = 6144;
+struct RtcFrameStore
+{
+  FrameCodecHeader header;
+  uint8_t payload[kRtcFrameCapacity];
+};
+RTC_DATA_ATTR RtcFrameStore rtcFrame;
+
 bool initialized = false;
 struct timeval rtcTimeBeforeNtpSync = {0, 0}; // Stores RTC time before NTP sync attempt (with microseconds)
 unsigned long ntpSyncDurationMs = 0;          // Duration of NTP sync wait time (ms) - RTC continues running during this time
 
+// SCD41 operating range
+bool temperatureLooksValid(float celsius)
+{
+  return !isnan(celsius) && celsius >= -20.0f && celsius <= 70.0f;
+}
+
+// Same clamp as the global rate (safety net against feedback runaway)
+constexpr float kMinDriftRate = -600.0f;
+constexpr float kMaxDriftRate = 600.0f;
+
+bool driftModelValid()
+{
+#if RTC_DRIFT_TEMP_MODEL
+  return rtcState.driftModel.magic == kDriftModelMagic;
+#else
+  return false;
+#endif
+}
+
+// Node below celsius and the weight of the node above it (linear interpolation, flat outside)
+void driftModelPosition(float celsius, int &node, float &upperWeight)
+{
+  float position = (celsius - kDriftModelMinTempC) / kDriftModelStepC;
+  if (position < 0.0f) position = 0.0f;
+  if (position > (float)(kDriftModelNodes - 1)) position = (float)(kDriftModelNodes - 1);
+  node = (int)position;
+  if (node >= kDriftModelNodes - 1)
+  {
+    node = kDriftModelNodes - 2;
+  }
+  upperWeight = position - (float)node;
+}
+
+float driftModelRate(float celsius)
+{
+  int node;
+  float upperWeight;
+  driftModelPosition(celsius, node, upperWeight);
+  const DriftTempModel &model = rtcState.driftModel;
+  return model.rateMsPerMin[node] * (1.0f - upperWeight) + model.rateMsPerMin[node + 1] * upperWeight;
+}
+
+// Drift rate for a sleep starting now: model at the last temperature, else the global EMA
+float compensationRate()
+{
+  if (driftModelValid() && temperatureLooksValid(rtcState.lastTemperature))
+  {
+    return driftModelRate(rtcState.lastTemperature);
+  }
+  return rtcState.driftRateMsPerMin;
+}
+
+// Credit sleep minutes to the nodes around the temperature they were compensated at
+void creditSleepMinutes(float sleepMinutes)
+{
+  if (!driftModelValid())
+  {
+    return;
+  }
+  DriftTempModel &model = rtcState.driftModel;
+  if (!temperatureLooksValid(rtcState.lastTemperature))
+  {
+    model.untrackedMin += sleepMinutes;
+    return;
+  }
+  int node;
+  float upperWeight;
+  driftModelPosition(rtcState.lastTemperature, node, upperWeight);
+  model.pendingMin[node] += sleepMinutes * (1.0f - upperWeight);
+  model.pendingMin[node + 1] += sleepMinutes * upperWeight;
+}
+
+float pendingSleepMinutes()
+{
+  const DriftTempModel &model = rtcState.driftModel;
+  float total = model.untrackedMin;
+  for (int i = 0; i < kDriftModelNodes; i++)
+  {
+    total += model.pendingMin[i];
+  }
+  return total;
+}
+
+void clearPendingMinutes()
+{
+  DriftTempModel &model = rtcState.driftModel;
+  for (int i = 0; i < kDriftModelNodes; i++)
+  {
+    model.pendingMin[i] = 0.0f;
+  }
+  model.untrackedMin = 0.0f;
+}
+
+// Start the model from the calibrated global rate (every node the same)
+void initDriftModel(float rateMsPerMin)
+{
+  DriftTempModel model;
+  model.magic = kDriftModelMagic;
+  for (int i = 0; i < kDriftModelNodes; i++)
+  {
+    model.rateMsPerMin[i] = rateMsPerMin;
+  }
+  rtcState.driftModel = model;
+}
+
+// Learn from the true drift of the interval since the last sync (normalized LMS)
+// The interval's predicted drift is sum(rate[i] * pendingMin[i]); the error is spread over the
+// nodes in proportion to the minutes spent there, so a single-temperature interval moves
+// that node halfway to the measured rate (same weight as the global EMA).
+// Returns false if the interval could not be attributed to temperatures.
+bool learnDriftModel(int64_t trueDriftMs)
+{
+  DriftTempModel &model = rtcState.driftModel;
+  const float total = pendingSleepMinutes();
+  if (total < 1.0f || model.untrackedMin > total * 0.1f)
+  {
+    return false;
+  }
+
+  float predictedMs = 0.0f;
+  float sumSquares = 0.0f;
+  for (int i = 0; i < kDriftModelNodes; i++)
+  {
+    predictedMs += model.rateMsPerMin[i] * model.pendingMin[i];
+    sumSquares += model.pendingMin[i] * model.pendingMin[i];
+  }
+  // Untracked minutes were compensated at about the global rate
+  predictedMs += rtcState.driftRateMsPerMin * model.untrackedMin;
+  const float errorMs = (float)trueDriftMs - predictedMs;
+
+  constexpr float kStep = 0.5f;
+  constexpr float kMaxLearnedMin = 100000.0f;
+  for (int i = 0; i < kDriftModelNodes; i++)
+  {
+    if (model.pendingMin[i] <= 0.0f)
+    {
+      continue;
+    }
+    float rate = model.rateMsPerMin[i] + kStep * errorMs * model.pendingMin[i] / sumSquares;
+    if (rate < kMinDriftRate) rate = kMinDriftRate;
+    if (rate > kMaxDriftRate) rate = kMaxDriftRate;
+    model.rateMsPerMin[i] = rate;
+    model.learnedMin[i] += model.pendingMin[i];
+    if (model.learnedMin[i] > kMaxLearnedMin) model.learnedMin[i] = kMaxLearnedMin;
+  }
+
+  // Nodes never visited follow their nearest learned neighbour (flat extrapolation)
+  for (int i = 0; i < kDriftModelNodes; i++)
+  {
+    if (model.learnedMin[i] > 0.0f)
+    {
+      continue;
+    }
+    for (int distance = 1; distance < kDriftModelNodes; distance++)
+    {
+      const int below = i - distance;
+      const int above = i + distance;
+      if (below >= 0 && model.learnedMin[below] > 0.0f)
+      {
+        model.rateMsPerMin[i] = model.rateMsPerMin[below];
+        break;
+      }
+      if (above < kDriftModelNodes && model.learnedMin[above] > 0.0f)
+      {
+        model.rateMsPerMin[i] = model.rateMsPerMin[above];
+        break;
+      }
+    }
+  }
+
+  LOGI(LogTag::DEEPSLEEP, "Drift model updated: error %.0f ms over %.1f min (predicted %.0f ms)",
+       errorMs, total, predictedMs);
+  return true;
+}
+
+// Every node rate is finite and inside the clamp
+bool driftModelLooksValid(const DriftTempModel &model)
+{
+  for (int i = 0; i < kDriftModelNodes; i++)
+  {
+    const float rate = model.rateMsPerMin[i];
+    if (isnan(rate) || isinf(rate) || rate < kMinDriftRate || rate > kMaxDriftRate ||
+        isnan(model.learnedMin[i]) || model.learnedMin[i] < 0.0f ||
+        isnan(model.pendingMin[i]) || model.pendingMin[i] < 0.0f)
+    {
+      return false;
+    }
+  }
+  return !isnan(model.untrackedMin) && model.untrackedMin >= 0.0f;
+}
+
 void restoreTimeFromRTC()
 {
   if (rtcState.savedTime > 0)
@@ -85,9 +291,12 @@ void restoreTimeFromRTC()
     // Apply RTC drift compensation
     // RTC slow clock runs slower than nominal, causing time to fall behind
     // Compensate by adding the expected drift based on sleep duration
+    // The rate comes from the temperature model at the temperature read before this sleep.
     float sleepMinutes = (float)rtcState.sleepDurationUs / 60000000.0f;
-    int64_t driftCompensationUs = (int64_t)(sleepMinutes * rtcState.driftRateMsPerMin * 1000.0f);
+    const float rateMsPerMin = compensationRate();
+    int64_t driftCompensationUs = (int64_t)(sleepMinutes * rateMsPerMin * 1000.0f);
     wakeupTimeUs += driftCompensationUs;
+    creditSleepMinutes(sleepMinutes);
 
     // Track cumulative compensation for accurate drift rate calculation
     // This is reset when NTP sync occurs
@@ -109,8 +318,85 @@ void restoreTimeFromRTC()
          timeinfo->tm_hour, timeinfo->tm_min, timeinfo->tm_sec,
          tv.tv_usec / 1000);
     LOGD(LogTag::DEEPSLEEP, "Drift compensation: %.0f ms (rate: %.1f ms/min, sleep: %.2f min, cumulative: %lld ms)",
-         driftCompensationUs / 1000.0f, rtcState.driftRateMsPerMin, sleepMinutes, rtcState.cumulativeCompensationMs);
+         driftCompensationUs / 1000.0f, rateMsPerMin, sleepMinutes, rtcState.cumulativeCompensationMs);
+  }
+}
+
+// A YYYYMMDD date in a sane range
+bool logDateLooksValid(uint32_t date)
+{
+  const uint32_t month = (date / 100) % 100;
+  const uint32_t day = date % 100;
+  return date >= 20200101 && date <= 20991231 && month >= 1 && month <= 12 && day >= 1 && day <= 31;
+}
+
+// Whether the adaptive schedule wants a sync at the hour starting at hourStart
+bool ntpSyncDue(time_t hourStart)
+{
+  if (!rtcState.driftRateCalibrated || rtcState.driftConvergedSyncs < NTP_SYNC_CONVERGED_SYNCS)
+  {
+    return true; // Still calibrating: sync every hour
+  }
+  if (temperatureLooksValid(rtcState.lastTemperature) && temperatureLooksValid(rtcState.ntpSyncTemperature) &&
+      fabsf(rtcState.lastTemperature - rtcState.ntpSyncTemperature) >= NTP_SYNC_TEMP_DELTA_C)
+  {
+    LOGI(LogTag::DEEPSLEEP, "NTP sync due: temperature %.1f -> %.1f C since last sync",
+         rtcState.ntpSyncTemperature, rtcState.lastTemperature);
+    return true;
   }
+  // Syncs land a little after the hour, so allow a few minutes of slack
+  constexpr time_t kSlackSec = 5 * 60;
+  const time_t sinceSync = hourStart - rtcState.lastNtpSyncTime;
+  if (rtcState.lastNtpSyncTime <= 0 || sinceSync + kSlackSec >= (time_t)rtcState.ntpSyncIntervalMin * 60)
+  {
+    return true;
+  }
+  LOGD(LogTag::DEEPSLEEP, "NTP sync not due (%ld/%u min)", (long)(sinceSync / 60), (unsigned)rtcState.ntpSyncIntervalMin);
+  return false;
+}
+
+// Stretch or shrink the NTP interval from the residual measured at this sync
+void updateNtpSchedule(int64_t residualMs)
+{
+  const int64_t magnitude = llabs(residualMs);
+  uint32_t interval = rtcState.ntpSyncIntervalMin;
+  if (!rtcState.driftRateCalibrated || magnitude > NTP_SYNC_TARGET_RESIDUAL_MS)
+  {
+    rtcState.driftConvergedSyncs = 0;
+    interval /= 2;
+  }
+  else if (magnitude * 2 <= NTP_SYNC_TARGET_RESIDUAL_MS)
+  {
+    if (rtcState.driftConvergedSyncs < NTP_SYNC_CONVERGED_SYNCS)
+    {
+      rtcState.driftConvergedSyncs++;
+    }
+    if (rtcState.driftConvergedSyncs >= NTP_SYNC_CONVERGED_SYNCS)
+    {
+      interval *= 2;
+    }
+  }
+  // Syncs happen on the hour, so keep whole hours
+  interval = (interval / 60) * 60;
+  if (interval < NTP_SYNC_MIN_INTERVAL_MIN) interval = NTP_SYNC_MIN_INTERVAL_MIN;
+  if (interval > NTP_SYNC_MAX_INTERVAL_MIN) interval = NTP_SYNC_MAX_INTERVAL_MIN;
+  if (interval != rtcState.ntpSyncIntervalMin)
+  {
+    LOGI(LogTag::DEEPSLEEP, "NTP interval %u -> %u min (residual %lld ms, converged %u)",
+         (unsigned)rtcState.ntpSyncIntervalMin, (unsigned)interval, (long long)residualMs,
+         (unsigned)rtcState.driftConvergedSyncs);
+  }
+  rtcState.ntpSyncIntervalMin = (uint16_t)interval;
+}
+
+// Empty cursor, or a cursor into a plausible log file
+bool uploadCursorLooksValid(const UploadCursor &cursor)
+{
+  if (cursor.fileDate == 0)
+  {
+    return cursor.offset == 0;
+  }
+  return logDateLooksValid(cursor.fileDate);
 }
 
 } // namespace
@@ -151,17 +437,77 @@ void DeepSleepManager_Init()
     rtcState.savedTimeUs = 0;
     rtcState.sleepDurationUs = 0;
     // Default processing estimates (boot-to-draw). Will be refined by adaptive loop.
-    rtcState.estimatedProcessingTimeNoWifi = 7.5f;
-    rtcState.estimatedProcessingTimeWifi = 7.5f;
+    rtcState.estimatedProcessingTimeNoWifi = kProcessingTimeDefaultSec;
+    rtcState.estimatedProcessingTimeWifi = kProcessingTimeDefaultSec;
     // Drift/upload fields can be stale if RTC memory was corrupted or struct changed.
     // Reset them so we can safely restore from storage.
     rtcState.lastUploadedTime = 0;
     rtcState.driftRateMsPerMin = kDefaultDriftRateMsPerMin;
     rtcState.driftRateCalibrated = false;
     rtcState.cumulativeCompensationMs = 0;
+    rtcState.displayLayers = DisplayLayerKeys();
+    rtcState.frameTier = FrameTier::None;
+    rtcState.uploadCursor = UploadCursor();
+    rtcState.binaryUploadRejectedTime = 0;
+    rtcState.processingTimesUnsaved = false;
+    rtcState.lastRetentionSweepDate = 0;
+    rtcState.wifiCache = WifiConnectCache();
+    rtcState.ntpSyncIntervalMin = NTP_SYNC_MIN_INTERVAL_MIN;
+    rtcState.driftConvergedSyncs = 0;
+    rtcState.lastTemperature = NAN;
+    rtcState.ntpSyncTemperature = NAN;
+    rtcState.driftModel = DriftTempModel();
+    rtcState.sensorShotTime = 0;
+    rtcState.sensorShotRhtOnly = false;
+    rtcState.co2ChangingFast = false;
+    rtcState.lastCo2Ppm = 0;
+    rtcState.lastCo2Time = 0;
+    rtcState.driftFilesUnsaved = false;
+    rtcState.drawJitter = DrawJitterStats();
   }
   else
   {
+    // frameTier was added later; older firmware always stored the frame on SD/SPIFFS
+    if (rtcState.frameTier != FrameTier::None && rtcState.frameTier != FrameTier::Rtc &&
+        rtcState.frameTier != FrameTier::Storage)
+    {
+      rtcState.frameTier = FrameTier::Storage;
+    }
+    // uploadCursor was added later; an implausible date means the field held other data
+    if (!uploadCursorLooksValid(rtcState.uploadCursor))
+    {
+      rtcState.uploadCursor = UploadCursor();
+    }
+    // lastRetentionSweepDate was added later; a bad value only makes the next sweep run early
+    if (rtcState.lastRetentionSweepDate != 0 && !logDateLooksValid(rtcState.lastRetentionSweepDate))
+    {
+      rtcState.lastRetentionSweepDate = 0;
+    }
+    // The NTP schedule fields were added later; start over from hourly syncs if they look wrong
+    if (rtcState.ntpSyncIntervalMin < NTP_SYNC_MIN_INTERVAL_MIN || rtcState.ntpSyncIntervalMin > NTP_SYNC_MAX_INTERVAL_MIN ||
+        rtcState.driftConvergedSyncs > NTP_SYNC_CONVERGED_SYNCS)
+    {
+      rtcState.ntpSyncIntervalMin = NTP_SYNC_MIN_INTERVAL_MIN;
+      rtcState.driftConvergedSyncs = 0;
+    }
+    if (!temperatureLooksValid(rtcState.lastTemperature))
+    {
+      rtcState.lastTemperature = NAN;
+    }
+    if (!temperatureLooksValid(rtcState.ntpSyncTemperature))
+    {
+      rtcState.ntpSyncTemperature = NAN;
+    }
+    // driftModel was added later; drop it if the memory held other data
+    if (rtcState.driftModel.magic == kDriftModelMagic && !driftModelLooksValid(rtcState.driftModel))
+    {
+      rtcState.driftModel = DriftTempModel();
+    }
+    // drawJitter was added later; a count past the log threshold means foreign data
+    if (rtcState.drawJitter.samples > kDrawJitterLogSamples)
+    {
+      rtcState.drawJitter = DrawJitterStats();
+    }
     // Normalize magic to current value (keeps RTC time intact across firmware upgrades)
     if (rtcState.magic != kRtcStateMagic)
     {
@@ -173,58 +519,39 @@ void DeepSleepManager_Init()
     restoreTimeFromRTC();
   }
 
-  // Try to initialize SD card first (preferred for write endurance)
-  // Enable SD card power (GPIO 42 must be HIGH for SD card to work)
-  pinMode(SD_POWER_PIN, OUTPUT);
-  digitalWrite(SD_POWER_PIN, HIGH);
-  delay(10); // Brief delay to ensure power stability
-
-  // Initialize HSPI bus for SD card with specified pins
-  SD_SPI.begin(SD_SCK_PIN, SD_MISO_PIN, SD_MOSI_PIN);
-
-  // Try to mount SD card with 80MHz SPI clock speed (same as official example)
-  if (SD.begin(SD_CS_PIN, SD_SPI, 80000000))
-  {
-    sdCardAvailable = true;
-    LOGI(LogTag::DEEPSLEEP, "SD card initialized successfully, size: %llu MB", SD.cardSize() / (1024 * 1024));
-  }
-  else
-  {
-    sdCardAvailable = false;
-    LOGW(LogTag::DEEPSLEEP, "SD card initialization failed, falling back to SPIFFS");
-    LOGW(LogTag::DEEPSLEEP, "WARNING: Using SPIFFS fallback - Flash memory write endurance is limited!");
-    LOGW(LogTag::DEEPSLEEP, "WARNING: SPIFFS has 10,000-100,000 write cycles. Consider using SD card for better durability.");
-
-    // Fallback to SPIFFS if SD card is not available
-    if (!SPIFFS.begin(true))
-    {
-      spiffsMounted = false;
-      LOGE(LogTag::DEEPSLEEP, "SPIFFS Mount Failed");
-      LOGE(LogTag::DEEPSLEEP, "ERROR: No storage available! Frame buffer will not be saved.");
-      // Continue initialization but frame buffer save/load will fail gracefully
-    }
-    else
-    {
-      spiffsMounted = true;
-      LOGI(LogTag::DEEPSLEEP, "SPIFFS Mounted (fallback)");
-      LOGI(LogTag::DEEPSLEEP, "SPIFFS Storage: %u / %u bytes used", SPIFFS.usedBytes(), SPIFFS.totalBytes());
-    }
-  }
-
   initialized = true;
 
+  // Storage is mounted lazily (storage_manager.h). The copies on storage are only read when
+  // RTC memory did not survive, so a normal wake does not power up the SD card here.
+  const bool restoreFromStorage = !magicValid;
+
   // Restore lastUploadedTime from SD card if not in RTC memory
   // This ensures we don't lose upload history across power cycles
-  if (rtcState.lastUploadedTime == 0)
+  if (restoreFromStorage && rtcState.lastUploadedTime == 0)
   {
-    time_t storedTime = DeepSleepManager_LoadLastUploadedTime();
+    UploadCursor storedCursor;
+    time_t storedTime = DeepSleepManager_LoadLastUploadedTime(&storedCursor);
     if (storedTime > 0)
     {
       rtcState.lastUploadedTime = storedTime;
+      rtcState.uploadCursor = storedCursor;
       LOGI(LogTag::DEEPSLEEP, "Restored lastUploadedTime from storage: %ld", (long)storedTime);
     }
   }
 
+#if RTC_DRIFT_TEMP_MODEL
+  // Restore the temperature drift model with the other settings after RTC memory was lost
+  if (restoreFromStorage && rtcState.driftModel.magic != kDriftModelMagic)
+  {
+    DriftTempModel storedModel;
+    if (DeepSleepManager_LoadDriftModel(storedModel) && driftModelLooksValid(storedModel))
+    {
+      rtcState.driftModel = storedModel;
+      LOGI(LogTag::DEEPSLEEP, "Restored drift model from storage");
+    }
+  }
+#endif
+
   // Restore driftRateMsPerMin from SD card if not calibrated in RTC memory
   // This allows drift rate to persist across power cycles/reboots
   const bool driftRateLooksValid =
@@ -233,7 +560,7 @@ void DeepSleepManager_Init()
       fabsf(rtcState.driftRateMsPerMin) >= 0.01f &&
       fabsf(rtcState.driftRateMsPerMin) <= 500.0f;
 
-  if (!rtcState.driftRateCalibrated || !driftRateLooksValid)
+  if ((restoreFromStorage && !rtcState.driftRateCalibrated) || !driftRateLooksValid)
   {
     float storedRate = DeepSleepManager_LoadDriftRate();
     if (!isnan(storedRate) && !isinf(storedRate) && storedRate != 0.0f)
@@ -267,7 +594,7 @@ void DeepSleepManager_Init()
   // Restore estimated processing time if available (persists across power cycles)
   float storedNoWifi = 0.0f;
   float storedWifi = 0.0f;
-  if (DeepSleepManager_LoadEstimatedProcessingTimes(storedNoWifi, storedWifi))
+  if (restoreFromStorage && DeepSleepManager_LoadEstimatedProcessingTimes(storedNoWifi, storedWifi))
   {
     rtcState.estimatedProcessingTimeNoWifi = storedNoWifi;
     rtcState.estimatedProcessingTimeWifi = storedWifi;
@@ -275,11 +602,11 @@ void DeepSleepManager_Init()
          rtcState.estimatedProcessingTimeNoWifi, rtcState.estimatedProcessingTimeWifi);
   }
   // Validate processing times (migration safety when RTC layout changed)
-  if (rtcState.estimatedProcessingTimeNoWifi < 1.0f || rtcState.estimatedProcessingTimeNoWifi > 20.0f)
+  if (!ProcessingTime_IsValid(rtcState.estimatedProcessingTimeNoWifi))
   {
-    rtcState.estimatedProcessingTimeNoWifi = 7.5f;
+    rtcState.estimatedProcessingTimeNoWifi = kProcessingTimeDefaultSec;
   }
-  if (rtcState.estimatedProcessingTimeWifi < 1.0f || rtcState.estimatedProcessingTimeWifi > 20.0f)
+  if (!ProcessingTime_IsValid(rtcState.estimatedProcessingTimeWifi))
   {
     // If wifi estimate is invalid, fallback to no-wifi estimate
     rtcState.estimatedProcessingTimeWifi = rtcState.estimatedProcessingTimeNoWifi;
@@ -336,7 +663,8 @@ uint64_t DeepSleepManager_CalculateSleepDuration()
   float processingTimeMs = processingTimeSec * 1000.0f;
 
   // Calculate sleep time in milliseconds, ensuring we don't go negative
-  float sleepMs = msUntilNextMinute - processingTimeMs - kEpdLeadTimeMs;
+  // The early margin is absorbed by DeepSleepManager_WaitUntil() before the draw
+  float sleepMs = msUntilNextMinute - processingTimeMs - kEpdLeadTimeMs - (float)WAKE_EARLY_MARGIN_MS;
   if (sleepMs < 1000.0f)
   {
     // Very close to minute boundary, sleep minimal time
@@ -351,6 +679,86 @@ uint64_t DeepSleepManager_CalculateSleepDuration()
   return (uint64_t)(sleepMs * 1000.0f); // Convert milliseconds to microseconds
 }
 
+void DeepSleepManager_WaitUntil(const struct timeval &target, bool allowLightSleep)
+{
+  auto usUntilTarget = [&target]() -> int64_t {
+    struct timeval now;
+    gettimeofday(&now, NULL);
+    return (int64_t)(target.tv_sec - now.tv_sec) * 1000000LL + (int64_t)(target.tv_usec - now.tv_usec);
+  };
+
+  int64_t remainingUs = usUntilTarget();
+  if (remainingUs <= 0)
+  {
+    return;
+  }
+
+  // Light sleep wake-up latency is a few ms; leave the tail to the one-shot timer
+  constexpr int64_t kLightSleepGuardUs = 20000;
+  constexpr int64_t kMinLightSleepUs = 10000;
+  if (allowLightSleep && remainingUs > kLightSleepGuardUs + kMinLightSleepUs)
+  {
+    Serial.flush();
+    esp_sleep_enable_timer_wakeup((uint64_t)(remainingUs - kLightSleepGuardUs));
+    PowerManager_LightSleep();
+    remainingUs = usUntilTarget();
+    if (remainingUs <= 0)
+    {
+      return;
+    }
+  }
+
+  // esp_timer one-shot: microsecond resolution instead of delay()'s 1 ms tick
+  static SemaphoreHandle_t waitDone = nullptr;
+  static esp_timer_handle_t waitTimer = nullptr;
+  if (waitTimer == nullptr)
+  {
+    waitDone = xSemaphoreCreateBinary();
+    esp_timer_create_args_t args = {};
+    args.callback = [](void *arg) { xSemaphoreGive(static_cast<SemaphoreHandle_t>(arg)); };
+    args.arg = waitDone;
+    args.dispatch_method = ESP_TIMER_TASK;
+    args.name = "wake_wait";
+    if (waitDone == nullptr || esp_timer_create(&args, &waitTimer) != ESP_OK)
+    {
+      waitTimer = nullptr;
+    }
+  }
+  if (waitTimer == nullptr || esp_timer_start_once(waitTimer, (uint64_t)remainingUs) != ESP_OK)
+  {
+    delay((uint32_t)((remainingUs + 999) / 1000));
+    return;
+  }
+  if (xSemaphoreTake(waitDone, pdMS_TO_TICKS(remainingUs / 1000 + 100)) != pdTRUE)
+  {
+    esp_timer_stop(waitTimer);
+  }
+}
+
+void DeepSleepManager_RecordDrawJitter(int32_t jitterMs)
+{
+  DrawJitterStats &stats = rtcState.drawJitter;
+  int bin = 0;
+  while (bin < kDrawJitterBins - 1 && jitterMs >= kDrawJitterEdgesMs[bin])
+  {
+    bin++;
+  }
+  stats.bins[bin]++;
+  stats.samples++;
+  stats.sumAbsMs += jitterMs < 0 ? -jitterMs : jitterMs;
+  LOGD(LogTag::DEEPSLEEP, "Draw jitter: %ld ms", (long)jitterMs);
+
+  if (stats.samples < kDrawJitterLogSamples)
+  {
+    return;
+  }
+  LOGI(LogTag::DEEPSLEEP,
+       "Draw jitter (%u boots, mean |%ld| ms): <-100:%u -100:%u -50:%u -20:%u 0:%u 20:%u 50:%u >=100:%u",
+       stats.samples, (long)(stats.sumAbsMs / stats.samples), stats.bins[0], stats.bins[1], stats.bins[2],
+       stats.bins[3], stats.bins[4], stats.bins[5], stats.bins[6], stats.bins[7]);
+  stats = DrawJitterStats();
+}
+
 void DeepSleepManager_EnterDeepSleep()
 {
   uint64_t sleepDuration = DeepSleepManager_CalculateSleepDuration();
@@ -382,18 +790,15 @@ void DeepSleepManager_EnterDeepSleep()
   // Disable WiFi before sleep to save power
   WiFi.disconnect(true);
   WiFi.mode(WIFI_OFF);
+  BootProfiler_SetRadio(false);
 
   // Disable Bluetooth if enabled
   btStop();
 
-  // Power off SD card to save battery during deep sleep
+  // Power off SD card to save battery during deep sleep (no-op unless something mounted
+  // it again after setup() powered it down)
   // SD card can consume several mA even when idle
-  if (sdCardAvailable)
-  {
-    SD.end();                        // Unmount SD card
-    digitalWrite(SD_POWER_PIN, LOW); // Cut power to SD card
-    LOGD(LogTag::DEEPSLEEP, "SD card powered off for deep sleep");
-  }
+  StorageManager_PowerDown();
 
   // Hold EPD pins to prevent noise
   DeepSleepManager_HoldEPDPins();
@@ -402,6 +807,8 @@ void DeepSleepManager_EnterDeepSleep()
   Serial.flush(); // Ensure all serial output is sent before sleep
   delay(100);     // Small delay to ensure serial flush completes
 
+  PowerManager_Finish();
+  BootProfiler_PrepareSleep(sleepDuration);
   esp_deep_sleep_start();
   // Code never reaches here - ESP32 will restart after wakeup
 }
@@ -436,9 +843,8 @@ bool DeepSleepManager_ShouldSyncWiFiNtp()
   // Case 1: Current minute is sync minute AND it's a new minute to display
   if (isSyncMinute && isNewMinute)
   {
-    LOGD(LogTag::DEEPSLEEP, "Sync minute: last=%d, current=%d, triggering NTP sync",
-         lastMinute, currentMinute);
-    return true;
+    LOGD(LogTag::DEEPSLEEP, "Sync minute: last=%d, current=%d", lastMinute, currentMinute);
+    return ntpSyncDue(now - timeinfo.tm_sec);
   }
 
   // Case 2: About to cross to sync minute (woke early, waiting for minute change)
@@ -448,7 +854,7 @@ bool DeepSleepManager_ShouldSyncWiFiNtp()
   {
     LOGD(LogTag::DEEPSLEEP, "Hour boundary approaching: last=%d, current=%d",
          lastMinute, currentMinute);
-    return true;
+    return ntpSyncDue(now - timeinfo.tm_sec + 60);
   }
 
   return false;
@@ -467,9 +873,18 @@ void DeepSleepManager_SaveNtpSyncDuration(unsigned long durationMs)
   LOGD(LogTag::DEEPSLEEP, "NTP sync duration: %lu ms", durationMs);
 }
 
+void DeepSleepManager_NoteTemperature(float celsius)
+{
+  if (temperatureLooksValid(celsius))
+  {
+    rtcState.lastTemperature = celsius;
+  }
+}
+
 void DeepSleepManager_MarkNtpSynced()
 {
   rtcState.lastNtpSyncBootCount = rtcState.bootCount;
+  rtcState.ntpSyncTemperature = rtcState.lastTemperature;
 
   // Get NTP time (after sync)
   struct timeval ntpTime;
@@ -523,9 +938,15 @@ void DeepSleepManager_MarkNtpSynced()
         // so we calibrate in units of "ms per minute of sleep", not wall time.
         // Derive total sleep minutes since last sync from the compensation we applied:
         // cumulative_comp_ms = used_rate_ms_per_min * total_sleep_minutes
+        // With the temperature model the rate varies per sleep, so use the minutes it tracked.
         float sleepMinutesSinceSync = wallMinutesSinceSync; // fallback
         const float usedRateDuringInterval = rtcState.driftRateMsPerMin;
-        if (fabsf(usedRateDuringInterval) > 0.01f && rtcState.cumulativeCompensationMs != 0)
+        const float trackedSleepMinutes = pendingSleepMinutes();
+        if (driftModelValid() && trackedSleepMinutes >= 1.0f && trackedSleepMinutes <= wallMinutesSinceSync * 1.2f)
+        {
+          sleepMinutesSinceSync = trackedSleepMinutes;
+        }
+        else if (fabsf(usedRateDuringInterval) > 0.01f && rtcState.cumulativeCompensationMs != 0)
         {
           float derivedSleepMinutes = (float)rtcState.cumulativeCompensationMs / usedRateDuringInterval;
           if (derivedSleepMinutes < 0.0f) derivedSleepMinutes = -derivedSleepMinutes;
@@ -544,12 +965,9 @@ void DeepSleepManager_MarkNtpSynced()
         // Clamp to reasonable range to prevent feedback instability
         // Unit: ms per minute of sleep
         // Negative means the device runs fast (system time ahead), positive means slow.
-        // NOTE: Clamp is a safety net against feedback runaway.
-        // Clamp is a safety net against feedback runaway.
+        // NOTE: Clamp (kMinDriftRate/kMaxDriftRate) is a safety net against feedback runaway.
         // IMPORTANT: If this is too tight, drift_rate will stick at the clamp and leave
         // a persistent residual drift each sync cycle.
-        constexpr float kMinDriftRate = -600.0f;
-        constexpr float kMaxDriftRate = 600.0f;
         float clampedRate = trueRate;
 
         // Guard against NaN/inf
@@ -616,14 +1034,29 @@ void DeepSleepManager_MarkNtpSynced()
              rtcState.driftRateMsPerMin, trueRate, sleepMinutesSinceSync, wallMinutesSinceSync,
              appliedAlpha, preDeltaRate, ntpSyncDurationMs);
 
-        // Save drift rate to SD card for persistence across power cycles
-        DeepSleepManager_SaveDriftRate(rtcState.driftRateMsPerMin);
+        // Saved to SD card for persistence across power cycles after the display refresh
+        // (DeepSleepManager_SaveDeferredState)
+        rtcState.driftFilesUnsaved = true;
+
+#if RTC_DRIFT_TEMP_MODEL
+        // The temperature model learns from the same interval; it starts from the global rate
+        if (driftModelValid())
+        {
+          learnDriftModel(trueDriftMs);
+        }
+        else
+        {
+          initDriftModel(rtcState.driftRateMsPerMin);
+        }
+#endif
         } // end rate update block
       }
     }
 
     // Reset cumulative compensation after NTP sync
     rtcState.cumulativeCompensationMs = 0;
+
+    updateNtpSchedule(actualDriftMs);
   }
   else
   {
@@ -632,10 +1065,27 @@ void DeepSleepManager_MarkNtpSynced()
     LOGI(LogTag::DEEPSLEEP, "NTP synced at boot %u (first sync or invalid RTC, drift skipped)", rtcState.bootCount);
   }
 
+  // Sleep minutes credited to the drift model belong to the interval that just ended
+  clearPendingMinutes();
+
   // Reset sync duration for next sync
   ntpSyncDurationMs = 0;
 }
 
+void DeepSleepManager_SaveDeferredState()
+{
+  if (!rtcState.driftFilesUnsaved)
+  {
+    return;
+  }
+  rtcState.driftFilesUnsaved = false;
+  DeepSleepManager_SaveDriftRate(rtcState.driftRateMsPerMin);
+  if (driftModelValid())
+  {
+    DeepSleepManager_SaveDriftModel(rtcState.driftModel);
+  }
+}
+
 bool DeepSleepManager_IsLastRtcDriftValid()
 {
   return rtcState.lastRtcDriftValid;
@@ -651,17 +1101,18 @@ float DeepSleepManager_GetDriftRateMsPerMin()
   return rtcState.driftRateMsPerMin;
 }
 
-bool DeepSleepManager_SaveFrameBuffer(const uint8_t *buffer, size_t size)
+static bool saveFrameBufferToStorage(const uint8_t *buffer, size_t size)
 {
+  const StorageMedium storage = StorageManager_Mount();
   File file;
   const char* storageType;
 
-  if (sdCardAvailable)
+  if (storage == StorageMedium::Sd)
   {
     file = SD.open(kFrameBufferFile, FILE_WRITE);
     storageType = "SD card";
   }
-  else if (spiffsMounted)
+  else if (storage == StorageMedium::Spiffs)
   {
     file = SPIFFS.open(kFrameBufferFile, FILE_WRITE);
     storageType = "SPIFFS (fallback - limited write endurance)";
@@ -679,23 +1130,30 @@ bool DeepSleepManager_SaveFrameBuffer(const uint8_t *buffer, size_t size)
   }
 
   unsigned long start = micros();
-  size_t written = file.write(buffer, size);
+  FrameCodecHeader header;
+  const uint8_t *payload = FrameCodec_Encode(buffer, size, kFrameRowBytes, frameScratch, sizeof(frameScratch), header);
+  const size_t fileSize = sizeof(header) + header.payloadSize;
+  size_t written = file.write(reinterpret_cast<const uint8_t *>(&header), sizeof(header));
+  written += file.write(payload, header.payloadSize);
   file.close();
   unsigned long duration = micros() - start;
 
-  if (written == size)
+  if (written == fileSize)
   {
     rtcState.imageSize = size;
-    LOGI(LogTag::DEEPSLEEP, "Saved to %s: %zu bytes in %lu us", storageType, size, duration);
+    rtcState.frameTier = FrameTier::Storage;
+    LOGI(LogTag::DEEPSLEEP, "Saved to %s: %zu bytes (%s, raw %zu) in %lu us", storageType, fileSize,
+         header.encoding == kFrameEncodingPackBits ? "RLE" : "raw", size, duration);
     return true;
   }
   else
   {
-    LOGE(LogTag::DEEPSLEEP, "Write failed (incomplete) on %s: wrote %zu of %zu", storageType, written, size);
+    LOGE(LogTag::DEEPSLEEP, "Write failed (incomplete) on %s: wrote %zu of %zu", storageType, written, fileSize);
+    rtcState.frameTier = FrameTier::None;
 
     // Auto-recovery: If SPIFFS write fails, the filesystem might be corrupted (common after partition change)
     // Attempt to format it so it works on next boot.
-    if (!sdCardAvailable && spiffsMounted)
+    if (storage == StorageMedium::Spiffs)
     {
       LOGW(LogTag::DEEPSLEEP, "Detected SPIFFS corruption. Formatting SPIFFS to recover...");
       SPIFFS.end();
@@ -715,24 +1173,65 @@ bool DeepSleepManager_SaveFrameBuffer(const uint8_t *buffer, size_t size)
   }
 }
 
-bool DeepSleepManager_LoadFrameBuffer(uint8_t *buffer, size_t size)
+bool DeepSleepManager_SaveFrameBuffer(const uint8_t *buffer, size_t size)
 {
-  if (rtcState.imageSize == 0)
+  unsigned long start = micros();
+  FrameCodecHeader header;
+  FrameCodec_Encode(buffer, size, kFrameRowBytes, rtcFrame.payload, sizeof(rtcFrame.payload), header);
+  if (header.encoding == kFrameEncodingPackBits)
   {
-    LOGW(LogTag::DEEPSLEEP, "No image info found");
+    rtcFrame.header = header;
+    rtcState.imageSize = size;
+    rtcState.frameTier = FrameTier::Rtc;
+    LOGI(LogTag::DEEPSLEEP, "Saved to RTC memory: %u bytes (raw %zu) in %lu us",
+         header.payloadSize, size, micros() - start);
+    return true;
+  }
+
+  // Overflow tier: the frame did not compress into RTC memory
+  LOGW(LogTag::DEEPSLEEP, "Frame does not fit in RTC memory (%zu bytes), using storage", sizeof(rtcFrame.payload));
+  rtcFrame.header.magic = 0;
+  return saveFrameBufferToStorage(buffer, size);
+}
+
+static bool loadFrameBufferFromRtc(uint8_t *buffer, size_t size)
+{
+  unsigned long start = micros();
+  FrameCodecHeader header;
+  if (!FrameCodec_ReadHeader(reinterpret_cast<const uint8_t *>(&rtcFrame.header), sizeof(rtcFrame.header), header) ||
+      header.encoding != kFrameEncodingPackBits || header.payloadSize > sizeof(rtcFrame.payload))
+  {
+    LOGE(LogTag::DEEPSLEEP, "RTC frame header invalid");
     return false;
   }
+  if (header.rowBytes != kFrameRowBytes)
+  {
+    LOGW(LogTag::DEEPSLEEP, "RTC frame uses another buffer layout (row stride %u), ignoring", header.rowBytes);
+    return false;
+  }
+  if (!FrameCodec_Decode(header, rtcFrame.payload, buffer, size))
+  {
+    LOGE(LogTag::DEEPSLEEP, "RTC frame decode/CRC check failed");
+    return false;
+  }
+  LOGI(LogTag::DEEPSLEEP, "Load successful: %zu bytes from RTC memory (%u encoded) in %lu us",
+       size, header.payloadSize, micros() - start);
+  return true;
+}
 
+static bool loadFrameBufferFromStorage(uint8_t *buffer, size_t size)
+{
+  const StorageMedium storage = StorageManager_Mount();
   File file;
   const char* storageType;
   bool fileExists = false;
 
-  if (sdCardAvailable)
+  if (storage == StorageMedium::Sd)
   {
     fileExists = SD.exists(kFrameBufferFile);
     storageType = "SD card";
   }
-  else if (spiffsMounted)
+  else if (storage == StorageMedium::Spiffs)
   {
     fileExists = SPIFFS.exists(kFrameBufferFile);
     storageType = "SPIFFS (fallback)";
@@ -749,11 +1248,11 @@ bool DeepSleepManager_LoadFrameBuffer(uint8_t *buffer, size_t size)
     return false;
   }
 
-  if (sdCardAvailable)
+  if (storage == StorageMedium::Sd)
   {
     file = SD.open(kFrameBufferFile, FILE_READ);
   }
-  else if (spiffsMounted)
+  else if (storage == StorageMedium::Spiffs)
   {
     file = SPIFFS.open(kFrameBufferFile, FILE_READ);
   }
@@ -770,28 +1269,117 @@ bool DeepSleepManager_LoadFrameBuffer(uint8_t *buffer, size_t size)
   }
 
   size_t fileSize = file.size();
-  if (fileSize != rtcState.imageSize || fileSize != size)
+  if (rtcState.imageSize != size)
   {
-    LOGE(LogTag::DEEPSLEEP, "File size mismatch on %s: expected %zu (RTC: %u), got %zu",
-         storageType, size, rtcState.imageSize, fileSize);
+    LOGE(LogTag::DEEPSLEEP, "Frame size mismatch: expected %zu, RTC has %u", size, rtcState.imageSize);
     file.close();
     return false;
   }
 
   LOGD(LogTag::DEEPSLEEP, "Loading frame buffer from %s...", storageType);
   unsigned long start = micros();
-  size_t read = file.read(buffer, size);
+
+  FrameCodecHeader header;
+  uint8_t headerBytes[sizeof(FrameCodecHeader)];
+  size_t read = file.read(headerBytes, sizeof(headerBytes));
+  bool ok;
+
+  if (FrameCodec_ReadHeader(headerBytes, read, header))
+  {
+    if (fileSize != sizeof(header) + header.payloadSize || header.rawSize != size)
+    {
+      LOGE(LogTag::DEEPSLEEP, "Encoded frame size mismatch on %s: file %zu, payload %u, raw %u (expected %zu)",
+           storageType, fileSize, header.payloadSize, header.rawSize, size);
+      file.close();
+      return false;
+    }
+    if (header.rowBytes != kFrameRowBytes)
+    {
+      LOGW(LogTag::DEEPSLEEP, "Frame on %s uses another buffer layout (row stride %u), ignoring",
+           storageType, header.rowBytes);
+      file.close();
+      return false;
+    }
+
+    uint8_t *payload;
+    if (header.encoding == kFrameEncodingRaw)
+    {
+      payload = buffer; // Decoded in place, only the CRC is checked
+    }
+    else if (header.payloadSize <= sizeof(frameScratch))
+    {
+      payload = frameScratch;
+    }
+    else
+    {
+      LOGE(LogTag::DEEPSLEEP, "Encoded frame too large on %s: %u bytes", storageType, header.payloadSize);
+      file.close();
+      return false;
+    }
+
+    read = file.read(payload, header.payloadSize);
+    ok = read == header.payloadSize;
+    if (!ok)
+    {
+      LOGE(LogTag::DEEPSLEEP, "Read failed (incomplete) on %s: read %zu of %u", storageType, read, header.payloadSize);
+    }
+    else if (!(ok = FrameCodec_Decode(header, payload, buffer, size)))
+    {
+      LOGE(LogTag::DEEPSLEEP, "Frame decode/CRC check failed on %s", storageType);
+    }
+  }
+  else
+  {
+    // Legacy raw frame written by older firmware (no header, row-major)
+    if (EPD_FRAME_CONTROLLER_ORDER)
+    {
+      LOGW(LogTag::DEEPSLEEP, "Legacy row-major frame on %s, ignoring", storageType);
+      file.close();
+      return false;
+    }
+    if (fileSize != size)
+    {
+      LOGE(LogTag::DEEPSLEEP, "File size mismatch on %s: expected %zu (RTC: %u), got %zu",
+           storageType, size, rtcState.imageSize, fileSize);
+      file.close();
+      return false;
+    }
+    memcpy(buffer, headerBytes, read);
+    const size_t rest = file.read(buffer + read, size - read);
+    read += rest;
+    ok = read == size;
+    if (!ok)
+    {
+      LOGE(LogTag::DEEPSLEEP, "Read failed (incomplete) on %s: read %zu of %zu", storageType, read, size);
+    }
+  }
   file.close();
   unsigned long duration = micros() - start;
 
-  if (read == size)
+  if (ok)
   {
-    LOGI(LogTag::DEEPSLEEP, "Load successful: %zu bytes in %lu us", size, duration);
-    return true;
+    LOGI(LogTag::DEEPSLEEP, "Load successful: %zu bytes from %zu byte file in %lu us", size, fileSize, duration);
   }
-  else
+  return ok;
+}
+
+bool DeepSleepManager_LoadFrameBuffer(uint8_t *buffer, size_t size)
+{
+  if (rtcState.imageSize == 0)
+  {
+    LOGW(LogTag::DEEPSLEEP, "No image info found");
+    return false;
+  }
+
+  // Only the tier written last is current; never fall back to a stale copy
+  switch (rtcState.frameTier)
   {
-    LOGE(LogTag::DEEPSLEEP, "Read failed (incomplete) on %s: read %zu of %zu", storageType, read, size);
+  case FrameTier::Rtc:
+    return loadFrameBufferFromRtc(buffer, size);
+  case FrameTier::Storage:
+    return loadFrameBufferFromStorage(buffer, size);
+  default:
+    LOGW(LogTag::DEEPSLEEP, "No saved frame buffer");
     return false;
   }
 }
@@ -945,17 +1533,18 @@ int DeepSleepManager_GetWakeupGPIO()
   return 2; // HOME_KEY
 }
 
-void DeepSleepManager_SaveLastUploadedTime(time_t timestamp)
+void DeepSleepManager_SaveLastUploadedTime(time_t timestamp, const UploadCursor &cursor)
 {
+  const StorageMedium storage = StorageManager_Mount();
   File file;
   const char *storageType;
 
-  if (sdCardAvailable)
+  if (storage == StorageMedium::Sd)
   {
     file = SD.open(kLastUploadedTimeFile, FILE_WRITE);
     storageType = "SD card";
   }
-  else if (spiffsMounted)
+  else if (storage == StorageMedium::Spiffs)
   {
     file = SPIFFS.open(kLastUploadedTimeFile, FILE_WRITE);
     storageType = "SPIFFS";
@@ -972,24 +1561,33 @@ void DeepSleepManager_SaveLastUploadedTime(time_t timestamp)
     return;
   }
 
+  // Line 1: timestamp (read by older firmware), line 2: "<fileDate> <offset>"
   file.println(timestamp);
+  file.printf("%lu %lu\n", (unsigned long)cursor.fileDate, (unsigned long)cursor.offset);
   file.close();
 
-  LOGD(LogTag::DEEPSLEEP, "Saved lastUploadedTime %ld to %s", (long)timestamp, storageType);
+  LOGD(LogTag::DEEPSLEEP, "Saved lastUploadedTime %ld (cursor %lu@%lu) to %s", (long)timestamp,
+       (unsigned long)cursor.fileDate, (unsigned long)cursor.offset, storageType);
 }
 
-time_t DeepSleepManager_LoadLastUploadedTime()
+time_t DeepSleepManager_LoadLastUploadedTime(UploadCursor *cursor)
 {
+  if (cursor != nullptr)
+  {
+    *cursor = UploadCursor();
+  }
+
+  const StorageMedium storage = StorageManager_Mount();
   File file;
   const char *storageType;
   bool fileExists = false;
 
-  if (sdCardAvailable)
+  if (storage == StorageMedium::Sd)
   {
     fileExists = SD.exists(kLastUploadedTimeFile);
     storageType = "SD card";
   }
-  else if (spiffsMounted)
+  else if (storage == StorageMedium::Spiffs)
   {
     fileExists = SPIFFS.exists(kLastUploadedTimeFile);
     storageType = "SPIFFS";
@@ -1005,11 +1603,11 @@ time_t DeepSleepManager_LoadLastUploadedTime()
     return 0;
   }
 
-  if (sdCardAvailable)
+  if (storage == StorageMedium::Sd)
   {
     file = SD.open(kLastUploadedTimeFile, FILE_READ);
   }
-  else if (spiffsMounted)
+  else if (storage == StorageMedium::Spiffs)
   {
     file = SPIFFS.open(kLastUploadedTimeFile, FILE_READ);
   }
@@ -1025,10 +1623,25 @@ time_t DeepSleepManager_LoadLastUploadedTime()
   }
 
   String line = file.readStringUntil('\n');
+  String cursorLine = file.readStringUntil('\n');
   file.close();
 
   time_t timestamp = (time_t)line.toInt();
 
+  // Files written before the cursor existed have no second line (full scan on next upload)
+  unsigned long fileDate = 0;
+  unsigned long offset = 0;
+  if (cursor != nullptr && sscanf(cursorLine.c_str(), "%lu %lu", &fileDate, &offset) == 2)
+  {
+    UploadCursor stored;
+    stored.fileDate = (uint32_t)fileDate;
+    stored.offset = (uint32_t)offset;
+    if (uploadCursorLooksValid(stored))
+    {
+      *cursor = stored;
+    }
+  }
+
   if (timestamp > 0)
   {
     LOGI(LogTag::DEEPSLEEP, "Loaded lastUploadedTime %ld from %s", (long)timestamp, storageType);
@@ -1039,15 +1652,16 @@ time_t DeepSleepManager_LoadLastUploadedTime()
 
 void DeepSleepManager_SaveDriftRate(float driftRate)
 {
+  const StorageMedium storage = StorageManager_Mount();
   File file;
   const char *storageType;
 
-  if (sdCardAvailable)
+  if (storage == StorageMedium::Sd)
   {
     file = SD.open(kDriftRateFile, FILE_WRITE);
     storageType = "SD card";
   }
-  else if (spiffsMounted)
+  else if (storage == StorageMedium::Spiffs)
   {
     file = SPIFFS.open(kDriftRateFile, FILE_WRITE);
     storageType = "SPIFFS";
@@ -1071,16 +1685,17 @@ void DeepSleepManager_SaveDriftRate(float driftRate)
 
 float DeepSleepManager_LoadDriftRate()
 {
+  const StorageMedium storage = StorageManager_Mount();
   File file;
   const char *storageType;
   bool fileExists = false;
 
-  if (sdCardAvailable)
+  if (storage == StorageMedium::Sd)
   {
     fileExists = SD.exists(kDriftRateFile);
     storageType = "SD card";
   }
-  else if (spiffsMounted)
+  else if (storage == StorageMedium::Spiffs)
   {
     fileExists = SPIFFS.exists(kDriftRateFile);
     storageType = "SPIFFS";
@@ -1096,11 +1711,11 @@ float DeepSleepManager_LoadDriftRate()
     return 0;
   }
 
-  if (sdCardAvailable)
+  if (storage == StorageMedium::Sd)
   {
     file = SD.open(kDriftRateFile, FILE_READ);
   }
-  else if (spiffsMounted)
+  else if (storage == StorageMedium::Spiffs)
   {
     file = SPIFFS.open(kDriftRateFile, FILE_READ);
   }
@@ -1128,17 +1743,113 @@ float DeepSleepManager_LoadDriftRate()
   return driftRate;
 }
 
+// drift_model.txt: one "<temperature C> <rate ms/min> <learned sleep min>" line per node
+void DeepSleepManager_SaveDriftModel(const DriftTempModel &model)
+{
+  const StorageMedium storage = StorageManager_Mount();
+  File file;
+  const char *storageType;
+
+  if (storage == StorageMedium::Sd)
+  {
+    file = SD.open(kDriftModelFile, FILE_WRITE);
+    storageType = "SD card";
+  }
+  else if (storage == StorageMedium::Spiffs)
+  {
+    file = SPIFFS.open(kDriftModelFile, FILE_WRITE);
+    storageType = "SPIFFS";
+  }
+  else
+  {
+    LOGW(LogTag::DEEPSLEEP, "Cannot save drift model: no storage available");
+    return;
+  }
+
+  if (!file)
+  {
+    LOGW(LogTag::DEEPSLEEP, "Failed to open drift model file for writing on %s", storageType);
+    return;
+  }
+
+  for (int i = 0; i < kDriftModelNodes; i++)
+  {
+    file.printf("%.0f %.2f %.0f\n", kDriftModelMinTempC + kDriftModelStepC * i,
+                model.rateMsPerMin[i], model.learnedMin[i]);
+  }
+  file.close();
+  LOGD(LogTag::DEEPSLEEP, "Saved drift model to %s", storageType);
+}
+
+bool DeepSleepManager_LoadDriftModel(DriftTempModel &model)
+{
+  const StorageMedium storage = StorageManager_Mount();
+  File file;
+  const char *storageType;
+
+  if (storage == StorageMedium::Sd)
+  {
+    if (!SD.exists(kDriftModelFile))
+    {
+      return false;
+    }
+    file = SD.open(kDriftModelFile, FILE_READ);
+    storageType = "SD card";
+  }
+  else if (storage == StorageMedium::Spiffs)
+  {
+    if (!SPIFFS.exists(kDriftModelFile))
+    {
+      return false;
+    }
+    file = SPIFFS.open(kDriftModelFile, FILE_READ);
+    storageType = "SPIFFS";
+  }
+  else
+  {
+    return false;
+  }
+
+  if (!file)
+  {
+    LOGW(LogTag::DEEPSLEEP, "Failed to open drift model file for reading on %s", storageType);
+    return false;
+  }
+
+  DriftTempModel loaded;
+  loaded.magic = kDriftModelMagic;
+  bool ok = true;
+  for (int i = 0; i < kDriftModelNodes && ok; i++)
+  {
+    String line = file.readStringUntil('\n');
+    float celsius = 0.0f;
+    ok = sscanf(line.c_str(), "%f %f %f", &celsius, &loaded.rateMsPerMin[i], &loaded.learnedMin[i]) == 3 &&
+         fabsf(celsius - (kDriftModelMinTempC + kDriftModelStepC * i)) < 0.5f;
+  }
+  file.close();
+
+  if (!ok)
+  {
+    LOGW(LogTag::DEEPSLEEP, "Ignoring malformed drift model file on %s", storageType);
+    return false;
+  }
+  model = loaded;
+  LOGI(LogTag::DEEPSLEEP, "Loaded drift model from %s", storageType);
+  return true;
+}
+
 void DeepSleepManager_SaveEstimatedProcessingTimes(float noWifiSeconds, float wifiSeconds)
 {
+  const StorageMedium storage = StorageManager_Mount();
   File file;
   const char *storageType;
 
-  if (sdCardAvailable)
+  if (storage == StorageMedium::Sd)
   {
     file = SD.open(kProcessingTimeFile, FILE_WRITE);
     storageType = "SD card";
   }
-  else if (spiffsMounted)
+  else if (storage == StorageMedium::Spiffs)
   {
     file = SPIFFS.open(kProcessingTimeFile, FILE_WRITE);
     storageType = "SPIFFS";
@@ -1155,8 +1866,9 @@ void DeepSleepManager_SaveEstimatedProcessingTimes(float noWifiSeconds, float wi
     return;
   }
 
-  // Simple key=value lines for easy manual inspection/editing.
-  file.printf("no_wifi=%.2f\nwifi=%.2f\n", noWifiSeconds, wifiSeconds);
+  char content[48];
+  ProcessingTime_Format(content, sizeof(content), noWifiSeconds, wifiSeconds);
+  file.print(content);
   file.close();
   LOGD(LogTag::DEEPSLEEP, "Saved processing times (noWiFi=%.2f, WiFi=%.2f) to %s",
        noWifiSeconds, wifiSeconds, storageType);
@@ -1164,16 +1876,17 @@ void DeepSleepManager_SaveEstimatedProcessingTimes(float noWifiSeconds, float wi
 
 bool DeepSleepManager_LoadEstimatedProcessingTimes(float &outNoWifiSeconds, float &outWifiSeconds)
 {
+  const StorageMedium storage = StorageManager_Mount();
   File file;
   const char *storageType;
   bool fileExists = false;
 
-  if (sdCardAvailable)
+  if (storage == StorageMedium::Sd)
   {
     fileExists = SD.exists(kProcessingTimeFile);
     storageType = "SD card";
   }
-  else if (spiffsMounted)
+  else if (storage == StorageMedium::Spiffs)
   {
     fileExists = SPIFFS.exists(kProcessingTimeFile);
     storageType = "SPIFFS";
@@ -1189,11 +1902,11 @@ bool DeepSleepManager_LoadEstimatedProcessingTimes(float &outNoWifiSeconds, floa
     return false;
   }
 
-  if (sdCardAvailable)
+  if (storage == StorageMedium::Sd)
   {
     file = SD.open(kProcessingTimeFile, FILE_READ);
   }
-  else if (spiffsMounted)
+  else if (storage == StorageMedium::Spiffs)
   {
     file = SPIFFS.open(kProcessingTimeFile, FILE_READ);
   }
@@ -1212,95 +1925,11 @@ bool DeepSleepManager_LoadEstimatedProcessingTimes(float &outNoWifiSeconds, floa
   String content = file.readString();
   file.close();
 
-  content.trim();
-  if (content.length() == 0)
-  {
-    return false;
-  }
-
-  // Backward compatible: if file is just a float, apply to both.
-  if (content.indexOf('=') < 0)
+  if (!ProcessingTime_Parse(content.c_str(), outNoWifiSeconds, outWifiSeconds))
   {
-    float seconds = content.toFloat();
-    if (seconds >= 1.0f && seconds <= 20.0f)
-    {
-      outNoWifiSeconds = seconds;
-      outWifiSeconds = seconds;
-      LOGI(LogTag::DEEPSLEEP, "Loaded processingTime %.2f sec (legacy) from %s", seconds, storageType);
-      return true;
-    }
     return false;
   }
-
-  float noWifi = 0.0f;
-  float wifi = 0.0f;
-  bool hasNoWifi = false;
-  bool hasWifi = false;
-
-  int start = 0;
-  while (start < content.length())
-  {
-    int end = content.indexOf('\n', start);
-    if (end < 0) end = content.length();
-    String line = content.substring(start, end);
-    line.trim();
-    start = end + 1;
-
-    if (line.length() == 0 || line.startsWith("#"))
-    {
-      continue;
-    }
-
-    int eq = line.indexOf('=');
-    if (eq < 0)
-    {
-      continue;
-    }
-
-    String key = line.substring(0, eq);
-    String val = line.substring(eq + 1);
-    key.trim();
-    key.toLowerCase();
-    val.trim();
-
-    float seconds = val.toFloat();
-    if (seconds < 1.0f || seconds > 20.0f)
-    {
-      continue;
-    }
-
-    if (key == "no_wifi" || key == "nowifi" || key == "no_wifi_seconds" || key == "nowifiseconds")
-    {
-      noWifi = seconds;
-      hasNoWifi = true;
-    }
-    else if (key == "wifi" || key == "wifi_seconds" || key == "wifiseconds")
-    {
-      wifi = seconds;
-      hasWifi = true;
-    }
-  }
-
-  if (!hasNoWifi && hasWifi)
-  {
-    // If only wifi is present, use it for both.
-    noWifi = wifi;
-    hasNoWifi = true;
-  }
-  if (hasNoWifi && !hasWifi)
-  {
-    wifi = noWifi;
-    hasWifi = true;
-  }
-
-  if (hasNoWifi)
-  {
-    outNoWifiSeconds = noWifi;
-    outWifiSeconds = wifi;
-    LOGI(LogTag::DEEPSLEEP, "Loaded processing times from %s: noWiFi=%.2f sec, WiFi=%.2f sec",
-         storageType, outNoWifiSeconds, outWifiSeconds);
-    return true;
-  }
-
-  return false;
+  LOGI(LogTag::DEEPSLEEP, "Loaded processing times from %s: noWiFi=%.2f sec, WiFi=%.2f sec",
+       storageType, outNoWifiSeconds, outWifiSeconds);
+  return true;
 }
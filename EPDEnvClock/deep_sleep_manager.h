@@ -3,6 +3,8 @@
 #include <Arduino.h>
 #include <sys/time.h>
 
+#include "processing_time.h"
+
 // RTC memory structure to persist across deep sleep
 // Default RTC drift rate measured on this device (Dec 2025)
 // RTC slow clock runs at ~143.69 kHz instead of nominal 150 kHz
@@ -10,6 +12,73 @@
 // Default is conservative; EMA will calibrate quickly, and value persists to SD card
 constexpr float kDefaultDriftRateMsPerMin = 50.0f;
 
+// Temperature-dependent drift model (RTCState::driftModel)
+// The slow-clock drift rate is learned per temperature node (0, 5, ... 40 C; linear in between,
+// flat outside) from NTP sync residuals. Each sleep is compensated with the rate at the temperature
+// read before it, and the sleep minutes are credited to the nodes around that temperature so the
+// next sync can attribute its residual. Set to 0 to use the single driftRateMsPerMin EMA only.
+#ifndef RTC_DRIFT_TEMP_MODEL
+#define RTC_DRIFT_TEMP_MODEL 1
+#endif
+
+constexpr uint32_t kDriftModelMagic = 0x44544D50; // "DTMP"
+constexpr int kDriftModelNodes = 9;
+constexpr float kDriftModelMinTempC = 0.0f;
+constexpr float kDriftModelStepC = 5.0f;
+
+struct DriftTempModel
+{
+  uint32_t magic = 0;
+  float rateMsPerMin[kDriftModelNodes] = {}; // Learned drift rate at each node (ms per sleep minute)
+  float learnedMin[kDriftModelNodes] = {};   // Sleep minutes learned into each node (0 = not seen yet)
+  float pendingMin[kDriftModelNodes] = {};   // Sleep minutes credited to each node since the last sync
+  float untrackedMin = 0.0f;                 // Sleep minutes since the last sync without a temperature
+};
+
+// Wake scheduling: deep sleep ends this much before the estimated draw start, and the rest is
+// spent in DeepSleepManager_WaitUntil() (light sleep + esp_timer one-shot) so the refresh starts
+// on time instead of late. Larger = fewer late refreshes, slightly more awake time.
+#ifndef WAKE_EARLY_MARGIN_MS
+#define WAKE_EARLY_MARGIN_MS 150
+#endif
+
+// Draw start jitter histogram (actual - target, ms), logged every kDrawJitterLogSamples boots
+// Bin upper edges; the last bin collects everything at or above the last edge
+constexpr int kDrawJitterBins = 8;
+constexpr int16_t kDrawJitterEdgesMs[kDrawJitterBins - 1] = {-100, -50, -20, 0, 20, 50, 100};
+constexpr uint16_t kDrawJitterLogSamples = 60;
+
+struct DrawJitterStats
+{
+  uint16_t bins[kDrawJitterBins] = {};
+  uint16_t samples = 0;   // Samples since the histogram was last logged
+  int32_t sumAbsMs = 0;   // Sum of |jitter| over those samples
+};
+
+// Adaptive WiFi/NTP schedule (DeepSleepManager_ShouldSyncWiFiNtp)
+// Syncs only happen on the hour. Every hour is synced until the drift rate has converged
+// (NTP_SYNC_CONVERGED_SYNCS syncs in a row with a residual under half the target). After that,
+// the interval doubles after each such sync and halves when the residual exceeds
+// NTP_SYNC_TARGET_RESIDUAL_MS. A temperature change of NTP_SYNC_TEMP_DELTA_C since the last sync
+// (the RTC drift rate follows temperature) brings the next sync forward to the coming hour.
+// Raise NTP_SYNC_MAX_INTERVAL_MIN / NTP_SYNC_TARGET_RESIDUAL_MS to trade clock accuracy for battery
+// life; note sensor readings are uploaded on the same WiFi boots.
+#ifndef NTP_SYNC_MIN_INTERVAL_MIN
+#define NTP_SYNC_MIN_INTERVAL_MIN 60
+#endif
+#ifndef NTP_SYNC_MAX_INTERVAL_MIN
+#define NTP_SYNC_MAX_INTERVAL_MIN 360
+#endif
+#ifndef NTP_SYNC_TARGET_RESIDUAL_MS
+#define NTP_SYNC_TARGET_RESIDUAL_MS 500
+#endif
+#ifndef NTP_SYNC_TEMP_DELTA_C
+#define NTP_SYNC_TEMP_DELTA_C 3.0f
+#endif
+#ifndef NTP_SYNC_CONVERGED_SYNCS
+#define NTP_SYNC_CONVERGED_SYNCS 3
+#endif
+
 // Magic number to detect valid RTC data.
 // IMPORTANT:
 // - This data is used to restore time after deep sleep.
@@ -20,6 +89,59 @@ constexpr uint32_t kRtcStateMagic = 0xDEADBEEF;
 // Compatibility: a short-lived firmware used this magic. Accept it to avoid wiping RTC time on upgrade.
 constexpr uint32_t kRtcStateMagicCompat_20251229 = 0xDEADBEF1;
 
+// Input keys of the dynamic display regions baked into the persisted frame buffer.
+// display_layout.cpp redraws a region only when its key changes; 0 means "not drawn".
+// The keys are trusted only while magic matches, so stale RTC memory forces a full redraw.
+constexpr uint32_t kDisplayLayerKeysMagic = 0x4C415952; // "LAYR"
+
+struct DisplayLayerKeys
+{
+  uint32_t magic = 0;
+  uint32_t timeKey = 0;
+  uint32_t dateKey = 0;
+  uint32_t statusKey = 0;
+  uint32_t temperatureKey = 0;
+  uint32_t humidityKey = 0;
+  uint32_t co2Key = 0;
+  bool sensorIconsDrawn = false;
+};
+
+// Where the persisted frame buffer lives (RTCState::frameTier)
+// Rtc: compressed frame retained in RTC slow memory (no SD access on wake)
+// Storage: frame.bin on SD/SPIFFS, used when the frame does not fit in RTC memory
+enum class FrameTier : uint8_t
+{
+  None = 0,
+  Rtc = 1,
+  Storage = 2,
+};
+
+// Read position of the sensor log upload (RTCState::uploadCursor)
+// fileDate: YYYYMMDD of the JSONL file holding the last uploaded record (0 = unknown)
+// offset: byte offset just past that record's line, so the next scan can seek() there
+struct UploadCursor
+{
+  uint32_t fileDate = 0;
+  uint32_t offset = 0;
+};
+
+// Last AP and IP configuration for the WiFi fast path (RTCState::wifiCache)
+// Valid only while magic matches and ssidHash matches the configured SSID.
+constexpr uint32_t kWifiCacheMagic = 0x57494649; // "WIFI"
+
+struct WifiConnectCache
+{
+  uint32_t magic = 0;
+  uint32_t ssidHash = 0;   // FNV-1a of WIFI_SSID the entry belongs to
+  uint8_t bssid[6] = {};
+  uint8_t channel = 0;
+  uint32_t ip = 0;         // Last DHCP lease (IPv4, network byte order; 0 = none)
+  uint32_t gateway = 0;
+  uint32_t subnet = 0;
+  uint32_t dns = 0;
+  time_t leaseTime = 0;    // When the lease was obtained by DHCP
+};
+
 struct RTCState
 {
   uint32_t magic = kRtcStateMagic; // Magic number to detect valid RTC data
@@ -37,11 +159,30 @@ struct RTCState
   time_t lastUploadedTime = 0;       // Timestamp of the last successfully uploaded data point
   // Estimated boot-to-display time in seconds (adaptive, ms precision)
   // We keep separate estimates because WiFi/NTP boots can have different timing/jitter.
-  float estimatedProcessingTimeNoWifi = 7.5f;
-  float estimatedProcessingTimeWifi = 7.5f;
+  float estimatedProcessingTimeNoWifi = kProcessingTimeDefaultSec;
+  float estimatedProcessingTimeWifi = kProcessingTimeDefaultSec;
   float driftRateMsPerMin = kDefaultDriftRateMsPerMin; // Measured RTC drift rate (positive = slow, ms/min)
   bool driftRateCalibrated = false;                    // True after first NTP sync calibrates the rate
   int64_t cumulativeCompensationMs = 0;                // Cumulative drift compensation since last NTP sync (for rate calculation)
+  DisplayLayerKeys displayLayers;                       // What the persisted frame buffer currently shows
+  FrameTier frameTier = FrameTier::None;                // Tier holding the latest frame (other tiers may be stale)
+  UploadCursor uploadCursor;                            // Log position matching lastUploadedTime
+  time_t binaryUploadRejectedTime = 0;                  // Last 415 reply to a binary batch (0 = never)
+  bool processingTimesUnsaved = false;                  // Estimates changed since last written to storage
+  uint32_t lastRetentionSweepDate = 0;                  // YYYYMMDD of the last sensor log retention sweep (0 = none)
+  WifiConnectCache wifiCache;                           // AP/IP of the last connect (network_manager.cpp)
+  uint16_t ntpSyncIntervalMin = NTP_SYNC_MIN_INTERVAL_MIN; // Current adaptive NTP interval
+  uint8_t driftConvergedSyncs = 0;                      // Syncs in a row with a small residual
+  float lastTemperature = NAN;                          // Latest sensor temperature (NaN = none)
+  float ntpSyncTemperature = NAN;                       // Temperature at the last NTP sync
+  DriftTempModel driftModel;                            // Drift rate vs temperature (see above)
+  uint32_t sensorShotTime = 0;                          // Unix time the pre-sleep SCD41 single shot was sent (0 = none)
+  bool sensorShotRhtOnly = false;                       // Pre-sleep shot was measure_single_shot_rht_only
+  bool co2ChangingFast = false;                         // Last two CO2 shots differed by >= SENSOR_CO2_FAST_CHANGE_PPM
+  uint16_t lastCo2Ppm = 0;                              // Last measured CO2 (carried forward by RHT-only reads)
+  uint32_t lastCo2Time = 0;                             // Unix time lastCo2Ppm was measured (0 = none)
+  bool driftFilesUnsaved = false;                       // Drift rate/model changed at NTP sync, not yet on storage
+  DrawJitterStats drawJitter;                           // Draw start vs target (see above)
 };
 
 // Initialize deep sleep manager
@@ -54,18 +195,31 @@ bool DeepSleepManager_IsWakeFromSleep();
 RTCState &DeepSleepManager_GetRTCState();
 
 // Calculate sleep duration until next minute update (in microseconds)
+// Includes WAKE_EARLY_MARGIN_MS so the boot arrives slightly early
 uint64_t DeepSleepManager_CalculateSleepDuration();
 
+// Wait until the given wall-clock time with sub-millisecond precision
+// allowLightSleep: light sleep through most of the wait (not while WiFi must stay connected)
+void DeepSleepManager_WaitUntil(const struct timeval &target, bool allowLightSleep);
+
+// Record how far the draw start landed from its target (ms, positive = late)
+// The histogram is logged and cleared every kDrawJitterLogSamples samples
+void DeepSleepManager_RecordDrawJitter(int32_t jitterMs);
+
 // Enter deep sleep until next minute update
 void DeepSleepManager_EnterDeepSleep();
 
 // Get boot count (increments on each wake)
 uint32_t DeepSleepManager_GetBootCount();
 
-// Check if WiFi/NTP sync should be performed (on first boot and top of every hour)
+// Check if WiFi/NTP sync should be performed (first boot, then on the hour per the adaptive
+// schedule above)
 // Returns true if WiFi connection and NTP sync are needed
 bool DeepSleepManager_ShouldSyncWiFiNtp();
 
+// Record the latest sensor temperature (drives the temperature-triggered NTP sync)
+void DeepSleepManager_NoteTemperature(float celsius);
+
 // Save RTC time before NTP sync (call this before attempting NTP sync)
 void DeepSleepManager_SaveRtcTimeBeforeSync();
 
@@ -85,11 +239,11 @@ bool DeepSleepManager_IsLastRtcDriftValid();
 // Get current drift rate in ms/min (positive = RTC runs slow)
 float DeepSleepManager_GetDriftRateMsPerMin();
 
-// Save frame buffer to SD card (or SPIFFS if SD card not available)
+// Save frame buffer to RTC memory (compressed), or to SD card / SPIFFS if it does not fit
 // Returns true if successful
 bool DeepSleepManager_SaveFrameBuffer(const uint8_t *buffer, size_t size);
 
-// Load frame buffer from SD card (or SPIFFS if SD card not available)
+// Load frame buffer from the tier it was last saved to (RTC memory, SD card or SPIFFS)
 // Returns true if successful
 bool DeepSleepManager_LoadFrameBuffer(uint8_t *buffer, size_t size);
 
@@ -111,13 +265,14 @@ bool DeepSleepManager_IsWakeFromGPIO();
 // Get wakeup GPIO pin number (returns -1 if not GPIO wakeup)
 int DeepSleepManager_GetWakeupGPIO();
 
-// Save lastUploadedTime to SD card (persists across power cycles)
+// Save lastUploadedTime (and the matching log cursor) to SD card (persists across power cycles)
 // Call this after successful data upload
-void DeepSleepManager_SaveLastUploadedTime(time_t timestamp);
+void DeepSleepManager_SaveLastUploadedTime(time_t timestamp, const UploadCursor &cursor = UploadCursor());
 
 // Load lastUploadedTime from SD card
+// cursor (optional): receives the stored log cursor, or an empty cursor if none was saved
 // Returns 0 if file doesn't exist or read fails
-time_t DeepSleepManager_LoadLastUploadedTime();
+time_t DeepSleepManager_LoadLastUploadedTime(UploadCursor *cursor = nullptr);
 
 // Save drift rate to SD card (persists across power cycles)
 // Call this after drift rate calibration via NTP sync
@@ -127,12 +282,21 @@ void DeepSleepManager_SaveDriftRate(float driftRate);
 // Returns 0 if file doesn't exist or read fails
 float DeepSleepManager_LoadDriftRate();
 
+// Save/load the temperature drift model (drift_model.txt, next to the drift rate file)
+// Load returns false if the file doesn't exist or is malformed (model is left untouched)
+void DeepSleepManager_SaveDriftModel(const DriftTempModel &model);
+bool DeepSleepManager_LoadDriftModel(DriftTempModel &model);
+
+// Write the drift rate/model updated by the last NTP sync (no-op if unchanged)
+// MarkNtpSynced only flags them so the SD write stays off the boot-to-display path;
+// call this after the display refresh has started.
+void DeepSleepManager_SaveDeferredState();
+
 // Save estimated processing times (boot-to-draw) to SD/SPIFFS for persistence
 // noWifiSeconds: normal minute updates (no WiFi)
 // wifiSeconds: top-of-hour (WiFi/NTP) boots
 void DeepSleepManager_SaveEstimatedProcessingTimes(float noWifiSeconds, float wifiSeconds);
 
-// Load estimated processing times.
-// Returns true if at least noWifiSeconds was loaded successfully.
-// Backward compatible: if the file contains a single float, it's applied to both.
+// Load estimated processing times (format and validation in processing_time.h)
+// Returns true if at least one estimate was loaded; a missing one takes the other's value.
 bool DeepSleepManager_LoadEstimatedProcessingTimes(float &outNoWifiSeconds, float &outWifiSeconds);
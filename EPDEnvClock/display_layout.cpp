@@ -0,0 +1,248 @@
+#include "display_layout.h"
+
+#include "EPD.h"
+#include "font_renderer.h"
+#include "bitmaps/Kerning_table.h"
+#include "logger.h"
+
+namespace
+{
+// Key for an undrawable state ("No Time" / "WiFi Failed" placeholders)
+constexpr uint32_t kPlaceholderKey = 0xFFFFFFFF;
+
+// ============================================================
+// Glyph Sequence Builders
+// ============================================================
+
+// Build temperature glyph sequence: "23.5" -> [2, 3, PERIOD, 5]
+uint8_t buildTemperatureGlyphs(float temp, uint8_t *glyphs)
+{
+  if (temp < 0.0f)
+    temp = 0.0f;
+
+  int tempInt = (int)temp;
+  int tempDecimal = (int)((temp - tempInt) * 10 + 0.5f);
+  if (tempDecimal >= 10)
+  {
+    tempInt++;
+    tempDecimal = 0;
+  }
+
+  glyphs[0] = tempInt / 10;
+  glyphs[1] = tempInt % 10;
+  glyphs[2] = GLYPH_PERIOD;
+  glyphs[3] = tempDecimal;
+  return 4;
+}
+
+// Build integer glyph sequence: 1234 -> [1, 2, 3, 4]
+uint8_t buildIntegerGlyphs(int value, uint8_t *glyphs)
+{
+  if (value < 0)
+    value = 0;
+  if (value == 0)
+  {
+    glyphs[0] = 0;
+    return 1;
+  }
+
+  uint8_t temp[4];
+  uint8_t count = 0;
+  while (value > 0 && count < 4)
+  {
+    temp[count++] = value % 10;
+    value /= 10;
+  }
+  // Reverse
+  for (uint8_t i = 0; i < count; i++)
+    glyphs[i] = temp[count - 1 - i];
+  return count;
+}
+
+// Build date glyph sequence: 2024.11.25 -> [2,0,2,4, PERIOD, 1,1, PERIOD, 2,5]
+// No zero padding for month/day: 2025.12.1 or 2026.1.1
+uint8_t buildDateGlyphs(uint16_t year, uint8_t month, uint8_t day, uint8_t *glyphs)
+{
+  uint8_t count = 0;
+  glyphs[count++] = (year / 1000) % 10;
+  glyphs[count++] = (year / 100) % 10;
+  glyphs[count++] = (year / 10) % 10;
+  glyphs[count++] = year % 10;
+  glyphs[count++] = GLYPH_PERIOD;
+  if (month >= 10)
+    glyphs[count++] = month / 10;
+  glyphs[count++] = month % 10;
+  glyphs[count++] = GLYPH_PERIOD;
+  if (day >= 10)
+    glyphs[count++] = day / 10;
+  glyphs[count++] = day % 10;
+  return count;
+}
+
+// Build time glyph sequence: 12:34 -> [1,2, COLON, 3,4] or 9:34 -> [9, COLON, 3,4]
+uint8_t buildTimeGlyphs(uint8_t hour, uint8_t minute, uint8_t *glyphs)
+{
+  uint8_t count = 0;
+  if (hour >= 10)
+    glyphs[count++] = hour / 10;
+  glyphs[count++] = hour % 10;
+  glyphs[count++] = GLYPH_COLON;
+  glyphs[count++] = minute / 10;
+  glyphs[count++] = minute % 10;
+  return count;
+}
+
+// Pack a glyph sequence into a non-zero region key
+uint32_t glyphKey(const uint8_t *glyphs, uint8_t count)
+{
+  uint32_t key = 1;
+  for (uint8_t i = 0; i < count; i++)
+    key = key * 31 + glyphs[i] + 1;
+  return key ? key : 1;
+}
+
+// FNV-1a over a string, never 0
+uint32_t stringKey(const char *str)
+{
+  uint32_t hash = 2166136261u;
+  while (*str)
+  {
+    hash ^= (uint8_t)*str++;
+    hash *= 16777619u;
+  }
+  return hash ? hash : 1;
+}
+
+// Returns true (after clearing the region) when the cached key is stale
+bool beginRegion(uint32_t &cachedKey, uint32_t newKey, const Region &region)
+{
+  if (cachedKey == newKey)
+    return false;
+  if (cachedKey != 0)
+    EPD_ClearWindows(region.x0, region.y0, region.x1, region.y1, WHITE);
+  cachedKey = newKey;
+  return true;
+}
+
+// ============================================================
+// Drawing Functions (using glyph runs)
+// ============================================================
+
+// Center of the time/date column (Range: 15 to 468)
+constexpr uint16_t kLeftColumnCenterX = 241;
+
+// Lay the sequence out once, then center it on its own width
+void drawCenteredGlyphs(const uint8_t *glyphs, uint8_t count, FontSize size, uint16_t centerX, uint16_t y)
+{
+  GlyphRun run;
+  layoutGlyphRun(glyphs, count, size, run);
+  drawGlyphRun(run, centerX - (run.width / 2), y);
+}
+
+} // namespace
+
+void DisplayLayout_DrawStatus(const char *statusLine)
+{
+  const int yPos = 4; // Adjusted for 12px font (centered in top 20px area?) or just top aligned
+  const uint16_t fontSize = 12;
+  EPD_ShowString(8, yPos, statusLine, fontSize, BLACK);
+}
+
+uint8_t DisplayLayout_Compose(DisplayLayerKeys &layers, const DisplayContent &content)
+{
+  uint8_t regionsDrawn = 0;
+
+  // Draw time and date only if time is available
+  if (content.timeAvailable)
+  {
+    uint8_t glyphs[10];
+    uint8_t count = buildTimeGlyphs(content.hour, content.minute, glyphs);
+    if (beginRegion(layers.timeKey, glyphKey(glyphs, count), kTimeRegion))
+    {
+      LOGD(LogTag::DISPLAY_MGR, "drawTime: %02d:%02d", content.hour, content.minute);
+      drawCenteredGlyphs(glyphs, count, FONT_L, kLeftColumnCenterX, kTimeY);
+      regionsDrawn++;
+    }
+
+    count = buildDateGlyphs(content.year, content.month, content.day, glyphs);
+    if (beginRegion(layers.dateKey, glyphKey(glyphs, count), kDateRegion))
+    {
+      LOGD(LogTag::DISPLAY_MGR, "drawDateM: %04d.%02d.%02d", content.year, content.month, content.day);
+      drawCenteredGlyphs(glyphs, count, FONT_M, kLeftColumnCenterX, kDateY);
+      regionsDrawn++;
+    }
+  }
+  else
+  {
+    // Draw error message instead of time
+    const uint16_t fontSize = 12;
+    if (beginRegion(layers.timeKey, kPlaceholderKey, kTimeRegion))
+    {
+      EPD_ShowString(kTimeX, kTimeY, "No Time", fontSize, BLACK);
+      regionsDrawn++;
+    }
+    if (beginRegion(layers.dateKey, kPlaceholderKey, kDateRegion))
+    {
+      EPD_ShowString(kDateX, kDateY, "WiFi Failed", fontSize, BLACK);
+      regionsDrawn++;
+    }
+  }
+
+  if (beginRegion(layers.statusKey, stringKey(content.statusLine), kStatusRegion))
+  {
+    DisplayLayout_DrawStatus(content.statusLine);
+    regionsDrawn++;
+  }
+
+  // Draw sensor icons and values
+  if (content.sensorAvailable)
+  {
+    // Static layer: icons are drawn once and then kept in the frame buffer
+    if (!layers.sensorIconsDrawn)
+    {
+      drawBitmapCorrect(kTempIconX, kTempIconY, IconTemp_WIDTH, IconTemp_HEIGHT, IconTemp);
+      drawBitmapCorrect(kHumidityIconX, kHumidityIconY, IconHumidity_WIDTH, IconHumidity_HEIGHT, IconHumidity);
+      drawBitmapCorrect(kCO2IconX, kCO2IconY, IconCO2_WIDTH, IconCO2_HEIGHT, IconCO2);
+      layers.sensorIconsDrawn = true;
+      regionsDrawn++;
+    }
+
+    uint8_t glyphs[4];
+    uint8_t count = buildTemperatureGlyphs(content.temperature, glyphs);
+    if (beginRegion(layers.temperatureKey, glyphKey(glyphs, count), kTempRegion))
+    {
+      uint16_t tempEndX = drawGlyphSequence(glyphs, count, kTempValueX, kTempValueY, FONT_M);
+      drawBitmapCorrect(tempEndX + kValueUnitSpacing, kTempValueY + kUnitYOffset, UnitC_WIDTH, UnitC_HEIGHT, UnitC);
+      regionsDrawn++;
+    }
+
+    const int humidityValue = (int)(content.humidity + 0.5f);
+    count = buildIntegerGlyphs(humidityValue, glyphs);
+    if (beginRegion(layers.humidityKey, glyphKey(glyphs, count), kHumidityRegion))
+    {
+      uint16_t humidityEndX = drawGlyphSequence(glyphs, count, kHumidityValueX, kHumidityValueY, FONT_M);
+      drawBitmapCorrect(humidityEndX + kValueUnitSpacing, kHumidityValueY + kUnitYOffset, UnitPercent_WIDTH, UnitPercent_HEIGHT, UnitPercent);
+      regionsDrawn++;
+    }
+
+    count = buildIntegerGlyphs(content.co2, glyphs);
+    if (beginRegion(layers.co2Key, glyphKey(glyphs, count), kCO2Region))
+    {
+      uint16_t co2EndX = drawGlyphSequence(glyphs, count, kCO2ValueX, kCO2ValueY, FONT_M);
+      drawBitmapCorrect(co2EndX + kValueUnitSpacing, kCO2ValueY + kUnitYOffset, UnitPpm_WIDTH, UnitPpm_HEIGHT, UnitPpm);
+      regionsDrawn++;
+    }
+  }
+  else if (layers.sensorIconsDrawn)
+  {
+    // Sensor went away: drop the whole sensor column (icons + values)
+    EPD_ClearWindows(kSensorRegion.x0, kSensorRegion.y0, kSensorRegion.x1, kSensorRegion.y1, WHITE);
+    layers.sensorIconsDrawn = false;
+    layers.temperatureKey = 0;
+    layers.humidityKey = 0;
+    layers.co2Key = 0;
+    regionsDrawn++;
+  }
+
+  return regionsDrawn;
+}
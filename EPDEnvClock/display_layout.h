@@ -0,0 +1,85 @@
+#pragma once
+
+#include <Arduino.h>
+
+#include "EPD_Init.h"
+#include "bitmaps/Icon_bitmap.h"
+#include "deep_sleep_manager.h"
+
+// Screen layout and layered compositor
+// Pure drawing into the Paint canvas (no time, sensor or network access), so the same code
+// runs in display_manager.cpp and in the host benchmark harness (bench/).
+
+// Layout constants
+constexpr uint16_t kTimeX = 16;
+constexpr uint16_t kTimeY = 123;
+constexpr uint16_t kDateX = 16;
+constexpr uint16_t kDateY = 45;
+constexpr uint16_t kTempValueX = 546;
+constexpr uint16_t kTempValueY = 33;
+constexpr uint16_t kHumidityValueX = 546;
+constexpr uint16_t kHumidityValueY = 114;
+constexpr uint16_t kCO2ValueX = 546;
+constexpr uint16_t kCO2ValueY = 193;
+constexpr uint16_t kSideMargin = 16;
+constexpr uint16_t kUnitYOffset = 26;
+constexpr uint16_t kIconValueSpacing = 6;
+constexpr uint16_t kValueUnitSpacing = 5;
+// Spacing is now handled by font advance widths + kerning from Kerning_table.h
+
+// Icon positions (fixed)
+constexpr uint16_t kTempIconX = 482;
+constexpr uint16_t kTempIconY = 33;
+constexpr uint16_t kHumidityIconX = 482;
+constexpr uint16_t kHumidityIconY = 114;
+constexpr uint16_t kCO2IconX = 482;
+constexpr uint16_t kCO2IconY = 193;
+
+// Glyph heights (NumberL*_HEIGHT / NumberM*_HEIGHT in bitmaps/)
+constexpr uint16_t kTimeGlyphHeight = 116;
+constexpr uint16_t kValueGlyphHeight = 58;
+constexpr uint16_t kStatusHeight = 20;
+
+// Dynamic regions of the layered compositor. Each one is cleared and redrawn
+// only when its key changes; everything outside them (icons) is a static layer
+// that survives in the persisted frame buffer.
+struct Region
+{
+  uint16_t x0, y0, x1, y1; // EPD_ClearWindows() bounds: rows y0..y1-1, columns x0..x1
+};
+constexpr Region kStatusRegion = {0, 0, EPD_W, kStatusHeight};
+constexpr Region kDateRegion = {0, kDateY, kTempIconX - 1, kDateY + kValueGlyphHeight};
+constexpr Region kTimeRegion = {0, kTimeY, kTempIconX - 1, kTimeY + kTimeGlyphHeight};
+// Value regions include the unit bitmap, which follows the value's end X
+constexpr uint16_t valueRegionHeight(uint16_t unitHeight)
+{
+  return (kUnitYOffset + unitHeight > kValueGlyphHeight) ? kUnitYOffset + unitHeight : kValueGlyphHeight;
+}
+constexpr Region kTempRegion = {kTempValueX, kTempValueY, EPD_W - 1, kTempValueY + valueRegionHeight(UnitC_HEIGHT)};
+constexpr Region kHumidityRegion = {kHumidityValueX, kHumidityValueY, EPD_W - 1, kHumidityValueY + valueRegionHeight(UnitPercent_HEIGHT)};
+constexpr Region kCO2Region = {kCO2ValueX, kCO2ValueY, EPD_W - 1, kCO2ValueY + valueRegionHeight(UnitPpm_HEIGHT)};
+constexpr Region kSensorRegion = {kTempIconX, kTempIconY, EPD_W - 1, kCO2Region.y1};
+
+// What one frame shows
+struct DisplayContent
+{
+  bool timeAvailable = false; // false draws the "No Time" / "WiFi Failed" placeholders
+  uint8_t hour = 0;
+  uint8_t minute = 0;
+  uint16_t year = 0;
+  uint8_t month = 0;
+  uint8_t day = 0;
+  const char *statusLine = "";
+  bool sensorAvailable = false; // false clears the sensor column
+  float temperature = 0.0f;
+  float humidity = 0.0f;
+  uint16_t co2 = 0;
+};
+
+// Redraw every region whose key in layers differs from content, updating the keys.
+// The canvas must hold the frame described by layers (reset both for a full redraw).
+// Returns the number of regions drawn.
+uint8_t DisplayLayout_Compose(DisplayLayerKeys &layers, const DisplayContent &content);
+
+// Draw a status line into the (already cleared) status region
+void DisplayLayout_DrawStatus(const char *statusLine);
@@ -5,12 +5,12 @@
 
 #include "EPD.h"
 #include "EPD_Init.h"
-#include "font_renderer.h"
-#include "bitmaps/Icon_bitmap.h"
-#include "bitmaps/Kerning_table.h"
+#include "display_layout.h"
 #include "sensor_manager.h"
 #include "deep_sleep_manager.h"
 #include "logger.h"
+#include "boot_profiler.h"
+#include "power_manager.h"
 #include "network_manager.h"
 #include "fuel_gauge_manager.h"
 
@@ -20,186 +20,22 @@ constexpr size_t kFrameBufferSize = 27200;
 constexpr uint16_t kScreenWidth = 792;
 constexpr uint16_t kScreenHeight = 272;
 
-// Layout constants
-constexpr uint16_t kTimeX = 16;
-constexpr uint16_t kTimeY = 123;
-constexpr uint16_t kDateX = 16;
-constexpr uint16_t kDateY = 45;
-constexpr uint16_t kTempValueX = 546;
-constexpr uint16_t kTempValueY = 33;
-constexpr uint16_t kHumidityValueX = 546;
-constexpr uint16_t kHumidityValueY = 114;
-constexpr uint16_t kCO2ValueX = 546;
-constexpr uint16_t kCO2ValueY = 193;
-constexpr uint16_t kSideMargin = 16;
-constexpr uint16_t kUnitYOffset = 26;
-constexpr uint16_t kIconValueSpacing = 6;
-constexpr uint16_t kValueUnitSpacing = 5;
-// Spacing is now handled by font advance widths + kerning from Kerning_table.h
-
-uint8_t ImageBW[kFrameBufferSize];
+// Controller-order frames are sent to the EPD straight from here (DMA reads it)
+WORD_ALIGNED_ATTR uint8_t ImageBW[kFrameBufferSize];
 
 char g_statusMessage[64] = "Init...";
+DisplayRefreshStartedCallback g_refreshStartedCallback = nullptr;
 
-// ============================================================
-// Glyph Sequence Builders
-// ============================================================
+// Increased buffer size to prevent overflow with long status messages
+// Format can be: "B:85%(3.85V) | W:OK(-50) 192.168.1.100 | N:OK | U:123m | H:12345 | Msg:...")
+// Max length: ~120 chars + 64 char message = ~184 chars, using 256 for safety
+constexpr size_t kStatusLineSize = 256;
 
-// Build temperature glyph sequence: "23.5" -> [2, 3, PERIOD, 5]
-uint8_t buildTemperatureGlyphs(float temp, uint8_t *glyphs)
+void formatStatus(char *statusLine, size_t statusLineSize, const NetworkState &networkState,
+                  float batteryVoltage, float batteryPercent)
 {
-  if (temp < 0.0f)
-    temp = 0.0f;
-
-  int tempInt = (int)temp;
-  int tempDecimal = (int)((temp - tempInt) * 10 + 0.5f);
-  if (tempDecimal >= 10)
-  {
-    tempInt++;
-    tempDecimal = 0;
-  }
-
-  glyphs[0] = tempInt / 10;
-  glyphs[1] = tempInt % 10;
-  glyphs[2] = GLYPH_PERIOD;
-  glyphs[3] = tempDecimal;
-  return 4;
-}
-
-// Build integer glyph sequence: 1234 -> [1, 2, 3, 4]
-uint8_t buildIntegerGlyphs(int value, uint8_t *glyphs)
-{
-  if (value < 0)
-    value = 0;
-  if (value == 0)
-  {
-    glyphs[0] = 0;
-    return 1;
-  }
-
-  uint8_t temp[4];
-  uint8_t count = 0;
-  while (value > 0 && count < 4)
-  {
-    temp[count++] = value % 10;
-    value /= 10;
-  }
-  // Reverse
-  for (uint8_t i = 0; i < count; i++)
-    glyphs[i] = temp[count - 1 - i];
-  return count;
-}
-
-// Build date glyph sequence: 2024.11.25 -> [2,0,2,4, PERIOD, 1,1, PERIOD, 2,5]
-// No zero padding for month/day: 2025.12.1 or 2026.1.1
-uint8_t buildDateGlyphs(uint16_t year, uint8_t month, uint8_t day, uint8_t *glyphs)
-{
-  uint8_t count = 0;
-  glyphs[count++] = (year / 1000) % 10;
-  glyphs[count++] = (year / 100) % 10;
-  glyphs[count++] = (year / 10) % 10;
-  glyphs[count++] = year % 10;
-  glyphs[count++] = GLYPH_PERIOD;
-  if (month >= 10)
-    glyphs[count++] = month / 10;
-  glyphs[count++] = month % 10;
-  glyphs[count++] = GLYPH_PERIOD;
-  if (day >= 10)
-    glyphs[count++] = day / 10;
-  glyphs[count++] = day % 10;
-  return count;
-}
-
-// Build time glyph sequence: 12:34 -> [1,2, COLON, 3,4] or 9:34 -> [9, COLON, 3,4]
-uint8_t buildTimeGlyphs(uint8_t hour, uint8_t minute, uint8_t *glyphs)
-{
-  uint8_t count = 0;
-  if (hour >= 10)
-    glyphs[count++] = hour / 10;
-  glyphs[count++] = hour % 10;
-  glyphs[count++] = GLYPH_COLON;
-  glyphs[count++] = minute / 10;
-  glyphs[count++] = minute % 10;
-  return count;
-}
-
-// ============================================================
-// Drawing Functions (using glyph sequences)
-// ============================================================
-
-uint16_t calculateTemperatureWidth(float temp)
-{
-  uint8_t glyphs[4];
-  uint8_t count = buildTemperatureGlyphs(temp, glyphs);
-  return calcGlyphSequenceWidth(glyphs, count, FONT_M);
-}
-
-uint16_t drawTemperature(float temp, uint16_t x, uint16_t y)
-{
-  uint8_t glyphs[4];
-  uint8_t count = buildTemperatureGlyphs(temp, glyphs);
-  LOGD(LogTag::DISPLAY_MGR, "drawTemp: %.1f at x=%d", temp, x);
-  return drawGlyphSequence(glyphs, count, x, y, FONT_M);
-}
-
-uint16_t calculateIntegerWidth(int value)
-{
-  uint8_t glyphs[4];
-  uint8_t count = buildIntegerGlyphs(value, glyphs);
-  return calcGlyphSequenceWidth(glyphs, count, FONT_M);
-}
-
-uint16_t drawInteger(int value, uint16_t x, uint16_t y)
-{
-  uint8_t glyphs[4];
-  uint8_t count = buildIntegerGlyphs(value, glyphs);
-  LOGD(LogTag::DISPLAY_MGR, "drawInt: %d at x=%d", value, x);
-  return drawGlyphSequence(glyphs, count, x, y, FONT_M);
-}
-
-uint16_t calculateDateWidth(uint16_t year, uint8_t month, uint8_t day)
-{
-  uint8_t glyphs[10];
-  uint8_t count = buildDateGlyphs(year, month, day, glyphs);
-  return calcGlyphSequenceWidth(glyphs, count, FONT_M);
-}
-
-void drawDateM(uint16_t year, uint8_t month, uint8_t day, uint16_t x, uint16_t y)
-{
-  uint8_t glyphs[10];
-  uint8_t count = buildDateGlyphs(year, month, day, glyphs);
-  LOGD(LogTag::DISPLAY_MGR, "drawDateM: %04d.%02d.%02d at x=%d", year, month, day, x);
-  drawGlyphSequence(glyphs, count, x, y, FONT_M);
-}
-
-uint16_t calculateTimeWidth(uint8_t hour, uint8_t minute)
-{
-  uint8_t glyphs[5];
-  uint8_t count = buildTimeGlyphs(hour, minute, glyphs);
-  return calcGlyphSequenceWidth(glyphs, count, FONT_L);
-}
-
-void drawTime(uint8_t hour, uint8_t minute, uint16_t x, uint16_t y)
-{
-  uint8_t glyphs[5];
-  uint8_t count = buildTimeGlyphs(hour, minute, glyphs);
-  LOGD(LogTag::DISPLAY_MGR, "drawTime: %02d:%02d at x=%d", hour, minute, x);
-  drawGlyphSequence(glyphs, count, x, y, FONT_L);
-}
-
-void drawStatus(const NetworkState &networkState, float batteryVoltage, float batteryPercent)
-{
-  // Increased buffer size to prevent overflow with long status messages
-  // Format can be: "B:85%(3.85V) | W:OK(-50) 192.168.1.100 | N:OK | U:123m | H:12345 | Msg:...")
-  // Max length: ~120 chars + 64 char message = ~184 chars, using 256 for safety
-  char statusLine[256];
   char ipStr[16];
   char batteryStr[24];
-  const int yPos = 4; // Adjusted for 12px font (centered in top 20px area?) or just top aligned
-  const uint16_t fontSize = 12;
-
-  // Clear the status area first
-  EPD_ClearWindows(0, 0, EPD_W, 20, WHITE);
 
   // Format IP address without using String class
   if (networkState.wifiConnected && WiFi.status() == WL_CONNECTED)
@@ -239,12 +75,12 @@ void drawStatus(const NetworkState &networkState, float batteryVoltage, float ba
   {
     if (hasMessage)
     {
-      snprintf(statusLine, sizeof(statusLine), "B:%s | W:%s(%ld) %s | N:%s | U:%lum | H:%u | Msg:%s",
+      snprintf(statusLine, statusLineSize, "B:%s | W:%s(%ld) %s | N:%s | U:%lum | H:%u | Msg:%s",
                batteryStr, wifiStatus, rssi, ipStr, ntpStatus, millis() / 60000, freeHeap, g_statusMessage);
     }
     else
     {
-      snprintf(statusLine, sizeof(statusLine), "B:%s | W:%s(%ld) %s | N:%s | U:%lum | H:%u",
+      snprintf(statusLine, statusLineSize, "B:%s | W:%s(%ld) %s | N:%s | U:%lum | H:%u",
                batteryStr, wifiStatus, rssi, ipStr, ntpStatus, millis() / 60000, freeHeap);
     }
   }
@@ -252,20 +88,17 @@ void drawStatus(const NetworkState &networkState, float batteryVoltage, float ba
   {
     if (hasMessage)
     {
-      snprintf(statusLine, sizeof(statusLine), "B:%s | W:%s | N:%s | U:%lum | H:%u | Msg:%s",
+      snprintf(statusLine, statusLineSize, "B:%s | W:%s | N:%s | U:%lum | H:%u | Msg:%s",
                batteryStr, wifiStatus, ntpStatus, millis() / 60000, freeHeap, g_statusMessage);
     }
     else
     {
-      snprintf(statusLine, sizeof(statusLine), "B:%s | W:%s | N:%s | U:%lum | H:%u",
+      snprintf(statusLine, statusLineSize, "B:%s | W:%s | N:%s | U:%lum | H:%u",
                batteryStr, wifiStatus, ntpStatus, millis() / 60000, freeHeap);
     }
   }
-
-  EPD_ShowString(8, yPos, statusLine, fontSize, BLACK);
 }
 
-void drawStatus(const NetworkState &networkState, float batteryVoltage, float batteryPercent); // Forward declaration
 
 bool performUpdate(const NetworkState &networkState, bool forceUpdate, bool fullUpdate, const struct tm *overrideTimeinfo)
 {
@@ -324,97 +157,98 @@ bool performUpdate(const NetworkState &networkState, bool forceUpdate, bool full
   }
 
   unsigned long startTime = micros();
-  Paint_Clear(WHITE);
-
+  // Rendering and the SPI upload run at the compute clock; the waveform wait does not
+  PowerManager_BeginCompute();
+
+  // Layered compositing: the restored frame already holds the static layer and
+  // every region whose key is unchanged. A full update redraws from scratch.
+  RTCState &rtcState = DeepSleepManager_GetRTCState();
+  DisplayLayerKeys &layers = rtcState.displayLayers;
+  if (fullUpdate || layers.magic != kDisplayLayerKeysMagic)
+  {
+    Paint_Clear(WHITE);
+    layers = DisplayLayerKeys();
+    layers.magic = kDisplayLayerKeysMagic;
+  }
   // Use battery voltage measured early in setup() (before WiFi/sensor operations)
   // This ensures we measure voltage when battery is in near-idle state (no load)
   float batteryVoltage = g_batteryVoltage;
 
-  // Draw time and date only if time is available
+  DisplayContent content;
+  content.timeAvailable = timeAvailable;
   if (timeAvailable)
   {
-    const uint8_t hour = timeinfo.tm_hour;
-    const uint8_t currentMinute = timeinfo.tm_min;
-    const uint16_t year = timeinfo.tm_year + 1900;
-    const uint8_t month = timeinfo.tm_mon + 1;
-    const uint8_t day = timeinfo.tm_mday;
-
-    // Calculate centered X for time (Range: 15 to 468, Center: 241)
-    uint16_t timeWidth = calculateTimeWidth(hour, currentMinute);
-    uint16_t timeX = 241 - (timeWidth / 2);
-
-    drawTime(hour, currentMinute, timeX, kTimeY);
-
-    // Calculate centered X for date (Range: 15 to 468, Center: 241)
-    uint16_t dateWidth = calculateDateWidth(year, month, day);
-    uint16_t dateX = 241 - (dateWidth / 2);
-
-    drawDateM(year, month, day, dateX, kDateY);
+    content.hour = timeinfo.tm_hour;
+    content.minute = timeinfo.tm_min;
+    content.year = timeinfo.tm_year + 1900;
+    content.month = timeinfo.tm_mon + 1;
+    content.day = timeinfo.tm_mday;
 
     // Update lastDisplayedMinute for next check
-    RTCState &rtcState = DeepSleepManager_GetRTCState();
-    rtcState.lastDisplayedMinute = currentMinute;
-  }
-  else
-  {
-    // Draw error message instead of time
-    const uint16_t fontSize = 12;
-    EPD_ShowString(kTimeX, kTimeY, "No Time", fontSize, BLACK);
-    EPD_ShowString(kDateX, kDateY, "WiFi Failed", fontSize, BLACK);
+    rtcState.lastDisplayedMinute = timeinfo.tm_min;
   }
 
-  drawStatus(networkState, batteryVoltage, g_batteryPercent);
+  char statusLine[kStatusLineSize];
+  formatStatus(statusLine, sizeof(statusLine), networkState, batteryVoltage, g_batteryPercent);
+  content.statusLine = statusLine;
 
-  // Draw sensor icons and values
-  if (SensorManager_IsInitialized())
+  content.sensorAvailable = SensorManager_IsInitialized();
+  if (content.sensorAvailable)
   {
-    // Get sensor values
-    float temp = SensorManager_GetTemperature();
-    float humidity = SensorManager_GetHumidity();
-    uint16_t co2 = SensorManager_GetCO2();
-
-    // Icon positions (fixed)
-    constexpr uint16_t kTempIconX = 482;
-    constexpr uint16_t kTempIconY = 33;
-    constexpr uint16_t kHumidityIconX = 482;
-    constexpr uint16_t kHumidityIconY = 114;
-    constexpr uint16_t kCO2IconX = 482;
-    constexpr uint16_t kCO2IconY = 193;
-
-    // Draw temperature
-    drawBitmapCorrect(kTempIconX, kTempIconY, IconTemp_WIDTH, IconTemp_HEIGHT, IconTemp);
-    uint16_t tempEndX = drawTemperature(temp, kTempValueX, kTempValueY);
-    drawBitmapCorrect(tempEndX + kValueUnitSpacing, kTempValueY + kUnitYOffset, UnitC_WIDTH, UnitC_HEIGHT, UnitC);
-
-    // Draw humidity
-    drawBitmapCorrect(kHumidityIconX, kHumidityIconY, IconHumidity_WIDTH, IconHumidity_HEIGHT, IconHumidity);
-    uint16_t humidityEndX = drawInteger((int)(humidity + 0.5f), kHumidityValueX, kHumidityValueY);
-    drawBitmapCorrect(humidityEndX + kValueUnitSpacing, kHumidityValueY + kUnitYOffset, UnitPercent_WIDTH, UnitPercent_HEIGHT, UnitPercent);
-
-    // Draw CO2
-    drawBitmapCorrect(kCO2IconX, kCO2IconY, IconCO2_WIDTH, IconCO2_HEIGHT, IconCO2);
-    uint16_t co2EndX = drawInteger(co2, kCO2ValueX, kCO2ValueY);
-    drawBitmapCorrect(co2EndX + kValueUnitSpacing, kCO2ValueY + kUnitYOffset, UnitPpm_WIDTH, UnitPpm_HEIGHT, UnitPpm);
+    content.temperature = SensorManager_GetTemperature();
+    content.humidity = SensorManager_GetHumidity();
+    content.co2 = SensorManager_GetCO2();
   }
 
+  const uint8_t regionsDrawn = DisplayLayout_Compose(layers, content);
+
   const unsigned long drawDuration = micros() - startTime;
+  PROFILE_MARK(Draw);
 
+  // Full refresh rewrites the whole RAM as a keyframe; partial refresh only
+  // uploads the byte-columns that differ from what the controllers hold
   startTime = micros();
-  EPD_Display(ImageBW);
+  uint32_t uploadedBytes = kFrameBufferSize;
+  if (fullUpdate)
+  {
+    EPD_Display(ImageBW);
+  }
+  else
+  {
+    uploadedBytes = EPD_DisplayChanged(ImageBW);
+  }
   const unsigned long displayDuration = micros() - startTime;
+  PROFILE_MARK(EpdDisplay);
+  PowerManager_EndCompute();
 
+  // Light sleep through the waveform unless WiFi is kept up (upload follows)
+  // or the refresh-started callback runs work on the other core
+  const bool otherWorkDuringRefresh = networkState.wifiConnected || g_refreshStartedCallback != nullptr;
+  EPD_SetBusyWaitMode(otherWorkDuringRefresh ? EPD_BUSY_WAIT_YIELD : EPD_BUSY_WAIT_LIGHT_SLEEP);
   startTime = micros();
   if (fullUpdate)
   {
     DisplayManager_SetStatus("Full Updating...");
-    EPD_Update();
+    EPD_UpdateStart();
   }
   else
   {
     DisplayManager_SetStatus("Updating...");
-    EPD_PartUpdate();
+    EPD_PartUpdateStart();
+  }
+  // The waveform is pure waiting time; let the caller overlap its I/O with it
+  if (g_refreshStartedCallback != nullptr)
+  {
+    g_refreshStartedCallback();
   }
+  const bool refreshed = EPD_READBUSY();
+  PROFILE_MARK(Refresh);
   const unsigned long updateDuration = micros() - startTime;
+  EPD_SetBusyWaitMode(EPD_BUSY_WAIT_YIELD);
+  if (!refreshed)
+  {
+    LOGW(LogTag::DISPLAY_MGR, "EPD BUSY timeout after %lu us, panel may not have refreshed", updateDuration);
+  }
 
   if (timeAvailable)
   {
@@ -424,8 +258,9 @@ bool performUpdate(const NetworkState &networkState, bool forceUpdate, bool full
   {
     LOGI(LogTag::DISPLAY_MGR, "%s (no time available), Battery: %.3fV", fullUpdate ? "Full update" : "Updated", batteryVoltage);
   }
-  LOGD(LogTag::DISPLAY_MGR, "Draw: %lu us, EPD_Display: %lu us, Update: %lu us, Total: %lu us",
-       drawDuration, displayDuration, updateDuration, drawDuration + displayDuration + updateDuration);
+  LOGD(LogTag::DISPLAY_MGR, "Draw: %lu us (%u regions), EPD_Display: %lu us (%lu bytes), Update: %lu us, Total: %lu us",
+       drawDuration, regionsDrawn, displayDuration, (unsigned long)uploadedBytes, updateDuration,
+       drawDuration + displayDuration + updateDuration);
 
   // Put EPD into deep sleep FIRST - secure the display before any other operations
   // EPD is sensitive and should not be disturbed by SD card or other I/O operations
@@ -433,7 +268,17 @@ bool performUpdate(const NetworkState &networkState, bool forceUpdate, bool full
   LOGI(LogTag::DISPLAY_MGR, "EPD entered deep sleep");
 
   // Save frame buffer to SD card AFTER EPD is safely in deep sleep
-  DeepSleepManager_SaveFrameBuffer(ImageBW, kFrameBufferSize);
+  // The region keys describe this frame, so they are only valid if it persisted
+  bool frameSaved;
+  {
+    PowerComputeScope compute; // Frame codec
+    frameSaved = DeepSleepManager_SaveFrameBuffer(ImageBW, kFrameBufferSize);
+  }
+  if (!frameSaved)
+  {
+    layers.magic = 0;
+  }
+  PROFILE_MARK(Save);
 
   return true;
 }
@@ -469,20 +314,26 @@ void DisplayManager_Init(bool wakeFromSleep)
     EPD_FastMode1Init();
 
     // Try to load previous frame buffer from RTC memory
+    PowerManager_BeginCompute(); // Frame codec + SPI upload
     if (DeepSleepManager_LoadFrameBuffer(ImageBW, kFrameBufferSize))
     {
-      // Success! Send previous data to EPD controller RAM
-      // This restores the RAM state so PartUpdate works correctly
-      EPD_Display(ImageBW);
-      EPD_PartUpdate(); // Optional: ensure display is in sync
+      // Success! Restore only the "previous" RAM bank (0x26/0xA6) so the partial
+      // waveform knows what the panel shows. The "current" bank kept this frame
+      // through deep sleep, so the first EPD_DisplayChanged() uploads only the
+      // changed window: one full upload plus one window per wake, then one refresh.
+      EPD_DisplayPrevious(ImageBW);
+      PowerManager_EndCompute();
+      PROFILE_MARK(FrameLoad);
       LOGI(LogTag::DISPLAY_MGR, "EPD restored with previous image data");
     }
     else
     {
       // Failed to load (first boot or corruption)
       // Clear screen to be safe
+      PowerManager_EndCompute();
       LOGW(LogTag::DISPLAY_MGR, "Failed to load previous image, clearing screen");
       Paint_Clear(WHITE);
+      DeepSleepManager_GetRTCState().displayLayers.magic = 0;
       EPD_Display_Clear();
       EPD_Update();
       EPD_PartUpdate();
@@ -493,13 +344,18 @@ void DisplayManager_Init(bool wakeFromSleep)
     // Cold boot: Full initialization with screen clear
     LOGI(LogTag::DISPLAY_MGR, "Cold boot - full initialization");
     Paint_Clear(WHITE);
+    DeepSleepManager_GetRTCState().displayLayers.magic = 0;
     EPD_FastMode1Init();
     EPD_Display_Clear();
     EPD_Update();
     EPD_PartUpdate();
+    delay(500);
   }
+}
 
-  delay(500);
+void DisplayManager_SetRefreshStartedCallback(DisplayRefreshStartedCallback callback)
+{
+  g_refreshStartedCallback = callback;
 }
 
 void DisplayManager_SetStatus(const char *message)
@@ -515,11 +371,11 @@ void DisplayManager_DrawSetupStatus(const char *message)
 {
   DisplayManager_SetStatus(message);
   // Clear status area
-  EPD_ClearWindows(0, 0, EPD_W, 20, WHITE);
-  const uint16_t fontSize = 12;
-  const int yPos = 4;
-  EPD_ShowString(8, yPos, message, fontSize, BLACK);
-  EPD_Display(ImageBW);
+  EPD_ClearWindows(kStatusRegion.x0, kStatusRegion.y0, kStatusRegion.x1, kStatusRegion.y1, WHITE);
+  // The status region no longer matches its cached key; redraw it next update
+  DeepSleepManager_GetRTCState().displayLayers.statusKey = 0;
+  DisplayLayout_DrawStatus(message);
+  EPD_DisplayChanged(ImageBW); // Only the status rows differ
   EPD_PartUpdate();
 }
 
@@ -585,21 +441,33 @@ float DisplayManager_ReadBatteryVoltage()
     return -1.0f;
   }
 
-  float max17048Percent = FuelGauge_GetPercent();
   float linearPercent = FuelGauge_GetLinearPercent(voltage);
-  float chargeRate = FuelGauge_GetChargeRate();
 
   g_batteryVoltage = voltage;
-  g_batteryPercent = linearPercent;           // Use linear for display
-  g_batteryMax17048Percent = max17048Percent; // Keep MAX17048 for reference
-  g_batteryChargeRate = chargeRate;
+  g_batteryPercent = linearPercent; // Use linear for display
+  // MAX17048 percent/rate are only logged; read by DisplayManager_ReadBatteryDetails()
+  g_batteryMax17048Percent = -1.0f;
+  g_batteryChargeRate = -1.0f;
 
-  LOGI(LogTag::DISPLAY_MGR, "Battery: %.3fV, %.1f%% (linear), %.1f%% (MAX17048), Rate: %.2f%%/hr",
-       voltage, linearPercent, max17048Percent, chargeRate);
+  LOGI(LogTag::DISPLAY_MGR, "Battery: %.3fV, %.1f%% (linear)", voltage, linearPercent);
 
   return voltage;
 }
 
+void DisplayManager_ReadBatteryDetails()
+{
+  if (g_batteryVoltage < 0.0f || !FuelGauge_IsAvailable())
+  {
+    return;
+  }
+
+  g_batteryMax17048Percent = FuelGauge_GetPercent(); // Keep MAX17048 for reference
+  g_batteryChargeRate = FuelGauge_GetChargeRate();
+
+  LOGI(LogTag::DISPLAY_MGR, "Battery: %.1f%% (MAX17048), Rate: %.2f%%/hr",
+       g_batteryMax17048Percent, g_batteryChargeRate);
+}
+
 float DisplayManager_GetBatteryPercent()
 {
   return g_batteryPercent;
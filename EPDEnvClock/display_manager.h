@@ -13,10 +13,19 @@ void DisplayManager_SetStatus(const char *message);
 // This is used to pre-render the *next minute* slightly before the boundary so the visible refresh aligns.
 bool DisplayManager_UpdateDisplay(const NetworkState &networkState, bool forceUpdate = false, const struct tm *overrideTimeinfo = nullptr);
 void DisplayManager_FullUpdate(const NetworkState &networkState);
+// Called from DisplayManager_UpdateDisplay()/FullUpdate() right after the EPD refresh is
+// triggered, before waiting on BUSY. Use it to start work that overlaps the waveform.
+// While set, the BUSY wait yields instead of light sleeping. Pass nullptr to clear.
+typedef void (*DisplayRefreshStartedCallback)();
+void DisplayManager_SetRefreshStartedCallback(DisplayRefreshStartedCallback callback);
 uint8_t *DisplayManager_GetFrameBuffer();
 // Battery measurement - reads from MAX17048 fuel gauge only
+// Reads charging state, voltage and the linear percent (what the frame and WiFi gate need)
 // Returns -1.0f if MAX17048 unavailable or reading invalid (outside 2.0-4.4V range)
 float DisplayManager_ReadBatteryVoltage();
+// Read the logging-only fuel gauge values (MAX17048 percent, charge rate)
+// Call after the display refresh has started; no-op if the voltage read failed
+void DisplayManager_ReadBatteryDetails();
 // Get battery state of charge in percent (0-100)
 float DisplayManager_GetBatteryPercent();
 // Get battery charge rate in %/hr (positive=charging, negative=discharging)
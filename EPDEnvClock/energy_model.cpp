@@ -0,0 +1,113 @@
+#include "energy_model.h"
+
+#include <time.h>
+
+#include "logger.h"
+
+namespace
+{
+constexpr size_t kPhaseEpdDisplay = static_cast<size_t>(BootPhase::EpdDisplay);
+constexpr size_t kPhaseRefresh = static_cast<size_t>(BootPhase::Refresh);
+constexpr uint32_t kCpuSlotUa[kBootProfilerCpuSlots] = {ENERGY_CPU_80MHZ_UA, ENERGY_CPU_160MHZ_UA,
+                                                        ENERGY_CPU_240MHZ_UA};
+constexpr float kUsPerHour = 3600.0e6f;
+
+// Today's accounted wakes; own magic, so a cold boot starts a new (partial) day
+constexpr uint32_t kEnergyDayMagic = 0x45595045; // "EPYE" (little-endian)
+struct EnergyDay
+{
+  uint32_t magic;
+  uint32_t date; // YYYYMMDD (local), 0 = clock was not valid yet
+  float uah;
+  uint32_t wakes;
+};
+RTC_DATA_ATTR EnergyDay energyDay;
+
+float previousWakeUAh = -1.0f;
+
+// µAh drawn by currentUa over durationUs
+float charge(uint32_t currentUa, uint64_t durationUs)
+{
+  return (float)currentUa * (float)durationUs / kUsPerHour;
+}
+
+uint32_t localDate()
+{
+  struct tm timeinfo;
+  if (!getLocalTime(&timeinfo, 0))
+  {
+    return 0;
+  }
+  return (uint32_t)(timeinfo.tm_year + 1900) * 10000 + (uint32_t)(timeinfo.tm_mon + 1) * 100 +
+         (uint32_t)timeinfo.tm_mday;
+}
+} // namespace
+
+EnergyEstimate EnergyModel_Estimate(const BootProfilePrevious &cycle)
+{
+  EnergyEstimate estimate = {};
+
+  uint64_t awakeUs = cycle.preTimerUs;
+  estimate.cpuUAh = charge(kCpuSlotUa[0], cycle.preTimerUs);
+  for (uint8_t slot = 0; slot < kBootProfilerCpuSlots; slot++)
+  {
+    awakeUs += cycle.cpuTimeUs[slot];
+    estimate.cpuUAh += charge(kCpuSlotUa[slot], cycle.cpuTimeUs[slot]);
+  }
+  awakeUs += cycle.lightSleepUs;
+  estimate.lightSleepUAh = charge(ENERGY_LIGHT_SLEEP_UA, cycle.lightSleepUs);
+  estimate.radioUAh = charge(ENERGY_RADIO_UA, cycle.radioOnUs);
+
+  const uint32_t uploadedUs = cycle.marksUs[kPhaseEpdDisplay];
+  const uint32_t refreshedUs = cycle.marksUs[kPhaseRefresh];
+  if (uploadedUs != 0 && refreshedUs > uploadedUs)
+  {
+    estimate.panelUAh = charge(ENERGY_EPD_REFRESH_UA, refreshedUs - uploadedUs);
+  }
+
+  estimate.sleepUAh = charge(ENERGY_DEEP_SLEEP_UA, cycle.sleepUs);
+  estimate.sensorUAh = charge(ENERGY_SENSOR_UA, awakeUs + cycle.sleepUs);
+  estimate.totalUAh = estimate.cpuUAh + estimate.lightSleepUAh + estimate.radioUAh + estimate.panelUAh +
+                      estimate.sleepUAh + estimate.sensorUAh;
+  estimate.awakeMs = (uint32_t)(awakeUs / 1000);
+  estimate.sleepMs = (uint32_t)(cycle.sleepUs / 1000);
+  return estimate;
+}
+
+void EnergyModel_AccountPreviousWake()
+{
+  BootProfilePrevious cycle;
+  if (previousWakeUAh >= 0.0f || !BootProfiler_GetPrevious(cycle))
+  {
+    return;
+  }
+  const EnergyEstimate estimate = EnergyModel_Estimate(cycle);
+  previousWakeUAh = estimate.totalUAh;
+
+  const uint32_t date = localDate();
+  if (energyDay.magic != kEnergyDayMagic || (date != 0 && date != energyDay.date))
+  {
+    if (energyDay.magic == kEnergyDayMagic && energyDay.date != 0)
+    {
+      LOGI(LogTag::SETUP, "Energy %lu: %.2f mAh estimated over %lu wakes", (unsigned long)energyDay.date,
+           energyDay.uah / 1000.0f, (unsigned long)energyDay.wakes);
+    }
+    energyDay = EnergyDay();
+    energyDay.magic = kEnergyDayMagic;
+    energyDay.date = date;
+  }
+  energyDay.uah += estimate.totalUAh;
+  energyDay.wakes++;
+
+  LOGI(LogTag::SETUP,
+       "Previous wake: %.1f uAh over %lu+%lu ms (CPU %.1f, light sleep %.1f, WiFi %.1f, EPD %.1f, "
+       "deep sleep %.1f, SCD41 %.1f); today %.2f mAh over %lu wakes",
+       estimate.totalUAh, (unsigned long)estimate.awakeMs, (unsigned long)estimate.sleepMs, estimate.cpuUAh,
+       estimate.lightSleepUAh, estimate.radioUAh, estimate.panelUAh, estimate.sleepUAh, estimate.sensorUAh,
+       energyDay.uah / 1000.0f, (unsigned long)energyDay.wakes);
+}
+
+float EnergyModel_GetPreviousWakeUAh()
+{
+  return previousWakeUAh;
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <Arduino.h>
+
+#include "boot_profiler.h"
+
+// Energy-per-wake estimate
+// One wake cycle (a boot plus the deep sleep after it) is modelled from the boot profiler's
+// timings: CPU time per clock, light sleep, radio-on time, EPD waveform time (EpdDisplay ->
+// Refresh) and deep sleep, each at a per-state board current below, plus the SCD41's average.
+// The previous cycle's µAh goes into this boot's sensor record (energy_uah), which the
+// dashboard charts against the MAX17048 discharge rate and sums per JST day (/api/data
+// energy_daily). The daily total kept here is only logged and does not survive a reset.
+// The currents are typical values; calibrate them against the measured drain (a day of
+// minute wakes without charging) or a power profiler on the battery lead.
+
+// Board current in deep sleep (ESP32-S3 RTC, LDO, MAX17048; SCD41 excluded)
+#ifndef ENERGY_DEEP_SLEEP_UA
+#define ENERGY_DEEP_SLEEP_UA 150
+#endif
+
+// Board current in light sleep (sensor wait, EPD BUSY wait)
+#ifndef ENERGY_LIGHT_SLEEP_UA
+#define ENERGY_LIGHT_SLEEP_UA 800
+#endif
+
+// Board current awake, radio off, per kBootProfilerCpuMhz slot
+#ifndef ENERGY_CPU_80MHZ_UA
+#define ENERGY_CPU_80MHZ_UA 20000
+#endif
+#ifndef ENERGY_CPU_160MHZ_UA
+#define ENERGY_CPU_160MHZ_UA 28000
+#endif
+#ifndef ENERGY_CPU_240MHZ_UA
+#define ENERGY_CPU_240MHZ_UA 36000
+#endif
+
+// Added while WiFi is on (association, DHCP, NTP, TLS; averaged over RX/TX/modem sleep)
+#ifndef ENERGY_RADIO_UA
+#define ENERGY_RADIO_UA 60000
+#endif
+
+// Added while the EPD runs a waveform
+#ifndef ENERGY_EPD_REFRESH_UA
+#define ENERGY_EPD_REFRESH_UA 4000
+#endif
+
+// SCD41 average over the whole cycle (single shots at the configured CO2 interval plus idle)
+#ifndef ENERGY_SENSOR_UA
+#define ENERGY_SENSOR_UA 500
+#endif
+
+struct EnergyEstimate
+{
+  float cpuUAh;        // Awake at each clock (ROM boot counted at 80 MHz)
+  float lightSleepUAh;
+  float radioUAh;
+  float panelUAh;
+  float sleepUAh;      // Deep sleep
+  float sensorUAh;
+  float totalUAh;
+  uint32_t awakeMs;
+  uint32_t sleepMs;
+};
+
+// Estimate one wake cycle from its profile
+EnergyEstimate EnergyModel_Estimate(const BootProfilePrevious &cycle);
+
+// Estimate the previous wake cycle, log it and add it to today's total (RTC memory; the day
+// is the local date once the clock is valid). Call once per boot, after the clock is set.
+void EnergyModel_AccountPreviousWake();
+
+// Previous wake cycle's µAh (negative if unknown: cold boot or not accounted yet)
+float EnergyModel_GetPreviousWakeUAh();
@@ -8,29 +8,61 @@
 namespace
 {
 
-// Bitmap lookup tables
-const uint8_t *NumberLBitmaps[] = {
-    NumberL0, NumberL1, NumberL2, NumberL3, NumberL4,
-    NumberL5, NumberL6, NumberL7, NumberL8, NumberL9};
-
-const uint16_t NumberLWidths[] = {
-    NumberL0_WIDTH, NumberL1_WIDTH, NumberL2_WIDTH, NumberL3_WIDTH, NumberL4_WIDTH,
-    NumberL5_WIDTH, NumberL6_WIDTH, NumberL7_WIDTH, NumberL8_WIDTH, NumberL9_WIDTH};
-
-const uint8_t *NumberMBitmaps[] = {
-    NumberM0, NumberM1, NumberM2, NumberM3, NumberM4,
-    NumberM5, NumberM6, NumberM7, NumberM8, NumberM9};
+// Glyph atlas: bitmap, size and pair advances of every glyph index per font size.
+// Period only exists in M and colon only in L; both sizes point at the one that exists.
+struct GlyphEntry
+{
+  const uint8_t *bitmap;
+  uint16_t width;
+  uint16_t height;
+};
 
-const uint16_t NumberMWidths[] = {
-    NumberM0_WIDTH, NumberM1_WIDTH, NumberM2_WIDTH, NumberM3_WIDTH, NumberM4_WIDTH,
-    NumberM5_WIDTH, NumberM6_WIDTH, NumberM7_WIDTH, NumberM8_WIDTH, NumberM9_WIDTH};
+struct GlyphAtlas
+{
+  GlyphEntry glyphs[kGlyphCount];
+  const int32_t (*pairAdvance)[kGlyphCount]; // 16.16 fixed-point pixels, [left][right]
+};
+
+constexpr GlyphAtlas kAtlasL = {
+    {{NumberL0, NumberL0_WIDTH, NumberL0_HEIGHT},
+     {NumberL1, NumberL1_WIDTH, NumberL1_HEIGHT},
+     {NumberL2, NumberL2_WIDTH, NumberL2_HEIGHT},
+     {NumberL3, NumberL3_WIDTH, NumberL3_HEIGHT},
+     {NumberL4, NumberL4_WIDTH, NumberL4_HEIGHT},
+     {NumberL5, NumberL5_WIDTH, NumberL5_HEIGHT},
+     {NumberL6, NumberL6_WIDTH, NumberL6_HEIGHT},
+     {NumberL7, NumberL7_WIDTH, NumberL7_HEIGHT},
+     {NumberL8, NumberL8_WIDTH, NumberL8_HEIGHT},
+     {NumberL9, NumberL9_WIDTH, NumberL9_HEIGHT},
+     {NumberMPeriod, NumberMPeriod_WIDTH, NumberMPeriod_HEIGHT},
+     {NumberLColon, NumberLColon_WIDTH, NumberLColon_HEIGHT}},
+    GlyphPairAdvanceL};
+
+constexpr GlyphAtlas kAtlasM = {
+    {{NumberM0, NumberM0_WIDTH, NumberM0_HEIGHT},
+     {NumberM1, NumberM1_WIDTH, NumberM1_HEIGHT},
+     {NumberM2, NumberM2_WIDTH, NumberM2_HEIGHT},
+     {NumberM3, NumberM3_WIDTH, NumberM3_HEIGHT},
+     {NumberM4, NumberM4_WIDTH, NumberM4_HEIGHT},
+     {NumberM5, NumberM5_WIDTH, NumberM5_HEIGHT},
+     {NumberM6, NumberM6_WIDTH, NumberM6_HEIGHT},
+     {NumberM7, NumberM7_WIDTH, NumberM7_HEIGHT},
+     {NumberM8, NumberM8_WIDTH, NumberM8_HEIGHT},
+     {NumberM9, NumberM9_WIDTH, NumberM9_HEIGHT},
+     {NumberMPeriod, NumberMPeriod_WIDTH, NumberMPeriod_HEIGHT},
+     {NumberLColon, NumberLColon_WIDTH, NumberLColon_HEIGHT}},
+    GlyphPairAdvanceM};
+
+inline const GlyphAtlas &atlasFor(FontSize size)
+{
+  return (size == FONT_L) ? kAtlasL : kAtlasM;
+}
 
-// Generic digit drawing helper
-void drawDigitGeneric(uint8_t digit, uint16_t x, uint16_t y,
-                      const uint8_t **bitmaps, const uint16_t *widths, uint16_t height)
+void drawAtlasGlyph(const GlyphAtlas &atlas, uint8_t glyphIndex, uint16_t x, uint16_t y)
 {
-  if (digit > 9) return;
-  drawBitmapCorrect(x, y, widths[digit], height, bitmaps[digit]);
+  if (glyphIndex >= kGlyphCount) return;
+  const GlyphEntry &glyph = atlas.glyphs[glyphIndex];
+  drawBitmapCorrect(x, y, glyph.width, glyph.height, glyph.bitmap);
 }
 
 } // namespace
@@ -41,36 +73,8 @@ void drawDigitGeneric(uint8_t digit, uint16_t x, uint16_t y,
 
 void drawBitmapCorrect(uint16_t x, uint16_t y, uint16_t width, uint16_t height, const uint8_t *bitmap)
 {
-  const uint16_t widthByte = (width + 7) / 8;
-
-  for (uint16_t row = 0; row < height; row++)
-  {
-    uint16_t pixel_x = x;
-
-    for (uint16_t col_byte = 0; col_byte < widthByte; col_byte++)
-    {
-      uint8_t bitmap_byte = bitmap[row * widthByte + col_byte];
-
-      for (uint8_t bit = 0; bit < 8; bit++)
-      {
-        if (pixel_x >= x + width)
-        {
-          break;
-        }
-
-        if (bitmap_byte & (0x80 >> bit))
-        {
-          Paint_SetPixel(pixel_x, y + row, BLACK);
-        }
-        else
-        {
-          Paint_SetPixel(pixel_x, y + row, WHITE);
-        }
-
-        pixel_x++;
-      }
-    }
-  }
+  // Row-at-a-time blit: rotation and seam offset are resolved once per bitmap
+  Paint_DrawBitmap(x, y, width, height, bitmap);
 }
 
 // ============================================================
@@ -79,22 +83,24 @@ void drawBitmapCorrect(uint16_t x, uint16_t y, uint16_t width, uint16_t height,
 
 void drawDigitL(uint8_t digit, uint16_t x, uint16_t y)
 {
-  drawDigitGeneric(digit, x, y, NumberLBitmaps, NumberLWidths, NumberL0_HEIGHT);
+  if (digit > 9) return;
+  drawAtlasGlyph(kAtlasL, digit, x, y);
 }
 
 void drawDigitM(uint8_t digit, uint16_t x, uint16_t y)
 {
-  drawDigitGeneric(digit, x, y, NumberMBitmaps, NumberMWidths, NumberM0_HEIGHT);
+  if (digit > 9) return;
+  drawAtlasGlyph(kAtlasM, digit, x, y);
 }
 
 void drawColon(uint16_t x, uint16_t y)
 {
-  drawBitmapCorrect(x, y, NumberLColon_WIDTH, NumberLColon_HEIGHT, NumberLColon);
+  drawAtlasGlyph(kAtlasL, GLYPH_COLON, x, y);
 }
 
 void drawPeriodM(uint16_t x, uint16_t y)
 {
-  drawBitmapCorrect(x, y, NumberMPeriod_WIDTH, NumberMPeriod_HEIGHT, NumberMPeriod);
+  drawAtlasGlyph(kAtlasM, GLYPH_PERIOD, x, y);
 }
 
 // ============================================================
@@ -104,13 +110,13 @@ void drawPeriodM(uint16_t x, uint16_t y)
 uint16_t getDigitLWidth(uint8_t digit)
 {
   if (digit > 9) return 0;
-  return NumberLWidths[digit];
+  return kAtlasL.glyphs[digit].width;
 }
 
 uint16_t getDigitMWidth(uint8_t digit)
 {
   if (digit > 9) return 0;
-  return NumberMWidths[digit];
+  return kAtlasM.glyphs[digit].width;
 }
 
 // ============================================================
@@ -119,90 +125,70 @@ uint16_t getDigitMWidth(uint8_t digit)
 
 void drawGlyph(uint8_t glyphIndex, uint16_t x, uint16_t y, FontSize size)
 {
-  if (glyphIndex <= 9)
-  {
-    // Digit 0-9
-    if (size == FONT_L)
-      drawDigitL(glyphIndex, x, y);
-    else
-      drawDigitM(glyphIndex, x, y);
-  }
-  else if (glyphIndex == GLYPH_PERIOD)
-  {
-    drawPeriodM(x, y); // Period only exists in M size
-  }
-  else if (glyphIndex == GLYPH_COLON)
-  {
-    drawColon(x, y); // Colon only exists in L size
-  }
+  drawAtlasGlyph(atlasFor(size), glyphIndex, x, y);
 }
 
 uint16_t getGlyphBitmapWidth(uint8_t glyphIndex, FontSize size)
 {
-  if (glyphIndex <= 9)
-  {
-    return (size == FONT_L) ? getDigitLWidth(glyphIndex) : getDigitMWidth(glyphIndex);
-  }
-  else if (glyphIndex == GLYPH_PERIOD)
-  {
-    return NumberMPeriod_WIDTH;
-  }
-  else if (glyphIndex == GLYPH_COLON)
-  {
-    return NumberLColon_WIDTH;
-  }
-  return 0;
+  if (glyphIndex >= kGlyphCount) return 0;
+  return atlasFor(size).glyphs[glyphIndex].width;
 }
 
 // ============================================================
-// Glyph sequence rendering (using float accumulation for precision)
+// Glyph runs (16.16 fixed-point pen, pair advances from the atlas)
 // ============================================================
 
-uint16_t drawGlyphSequence(const uint8_t* glyphs, uint8_t count, uint16_t x, uint16_t y, FontSize size)
+void layoutGlyphRun(const uint8_t* glyphs, uint8_t count, FontSize size, GlyphRun& run)
 {
-  if (count == 0) return x;
-
-  float currentX = (float)x; // Accumulate in float for precision
+  const GlyphAtlas &atlas = atlasFor(size);
+  run.size = size;
+  run.count = 0;
+  run.width = 0;
 
-  for (uint8_t i = 0; i < count; i++)
+  int32_t pen = 0;
+  for (uint8_t i = 0; i < count && i < kMaxGlyphRun; i++)
   {
-    // Round to integer only when drawing
-    uint16_t drawX = (uint16_t)(currentX + 0.5f);
-    drawGlyph(glyphs[i], drawX, y, size);
-
-    if (i < count - 1) // Not the last glyph
-    {
-      float advance = getAdvancef(glyphs[i], size);
-      float kern = getKerningf(glyphs[i], glyphs[i + 1], size);
-      // LOGD(LogTag::FONT, "  [%d] glyph=%d, x=%d, adv=%.1f, kern=%.1f", i, glyphs[i], drawX, advance, kern);
-      currentX += advance + kern;
-    }
-    else // Last glyph
+    const uint8_t glyph = glyphs[i];
+    if (glyph >= kGlyphCount) continue; // Unknown glyphs take no space
+    if (run.count > 0)
     {
-      uint16_t bitmapWidth = getGlyphBitmapWidth(glyphs[i], size);
-      // LOGD(LogTag::FONT, "  [%d] glyph=%d, x=%d, width=%d (last)", i, glyphs[i], drawX, bitmapWidth);
-      currentX += bitmapWidth;
+      pen += atlas.pairAdvance[run.glyphs[run.count - 1]][glyph];
     }
+    run.glyphs[run.count] = glyph;
+    // Round to integer only when drawing
+    run.offsets[run.count] = (uint16_t)((pen + kGlyphFixedHalf) >> kGlyphFixedShift);
+    run.count++;
+  }
+  if (run.count > 0)
+  {
+    // Last glyph uses its bitmap width (no trailing sidebearing)
+    pen += (int32_t)atlas.glyphs[run.glyphs[run.count - 1]].width << kGlyphFixedShift;
+    run.width = (uint16_t)((pen + kGlyphFixedHalf) >> kGlyphFixedShift);
   }
-
-  return (uint16_t)(currentX + 0.5f);
 }
 
-uint16_t calcGlyphSequenceWidth(const uint8_t* glyphs, uint8_t count, FontSize size)
+uint16_t drawGlyphRun(const GlyphRun& run, uint16_t x, uint16_t y)
 {
-  if (count == 0) return 0;
-
-  float width = 0.0f; // Accumulate in float for precision
-
-  for (uint8_t i = 0; i < count - 1; i++)
+  const GlyphAtlas &atlas = atlasFor(run.size);
+  for (uint8_t i = 0; i < run.count; i++)
   {
-    float kern = getKerningf(glyphs[i], glyphs[i + 1], size);
-    width += getAdvancef(glyphs[i], size) + kern;
+    drawAtlasGlyph(atlas, run.glyphs[i], x + run.offsets[i], y);
   }
-  // Last glyph uses bitmap width
-  width += getGlyphBitmapWidth(glyphs[count - 1], size);
+  return x + run.width;
+}
 
-  return (uint16_t)(width + 0.5f);
+uint16_t drawGlyphSequence(const uint8_t* glyphs, uint8_t count, uint16_t x, uint16_t y, FontSize size)
+{
+  GlyphRun run;
+  layoutGlyphRun(glyphs, count, size, run);
+  return drawGlyphRun(run, x, y);
+}
+
+uint16_t calcGlyphSequenceWidth(const uint8_t* glyphs, uint8_t count, FontSize size)
+{
+  GlyphRun run;
+  layoutGlyphRun(glyphs, count, size, run);
+  return run.width;
 }
 
 void fontRendererInit()
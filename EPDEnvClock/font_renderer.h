@@ -15,7 +15,25 @@ void fontRendererInit();
 void drawGlyph(uint8_t glyphIndex, uint16_t x, uint16_t y, FontSize size);
 uint16_t getGlyphBitmapWidth(uint8_t glyphIndex, FontSize size);
 
-// Glyph sequence drawing
+// Glyph run: a sequence laid out once (integer pen positions relative to the run start),
+// so centering on its width and drawing it share a single pass over the pair advances
+constexpr uint8_t kMaxGlyphRun = 10;
+
+struct GlyphRun
+{
+  FontSize size;
+  uint8_t count;
+  uint8_t glyphs[kMaxGlyphRun];
+  uint16_t offsets[kMaxGlyphRun];
+  uint16_t width; // Last glyph ends at its bitmap width (no trailing advance)
+};
+
+// Sequences longer than kMaxGlyphRun are truncated
+void layoutGlyphRun(const uint8_t* glyphs, uint8_t count, FontSize size, GlyphRun& run);
+// Returns the X right after the run
+uint16_t drawGlyphRun(const GlyphRun& run, uint16_t x, uint16_t y);
+
+// Glyph sequence drawing (layout + draw in one call)
 uint16_t drawGlyphSequence(const uint8_t* glyphs, uint8_t count, uint16_t x, uint16_t y, FontSize size);
 uint16_t calcGlyphSequenceWidth(const uint8_t* glyphs, uint8_t count, FontSize size);
 
@@ -29,7 +47,7 @@ void drawPeriodM(uint16_t x, uint16_t y);
 uint16_t getDigitLWidth(uint8_t digit);
 uint16_t getDigitMWidth(uint8_t digit);
 
-// Low-level bitmap drawing (used internally and by display_manager for icons)
+// Low-level bitmap drawing (used internally and by display_layout for icons)
 void drawBitmapCorrect(uint16_t x, uint16_t y, uint16_t width, uint16_t height, const uint8_t* bitmap);
 
 #endif // FONT_RENDERER_H
@@ -0,0 +1,247 @@
+#include "frame_codec.h"
+
+#include <esp_rom_crc.h>
+
+namespace
+{
+// PackBits limits: a control byte covers at most 128 bytes
+constexpr size_t kMaxRun = 128;
+constexpr size_t kMaxLiteral = 128;
+
+// Column-major view of a row-major frame: scan index k -> buffer offset
+struct ColumnScan
+{
+  size_t rows;
+  size_t rowBytes;
+  size_t offset(size_t k) const { return (k % rows) * rowBytes + k / rows; }
+};
+
+// Encode with PackBits; returns payload length, or 0 if it does not fit
+size_t packBitsEncode(const uint8_t *src, size_t size, const ColumnScan &scan, uint8_t *dst, size_t capacity)
+{
+  size_t in = 0;
+  size_t out = 0;
+
+  while (in < size)
+  {
+    // Length of the run starting at scan position in
+    const uint8_t value = src[scan.offset(in)];
+    size_t run = 1;
+    while (in + run < size && run < kMaxRun && src[scan.offset(in + run)] == value)
+      run++;
+
+    if (run >= 2)
+    {
+      if (out + 2 > capacity)
+        return 0;
+      dst[out++] = (uint8_t)(257 - run); // -(run - 1)
+      dst[out++] = value;
+      in += run;
+      continue;
+    }
+
+    // Literal span: stop before the next run of 2+ so it can be packed
+    size_t lit = 1;
+    while (in + lit < size && lit < kMaxLiteral)
+    {
+      if (in + lit + 1 < size && src[scan.offset(in + lit)] == src[scan.offset(in + lit + 1)])
+        break;
+      lit++;
+    }
+    if (out + 1 + lit > capacity)
+      return 0;
+    dst[out++] = (uint8_t)(lit - 1);
+    for (size_t i = 0; i < lit; i++)
+      dst[out++] = src[scan.offset(in + i)];
+    in += lit;
+  }
+  return out;
+}
+
+bool packBitsDecode(const uint8_t *src, size_t size, const ColumnScan &scan, uint8_t *dst, size_t rawSize)
+{
+  size_t in = 0;
+  size_t out = 0;
+
+  while (in < size)
+  {
+    const uint8_t control = src[in++];
+    if (control < 128)
+    {
+      const size_t lit = (size_t)control + 1;
+      if (in + lit > size || out + lit > rawSize)
+        return false;
+      for (size_t i = 0; i < lit; i++)
+        dst[scan.offset(out++)] = src[in++];
+    }
+    else if (control > 128)
+    {
+      const size_t run = 257 - (size_t)control;
+      if (in >= size || out + run > rawSize)
+        return false;
+      const uint8_t value = src[in++];
+      for (size_t i = 0; i < run; i++)
+        dst[scan.offset(out++)] = value;
+    }
+    // 128 is a no-op in PackBits
+  }
+  return out == rawSize;
+}
+
+// XOR of frame and reference (all white when reference is null) at offset i
+uint8_t xorAt(const uint8_t *frame, const uint8_t *reference, size_t i)
+{
+  return frame[i] ^ (reference != nullptr ? reference[i] : 0xFF);
+}
+
+bool writeVarint(size_t value, uint8_t *out, size_t capacity, size_t &pos)
+{
+  do
+  {
+    if (pos >= capacity)
+      return false;
+    const uint8_t low = value & 0x7F;
+    value >>= 7;
+    out[pos++] = value ? (uint8_t)(low | 0x80) : low;
+  } while (value);
+  return true;
+}
+
+bool readVarint(const uint8_t *in, size_t size, size_t &pos, size_t &value)
+{
+  value = 0;
+  for (uint8_t shift = 0; shift < 32; shift += 7)
+  {
+    if (pos >= size)
+      return false;
+    const uint8_t byte = in[pos++];
+    value |= (size_t)(byte & 0x7F) << shift;
+    if (!(byte & 0x80))
+      return true;
+  }
+  return false;
+}
+} // namespace
+
+uint32_t FrameCodec_Crc32(const uint8_t *data, size_t size)
+{
+  return esp_rom_crc32_le(0, data, size);
+}
+
+const uint8_t *FrameCodec_Encode(const uint8_t *raw, size_t rawSize, uint16_t rowBytes,
+                                 uint8_t *scratch, size_t scratchCapacity, FrameCodecHeader &header)
+{
+  header.magic = kFrameCodecMagic;
+  header.version = kFrameCodecVersion;
+  header.rowBytes = rowBytes;
+  header.rawSize = rawSize;
+  header.crc32 = FrameCodec_Crc32(raw, rawSize);
+
+  // Only keep RLE when it is actually smaller than the raw frame
+  size_t rleSize = 0;
+  if (rowBytes > 0 && rawSize % rowBytes == 0)
+  {
+    const ColumnScan scan = {rawSize / rowBytes, rowBytes};
+    const size_t rleCapacity = min(scratchCapacity, rawSize - 1);
+    rleSize = packBitsEncode(raw, rawSize, scan, scratch, rleCapacity);
+  }
+  if (rleSize > 0)
+  {
+    header.encoding = kFrameEncodingPackBits;
+    header.payloadSize = rleSize;
+    return scratch;
+  }
+
+  header.encoding = kFrameEncodingRaw;
+  header.payloadSize = rawSize;
+  return raw;
+}
+
+bool FrameCodec_ReadHeader(const uint8_t *data, size_t size, FrameCodecHeader &header)
+{
+  if (size < sizeof(FrameCodecHeader))
+    return false;
+  memcpy(&header, data, sizeof(header));
+  return header.magic == kFrameCodecMagic && header.version == kFrameCodecVersion;
+}
+
+bool FrameCodec_Decode(const FrameCodecHeader &header, const uint8_t *payload, uint8_t *raw, size_t rawSize)
+{
+  if (header.rawSize != rawSize)
+    return false;
+
+  bool ok;
+  switch (header.encoding)
+  {
+  case kFrameEncodingRaw:
+    ok = header.payloadSize == rawSize;
+    if (ok && payload != raw)
+      memcpy(raw, payload, rawSize);
+    break;
+  case kFrameEncodingPackBits:
+    ok = header.rowBytes > 0 && rawSize % header.rowBytes == 0;
+    if (ok)
+    {
+      const ColumnScan scan = {rawSize / header.rowBytes, header.rowBytes};
+      ok = packBitsDecode(payload, header.payloadSize, scan, raw, rawSize);
+    }
+    break;
+  default:
+    ok = false;
+    break;
+  }
+
+  return ok && FrameCodec_Crc32(raw, rawSize) == header.crc32;
+}
+
+bool FrameCodec_EncodeXorDelta(const uint8_t *frame, const uint8_t *reference, size_t size, uint8_t *out,
+                               size_t capacity, size_t &deltaSize)
+{
+  size_t in = 0;
+  size_t pos = 0;
+  while (true)
+  {
+    const size_t runStart = in;
+    while (in < size && xorAt(frame, reference, in) == 0)
+      in++;
+    if (in == size)
+      break; // Trailing zeros are implied
+
+    // Literal span, ended by kFrameDeltaMinZeroRun zeros (or the end of the frame)
+    const size_t literalStart = in;
+    size_t zeros = 0;
+    while (in < size && zeros < kFrameDeltaMinZeroRun)
+    {
+      zeros = xorAt(frame, reference, in) == 0 ? zeros + 1 : 0;
+      in++;
+    }
+    const size_t literalEnd = in - zeros;
+    in = literalEnd;
+
+    if (!writeVarint(literalStart - runStart, out, capacity, pos) ||
+        !writeVarint(literalEnd - literalStart, out, capacity, pos) || pos + (literalEnd - literalStart) > capacity)
+      return false;
+    for (size_t i = literalStart; i < literalEnd; i++)
+      out[pos++] = xorAt(frame, reference, i);
+  }
+  deltaSize = pos;
+  return true;
+}
+
+bool FrameCodec_ApplyXorDelta(const uint8_t *delta, size_t deltaSize, uint8_t *frame, size_t size)
+{
+  size_t pos = 0;
+  size_t out = 0;
+  while (pos < deltaSize)
+  {
+    size_t run, literal;
+    if (!readVarint(delta, deltaSize, pos, run) || !readVarint(delta, deltaSize, pos, literal))
+      return false;
+    if (run > size - out || literal > size - out - run || literal > deltaSize - pos)
+      return false;
+    out += run;
+    for (size_t i = 0; i < literal; i++)
+      frame[out++] ^= delta[pos++];
+  }
+  return true;
+}
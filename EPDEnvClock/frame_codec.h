@@ -0,0 +1,69 @@
+#pragma once
+
+#include <Arduino.h>
+
+// Persisted frame buffer format
+//
+// Layout: FrameCodecHeader followed by payloadSize bytes of payload.
+// - kFrameEncodingRaw:      payload is the raw frame (used when RLE does not pay off)
+// - kFrameEncodingPackBits: payload is PackBits RLE of the frame scanned column by
+//                           column (byte column 0 rows 0..N, then column 1, ...).
+//                           Glyphs are tall, so vertical runs are ~3x longer than
+//                           horizontal ones (a typical clock face is ~4.5 KB).
+// crc32 covers the decoded (raw) frame so a corrupt file is never shown.
+// Legacy files without a header are plain raw frames (see FrameCodec_IsEncoded).
+constexpr uint32_t kFrameCodecMagic = 0x46445045; // "EPDF" (little-endian)
+constexpr uint8_t kFrameCodecVersion = 1;
+
+constexpr uint8_t kFrameEncodingRaw = 0;
+constexpr uint8_t kFrameEncodingPackBits = 1;
+
+struct __attribute__((packed)) FrameCodecHeader
+{
+  uint32_t magic;
+  uint8_t version;
+  uint8_t encoding;
+  uint16_t rowBytes; // Row stride of the raw frame used for the column scan
+  uint32_t rawSize;
+  uint32_t payloadSize;
+  uint32_t crc32;
+};
+static_assert(sizeof(FrameCodecHeader) == 20, "FrameCodecHeader must stay 20 bytes");
+
+// CRC32 (IEEE, same as esp_rom_crc32_le / zlib) of a buffer
+uint32_t FrameCodec_Crc32(const uint8_t *data, size_t size);
+
+// Encode a raw frame
+// Fills header and, when PackBits fits in scratchCapacity and beats the raw size,
+// writes the RLE payload to scratch. Otherwise header.encoding is kFrameEncodingRaw
+// and the payload to store is the raw frame itself.
+// Returns a pointer to the payload to write after the header (scratch or raw).
+// rowBytes must divide rawSize; pass rawSize to scan the buffer linearly.
+const uint8_t *FrameCodec_Encode(const uint8_t *raw, size_t rawSize, uint16_t rowBytes,
+                                 uint8_t *scratch, size_t scratchCapacity, FrameCodecHeader &header);
+
+// Parse and validate a header (magic + supported version)
+// Returns false for legacy raw files, which have no header.
+bool FrameCodec_ReadHeader(const uint8_t *data, size_t size, FrameCodecHeader &header);
+
+// Decode a payload into raw and verify its CRC
+// For kFrameEncodingRaw the payload may already be in raw (payload == raw).
+bool FrameCodec_Decode(const FrameCodecHeader &header, const uint8_t *payload, uint8_t *raw, size_t rawSize);
+
+// XOR-RLE frame delta
+// The XOR of a frame with a reference frame (nullptr: all white, 0xFF), scanned linearly, as
+// groups of (zero run, literal count) LEB128 varints, each followed by its literal XOR bytes.
+// Zero gaps shorter than kFrameDeltaMinZeroRun stay inside literals and the trailing zero run
+// is omitted, so an unchanged frame encodes to 0 bytes. The output is at most
+// size + kFrameDeltaSlack bytes and never gets ahead of the input by more than that, so with
+// reference == nullptr, frame may be out + kFrameDeltaSlack (encoded in place).
+constexpr size_t kFrameDeltaMinZeroRun = 3;
+constexpr size_t kFrameDeltaSlack = 8;
+
+// Returns false if the delta does not fit in capacity
+bool FrameCodec_EncodeXorDelta(const uint8_t *frame, const uint8_t *reference, size_t size, uint8_t *out,
+                               size_t capacity, size_t &deltaSize);
+
+// XOR a delta into frame, which holds the reference on entry (all white for a keyframe)
+// Returns false for a malformed delta or one that runs past size.
+bool FrameCodec_ApplyXorDelta(const uint8_t *delta, size_t deltaSize, uint8_t *frame, size_t size);
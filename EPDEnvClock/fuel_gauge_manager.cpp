@@ -2,16 +2,25 @@
 #include "fuel_gauge_manager.h"
 
 #include <Adafruit_MAX1704X.h>
-#include <Wire.h>
+#include <esp_attr.h>
 
+#include "i2c_bus.h"
 #include "logger.h"
 
 namespace {
 Adafruit_MAX17048 maxlipo;
 bool fuelGaugeAvailable = false;
-bool wireInitialized = false;
 bool chrgPinInitialized = false;
 bool lastChargingState = false;
+
+// Percent/charge rate read ahead of use (FuelGauge_PrefetchDetails)
+bool detailsCached = false;
+float cachedPercent = -1.0f;
+float cachedChargeRate = -1.0f;
+
+// Survives deep sleep, cleared on power-up: the gauge keeps running while we sleep,
+// so its ModelGauge estimate only needs a fresh Quick Start after power-up
+RTC_DATA_ATTR bool quickStartDone = false;
 }  // namespace
 
 // ============================================================
@@ -54,42 +63,6 @@ bool Charging_IsCharging() {
   return charging;
 }
 
-// Recover I2C bus by bit-banging SCL to release a stuck SDA line.
-// When a slave holds SDA LOW (e.g. mid-transfer interrupted by deep sleep),
-// toggling SCL up to 9 times clocks out the stuck byte/ACK, then a STOP
-// condition (SDA LOW→HIGH while SCL is HIGH) resets the bus state.
-void recoverI2CBus(uint8_t sdaPin, uint8_t sclPin) {
-  LOGI(LogTag::SENSOR, "I2C bus recovery on SDA:%d SCL:%d", sdaPin, sclPin);
-
-  pinMode(sdaPin, INPUT_PULLUP);
-  pinMode(sclPin, OUTPUT);
-
-  // Clock up to 9 times to let the slave release SDA
-  for (int i = 0; i < 9; i++) {
-    if (digitalRead(sdaPin) == HIGH) {
-      LOGD(LogTag::SENSOR, "I2C bus recovered after %d clock pulses", i);
-      break;
-    }
-    digitalWrite(sclPin, LOW);
-    delayMicroseconds(5);
-    digitalWrite(sclPin, HIGH);
-    delayMicroseconds(5);
-  }
-
-  // Generate STOP condition: SDA LOW→HIGH while SCL is HIGH
-  pinMode(sdaPin, OUTPUT);
-  digitalWrite(sdaPin, LOW);
-  delayMicroseconds(5);
-  digitalWrite(sclPin, HIGH);
-  delayMicroseconds(5);
-  digitalWrite(sdaPin, HIGH);
-  delayMicroseconds(5);
-
-  // Release pins back to input for Wire1 to take over
-  pinMode(sdaPin, INPUT_PULLUP);
-  pinMode(sclPin, INPUT_PULLUP);
-}
-
 bool FuelGauge_Init() {
   // MAX17048 uses separate I2C bus (Wire1) on GPIO 14/16
   // Note: Must be called AFTER DeepSleepManager_ReleaseI2CPins() to ensure
@@ -97,25 +70,21 @@ bool FuelGauge_Init() {
   constexpr int kMaxAttempts = 3;
 
   for (int attempt = 1; attempt <= kMaxAttempts; attempt++) {
-    if (!wireInitialized) {
-      // On retry, perform I2C bus recovery before re-initializing Wire1.
-      // This handles cases where SDA is stuck LOW (slave hung mid-transfer).
-      if (attempt > 1) {
-        recoverI2CBus(FUEL_GAUGE_SDA_PIN, FUEL_GAUGE_SCL_PIN);
-        delay(50);
-      }
-
-      if (!Wire1.begin(FUEL_GAUGE_SDA_PIN, FUEL_GAUGE_SCL_PIN)) {
-        LOGE(LogTag::SENSOR, "Wire1.begin() failed (SDA:%d, SCL:%d, attempt %d/%d)",
-             FUEL_GAUGE_SDA_PIN, FUEL_GAUGE_SCL_PIN, attempt, kMaxAttempts);
-        continue;
-      }
-      Wire1.setClock(100000);
-      wireInitialized = true;
+    // On retry, recover the bus (SDA stuck LOW, slave hung mid-transfer) and restart it
+    const bool busReady = attempt == 1 ? I2CBus_Begin(I2CBusId::FuelGauge)
+                                       : I2CBus_Reset(I2CBusId::FuelGauge);
+    if (!busReady) {
+      LOGE(LogTag::SENSOR, "Wire1 not available (attempt %d/%d)", attempt, kMaxAttempts);
       delay(50);
+      continue;
     }
 
-    if (maxlipo.begin(&Wire1)) {
+    bool found;
+    {
+      I2CBusGuard bus(I2CBusId::FuelGauge);
+      found = bus.locked() && maxlipo.begin(&I2CBus_Wire(I2CBusId::FuelGauge));
+    }
+    if (found) {
       if (attempt > 1) {
         LOGI(LogTag::SENSOR, "MAX17048 found on attempt %d", attempt);
       }
@@ -125,8 +94,16 @@ bool FuelGauge_Init() {
       // Quick Start to ensure SOC is calculated
       // MAX17048 needs this after power-up or if SOC is stuck
       // Takes ~175ms to complete per datasheet
-      maxlipo.quickStart();
-      delay(250);  // Wait for Quick Start to complete
+      if (!quickStartDone) {
+        {
+          I2CBusGuard bus(I2CBusId::FuelGauge);
+          if (bus.locked()) {
+            maxlipo.quickStart();
+          }
+        }
+        delay(250);  // Wait for Quick Start to complete
+        quickStartDone = true;
+      }
 
       fuelGaugeAvailable = true;
       return true;
@@ -134,10 +111,6 @@ bool FuelGauge_Init() {
 
     LOGW(LogTag::SENSOR, "MAX17048 not found (attempt %d/%d, SDA:%d, SCL:%d)",
          attempt, kMaxAttempts, FUEL_GAUGE_SDA_PIN, FUEL_GAUGE_SCL_PIN);
-
-    // Tear down Wire1 and retry with fresh I2C bus init
-    Wire1.end();
-    wireInitialized = false;
     delay(100);
   }
 
@@ -149,7 +122,14 @@ float FuelGauge_GetVoltage() {
   if (!fuelGaugeAvailable) {
     return -1.0f;  // Error: not available
   }
-  float voltage = maxlipo.cellVoltage();
+  float voltage;
+  {
+    I2CBusGuard bus(I2CBusId::FuelGauge);
+    if (!bus.locked()) {
+      return -1.0f;
+    }
+    voltage = maxlipo.cellVoltage();
+  }
 
   // Validate voltage range (2.0V - 4.4V)
   // Values outside this range indicate sensor error or malfunction
@@ -169,7 +149,17 @@ float FuelGauge_GetPercent() {
   if (!fuelGaugeAvailable) {
     return -1.0f;
   }
-  float percent = maxlipo.cellPercent();
+  if (detailsCached) {
+    return cachedPercent;
+  }
+  float percent;
+  {
+    I2CBusGuard bus(I2CBusId::FuelGauge);
+    if (!bus.locked()) {
+      return -1.0f;
+    }
+    percent = maxlipo.cellPercent();
+  }
   // Clamp to 0-100 range
   if (percent < 0.0f) percent = 0.0f;
   if (percent > 100.0f) percent = 100.0f;
@@ -198,9 +188,25 @@ float FuelGauge_GetChargeRate() {
   if (!fuelGaugeAvailable) {
     return -1.0f;
   }
+  if (detailsCached) {
+    return cachedChargeRate;
+  }
+  I2CBusGuard bus(I2CBusId::FuelGauge);
+  if (!bus.locked()) {
+    return -1.0f;
+  }
   return maxlipo.chargeRate();
 }
 
+void FuelGauge_PrefetchDetails() {
+  if (!fuelGaugeAvailable || detailsCached) {
+    return;
+  }
+  cachedPercent = FuelGauge_GetPercent();
+  cachedChargeRate = FuelGauge_GetChargeRate();
+  detailsCached = cachedPercent >= 0.0f; // Bus busy: read again when the values are needed
+}
+
 bool FuelGauge_IsAvailable() {
   return fuelGaugeAvailable;
 }
@@ -209,6 +215,13 @@ void FuelGauge_QuickStart() {
   if (!fuelGaugeAvailable) {
     return;
   }
-  maxlipo.quickStart();
+  {
+    I2CBusGuard bus(I2CBusId::FuelGauge);
+    if (!bus.locked()) {
+      return;
+    }
+    maxlipo.quickStart();
+  }
+  detailsCached = false;
   LOGI(LogTag::SENSOR, "MAX17048 quick start triggered");
 }
@@ -10,7 +10,8 @@ constexpr uint8_t FUEL_GAUGE_SCL_PIN = 16;
 // 4054A CHRG pin (open-drain, active LOW when charging)
 constexpr uint8_t CHRG_PIN = 8;
 
-// Initialize fuel gauge on Wire1
+// Initialize fuel gauge on Wire1 (through the I2C bus manager)
+// Quick Start runs only after power-up; the gauge keeps tracking through deep sleep
 bool FuelGauge_Init();
 
 // Read battery voltage in volts
@@ -31,6 +32,10 @@ float FuelGauge_GetLinearPercent(float voltage);
 // Returns -1.0f if unavailable
 float FuelGauge_GetChargeRate();
 
+// Read percent and charge rate now and return them from the getters for the rest of the boot
+// Called while the SCD41 measures so the reads leave the post-draw path
+void FuelGauge_PrefetchDetails();
+
 // Check if fuel gauge is available
 bool FuelGauge_IsAvailable();
 
@@ -0,0 +1,166 @@
+#include "i2c_bus.h"
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+
+#include "fuel_gauge_manager.h"
+#include "logger.h"
+#include "sensor_manager.h"
+
+namespace
+{
+struct BusState
+{
+  TwoWire &wire;
+  const char *name;
+  uint8_t sdaPin;
+  uint8_t sclPin;
+  SemaphoreHandle_t mutex;
+  bool attempted;
+  bool started;
+};
+
+BusState buses[] = {
+    {Wire, "Wire", SENSOR_I2C_SDA_PIN, SENSOR_I2C_SCL_PIN, nullptr, false, false},
+    {Wire1, "Wire1", FUEL_GAUGE_SDA_PIN, FUEL_GAUGE_SCL_PIN, nullptr, false, false},
+};
+
+BusState &busState(I2CBusId bus)
+{
+  return buses[static_cast<uint8_t>(bus)];
+}
+
+// Recover I2C bus by bit-banging SCL to release a stuck SDA line.
+// When a slave holds SDA LOW (e.g. mid-transfer interrupted by deep sleep),
+// toggling SCL up to 9 times clocks out the stuck byte/ACK, then a STOP
+// condition (SDA LOW→HIGH while SCL is HIGH) resets the bus state.
+void recoverBus(uint8_t sdaPin, uint8_t sclPin)
+{
+  LOGI(LogTag::SENSOR, "I2C bus recovery on SDA:%d SCL:%d", sdaPin, sclPin);
+
+  pinMode(sdaPin, INPUT_PULLUP);
+  pinMode(sclPin, OUTPUT);
+
+  // Clock up to 9 times to let the slave release SDA
+  for (int i = 0; i < 9; i++)
+  {
+    if (digitalRead(sdaPin) == HIGH)
+    {
+      LOGD(LogTag::SENSOR, "I2C bus recovered after %d clock pulses", i);
+      break;
+    }
+    digitalWrite(sclPin, LOW);
+    delayMicroseconds(5);
+    digitalWrite(sclPin, HIGH);
+    delayMicroseconds(5);
+  }
+
+  // Generate STOP condition: SDA LOW→HIGH while SCL is HIGH
+  pinMode(sdaPin, OUTPUT);
+  digitalWrite(sdaPin, LOW);
+  delayMicroseconds(5);
+  digitalWrite(sclPin, HIGH);
+  delayMicroseconds(5);
+  digitalWrite(sdaPin, HIGH);
+  delayMicroseconds(5);
+
+  // Release pins back to input for the I2C driver to take over
+  pinMode(sdaPin, INPUT_PULLUP);
+  pinMode(sclPin, INPUT_PULLUP);
+}
+
+// Caller holds the bus lock
+bool startBus(BusState &state)
+{
+  state.attempted = true;
+  state.started = state.wire.begin(state.sdaPin, state.sclPin, I2C_BUS_CLOCK_HZ);
+  if (!state.started)
+  {
+    // A slave left holding SDA low makes the driver fail; clock it free and try once more
+    recoverBus(state.sdaPin, state.sclPin);
+    state.started = state.wire.begin(state.sdaPin, state.sclPin, I2C_BUS_CLOCK_HZ);
+  }
+  if (state.started)
+  {
+    LOGD(LogTag::SENSOR, "%s started (SDA:%d, SCL:%d, %lu Hz)", state.name, state.sdaPin, state.sclPin,
+         (unsigned long)I2C_BUS_CLOCK_HZ);
+  }
+  else
+  {
+    LOGE(LogTag::SENSOR, "%s.begin() failed (SDA:%d, SCL:%d)", state.name, state.sdaPin, state.sclPin);
+  }
+  return state.started;
+}
+} // namespace
+
+void I2CBus_Init()
+{
+  for (BusState &state : buses)
+  {
+    if (state.mutex == nullptr)
+    {
+      state.mutex = xSemaphoreCreateMutex();
+    }
+  }
+}
+
+bool I2CBus_Begin(I2CBusId bus)
+{
+  BusState &state = busState(bus);
+  I2CBusGuard guard(bus);
+  if (!guard.locked())
+  {
+    return false;
+  }
+  if (state.attempted)
+  {
+    return state.started;
+  }
+  return startBus(state);
+}
+
+bool I2CBus_Reset(I2CBusId bus)
+{
+  BusState &state = busState(bus);
+  I2CBusGuard guard(bus);
+  if (!guard.locked())
+  {
+    return false;
+  }
+  if (state.started)
+  {
+    state.wire.end();
+    state.started = false;
+  }
+  recoverBus(state.sdaPin, state.sclPin);
+  return startBus(state);
+}
+
+TwoWire &I2CBus_Wire(I2CBusId bus)
+{
+  return busState(bus).wire;
+}
+
+bool I2CBus_Lock(I2CBusId bus)
+{
+  BusState &state = busState(bus);
+  if (state.mutex == nullptr)
+  {
+    return true;
+  }
+  if (xSemaphoreTake(state.mutex, pdMS_TO_TICKS(I2C_BUS_LOCK_TIMEOUT_MS)) != pdTRUE)
+  {
+    LOGW(LogTag::SENSOR, "%s lock not free after %d ms, skipping transaction", state.name, I2C_BUS_LOCK_TIMEOUT_MS);
+    return false;
+  }
+  return true;
+}
+
+void I2CBus_Unlock(I2CBusId bus)
+{
+  SemaphoreHandle_t mutex = busState(bus).mutex;
+  if (mutex != nullptr)
+  {
+    xSemaphoreGive(mutex);
+  }
+}
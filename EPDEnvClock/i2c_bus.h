@@ -0,0 +1,64 @@
+#pragma once
+
+#include <Arduino.h>
+#include <Wire.h>
+
+// I2C bus manager for the two sensor buses
+// Each bus is started once per boot (with stuck-bus recovery) and every transaction runs
+// under the bus lock, so the sensor task, the main task and the post-draw task can share
+// a device without interleaving transfers.
+
+// Bus clock for both buses (SCD41 and MAX17048 both support Fast Mode)
+#ifndef I2C_BUS_CLOCK_HZ
+#define I2C_BUS_CLOCK_HZ 400000
+#endif
+
+// Longest wait for a bus lock; a holder that never gives it back (a task deleted mid-transfer)
+// then fails the caller's transaction instead of hanging it
+#ifndef I2C_BUS_LOCK_TIMEOUT_MS
+#define I2C_BUS_LOCK_TIMEOUT_MS 1000
+#endif
+
+enum class I2CBusId : uint8_t
+{
+  Sensor,    // Wire: SCD41 (SENSOR_I2C_SDA_PIN / SENSOR_I2C_SCL_PIN)
+  FuelGauge, // Wire1: MAX17048 (FUEL_GAUGE_SDA_PIN / FUEL_GAUGE_SCL_PIN)
+};
+
+// Create the bus locks (call once early in setup, before any task starts)
+void I2CBus_Init();
+
+// Start the bus on first use; later calls return the same result without touching the bus
+// Call after DeepSleepManager_ReleaseI2CPins(). Safe to call from either core.
+bool I2CBus_Begin(I2CBusId bus);
+
+// Tear the bus down, clock a stuck slave free and start it again (device probe failed)
+bool I2CBus_Reset(I2CBusId bus);
+
+TwoWire &I2CBus_Wire(I2CBusId bus);
+
+// Returns false if the lock was not free within I2C_BUS_LOCK_TIMEOUT_MS (skip the transaction)
+bool I2CBus_Lock(I2CBusId bus);
+void I2CBus_Unlock(I2CBusId bus);
+
+// Holds the bus lock for the enclosing scope; keep it to a transaction, not a measurement wait
+class I2CBusGuard
+{
+public:
+  explicit I2CBusGuard(I2CBusId bus) : bus_(bus), locked_(I2CBus_Lock(bus)) {}
+  ~I2CBusGuard()
+  {
+    if (locked_)
+    {
+      I2CBus_Unlock(bus_);
+    }
+  }
+  I2CBusGuard(const I2CBusGuard &) = delete;
+  I2CBusGuard &operator=(const I2CBusGuard &) = delete;
+
+  bool locked() const { return locked_; }
+
+private:
+  I2CBusId bus_;
+  bool locked_;
+};
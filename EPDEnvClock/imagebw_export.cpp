@@ -1,46 +1,46 @@
 #include "imagebw_export.h"
 
 #include <HTTPClient.h>
+#include <SD.h>
 #include <WiFi.h>
 
+#include "EPD_Init.h"
+#include "frame_codec.h"
 #include "server_config.h"
+#include "storage_manager.h"
 #include "logger.h"
 
-bool ImageBWExporter_Send(const uint8_t *buffer, size_t length)
+namespace
 {
-  if (WiFi.status() != WL_CONNECTED)
-  {
-    LOGW(LogTag::IMAGEBW, "WiFi not connected, skipping export");
-    return false;
-  }
+#define IMAGEBW_STRINGIFY_(x) #x
+#define IMAGEBW_STRINGIFY(x) IMAGEBW_STRINGIFY_(x)
+#define IMAGEBW_SERVER_URL "http://" IMAGEBW_SERVER_IP ":" IMAGEBW_STRINGIFY(IMAGEBW_SERVER_PORT)
 
-  HTTPClient http;
-  String url = "http://" + String(IMAGEBW_SERVER_IP) + ":" + String(IMAGEBW_SERVER_PORT) + "/imagebw";
+constexpr char kFrameUrl[] = IMAGEBW_SERVER_URL "/imagebw";
+constexpr char kStreamUrl[] = IMAGEBW_SERVER_URL "/imagebw/stream";
+constexpr int kHttpConflict = 409;
 
-  LOGD(LogTag::IMAGEBW, "Sending to server: %s", url.c_str());
+int post(const char *url, const char *contentType, const uint8_t *body, size_t length)
+{
+  LOGD(LogTag::IMAGEBW, "Sending %zu bytes to %s", length, url);
 
+  HTTPClient http;
   http.begin(url);
-  http.addHeader("Content-Type", "application/octet-stream");
-  http.addHeader("Content-Length", String(length));
+  http.addHeader("Content-Type", contentType);
+  // Buffer layout (EPD_FRAME_CONTROLLER_ORDER); the server reorders controller-order frames
+  http.addHeader("X-ImageBW-Layout", EPD_FRAME_CONTROLLER_ORDER ? "controller" : "row");
 
   const unsigned long startTime = millis();
   // HTTPClient::POST expects a non-const pointer, but it does not modify the payload.
-  const int httpResponseCode = http.POST(const_cast<uint8_t *>(buffer), length);
+  const int httpResponseCode = http.POST(const_cast<uint8_t *>(body), length);
   const unsigned long sendTime = millis() - startTime;
 
-  bool success = false;
-
   if (httpResponseCode > 0)
   {
     String response = http.getString();
     LOGI(LogTag::IMAGEBW, "Response code: %d", httpResponseCode);
     LOGD(LogTag::IMAGEBW, "Response: %s", response.c_str());
     LOGD(LogTag::IMAGEBW, "Send time: %lu ms", sendTime);
-
-    if (httpResponseCode == 200)
-    {
-      success = true;
-    }
   }
   else
   {
@@ -48,5 +48,169 @@ bool ImageBWExporter_Send(const uint8_t *buffer, size_t length)
   }
 
   http.end();
+  return httpResponseCode;
+}
+
+#if IMAGEBW_EXPORT_DELTA
+constexpr char kReferenceFile[] = "/imagebw_ref.bin";
+
+// Last frame the server acknowledged (its pixels are in kReferenceFile)
+// Own magic, so a cold boot starts over with a keyframe.
+constexpr uint32_t kExportStateMagic = 0x58495045; // "EPIX" (little-endian)
+struct ExportState
+{
+  uint32_t magic;
+  uint32_t sequence;      // Last sequence number sent
+  uint32_t ackedSequence; // 0 = no reference, next frame is a keyframe
+  uint32_t ackedCrc32;
+  uint16_t deltasSinceKey;
+};
+RTC_DATA_ATTR ExportState exportState;
+
+// Read the acknowledged frame into reference. The file is stored raw, so it loads without a
+// decode buffer next to the stream body.
+bool loadReference(uint8_t *reference, size_t length)
+{
+  if (StorageManager_Mount() != StorageMedium::Sd)
+  {
+    return false;
+  }
+  File file = SD.open(kReferenceFile, FILE_READ);
+  if (!file)
+  {
+    return false;
+  }
+  uint8_t headerBytes[sizeof(FrameCodecHeader)];
+  FrameCodecHeader header;
+  bool ok = file.read(headerBytes, sizeof(headerBytes)) == sizeof(headerBytes) &&
+            FrameCodec_ReadHeader(headerBytes, sizeof(headerBytes), header) && header.rawSize == length &&
+            header.crc32 == exportState.ackedCrc32 && header.encoding == kFrameEncodingRaw;
+  ok = ok && file.read(reference, length) == length;
+  file.close();
+  return ok && FrameCodec_Crc32(reference, length) == header.crc32;
+}
+
+bool saveReference(const uint8_t *buffer, size_t length)
+{
+  if (StorageManager_Mount() != StorageMedium::Sd)
+  {
+    return false;
+  }
+  FrameCodecHeader header;
+  // No scratch: always kFrameEncodingRaw, which loadReference reads in place
+  const uint8_t *payload = FrameCodec_Encode(buffer, length, 0, nullptr, 0, header);
+  File file = SD.open(kReferenceFile, FILE_WRITE);
+  if (!file)
+  {
+    return false;
+  }
+  size_t written = file.write(reinterpret_cast<const uint8_t *>(&header), sizeof(header));
+  written += file.write(payload, header.payloadSize);
+  file.close();
+  return written == sizeof(header) + header.payloadSize;
+}
+
+bool sendStream(const uint8_t *buffer, size_t length)
+{
+  if (exportState.magic != kExportStateMagic)
+  {
+    exportState = ExportState();
+    exportState.magic = kExportStateMagic;
+  }
+
+  // The only frame-sized allocation while WiFi is up: the reference is loaded into the
+  // payload kFrameDeltaSlack bytes in and the delta is encoded over it in place
+  const size_t capacity = length + kFrameDeltaSlack;
+  uint8_t *body = static_cast<uint8_t *>(malloc(sizeof(ImageBWStreamHeader) + capacity));
+  if (body == nullptr)
+  {
+    LOGE(LogTag::IMAGEBW, "Out of memory for the export stream");
+    return false;
+  }
+  uint8_t *payload = body + sizeof(ImageBWStreamHeader);
+  uint8_t *reference = payload + kFrameDeltaSlack;
+
+  bool delta = exportState.ackedSequence != 0 && exportState.deltasSinceKey + 1 < IMAGEBW_KEYFRAME_INTERVAL;
+  if (delta && !loadReference(reference, length))
+  {
+    LOGW(LogTag::IMAGEBW, "Reference frame #%lu unavailable, sending a keyframe", (unsigned long)exportState.ackedSequence);
+    delta = false;
+  }
+  if (delta)
+  {
+    // reference ^ frame against all white (0xFF) is the delta against the reference
+    for (size_t i = 0; i < length; i++)
+    {
+      reference[i] ^= buffer[i] ^ 0xFF;
+    }
+  }
+
+  ImageBWStreamHeader header = {};
+  int httpResponseCode = 0;
+  // Second pass only when the server does not hold the reference
+  for (uint8_t attempt = 0; attempt < 2; attempt++)
+  {
+    size_t deltaSize = 0;
+    if (!FrameCodec_EncodeXorDelta(delta ? reference : buffer, nullptr, length, payload, capacity, deltaSize))
+    {
+      LOGE(LogTag::IMAGEBW, "Delta does not fit in %zu bytes", capacity);
+      break;
+    }
+    header = ImageBWStreamHeader();
+    header.magic = kImageBWStreamMagic;
+    header.version = kImageBWStreamVersion;
+    header.type = delta ? kImageBWFrameDelta : kImageBWFrameKey;
+    header.layout = EPD_FRAME_CONTROLLER_ORDER ? kImageBWLayoutController : kImageBWLayoutRowMajor;
+    header.sequence = ++exportState.sequence;
+    header.baseSequence = delta ? exportState.ackedSequence : 0;
+    header.baseCrc32 = delta ? exportState.ackedCrc32 : 0;
+    header.frameCrc32 = FrameCodec_Crc32(buffer, length);
+    header.frameSize = length;
+    header.payloadSize = deltaSize;
+    memcpy(body, &header, sizeof(header));
+
+    LOGI(LogTag::IMAGEBW, "Frame #%lu: %s, %zu bytes", (unsigned long)header.sequence, delta ? "delta" : "keyframe",
+         deltaSize);
+    httpResponseCode = post(kStreamUrl, kImageBWStreamContentType, body, sizeof(header) + deltaSize);
+    if (httpResponseCode != kHttpConflict || !delta)
+    {
+      break;
+    }
+    LOGW(LogTag::IMAGEBW, "Server does not hold frame #%lu, sending a keyframe", (unsigned long)header.baseSequence);
+    delta = false;
+  }
+
+  const bool success = httpResponseCode == 200;
+  if (success)
+  {
+    const bool referenceUnchanged = delta && header.payloadSize == 0;
+    exportState.ackedSequence = header.sequence;
+    exportState.ackedCrc32 = header.frameCrc32;
+    exportState.deltasSinceKey = delta ? exportState.deltasSinceKey + 1 : 0;
+    if (!referenceUnchanged && !saveReference(buffer, length))
+    {
+      LOGW(LogTag::IMAGEBW, "Could not store the reference frame, next export is a keyframe");
+      exportState.ackedSequence = 0;
+    }
+  }
+
+  free(body);
   return success;
 }
+#endif
+} // namespace
+
+bool ImageBWExporter_Send(const uint8_t *buffer, size_t length)
+{
+  if (WiFi.status() != WL_CONNECTED)
+  {
+    LOGW(LogTag::IMAGEBW, "WiFi not connected, skipping export");
+    return false;
+  }
+
+#if IMAGEBW_EXPORT_DELTA
+  return sendStream(buffer, length);
+#else
+  return post(kFrameUrl, "application/octet-stream", buffer, length) == 200;
+#endif
+}
@@ -2,4 +2,46 @@
 
 #include <Arduino.h>
 
+// ImageBW export stream (POST /imagebw/stream, Content-Type: application/x-imagebw-stream)
+//
+// Body: one or more records, each an ImageBWStreamHeader followed by payloadSize bytes of
+// XOR-RLE delta (FrameCodec_EncodeXorDelta, frame_codec.h):
+// - kImageBWFrameKey:   against an all-white frame, so the server needs no state
+// - kImageBWFrameDelta: against frame baseSequence (CRC32 baseCrc32), which must be the last
+//                       frame the server holds; otherwise it answers 409 and the device sends
+//                       a keyframe
+// Records in one body chain (each delta is against the record before it), so a batch of
+// historical frames goes in one request. frameCrc32 is the CRC32 of the decoded frame.
+// The server answers 200 once every record is stored. scripts/imagebw_server.py decodes it.
+constexpr uint32_t kImageBWStreamMagic = 0x53495045; // "EPIS" (little-endian)
+constexpr uint8_t kImageBWStreamVersion = 1;
+constexpr char kImageBWStreamContentType[] = "application/x-imagebw-stream";
+
+constexpr uint8_t kImageBWFrameKey = 0;
+constexpr uint8_t kImageBWFrameDelta = 1;
+
+// ImageBWStreamHeader::layout (EPD_FRAME_CONTROLLER_ORDER)
+constexpr uint8_t kImageBWLayoutRowMajor = 0;
+constexpr uint8_t kImageBWLayoutController = 1;
+
+struct __attribute__((packed)) ImageBWStreamHeader
+{
+  uint32_t magic;
+  uint8_t version;
+  uint8_t type;     // kImageBWFrame*
+  uint8_t layout;   // kImageBWLayout*
+  uint8_t reserved;
+  uint32_t sequence;     // Increments per frame sent; restarts after a cold boot
+  uint32_t baseSequence; // Delta reference (0 for a keyframe)
+  uint32_t baseCrc32;    // CRC32 of the reference frame (0 for a keyframe)
+  uint32_t frameCrc32;
+  uint32_t frameSize;
+  uint32_t payloadSize;
+};
+static_assert(sizeof(ImageBWStreamHeader) == 32, "ImageBWStreamHeader must stay 32 bytes");
+
+// Send the frame to the preview server (IMAGEBW_EXPORT_DELTA in server_config.h)
+// Deltas are against the last frame the server acknowledged, which is kept on the SD card;
+// a keyframe goes out every IMAGEBW_KEYFRAME_INTERVAL frames, without a stored reference,
+// and right away when the server does not hold the reference.
 bool ImageBWExporter_Send(const uint8_t *buffer, size_t length);
@@ -1,39 +1,522 @@
 #include "logger.h"
+#include "storage_manager.h"
 
 #include <stdarg.h>
 #include <stdio.h>
 #include <SD.h>
 #include <sys/time.h>
+#include <freertos/FreeRTOS.h>
+#if LOG_HEADLESS == 2 && ARDUINO_USB_CDC_ON_BOOT && CONFIG_IDF_TARGET_ESP32S3
+#include <soc/usb_serial_jtag_struct.h>
+#define LOG_DETECT_USB_HOST 1
+#else
+#define LOG_DETECT_USB_HOST 0
+#endif
 
 namespace
 {
 LoggerConfig g_config;
 
-// Buffer for ERROR/WARN logs to be written to SD card
+#if LOG_DETECT_USB_HOST
+// A host sends a USB start-of-frame every 1 ms; if the frame counter has not moved
+// kUsbHostProbeUs after Logger_Init(), nobody is listening
+constexpr uint32_t kUsbHostProbeUs = 2000;
+enum class UsbHostState : uint8_t
+{
+  Unknown,
+  Attached,
+  Detached
+};
+UsbHostState g_usbHost = UsbHostState::Unknown;
+uint32_t g_usbProbeStartUs = 0;
+uint32_t g_usbProbeFrame = 0;
+#endif
+
+// Ring of ERROR/WARN records to be written to SD card
+// Records keep the format string pointer and the raw arguments (strings copied inline);
+// the text is only rendered by Logger_FlushToSD(). When the ring is full the oldest
+// record is overwritten and counted as dropped.
 constexpr size_t kMaxLogEntries = 32;
-constexpr size_t kMaxLogLineLength = 192;
+constexpr size_t kLogArgBytes = 48;
+constexpr size_t kMaxLogLineLength = 256;
+// Timestamp, level and tag prefix plus a 256-byte message
+constexpr size_t kMaxSerialLineLength = 320;
+constexpr size_t kMaxLogTags = 16;
+constexpr uint8_t kUnknownTag = 0xFF;
+// Wall clock values below this mean the time was never set (same bound as getLocalTime)
+constexpr time_t kMinValidUnixTime = 1451606400; // 2016-01-01
 constexpr char kLogDirectory[] = "/error_logs";
 
-struct LogEntry
+struct LogRecord
 {
-  char message[kMaxLogLineLength];
-  bool used;
+  const char *format;   // Format string literal of the LOG call
+  uint32_t unixTime;    // Wall clock at log time (0 = not set)
+  uint32_t bootMs;      // millis() at log time
+  uint8_t level;        // LogLevel
+  uint8_t tagId;        // Index into g_logTags
+  uint8_t argCount;     // Conversions captured in args (later ones render as "?")
+  uint8_t argBytes;     // Bytes used in args
+  uint8_t args[kLogArgBytes];
 };
 
-LogEntry g_logBuffer[kMaxLogEntries];
-size_t g_logBufferIndex = 0;
-bool g_sdLoggingEnabled = false;
+LogRecord g_logRing[kMaxLogEntries];
+size_t g_logRingHead = 0;  // Oldest record
+size_t g_logRingCount = 0;
+uint32_t g_logDropped = 0; // Records overwritten before they were flushed
+// Tag strings are literals, so a record stores the index of its tag pointer
+const char *g_logTags[kMaxLogTags];
+size_t g_logTagCount = 0;
+// Logs are written from both cores (parallel tasks, post-draw stage)
+portMUX_TYPE g_logBufferMux = portMUX_INITIALIZER_UNLOCKED;
+
+// Caller holds g_logBufferMux
+uint8_t tagIdLocked(const char *tag)
+{
+  for (size_t i = 0; i < g_logTagCount; i++)
+  {
+    if (g_logTags[i] == tag)
+    {
+      return (uint8_t)i;
+    }
+  }
+  if (g_logTagCount < kMaxLogTags)
+  {
+    g_logTags[g_logTagCount] = tag;
+    return (uint8_t)g_logTagCount++;
+  }
+  return kUnknownTag;
+}
+
+// One printf conversion: %[flags][width][.precision][length]conversion
+struct FormatSpec
+{
+  const char *text;  // Points at the '%'
+  size_t prefixLength; // '%' + flags/width/precision (without the length modifier)
+  char length;       // 0, 'H' (hh), 'h', 'l', 'L' (ll), 'z', 'j', 't' or 'D' (long double)
+  char conversion;
+  uint8_t stars;     // '*' width/precision arguments
+};
+
+// Parse the conversion after the '%' at format; returns the character after it
+const char *parseSpec(const char *format, FormatSpec &spec)
+{
+  spec.text = format;
+  spec.length = 0;
+  spec.stars = 0;
+  const char *p = format + 1;
+  while (*p == '-' || *p == '+' || *p == ' ' || *p == '#' || *p == '0')
+  {
+    p++;
+  }
+  if (*p == '*')
+  {
+    spec.stars++;
+    p++;
+  }
+  while (*p >= '0' && *p <= '9')
+  {
+    p++;
+  }
+  if (*p == '.')
+  {
+    p++;
+    if (*p == '*')
+    {
+      spec.stars++;
+      p++;
+    }
+    while (*p >= '0' && *p <= '9')
+    {
+      p++;
+    }
+  }
+  spec.prefixLength = (size_t)(p - format);
+  switch (*p)
+  {
+  case 'h':
+    spec.length = (p[1] == 'h') ? 'H' : 'h';
+    p += (p[1] == 'h') ? 2 : 1;
+    break;
+  case 'l':
+    spec.length = (p[1] == 'l') ? 'L' : 'l';
+    p += (p[1] == 'l') ? 2 : 1;
+    break;
+  case 'z':
+  case 'j':
+  case 't':
+    spec.length = *p++;
+    break;
+  case 'L':
+    spec.length = 'D';
+    p++;
+    break;
+  default:
+    break;
+  }
+  spec.conversion = *p;
+  return (*p != '\0') ? p + 1 : p;
+}
+
+bool isSignedConversion(char c)
+{
+  return c == 'd' || c == 'i';
+}
+
+bool isUnsignedConversion(char c)
+{
+  return c == 'u' || c == 'x' || c == 'X' || c == 'o';
+}
+
+bool isFloatConversion(char c)
+{
+  return c == 'f' || c == 'F' || c == 'e' || c == 'E' || c == 'g' || c == 'G' || c == 'a' || c == 'A';
+}
+
+// Integers are stored at their promoted width (4 bytes, 8 for 64-bit types)
+size_t intArgSize(const FormatSpec &spec)
+{
+  switch (spec.length)
+  {
+  case 'L':
+  case 'j':
+    return 8;
+  case 'l':
+    return sizeof(long);
+  case 'z':
+    return sizeof(size_t);
+  case 't':
+    return sizeof(ptrdiff_t);
+  default:
+    return sizeof(int);
+  }
+}
+
+bool putArg(LogRecord &record, const void *value, size_t size)
+{
+  if (record.argBytes + size > kLogArgBytes)
+  {
+    return false;
+  }
+  memcpy(record.args + record.argBytes, value, size);
+  record.argBytes += (uint8_t)size;
+  return true;
+}
+
+// Copy the arguments of format into record (strings inline, NUL-terminated)
+void captureArgs(LogRecord &record, const char *format, va_list args)
+{
+  record.argCount = 0;
+  record.argBytes = 0;
+  for (const char *p = format; *p != '\0';)
+  {
+    if (*p != '%')
+    {
+      p++;
+      continue;
+    }
+    FormatSpec spec;
+    p = parseSpec(p, spec);
+    if (spec.conversion == '%')
+    {
+      continue;
+    }
+
+    bool stored = true;
+    for (uint8_t i = 0; i < spec.stars && stored; i++)
+    {
+      const int star = va_arg(args, int);
+      stored = putArg(record, &star, sizeof(star));
+    }
+    const char c = spec.conversion;
+    if (isSignedConversion(c))
+    {
+      int64_t v;
+      switch (spec.length)
+      {
+      case 'l': v = va_arg(args, long); break;
+      case 'L': v = va_arg(args, long long); break;
+      case 'z': v = (int64_t)va_arg(args, size_t); break;
+      case 'j': v = va_arg(args, intmax_t); break;
+      case 't': v = va_arg(args, ptrdiff_t); break;
+      case 'H': v = (signed char)va_arg(args, int); break;
+      case 'h': v = (short)va_arg(args, int); break;
+      default: v = va_arg(args, int); break;
+      }
+      if (intArgSize(spec) == 8)
+      {
+        stored = stored && putArg(record, &v, sizeof(v));
+      }
+      else
+      {
+        const int32_t narrow = (int32_t)v;
+        stored = stored && putArg(record, &narrow, sizeof(narrow));
+      }
+    }
+    else if (isUnsignedConversion(c))
+    {
+      uint64_t v;
+      switch (spec.length)
+      {
+      case 'l': v = va_arg(args, unsigned long); break;
+      case 'L': v = va_arg(args, unsigned long long); break;
+      case 'z': v = va_arg(args, size_t); break;
+      case 'j': v = va_arg(args, uintmax_t); break;
+      case 't': v = (uint64_t)va_arg(args, ptrdiff_t); break;
+      case 'H': v = (unsigned char)va_arg(args, unsigned int); break;
+      case 'h': v = (unsigned short)va_arg(args, unsigned int); break;
+      default: v = va_arg(args, unsigned int); break;
+      }
+      if (intArgSize(spec) == 8)
+      {
+        stored = stored && putArg(record, &v, sizeof(v));
+      }
+      else
+      {
+        const uint32_t narrow = (uint32_t)v;
+        stored = stored && putArg(record, &narrow, sizeof(narrow));
+      }
+    }
+    else if (c == 'c')
+    {
+      const char v = (char)va_arg(args, int);
+      stored = stored && putArg(record, &v, sizeof(v));
+    }
+    else if (isFloatConversion(c))
+    {
+      const double v = (spec.length == 'D') ? (double)va_arg(args, long double) : va_arg(args, double);
+      stored = stored && putArg(record, &v, sizeof(v));
+    }
+    else if (c == 's')
+    {
+      const char *str = va_arg(args, const char *);
+      if (str == nullptr)
+      {
+        str = "(null)";
+      }
+      // Truncate to the space left (at least the terminator must fit)
+      const size_t room = kLogArgBytes - record.argBytes;
+      size_t len = strlen(str);
+      if (len + 1 > room)
+      {
+        len = room > 0 ? room - 1 : 0;
+      }
+      stored = stored && room > 0;
+      if (stored)
+      {
+        memcpy(record.args + record.argBytes, str, len);
+        record.args[record.argBytes + len] = '\0';
+        record.argBytes += (uint8_t)(len + 1);
+      }
+    }
+    else if (c == 'p')
+    {
+      const uintptr_t v = (uintptr_t)va_arg(args, void *);
+      stored = stored && putArg(record, &v, sizeof(v));
+    }
+    else if (c == 'n')
+    {
+      (void)va_arg(args, void *); // Never written back
+    }
+    else
+    {
+      stored = false; // Unknown conversion: the argument types after it are unknown
+    }
+
+    if (!stored)
+    {
+      return;
+    }
+    record.argCount++;
+  }
+}
 
-void bufferLogForSD(const char *formattedLog)
+template <typename T>
+int formatValue(char *out, size_t size, const char *spec, const int *stars, uint8_t starCount, T value)
 {
-  if (g_logBufferIndex < kMaxLogEntries)
+  switch (starCount)
   {
-    strncpy(g_logBuffer[g_logBufferIndex].message, formattedLog, kMaxLogLineLength - 1);
-    g_logBuffer[g_logBufferIndex].message[kMaxLogLineLength - 1] = '\0';
-    g_logBuffer[g_logBufferIndex].used = true;
-    g_logBufferIndex++;
+  case 0:
+    return snprintf(out, size, spec, value);
+  case 1:
+    return snprintf(out, size, spec, stars[0], value);
+  default:
+    return snprintf(out, size, spec, stars[0], stars[1], value);
   }
-  // If buffer is full, oldest logs are lost (ring buffer would add complexity)
+}
+
+// Render a record's message (the part after the tag)
+void renderMessage(const LogRecord &record, char *out, size_t outSize)
+{
+  size_t used = 0;
+  size_t argOffset = 0;
+  uint8_t argIndex = 0;
+  auto append = [&](const char *text, size_t len) {
+    const size_t room = outSize - 1 - used;
+    if (len > room)
+    {
+      len = room;
+    }
+    memcpy(out + used, text, len);
+    used += len;
+  };
+  auto readArg = [&](void *value, size_t size) {
+    memcpy(value, record.args + argOffset, size);
+    argOffset += size;
+  };
+
+  for (const char *p = record.format; *p != '\0' && used < outSize - 1;)
+  {
+    if (*p != '%')
+    {
+      const char *next = strchr(p, '%');
+      const size_t len = next != nullptr ? (size_t)(next - p) : strlen(p);
+      append(p, len);
+      p += len;
+      continue;
+    }
+
+    FormatSpec spec;
+    p = parseSpec(p, spec);
+    const char c = spec.conversion;
+    if (c == '%')
+    {
+      append("%", 1);
+      continue;
+    }
+    if (c == 'n')
+    {
+      argIndex++;
+      continue;
+    }
+    if (argIndex >= record.argCount)
+    {
+      append("?", 1);
+      continue;
+    }
+    argIndex++;
+
+    int stars[2] = {0, 0};
+    for (uint8_t i = 0; i < spec.stars && i < 2; i++)
+    {
+      readArg(&stars[i], sizeof(stars[i]));
+    }
+
+    // Rebuild the conversion with the width of the stored value
+    char specText[24];
+    size_t prefix = spec.prefixLength < sizeof(specText) - 4 ? spec.prefixLength : sizeof(specText) - 4;
+    memcpy(specText, spec.text, prefix);
+    char value[64];
+    int n = 0;
+    if (isSignedConversion(c) || isUnsignedConversion(c))
+    {
+      specText[prefix++] = 'l';
+      specText[prefix++] = 'l';
+      specText[prefix++] = c;
+      specText[prefix] = '\0';
+      const bool wide = intArgSize(spec) == 8;
+      if (isSignedConversion(c))
+      {
+        int64_t v;
+        if (wide)
+        {
+          readArg(&v, sizeof(v));
+        }
+        else
+        {
+          int32_t narrow;
+          readArg(&narrow, sizeof(narrow));
+          v = narrow;
+        }
+        n = formatValue(value, sizeof(value), specText, stars, spec.stars, (long long)v);
+      }
+      else
+      {
+        uint64_t v;
+        if (wide)
+        {
+          readArg(&v, sizeof(v));
+        }
+        else
+        {
+          uint32_t narrow;
+          readArg(&narrow, sizeof(narrow));
+          v = narrow;
+        }
+        n = formatValue(value, sizeof(value), specText, stars, spec.stars, (unsigned long long)v);
+      }
+    }
+    else
+    {
+      specText[prefix++] = c;
+      specText[prefix] = '\0';
+      if (c == 'c')
+      {
+        char v;
+        readArg(&v, sizeof(v));
+        n = formatValue(value, sizeof(value), specText, stars, spec.stars, (int)v);
+      }
+      else if (isFloatConversion(c))
+      {
+        double v;
+        readArg(&v, sizeof(v));
+        n = formatValue(value, sizeof(value), specText, stars, spec.stars, v);
+      }
+      else if (c == 'p')
+      {
+        uintptr_t v;
+        readArg(&v, sizeof(v));
+        n = formatValue(value, sizeof(value), specText, stars, spec.stars, (void *)v);
+      }
+      else // 's'
+      {
+        const char *str = reinterpret_cast<const char *>(record.args + argOffset);
+        argOffset += strlen(str) + 1;
+        n = formatValue(value, sizeof(value), specText, stars, spec.stars, str);
+      }
+    }
+    if (n > 0)
+    {
+      append(value, (size_t)n < sizeof(value) ? (size_t)n : sizeof(value) - 1);
+    }
+  }
+  out[used] = '\0';
+}
+
+void bufferLogForSD(LogLevel level, const char *tag, const char *format, va_list args)
+{
+  LogRecord record;
+  record.format = format;
+  const time_t now = time(nullptr);
+  record.unixTime = now >= kMinValidUnixTime ? (uint32_t)now : 0;
+  record.bootMs = (uint32_t)millis();
+  record.level = (uint8_t)level;
+  captureArgs(record, format, args);
+
+  portENTER_CRITICAL(&g_logBufferMux);
+  record.tagId = tagIdLocked(tag);
+  size_t slot;
+  if (g_logRingCount < kMaxLogEntries)
+  {
+    slot = (g_logRingHead + g_logRingCount) % kMaxLogEntries;
+    g_logRingCount++;
+  }
+  else
+  {
+    // Full: overwrite the oldest record
+    slot = g_logRingHead;
+    g_logRingHead = (g_logRingHead + 1) % kMaxLogEntries;
+    g_logDropped++;
+  }
+  memcpy(&g_logRing[slot], &record, sizeof(record));
+  portEXIT_CRITICAL(&g_logBufferMux);
+}
+
+// Put back a drop count that could not be written
+void restoreDropped(uint32_t dropped)
+{
+  portENTER_CRITICAL(&g_logBufferMux);
+  g_logDropped += dropped;
+  portEXIT_CRITICAL(&g_logBufferMux);
 }
 
 const char *getLevelString(LogLevel level)
@@ -113,50 +596,49 @@ void formatDateTime(char *buffer, size_t bufferSize)
            ms);
 }
 
-void printTimestamp()
+// Appends the serial timestamp to buffer; returns its length
+size_t formatTimestamp(char *buffer, size_t bufferSize)
 {
   char bootTimeBuffer[32];
   char dateTimeBuffer[32];
+  int n = 0;
 
+  formatBootTime(bootTimeBuffer, sizeof(bootTimeBuffer));
   switch (g_config.timestampMode)
   {
   case TimestampMode::BOOT_TIME:
-    formatBootTime(bootTimeBuffer, sizeof(bootTimeBuffer));
-    Serial.print("[");
-    Serial.print(bootTimeBuffer);
-    Serial.print("]");
+    n = snprintf(buffer, bufferSize, "[%s]", bootTimeBuffer);
     break;
 
   case TimestampMode::DATE_TIME:
     if (g_config.ntpSynced)
     {
       formatDateTime(dateTimeBuffer, sizeof(dateTimeBuffer));
-      Serial.print("[");
-      Serial.print(dateTimeBuffer);
-      Serial.print("]");
+      n = snprintf(buffer, bufferSize, "[%s]", dateTimeBuffer);
     }
     else
     {
-      formatBootTime(bootTimeBuffer, sizeof(bootTimeBuffer));
-      Serial.print("[");
-      Serial.print(bootTimeBuffer);
-      Serial.print("]");
+      n = snprintf(buffer, bufferSize, "[%s]", bootTimeBuffer);
     }
     break;
 
   case TimestampMode::BOTH:
-    formatBootTime(bootTimeBuffer, sizeof(bootTimeBuffer));
-    Serial.print("[");
-    Serial.print(bootTimeBuffer);
     if (g_config.ntpSynced)
     {
       formatDateTime(dateTimeBuffer, sizeof(dateTimeBuffer));
-      Serial.print(" | ");
-      Serial.print(dateTimeBuffer);
+      n = snprintf(buffer, bufferSize, "[%s | %s]", bootTimeBuffer, dateTimeBuffer);
+    }
+    else
+    {
+      n = snprintf(buffer, bufferSize, "[%s]", bootTimeBuffer);
     }
-    Serial.print("]");
     break;
   }
+  if (n < 0)
+  {
+    return 0;
+  }
+  return (size_t)n < bufferSize ? (size_t)n : bufferSize - 1;
 }
 
 } // namespace
@@ -167,6 +649,11 @@ void Logger_Init(LogLevel minLevel, TimestampMode timestampMode)
   g_config.timestampMode = timestampMode;
   g_config.enableColors = true;
   g_config.ntpSynced = false;
+#if LOG_DETECT_USB_HOST
+  g_usbHost = UsbHostState::Unknown;
+  g_usbProbeStartUs = micros();
+  g_usbProbeFrame = USB_SERIAL_JTAG.fram_num.sof_frame_index;
+#endif
 }
 
 void Logger_SetMinLevel(LogLevel level)
@@ -184,6 +671,27 @@ void Logger_SetNtpSynced(bool synced)
   g_config.ntpSynced = synced;
 }
 
+bool Logger_SerialEnabled()
+{
+#if LOG_HEADLESS == 1
+  return false;
+#elif LOG_DETECT_USB_HOST
+  if (g_usbHost == UsbHostState::Unknown)
+  {
+    // Lines logged before the probe window ends are still printed
+    if (micros() - g_usbProbeStartUs < kUsbHostProbeUs)
+    {
+      return true;
+    }
+    g_usbHost = USB_SERIAL_JTAG.fram_num.sof_frame_index != g_usbProbeFrame ? UsbHostState::Attached
+                                                                         : UsbHostState::Detached;
+  }
+  return g_usbHost == UsbHostState::Attached;
+#else
+  return true;
+#endif
+}
+
 void Logger_Log(LogLevel level, const char *tag, const char *format, ...)
 {
   // Check if log level is enabled
@@ -191,85 +699,80 @@ void Logger_Log(LogLevel level, const char *tag, const char *format, ...)
   {
     return;
   }
+  const bool toSerial = Logger_SerialEnabled();
+  if (!toSerial && level < LogLevel::WARN)
+  {
+    return;
+  }
 
-  // Format the user message first
   va_list args;
   va_start(args, format);
-  char messageBuffer[256];
-  vsnprintf(messageBuffer, sizeof(messageBuffer), format, args);
-  va_end(args);
-
-  // Print timestamp
-  printTimestamp();
-
-  // Print level with color
-  Serial.print(" ");
-  Serial.print(getLevelColor(level));
-  Serial.print("[");
-  Serial.print(getLevelString(level));
-  Serial.print("]");
-  Serial.print(getResetColor());
 
-  // Print tag
-  Serial.print(" [");
-  Serial.print(tag);
-  Serial.print("]");
+  // Buffer ERROR and WARN logs for SD card (rendered at flush time)
+  if (level >= LogLevel::WARN)
+  {
+    va_list sdArgs;
+    va_copy(sdArgs, args);
+    bufferLogForSD(level, tag, format, sdArgs);
+    va_end(sdArgs);
+  }
 
-  // Print message
-  Serial.print(" ");
-  Serial.print(messageBuffer);
-  Serial.println();
+  if (!toSerial)
+  {
+    va_end(args);
+    return;
+  }
 
-  // Buffer ERROR and WARN logs for SD card
-  if (level >= LogLevel::WARN)
+  // Assemble the whole line so it goes out in a single Serial.write
+  char line[kMaxSerialLineLength];
+  size_t used = formatTimestamp(line, sizeof(line));
+  const int header = snprintf(line + used, sizeof(line) - used, " %s[%s]%s [%s] ",
+                              getLevelColor(level), getLevelString(level), getResetColor(), tag);
+  if (header > 0)
   {
-    char logLine[kMaxLogLineLength];
-    char timestampBuffer[64];
-
-    // Format timestamp for SD log (no colors)
-    // Try to get actual date/time first (works if RTC time was restored from deep sleep)
-    struct tm timeinfo;
-    if (getLocalTime(&timeinfo))
-    {
-      char bootTimeBuffer[16];
-      formatBootTime(bootTimeBuffer, sizeof(bootTimeBuffer));
-      // Include both datetime and boot time for correlation
-      snprintf(timestampBuffer, sizeof(timestampBuffer), "%04d-%02d-%02d %02d:%02d:%02d (%s)",
-               timeinfo.tm_year + 1900,
-               timeinfo.tm_mon + 1,
-               timeinfo.tm_mday,
-               timeinfo.tm_hour,
-               timeinfo.tm_min,
-               timeinfo.tm_sec,
-               bootTimeBuffer);
-    }
-    else
+    used += (size_t)header;
+  }
+  // Leave room for "\r\n"
+  if (used < sizeof(line) - 2)
+  {
+    const int n = vsnprintf(line + used, sizeof(line) - 2 - used, format, args);
+    if (n > 0)
     {
-      formatBootTime(timestampBuffer, sizeof(timestampBuffer));
+      used += (size_t)n;
     }
-
-    snprintf(logLine, sizeof(logLine), "[%s] [%s] [%s] %s",
-             timestampBuffer,
-             getLevelString(level),
-             tag,
-             messageBuffer);
-
-    bufferLogForSD(logLine);
   }
+  va_end(args);
+  if (used > sizeof(line) - 3)
+  {
+    used = sizeof(line) - 3; // Message was truncated
+  }
+  line[used++] = '\r';
+  line[used++] = '\n';
+  Serial.write(reinterpret_cast<const uint8_t *>(line), used);
 }
 
 int Logger_FlushToSD()
 {
-  // Check if there are any logs to write
-  if (g_logBufferIndex == 0)
+  // Check if there are any logs to write; the drop count is taken with the ring state it
+  // belongs to (records dropped during the drain are reported by the next flush)
+  portENTER_CRITICAL(&g_logBufferMux);
+  const bool empty = g_logRingCount == 0 && g_logDropped == 0;
+  const uint32_t dropped = g_logDropped;
+  g_logDropped = 0;
+  portEXIT_CRITICAL(&g_logBufferMux);
+  if (empty)
   {
     return 0;
   }
 
-  // Check if SD card is available
-  if (!SD.exists("/"))
+  // Mounts the SD card if nothing else used it this boot
+  if (StorageManager_Mount() != StorageMedium::Sd)
   {
-    Serial.println("[Logger] SD card not available, cannot flush logs");
+    if (Logger_SerialEnabled())
+    {
+      Serial.println("[Logger] SD card not available, cannot flush logs");
+    }
+    restoreDropped(dropped);
     return -1;
   }
 
@@ -278,15 +781,20 @@ int Logger_FlushToSD()
   {
     if (!SD.mkdir(kLogDirectory))
     {
-      Serial.println("[Logger] Failed to create log directory");
+      if (Logger_SerialEnabled())
+      {
+        Serial.println("[Logger] Failed to create log directory");
+      }
+      restoreDropped(dropped);
       return -1;
     }
   }
 
   // Generate filename with current date
   char filename[64];
+  const time_t now = time(nullptr);
   struct tm timeinfo;
-  if (getLocalTime(&timeinfo))
+  if (now >= kMinValidUnixTime && localtime_r(&now, &timeinfo) != nullptr)
   {
     snprintf(filename, sizeof(filename), "%s/error_%04d%02d%02d.log",
              kLogDirectory,
@@ -304,27 +812,74 @@ int Logger_FlushToSD()
   File file = SD.open(filename, FILE_APPEND);
   if (!file)
   {
-    Serial.printf("[Logger] Failed to open log file: %s\n", filename);
+    if (Logger_SerialEnabled())
+    {
+      Serial.printf("[Logger] Failed to open log file: %s\n", filename);
+    }
+    restoreDropped(dropped);
     return -1;
   }
 
-  // Write all buffered logs
+  if (dropped > 0)
+  {
+    // Overwritten records preceded everything still in the ring
+    file.printf("[%lums] [WARN] [Logger] %lu log entries dropped (buffer full)\n",
+                (unsigned long)millis(), (unsigned long)dropped);
+  }
+
+  // Records are taken one at a time, so the other core can keep logging meanwhile
   int written = 0;
-  for (size_t i = 0; i < g_logBufferIndex; i++)
+  char line[kMaxLogLineLength];
+  char message[kMaxLogLineLength];
+  char timestampBuffer[48];
+  LogRecord record;
+  for (;;)
   {
-    if (g_logBuffer[i].used)
+    const char *tag = "?";
+    portENTER_CRITICAL(&g_logBufferMux);
+    const bool haveRecord = g_logRingCount > 0;
+    if (haveRecord)
+    {
+      memcpy(&record, &g_logRing[g_logRingHead], sizeof(record));
+      g_logRingHead = (g_logRingHead + 1) % kMaxLogEntries;
+      g_logRingCount--;
+      if (record.tagId < g_logTagCount)
+      {
+        tag = g_logTags[record.tagId];
+      }
+    }
+    portEXIT_CRITICAL(&g_logBufferMux);
+
+    if (!haveRecord)
+    {
+      break;
+    }
+
+    // Include both datetime and boot time for correlation when the clock was set
+    if (record.unixTime != 0)
     {
-      file.println(g_logBuffer[i].message);
-      g_logBuffer[i].used = false;
-      written++;
+      const time_t t = (time_t)record.unixTime;
+      localtime_r(&t, &timeinfo);
+      snprintf(timestampBuffer, sizeof(timestampBuffer), "%04d-%02d-%02d %02d:%02d:%02d (%lums)",
+               timeinfo.tm_year + 1900, timeinfo.tm_mon + 1, timeinfo.tm_mday,
+               timeinfo.tm_hour, timeinfo.tm_min, timeinfo.tm_sec, (unsigned long)record.bootMs);
     }
+    else
+    {
+      snprintf(timestampBuffer, sizeof(timestampBuffer), "%lums", (unsigned long)record.bootMs);
+    }
+    renderMessage(record, message, sizeof(message));
+    snprintf(line, sizeof(line), "[%s] [%s] [%s] %s",
+             timestampBuffer, getLevelString((LogLevel)record.level), tag, message);
+    file.println(line);
+    written++;
   }
 
   file.close();
 
-  // Clear buffer
-  g_logBufferIndex = 0;
-
-  Serial.printf("[Logger] Flushed %d log entries to %s\n", written, filename);
+  if (Logger_SerialEnabled())
+  {
+    Serial.printf("[Logger] Flushed %d log entries to %s\n", written, filename);
+  }
   return written;
 }
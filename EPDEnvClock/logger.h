@@ -22,6 +22,7 @@ namespace LogTag
   constexpr const char *DISPLAY_MGR = "Display";  // DISPLAY conflicts with Arduino.h macro
   constexpr const char *FONT = "Font";
   constexpr const char *DEEPSLEEP = "DeepSleep";
+  constexpr const char *STORAGE = "Storage";
   constexpr const char *IMAGEBW = "ImageBW";
 }
 
@@ -57,6 +58,9 @@ void Logger_SetNtpSynced(bool synced);
 // Log functions
 void Logger_Log(LogLevel level, const char *tag, const char *format, ...);
 
+// Whether log lines are written to Serial (false in headless builds or with no USB host)
+bool Logger_SerialEnabled();
+
 // Flush buffered ERROR/WARN logs to SD card
 // Call this before deep sleep to persist error logs
 // Returns number of log entries written, or -1 on error
@@ -73,6 +77,19 @@ int Logger_FlushToSD();
 #define LOG_MIN_LEVEL 0  // 0=DEBUG, 1=INFO, 2=WARN, 3=ERROR
 #endif
 
+// Serial output mode
+// 0: always write log lines to Serial
+// 1: headless build - no serial output; DEBUG/INFO compile out and WARN/ERROR only go to the SD ring
+// 2: write to Serial only while a USB host is attached (native USB CDC builds; otherwise same as 0)
+#ifndef LOG_HEADLESS
+#define LOG_HEADLESS 0
+#endif
+
+#if LOG_HEADLESS == 1 && LOG_MIN_LEVEL < 2
+#undef LOG_MIN_LEVEL
+#define LOG_MIN_LEVEL 2  // DEBUG/INFO are serial-only
+#endif
+
 #if LOG_MIN_LEVEL <= 0
 #define LOGD(tag, ...) LOG_DEBUG(tag, __VA_ARGS__)
 #else
@@ -1,19 +1,59 @@
 #include "network_manager.h"
 
 #include <WiFi.h>
-#include <WiFiUdp.h>
 #include <time.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/event_groups.h>
+#include <lwip/dns.h>
+#include <lwip/sockets.h>
 #include <esp_timer.h>
+#include <ping/ping_sock.h>
 #include <sys/time.h>
 
 #include "wifi_config.h"
 #include "server_config.h"
 #include "logger.h"
 #include "deep_sleep_manager.h"
-#include <HTTPClient.h>
+#include "boot_profiler.h"
+#include <WiFiClientSecure.h>
 
 namespace
 {
+// Body bytes per HTTP chunk; the whole upload buffers at most this much
+constexpr size_t kUploadChunkSize = 1024;
+// "XXXX\r\n" chunk-size line (zero-padded hex) in front of the chunk data
+constexpr size_t kChunkHeaderSize = 6;
+// Read/connect timeout (WiFiClient::setTimeout takes seconds on ESP32)
+constexpr uint32_t kUploadTimeoutSec = 10;
+// Reply body kept for the debug log; without a Content-Length only what has already arrived
+// within this long is read, so the radio does not wait out kUploadTimeoutSec
+constexpr size_t kResponseLogBytes = 127;
+constexpr unsigned long kResponseDrainMs = 200;
+
+// WiFi connect
+// Fast path: join the cached BSSID on its channel (no scan), reusing the last lease (no DHCP)
+constexpr unsigned long kFastConnectTimeoutMs = 3000;
+// Full scan + DHCP, same total as the old 20 x 500 ms loop
+constexpr unsigned long kFullConnectTimeoutMs = 10000;
+constexpr unsigned long kConnectStatusIntervalMs = 2000;
+// Renew the lease through DHCP after this long, even if the fast path works
+constexpr time_t kLeaseReuseMaxSec = 12 * 60 * 60;
+// A reused lease is not confirmed by DHCP; one ping to its gateway must answer within this
+constexpr uint32_t kLeaseProbeTimeoutMs = 500;
+// Lease ages are only measured on a synced clock
+constexpr time_t kMinValidTime = 1577836800; // 2020-01-01 00:00:00 UTC
+
+// State of the streaming batch upload between Begin and End
+struct BatchUpload
+{
+  WiFiClient *client = nullptr;
+  bool failed = false;
+  size_t used = 0;      // Body bytes buffered for the current chunk
+  size_t bodyBytes = 0; // Body bytes sent so far
+  char buffer[kChunkHeaderSize + kUploadChunkSize + 2];
+};
+BatchUpload batchUpload;
+
 void updateStatus(StatusCallback callback, const char *message)
 {
   if (callback != nullptr)
@@ -21,6 +61,330 @@ void updateStatus(StatusCallback callback, const char *message)
     callback(message);
   }
 }
+
+// Split "http[s]://host[:port]/path" (path defaults to "/")
+bool parseUrl(const String &url, bool &https, String &host, uint16_t &port, String &path)
+{
+  int hostStart;
+  if (url.startsWith("https://"))
+  {
+    https = true;
+    port = 443;
+    hostStart = 8;
+  }
+  else if (url.startsWith("http://"))
+  {
+    https = false;
+    port = 80;
+    hostStart = 7;
+  }
+  else
+  {
+    return false;
+  }
+
+  int pathStart = url.indexOf('/', hostStart);
+  if (pathStart < 0)
+  {
+    pathStart = url.length();
+  }
+  host = url.substring(hostStart, pathStart);
+  path = pathStart < (int)url.length() ? url.substring(pathStart) : String("/");
+
+  const int colon = host.indexOf(':');
+  if (colon >= 0)
+  {
+    port = (uint16_t)host.substring(colon + 1).toInt();
+    host = host.substring(0, colon);
+  }
+  return host.length() > 0 && port != 0;
+}
+
+// One client per transport, kept for the whole boot (no per-upload allocation)
+WiFiClient &uploadClient(bool https)
+{
+  static WiFiClient plainClient;
+  static WiFiClientSecure secureClient;
+  if (!https)
+  {
+    return plainClient;
+  }
+  // Same as HTTPClient without a CA certificate
+  secureClient.setInsecure();
+  return secureClient;
+}
+
+// SENSOR_DEVICE_ID, or "epd-" + the factory MAC (first octet in the low byte of the eFuse value)
+const char *deviceId()
+{
+  if (sizeof(SENSOR_DEVICE_ID) > 1)
+  {
+    return SENSOR_DEVICE_ID;
+  }
+  static char macId[17] = "";
+  if (macId[0] == '\0')
+  {
+    const uint64_t mac = ESP.getEfuseMac();
+    snprintf(macId, sizeof(macId), "epd-%02x%02x%02x%02x%02x%02x", (unsigned)(mac & 0xFF), (unsigned)((mac >> 8) & 0xFF),
+             (unsigned)((mac >> 16) & 0xFF), (unsigned)((mac >> 24) & 0xFF), (unsigned)((mac >> 32) & 0xFF),
+             (unsigned)((mac >> 40) & 0xFF));
+  }
+  return macId;
+}
+
+// Send the buffered body bytes as one chunk (header, data and CRLF in a single write)
+bool flushChunk(BatchUpload &upload)
+{
+  if (upload.used == 0)
+  {
+    return true;
+  }
+  char sizeLine[kChunkHeaderSize + 1];
+  snprintf(sizeLine, sizeof(sizeLine), "%04X\r\n", (unsigned)upload.used);
+  memcpy(upload.buffer, sizeLine, kChunkHeaderSize);
+  upload.buffer[kChunkHeaderSize + upload.used] = '\r';
+  upload.buffer[kChunkHeaderSize + upload.used + 1] = '\n';
+
+  const size_t total = kChunkHeaderSize + upload.used + 2;
+  if (upload.client->write(reinterpret_cast<const uint8_t *>(upload.buffer), total) != total)
+  {
+    upload.failed = true;
+    return false;
+  }
+  upload.bodyBytes += upload.used;
+  upload.used = 0;
+  return true;
+}
+} // namespace
+
+namespace
+{
+// Set by the WiFi event task; the connecting task blocks on them instead of polling
+constexpr EventBits_t kWifiGotIpBit = (1 << 0);
+constexpr EventBits_t kWifiDisconnectedBit = (1 << 1);
+// Set by the ping task while probing the gateway of a reused lease
+constexpr EventBits_t kGatewayReplyBit = (1 << 2);
+constexpr EventBits_t kGatewayProbeEndBit = (1 << 3);
+EventGroupHandle_t wifiEvents = nullptr;
+volatile uint8_t lastDisconnectReason = 0;
+
+void onWifiEvent(arduino_event_id_t event, arduino_event_info_t info)
+{
+  if (event == ARDUINO_EVENT_WIFI_STA_GOT_IP)
+  {
+    xEventGroupSetBits(wifiEvents, kWifiGotIpBit);
+  }
+  else if (event == ARDUINO_EVENT_WIFI_STA_DISCONNECTED)
+  {
+    lastDisconnectReason = info.wifi_sta_disconnected.reason;
+    xEventGroupSetBits(wifiEvents, kWifiDisconnectedBit);
+  }
+}
+
+bool initWifiEvents()
+{
+  if (wifiEvents != nullptr)
+  {
+    return true;
+  }
+  wifiEvents = xEventGroupCreate();
+  if (wifiEvents == nullptr)
+  {
+    return false;
+  }
+  WiFi.onEvent(onWifiEvent, ARDUINO_EVENT_WIFI_STA_GOT_IP);
+  WiFi.onEvent(onWifiEvent, ARDUINO_EVENT_WIFI_STA_DISCONNECTED);
+  return true;
+}
+
+uint32_t fnv1a(const char *text)
+{
+  uint32_t hash = 2166136261u;
+  for (; *text != '\0'; text++)
+  {
+    hash = (hash ^ (uint8_t)*text) * 16777619u;
+  }
+  return hash;
+}
+
+// True once NTP has set the clock at least once (the RTC keeps it across deep sleep)
+bool clockSynced(time_t now)
+{
+  return now >= kMinValidTime && DeepSleepManager_GetRTCState().lastNtpSyncTime != 0;
+}
+
+bool wifiCacheValid(const WifiConnectCache &cache)
+{
+  return cache.magic == kWifiCacheMagic && cache.ssidHash == fnv1a(WIFI_SSID) && cache.channel != 0;
+}
+
+// Static IP from wifi_config.h, else the cached lease if it is recent enough
+// Returns false to use DHCP
+bool selectIpConfig(const WifiConnectCache &cache, bool useCache, IPAddress &ip, IPAddress &gateway,
+                    IPAddress &subnet, IPAddress &dns)
+{
+#if defined(WIFI_STATIC_IP) && defined(WIFI_GATEWAY) && defined(WIFI_SUBNET)
+  (void)cache;
+  (void)useCache;
+  ip.fromString(WIFI_STATIC_IP);
+  gateway.fromString(WIFI_GATEWAY);
+  subnet.fromString(WIFI_SUBNET);
+#ifdef WIFI_DNS
+  dns.fromString(WIFI_DNS);
+#else
+  dns = gateway;
+#endif
+  return true;
+#else
+  const time_t now = time(nullptr);
+  if (!useCache || cache.ip == 0 || !clockSynced(now) || now < cache.leaseTime ||
+      now - cache.leaseTime > kLeaseReuseMaxSec)
+  {
+    return false;
+  }
+  ip = IPAddress(cache.ip);
+  gateway = IPAddress(cache.gateway);
+  subnet = IPAddress(cache.subnet);
+  dns = IPAddress(cache.dns != 0 ? cache.dns : cache.gateway);
+  return true;
+#endif
+}
+
+// Start a connect attempt; fast uses the cached AP (and lease)
+// Returns true if a static/cached IP configuration was applied
+bool beginConnect(const WifiConnectCache &cache, bool fast)
+{
+  IPAddress ip, gateway, subnet, dns;
+  const bool staticIp = selectIpConfig(cache, fast, ip, gateway, subnet, dns);
+  if (staticIp)
+  {
+    WiFi.config(ip, gateway, subnet, dns);
+  }
+  else
+  {
+    WiFi.config(INADDR_NONE, INADDR_NONE, INADDR_NONE); // DHCP
+  }
+
+  xEventGroupClearBits(wifiEvents, kWifiGotIpBit | kWifiDisconnectedBit);
+  if (fast)
+  {
+    WiFi.begin(WIFI_SSID, WIFI_PASSWORD, cache.channel, cache.bssid, true);
+  }
+  else
+  {
+    WiFi.begin(WIFI_SSID, WIFI_PASSWORD);
+  }
+  return staticIp;
+}
+
+// Block until an IP is assigned or timeoutMs elapsed since startTime
+// stopOnDisconnect: also give up on the first disconnect event (fast path: wrong channel/AP)
+bool waitForConnect(unsigned long startTime, unsigned long timeoutMs, bool stopOnDisconnect,
+                    StatusCallback statusCallback)
+{
+  const EventBits_t waitBits = kWifiGotIpBit | (stopOnDisconnect ? kWifiDisconnectedBit : 0);
+  unsigned long nextStatus = kConnectStatusIntervalMs;
+  for (;;)
+  {
+    const unsigned long elapsed = millis() - startTime;
+    if (elapsed >= timeoutMs)
+    {
+      return WiFi.status() == WL_CONNECTED;
+    }
+    // Wake for the status message at most every kConnectStatusIntervalMs
+    unsigned long waitMs = timeoutMs - elapsed;
+    if (statusCallback != nullptr && nextStatus > elapsed && nextStatus - elapsed < waitMs)
+    {
+      waitMs = nextStatus - elapsed;
+    }
+    const EventBits_t bits = xEventGroupWaitBits(wifiEvents, waitBits, pdTRUE, pdFALSE, pdMS_TO_TICKS(waitMs));
+    if (bits & kWifiGotIpBit)
+    {
+      return true;
+    }
+    if (bits & kWifiDisconnectedBit)
+    {
+      LOGD(LogTag::NETWORK, "Wi-Fi disconnected while connecting (reason %u)", (unsigned)lastDisconnectReason);
+      return false;
+    }
+    if (millis() - startTime >= nextStatus)
+    {
+      char statusMsg[48];
+      snprintf(statusMsg, sizeof(statusMsg), "WiFi connecting... %lums", millis() - startTime);
+      updateStatus(statusCallback, statusMsg);
+      nextStatus += kConnectStatusIntervalMs;
+    }
+  }
+}
+
+void onGatewayReply(esp_ping_handle_t, void *)
+{
+  xEventGroupSetBits(wifiEvents, kGatewayReplyBit);
+}
+
+void onGatewayProbeEnd(esp_ping_handle_t, void *)
+{
+  xEventGroupSetBits(wifiEvents, kGatewayProbeEndBit);
+}
+
+// Send one ping to the gateway: the first packet over a reused lease shows whether the
+// network still routes it (a dead lease then renews at once instead of timing out later)
+bool gatewayAnswers(const IPAddress &gateway)
+{
+  esp_ping_config_t config = ESP_PING_DEFAULT_CONFIG();
+  IP_ADDR4(&config.target_addr, gateway[0], gateway[1], gateway[2], gateway[3]);
+  config.count = 1;
+  config.timeout_ms = kLeaseProbeTimeoutMs;
+  esp_ping_callbacks_t callbacks = {};
+  callbacks.on_ping_success = onGatewayReply;
+  callbacks.on_ping_end = onGatewayProbeEnd;
+
+  esp_ping_handle_t ping;
+  if (esp_ping_new_session(&config, &callbacks, &ping) != ESP_OK)
+  {
+    LOGW(LogTag::NETWORK, "Gateway probe unavailable, keeping the cached lease");
+    return true;
+  }
+  xEventGroupClearBits(wifiEvents, kGatewayReplyBit | kGatewayProbeEndBit);
+  esp_ping_start(ping);
+  const EventBits_t bits =
+      xEventGroupWaitBits(wifiEvents, kGatewayProbeEndBit, pdTRUE, pdFALSE, pdMS_TO_TICKS(2 * kLeaseProbeTimeoutMs));
+  esp_ping_stop(ping);
+  esp_ping_delete_session(ping);
+  return (bits & kGatewayReplyBit) != 0;
+}
+
+// Remember the AP, and the lease when it came from DHCP
+void updateWifiCache(WifiConnectCache &cache, bool staticIp)
+{
+  const uint8_t *bssid = WiFi.BSSID();
+  if (bssid == nullptr)
+  {
+    cache.magic = 0;
+    return;
+  }
+  const bool sameAp = wifiCacheValid(cache) && memcmp(cache.bssid, bssid, sizeof(cache.bssid)) == 0;
+  cache.magic = kWifiCacheMagic;
+  cache.ssidHash = fnv1a(WIFI_SSID);
+  memcpy(cache.bssid, bssid, sizeof(cache.bssid));
+  cache.channel = (uint8_t)WiFi.channel();
+  if (!staticIp)
+  {
+    cache.ip = (uint32_t)WiFi.localIP();
+    cache.gateway = (uint32_t)WiFi.gatewayIP();
+    cache.subnet = (uint32_t)WiFi.subnetMask();
+    cache.dns = (uint32_t)WiFi.dnsIP(0);
+    cache.leaseTime = time(nullptr);
+    if (!clockSynced(cache.leaseTime))
+    {
+      cache.ip = 0; // Its age could not be told on the next boot
+    }
+  }
+  else if (!sameAp)
+  {
+    cache.ip = 0; // A cached lease from another AP's network is not reused
+  }
+}
 } // namespace
 
 bool NetworkManager_ConnectWiFi(NetworkState &state, StatusCallback statusCallback)
@@ -30,38 +394,67 @@ bool NetworkManager_ConnectWiFi(NetworkState &state, StatusCallback statusCallba
   updateStatus(statusCallback, "Connecting WiFi...");
 
   const unsigned long startTime = millis();
+  WifiConnectCache &cache = DeepSleepManager_GetRTCState().wifiCache;
 
+  if (!initWifiEvents())
+  {
+    LOGE(LogTag::NETWORK, "Failed to create Wi-Fi event group");
+    return false;
+  }
   WiFi.mode(WIFI_STA);
-  WiFi.begin(WIFI_SSID, WIFI_PASSWORD);
+  BootProfiler_SetRadio(true);
 
-  int attempts = 0;
-  while (WiFi.status() != WL_CONNECTED && attempts < 20)
+  bool connected = false;
+  bool staticIp = false;
+  bool fastPath = wifiCacheValid(cache);
+  if (fastPath)
   {
-    delay(500);
-    LOGD(LogTag::NETWORK, ".");
-    attempts++;
-
-    if (attempts % 4 == 0)
+    LOGD(LogTag::NETWORK, "Wi-Fi fast path: channel %u, BSSID %02X:%02X:%02X:%02X:%02X:%02X",
+         (unsigned)cache.channel, cache.bssid[0], cache.bssid[1], cache.bssid[2], cache.bssid[3],
+         cache.bssid[4], cache.bssid[5]);
+    staticIp = beginConnect(cache, true);
+    connected = waitForConnect(startTime, kFastConnectTimeoutMs, true, statusCallback);
+#if !(defined(WIFI_STATIC_IP) && defined(WIFI_GATEWAY) && defined(WIFI_SUBNET))
+    if (connected && staticIp && !gatewayAnswers(IPAddress(cache.gateway)))
     {
-      char statusMsg[48];
-      snprintf(statusMsg, sizeof(statusMsg), "WiFi connecting... %d", attempts);
-      updateStatus(statusCallback, statusMsg);
+      // Lease expired or the network changed behind the same AP: ask DHCP on this association
+      LOGW(LogTag::NETWORK, "Cached lease got no gateway reply, renewing through DHCP");
+      cache.ip = 0;
+      staticIp = false;
+      xEventGroupClearBits(wifiEvents, kWifiGotIpBit);
+      WiFi.config(INADDR_NONE, INADDR_NONE, INADDR_NONE);
+      connected = waitForConnect(millis(), kFullConnectTimeoutMs, false, statusCallback);
     }
+#endif
+    if (!connected)
+    {
+      // AP moved channel, was replaced, or the lease is gone: forget it and scan
+      LOGW(LogTag::NETWORK, "Wi-Fi fast path failed after %lums, scanning", millis() - startTime);
+      cache.magic = 0;
+      fastPath = false;
+      WiFi.disconnect();
+    }
+  }
+  if (!connected)
+  {
+    staticIp = beginConnect(cache, false);
+    connected = waitForConnect(millis(), kFullConnectTimeoutMs, false, statusCallback);
   }
 
   const unsigned long connectionTime = millis() - startTime;
 
-  if (WiFi.status() == WL_CONNECTED)
+  if (connected)
   {
+    updateWifiCache(cache, staticIp);
     state.wifiConnected = true;
     state.wifiConnectTime = connectionTime;
-    LOGI(LogTag::NETWORK, "Wi-Fi connected! IP address: %s", WiFi.localIP().toString().c_str());
+    LOGI(LogTag::NETWORK, "Wi-Fi connected! IP address: %s (%s%s)", WiFi.localIP().toString().c_str(),
+         fastPath ? "cached AP" : "scan", staticIp ? ", static IP" : ", DHCP");
     LOGD(LogTag::NETWORK, "Wi-Fi connection time: %lu ms", connectionTime);
 
     char statusMsg[48];
     snprintf(statusMsg, sizeof(statusMsg), "WiFi OK! (%lums)", connectionTime);
     updateStatus(statusCallback, statusMsg);
-    delay(500);
     return true;
   }
 
@@ -71,13 +464,12 @@ bool NetworkManager_ConnectWiFi(NetworkState &state, StatusCallback statusCallba
   LOGD(LogTag::NETWORK, "Wi-Fi connection attempt time: %lu ms", connectionTime);
 
   updateStatus(statusCallback, "WiFi FAILED!");
-  delay(1000);
   return false;
 }
 
 namespace
 {
-  // NTP servers to try in order (Japan-optimized)
+  // NTP servers, queried at once (Japan-optimized)
   // 1. ntp.nict.jp - NICT (Japan's official time source)
   // 2. jp.pool.ntp.org - NTP Pool Japan zone (multiple servers)
   // 3. time.google.com - Google public NTP (global, highly reliable)
@@ -87,7 +479,30 @@ namespace
       "time.google.com"};
   constexpr size_t NTP_SERVER_COUNT = sizeof(NTP_SERVERS) / sizeof(NTP_SERVERS[0]);
   constexpr size_t NTP_PACKET_SIZE = 48;
+  constexpr uint16_t NTP_PORT = 123;
+  constexpr unsigned long NTP_TIMEOUT_MS = 2000;
+  constexpr unsigned long NTP_STATUS_INTERVAL_MS = 500;
+  // A reply this fast is accepted without waiting for the other servers
+  constexpr int64_t NTP_GOOD_RTT_US = 30000;
   constexpr uint32_t SEVENTY_YEARS = 2208988800UL; // 1970 - 1900 in seconds
+  // Uncached names are looked up at once; the query waits at most this long for them
+  // (a later answer still lands in the cache for the next sync)
+  constexpr unsigned long NTP_DNS_TIMEOUT_MS = 1500;
+  // wifiEvents bit of server i's lookup: NTP_DNS_FIRST_BIT << i
+  constexpr EventBits_t NTP_DNS_FIRST_BIT = (1 << 4);
+  static_assert(NTP_SERVER_COUNT <= 8, "NTP lookup bits overlap the event group's control bits");
+
+  // Resolved server addresses, kept in RTC memory so most syncs send without DNS
+  // Own magic: a cold boot resolves again. An entry is keyed by a hash of its server name
+  // and dropped when that server does not answer, so the next sync resolves it again.
+  constexpr uint32_t NTP_ADDRESS_CACHE_MAGIC = 0x4E545041; // "APTN" (little-endian)
+  struct NtpAddressCache
+  {
+    uint32_t magic;
+    uint32_t nameHash[NTP_SERVER_COUNT];
+    uint32_t address[NTP_SERVER_COUNT]; // IPv4, network byte order (0 = resolve)
+  };
+  RTC_DATA_ATTR NtpAddressCache ntpAddressCache;
 
   struct NtpQueryResult
   {
@@ -135,133 +550,286 @@ namespace
     return unixSec * 1000000LL + usec;
   }
 
-  // Try to get NTP response from a single server
-  // Returns true if successful, fills in NTP-derived corrected time + RTT/offset.
-  bool tryNtpServer(const char *server, NtpQueryResult &out, StatusCallback statusCallback)
+  // One outstanding request of a parallel query
+  struct NtpRequest
   {
-    // DNS resolution
-    LOGD(LogTag::NETWORK, "NTP: Resolving %s...", server);
-    IPAddress ntpServerIP;
-    if (!WiFi.hostByName(server, ntpServerIP))
+    const char *server = nullptr;
+    uint32_t address = 0;     // IPv4, network byte order (0 = DNS failed)
+    int64_t t1UnixUs = 0;     // Local transmit time
+    uint32_t t1NtpSec = 0;    // Transmit timestamp as sent (echoed back as Originate)
+    uint32_t t1NtpFrac = 0;
+    bool answered = false;
+  };
+
+  // Offset/RTT of one reply (t4UnixUs: local receive time)
+  // Returns false if the reply does not belong to request or carries no time
+  bool parseNtpReply(const byte *packet, const NtpRequest &request, int64_t t4UnixUs, NtpQueryResult &out)
+  {
+    // Originate (t1)  : bytes 24-31 (client transmit echoed by server)
+    // Receive (t2)    : bytes 32-39
+    // Transmit (t3)   : bytes 40-47
+    const uint8_t mode = packet[0] & 0x07;
+    const uint8_t stratum = packet[1];
+    if (mode != 4 || stratum == 0 || readU32BE(&packet[24]) != request.t1NtpSec ||
+        readU32BE(&packet[28]) != request.t1NtpFrac)
     {
-      LOGW(LogTag::NETWORK, "NTP: DNS resolution failed for %s", server);
-      return false;
+      return false; // Not a server reply, a kiss-o'-death, or an answer to another request
+    }
+    const int64_t t2UnixUs = ntpTimestampToUnixUs(readU32BE(&packet[32]), readU32BE(&packet[36]));
+    const int64_t t3UnixUs = ntpTimestampToUnixUs(readU32BE(&packet[40]), readU32BE(&packet[44]));
+
+    // Standard NTP offset/delay (assuming symmetric network delay)
+    // offset = ((t2 - t1) + (t3 - t4)) / 2
+    // delay  = (t4 - t1) - (t3 - t2)
+    out.offsetUs = ((t2UnixUs - request.t1UnixUs) + (t3UnixUs - t4UnixUs)) / 2;
+    out.rttUs = (t4UnixUs - request.t1UnixUs) - (t3UnixUs - t2UnixUs);
+    out.correctedUnixUsAtReceive = t4UnixUs + out.offsetUs;
+    LOGD(LogTag::NETWORK, "NTP: %s t2=%lld.%03lld, t3=%lld.%03lld, offset=%lldms, rtt=%lldms", request.server,
+         (long long)(t2UnixUs / 1000000LL), (long long)((t2UnixUs % 1000000LL) / 1000LL),
+         (long long)(t3UnixUs / 1000000LL), (long long)((t3UnixUs % 1000000LL) / 1000LL),
+         (long long)(out.offsetUs / 1000LL), (long long)(out.rttUs / 1000LL));
+    return true;
+  }
+
+  // lwIP DNS callback (tcpip task); arg is the server index
+  void onNtpServerResolved(const char *name, const ip_addr_t *ipaddr, void *arg)
+  {
+    (void)name;
+    const size_t index = (size_t)(uintptr_t)arg;
+    if (ipaddr != nullptr && IP_IS_V4(ipaddr))
+    {
+      ntpAddressCache.address[index] = ipaddr->u_addr.ip4.addr;
     }
-    LOGD(LogTag::NETWORK, "NTP: Resolved to %s", ntpServerIP.toString().c_str());
-
-    WiFiUDP udp;
-    byte packet[NTP_PACKET_SIZE] = {0};
-
-    // NTP request header: LI=0, Version=3, Mode=3 (client)
-    // (0x1B = 00 011 011)
-    packet[0] = 0x1B;
-
-    // Client transmit timestamp (t1) in request (bytes 40-47)
-    // Server will echo it back as Originate timestamp in response.
-    struct timeval tv1;
-    gettimeofday(&tv1, NULL);
-    const int64_t t1UnixUs = timevalToUnixUs(tv1);
-    const uint32_t t1NtpSec = (uint32_t)((uint64_t)tv1.tv_sec + (uint64_t)SEVENTY_YEARS);
-    const uint32_t t1NtpFrac = usecToNtpFrac((uint32_t)tv1.tv_usec);
-    writeU32BE(&packet[40], t1NtpSec);
-    writeU32BE(&packet[44], t1NtpFrac);
-
-    // Open UDP socket
-    int udpBeginResult = udp.begin(123);
-    LOGD(LogTag::NETWORK, "NTP: UDP begin result: %d", udpBeginResult);
-
-    // Send NTP request
-    int beginPacketResult = udp.beginPacket(ntpServerIP, 123);
-    if (beginPacketResult == 0)
+    if (wifiEvents != nullptr)
     {
-      LOGW(LogTag::NETWORK, "NTP: beginPacket failed for %s", server);
-      udp.stop();
-      return false;
+      xEventGroupSetBits(wifiEvents, NTP_DNS_FIRST_BIT << index);
     }
+  }
 
-    size_t bytesWritten = udp.write(packet, NTP_PACKET_SIZE);
-    int endPacketResult = udp.endPacket();
-    LOGD(LogTag::NETWORK, "NTP: Sent %zu bytes, endPacket=%d", bytesWritten, endPacketResult);
-
-    if (endPacketResult == 0)
+  // Fill the request addresses from the cache and look up the missing names in parallel
+  // Only waits (up to NTP_DNS_TIMEOUT_MS) when no cached address can be sent to right away
+  void resolveNtpServers(NtpRequest (&requests)[NTP_SERVER_COUNT])
+  {
+    if (ntpAddressCache.magic != NTP_ADDRESS_CACHE_MAGIC)
     {
-      LOGW(LogTag::NETWORK, "NTP: endPacket failed for %s", server);
-      udp.stop();
-      return false;
+      ntpAddressCache = NtpAddressCache();
+      ntpAddressCache.magic = NTP_ADDRESS_CACHE_MAGIC;
     }
 
-    // Wait for response (max 2 seconds)
-    unsigned long startWait = millis();
-    int packetSize = 0;
-    LOGD(LogTag::NETWORK, "NTP: Waiting for response from %s...", server);
-    while (packetSize == 0 && millis() - startWait < 2000)
+    size_t cached = 0;
+    EventBits_t pendingBits = 0;
+    for (size_t i = 0; i < NTP_SERVER_COUNT; i++)
     {
-      delay(10);
-      packetSize = udp.parsePacket();
+      requests[i].server = NTP_SERVERS[i];
+      const uint32_t nameHash = fnv1a(NTP_SERVERS[i]);
+      if (ntpAddressCache.nameHash[i] == nameHash && ntpAddressCache.address[i] != 0)
+      {
+        requests[i].address = ntpAddressCache.address[i];
+        cached++;
+        continue;
+      }
+      ntpAddressCache.nameHash[i] = nameHash;
+      ntpAddressCache.address[i] = 0;
 
-      // Update status periodically
-      if ((millis() - startWait) % 500 == 0)
+      const EventBits_t bit = NTP_DNS_FIRST_BIT << i;
+      if (wifiEvents != nullptr)
       {
-        char statusMsg[48];
-        snprintf(statusMsg, sizeof(statusMsg), "NTP %s %lums", server, millis() - startWait);
-        updateStatus(statusCallback, statusMsg);
+        xEventGroupClearBits(wifiEvents, bit);
+      }
+      ip_addr_t address;
+      const err_t err = dns_gethostbyname(NTP_SERVERS[i], &address, onNtpServerResolved, (void *)(uintptr_t)i);
+      if (err == ERR_OK && IP_IS_V4(&address))
+      {
+        ntpAddressCache.address[i] = address.u_addr.ip4.addr;
+      }
+      else if (err == ERR_INPROGRESS)
+      {
+        pendingBits |= bit;
+      }
+      else
+      {
+        LOGW(LogTag::NETWORK, "NTP: DNS lookup failed for %s", NTP_SERVERS[i]);
       }
     }
 
-    unsigned long waitTime = millis() - startWait;
-    if (packetSize < NTP_PACKET_SIZE)
+    if (pendingBits != 0 && cached == 0 && wifiEvents != nullptr)
     {
-      LOGW(LogTag::NETWORK, "NTP: No response from %s after %lums (size=%d)", server, waitTime, packetSize);
-      udp.stop();
-      return false;
+      xEventGroupWaitBits(wifiEvents, pendingBits, pdTRUE, pdTRUE, pdMS_TO_TICKS(NTP_DNS_TIMEOUT_MS));
+    }
+    for (size_t i = 0; i < NTP_SERVER_COUNT; i++)
+    {
+      if (requests[i].address == 0 && ntpAddressCache.address[i] != 0)
+      {
+        requests[i].address = ntpAddressCache.address[i];
+        LOGD(LogTag::NETWORK, "NTP: %s resolved to %s", NTP_SERVERS[i],
+             IPAddress(requests[i].address).toString().c_str());
+      }
+      else if (requests[i].address == 0)
+      {
+        LOGW(LogTag::NETWORK, "NTP: DNS resolution failed for %s", NTP_SERVERS[i]);
+      }
     }
-    LOGD(LogTag::NETWORK, "NTP: Received %d bytes from %s after %lums", packetSize, server, waitTime);
+    LOGD(LogTag::NETWORK, "NTP: %u of %u server addresses cached", (unsigned)cached, (unsigned)NTP_SERVER_COUNT);
+  }
 
-    // Capture destination timestamp (t4) as soon as packet is available
-    struct timeval tv4;
-    gettimeofday(&tv4, NULL);
-    const int64_t t4UnixUs = timevalToUnixUs(tv4);
+  // Query all NTP servers at once from one socket and keep the reply with the lowest RTT
+  // (symmetric-delay error is at most RTT/2). Stops early once a reply is under
+  // NTP_GOOD_RTT_US, or when every server answered.
+  // Returns the server of the chosen sample, or nullptr if none answered.
+  const char *queryNtpServers(NtpQueryResult &best, StatusCallback statusCallback)
+  {
+    NtpRequest requests[NTP_SERVER_COUNT];
+    size_t pending = 0;
+    resolveNtpServers(requests);
 
-    // Read response
-    udp.read(packet, NTP_PACKET_SIZE);
-    udp.stop();
+    // Plain lwIP socket so the wait can block in select() until a reply arrives
+    const int sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (sock < 0)
+    {
+      LOGW(LogTag::NETWORK, "NTP: socket() failed");
+      return nullptr;
+    }
 
-    // Parse timestamps from response
-    // Originate (t1)  : bytes 24-31 (client transmit echoed by server)
-    // Receive (t2)    : bytes 32-39
-    // Transmit (t3)   : bytes 40-47
-    const uint32_t t1RespSec = readU32BE(&packet[24]);
-    const uint32_t t1RespFrac = readU32BE(&packet[28]);
-    const uint32_t t2Sec = readU32BE(&packet[32]);
-    const uint32_t t2Frac = readU32BE(&packet[36]);
-    const uint32_t t3Sec = readU32BE(&packet[40]);
-    const uint32_t t3Frac = readU32BE(&packet[44]);
-
-    // Convert to Unix microseconds
-    // Prefer our local captured t1UnixUs (more direct); but keep response for sanity log.
-    const int64_t t2UnixUs = ntpTimestampToUnixUs(t2Sec, t2Frac);
-    const int64_t t3UnixUs = ntpTimestampToUnixUs(t3Sec, t3Frac);
+    byte packet[NTP_PACKET_SIZE];
+    for (NtpRequest &request : requests)
+    {
+      if (request.address == 0)
+      {
+        continue;
+      }
+      // Several pool names can resolve to the same host; one request per address
+      bool duplicate = false;
+      for (const NtpRequest &other : requests)
+      {
+        duplicate = duplicate || (&other < &request && other.address == request.address);
+      }
+      if (duplicate)
+      {
+        request.address = 0;
+        continue;
+      }
 
-    // Standard NTP offset/delay (assuming symmetric network delay)
-    // offset = ((t2 - t1) + (t3 - t4)) / 2
-    // delay  = (t4 - t1) - (t3 - t2)
-    const int64_t offsetUs = ((t2UnixUs - t1UnixUs) + (t3UnixUs - t4UnixUs)) / 2;
-    const int64_t rttUs = (t4UnixUs - t1UnixUs) - (t3UnixUs - t2UnixUs);
-
-    out.offsetUs = offsetUs;
-    out.rttUs = rttUs;
-    out.waitTimeMs = waitTime;
-    out.correctedUnixUsAtReceive = t4UnixUs + offsetUs;
-
-    LOGI(LogTag::NETWORK, "NTP: Got time from %s", server);
-    LOGD(LogTag::NETWORK, "NTP: t1(req)=%ld.%03ld, t1(resp)=%lu.%03u, t2=%lld.%03lld, t3=%lld.%03lld, t4=%ld.%03ld, offset=%lldms, rtt=%lldms",
-         (long)tv1.tv_sec, (long)(tv1.tv_usec / 1000),
-         (unsigned long)(t1RespSec - SEVENTY_YEARS), (unsigned) (ntpFracToUsec(t1RespFrac) / 1000),
-         (long long)(t2UnixUs / 1000000LL), (long long)((t2UnixUs % 1000000LL) / 1000LL),
-         (long long)(t3UnixUs / 1000000LL), (long long)((t3UnixUs % 1000000LL) / 1000LL),
-         (long)tv4.tv_sec, (long)(tv4.tv_usec / 1000),
-         (long long)(offsetUs / 1000LL), (long long)(rttUs / 1000LL));
-    return true;
+      // NTP request header: LI=0, Version=3, Mode=3 (client)
+      // (0x1B = 00 011 011)
+      memset(packet, 0, sizeof(packet));
+      packet[0] = 0x1B;
+
+      // Client transmit timestamp (t1) in request (bytes 40-47)
+      // Server will echo it back as Originate timestamp in response.
+      struct timeval tv1;
+      gettimeofday(&tv1, NULL);
+      request.t1UnixUs = timevalToUnixUs(tv1);
+      request.t1NtpSec = (uint32_t)((uint64_t)tv1.tv_sec + (uint64_t)SEVENTY_YEARS);
+      request.t1NtpFrac = usecToNtpFrac((uint32_t)tv1.tv_usec);
+      writeU32BE(&packet[40], request.t1NtpSec);
+      writeU32BE(&packet[44], request.t1NtpFrac);
+
+      struct sockaddr_in serverAddr = {};
+      serverAddr.sin_family = AF_INET;
+      serverAddr.sin_port = htons(NTP_PORT);
+      serverAddr.sin_addr.s_addr = request.address;
+      const int sent = sendto(sock, packet, NTP_PACKET_SIZE, 0,
+                              reinterpret_cast<const struct sockaddr *>(&serverAddr), sizeof(serverAddr));
+      if (sent != (int)NTP_PACKET_SIZE)
+      {
+        LOGW(LogTag::NETWORK, "NTP: sendto failed for %s", request.server);
+        ntpAddressCache.address[&request - requests] = 0;
+        request.address = 0;
+        continue;
+      }
+      pending++;
+    }
+
+    const char *bestServer = nullptr;
+    const unsigned long startWait = millis();
+    LOGD(LogTag::NETWORK, "NTP: Waiting for %u servers...", (unsigned)pending);
+    while (pending > 0 && millis() - startWait < NTP_TIMEOUT_MS)
+    {
+      // Wake every NTP_STATUS_INTERVAL_MS for the status message
+      unsigned long waitMs = NTP_TIMEOUT_MS - (millis() - startWait);
+      if (statusCallback != nullptr && waitMs > NTP_STATUS_INTERVAL_MS)
+      {
+        waitMs = NTP_STATUS_INTERVAL_MS;
+      }
+      fd_set readSet;
+      FD_ZERO(&readSet);
+      FD_SET(sock, &readSet);
+      struct timeval timeout;
+      timeout.tv_sec = (long)(waitMs / 1000);
+      timeout.tv_usec = (long)((waitMs % 1000) * 1000);
+      const int ready = select(sock + 1, &readSet, nullptr, nullptr, &timeout);
+      if (ready < 0)
+      {
+        break;
+      }
+      if (ready == 0)
+      {
+        char statusMsg[48];
+        snprintf(statusMsg, sizeof(statusMsg), "NTP %lums", millis() - startWait);
+        updateStatus(statusCallback, statusMsg);
+        continue;
+      }
+
+      struct sockaddr_in from = {};
+      socklen_t fromLength = sizeof(from);
+      const int packetSize = recvfrom(sock, packet, NTP_PACKET_SIZE, 0,
+                                      reinterpret_cast<struct sockaddr *>(&from), &fromLength);
+      // Capture destination timestamp (t4) as soon as packet is available
+      struct timeval tv4;
+      gettimeofday(&tv4, NULL);
+      if (packetSize < (int)NTP_PACKET_SIZE)
+      {
+        continue;
+      }
+
+      for (NtpRequest &request : requests)
+      {
+        if (request.answered || request.address == 0 || request.address != from.sin_addr.s_addr)
+        {
+          continue;
+        }
+        NtpQueryResult sample;
+        if (!parseNtpReply(packet, request, timevalToUnixUs(tv4), sample))
+        {
+          break;
+        }
+        request.answered = true;
+        pending--;
+        sample.waitTimeMs = millis() - startWait;
+        if (bestServer == nullptr || sample.rttUs < best.rttUs)
+        {
+          best = sample;
+          bestServer = request.server;
+        }
+        break;
+      }
+      if (bestServer != nullptr && best.rttUs < NTP_GOOD_RTT_US)
+      {
+        break; // Good enough: waiting for the others would only add radio-on time
+      }
+    }
+    close(sock);
+
+    // A server that had its full chance and did not answer is resolved again next time
+    const bool stoppedEarly = pending > 0 && bestServer != nullptr && best.rttUs < NTP_GOOD_RTT_US;
+    for (size_t i = 0; i < NTP_SERVER_COUNT && !stoppedEarly; i++)
+    {
+      if (requests[i].address != 0 && !requests[i].answered)
+      {
+        ntpAddressCache.address[i] = 0;
+      }
+    }
+
+    if (bestServer != nullptr)
+    {
+      LOGI(LogTag::NETWORK, "NTP: Got time from %s (rtt=%lldms, %u unanswered)", bestServer,
+           (long long)(best.rttUs / 1000LL), (unsigned)pending);
+    }
+    else
+    {
+      LOGW(LogTag::NETWORK, "NTP: No response after %lums", millis() - startWait);
+    }
+    return bestServer;
   }
 } // namespace
 
@@ -276,24 +844,9 @@ bool NetworkManager_SyncNtp(NetworkState &state, StatusCallback statusCallback)
 
   const unsigned long startTime = millis();
 
-  // Try each NTP server in order until one succeeds
+  // Query all servers at once and use the lowest-RTT sample
   NtpQueryResult ntpResult;
-  const char *successServer = nullptr;
-
-  for (size_t i = 0; i < NTP_SERVER_COUNT; i++)
-  {
-    if (tryNtpServer(NTP_SERVERS[i], ntpResult, statusCallback))
-    {
-      successServer = NTP_SERVERS[i];
-      break;
-    }
-    // Brief delay before trying next server
-    if (i < NTP_SERVER_COUNT - 1)
-    {
-      LOGI(LogTag::NETWORK, "NTP: Trying fallback server...");
-      delay(100);
-    }
-  }
+  const char *successServer = queryNtpServers(ntpResult, statusCallback);
 
   if (successServer == nullptr)
   {
@@ -301,7 +854,6 @@ bool NetworkManager_SyncNtp(NetworkState &state, StatusCallback statusCallback)
     state.ntpSynced = false;
     state.ntpSyncTime = 0;
     updateStatus(statusCallback, "NTP FAILED!");
-    delay(1000);
     return false;
   }
 
@@ -358,7 +910,6 @@ bool NetworkManager_SyncNtp(NetworkState &state, StatusCallback statusCallback)
   char statusMsg[48];
   snprintf(statusMsg, sizeof(statusMsg), "NTP OK! (%lums)", syncTime);
   updateStatus(statusCallback, statusMsg);
-  delay(50);
   return true;
 }
 
@@ -431,17 +982,10 @@ int32_t NetworkManager_MeasureNtpDrift()
     return INT32_MIN;
   }
 
-  // Try each NTP server until one succeeds
-  for (size_t serverIdx = 0; serverIdx < NTP_SERVER_COUNT; serverIdx++)
+  NtpQueryResult result;
+  const char *server = queryNtpServers(result, nullptr);
+  if (server != nullptr)
   {
-    const char *server = NTP_SERVERS[serverIdx];
-
-    NtpQueryResult result;
-    if (!tryNtpServer(server, result, nullptr))
-    {
-      continue;
-    }
-
     // offsetUs is (server - client) at receive moment.
     // Positive = system is behind (slow), Negative = system is ahead (fast).
     int32_t driftMs = (int32_t)(result.offsetUs / 1000LL);
@@ -454,31 +998,61 @@ int32_t NetworkManager_MeasureNtpDrift()
   return INT32_MIN;
 }
 
-bool NetworkManager_SendBatchData(const String &payload)
+bool NetworkManager_BeginBatchUpload(const char *contentType)
 {
+  BatchUpload &upload = batchUpload;
+  upload.client = nullptr;
+  upload.failed = false;
+  upload.used = 0;
+  upload.bodyBytes = 0;
+
   if (WiFi.status() != WL_CONNECTED)
   {
     LOGW(LogTag::NETWORK, "Cannot send batch data: WiFi not connected");
     return false;
   }
 
-  HTTPClient http;
-
   // Construct URL
   String url = String(SENSOR_API_URL) + String(SENSOR_API_ENDPOINT);
+  bool https = false;
+  String host;
+  uint16_t port = 0;
+  String path;
+  if (!parseUrl(url, https, host, port, path))
+  {
+    LOGE(LogTag::NETWORK, "Invalid sensor API URL: %s", url.c_str());
+    return false;
+  }
 
-  LOGI(LogTag::NETWORK, "Sending batch data (%d bytes) to %s", payload.length(), url.c_str());
-  // Log first 500 chars of payload for debugging
-  LOGI(LogTag::NETWORK, "Payload preview: %.500s", payload.c_str());
+  WiFiClient &client = uploadClient(https);
+  client.setTimeout(kUploadTimeoutSec);
+  if (!client.connect(host.c_str(), port))
+  {
+    LOGE(LogTag::NETWORK, "Error sending batch data: cannot connect to %s:%u", host.c_str(), (unsigned)port);
+    client.stop();
+    return false;
+  }
 
-  http.begin(url);
-  http.addHeader("Content-Type", "application/json");
+  // Request line and headers in one write (one TLS record)
+  String request;
+  request.reserve(384);
+  request += "POST ";
+  request += path;
+  request += " HTTP/1.1\r\nHost: ";
+  request += host;
+  request += "\r\nContent-Type: ";
+  request += contentType;
+  request += "\r\nTransfer-Encoding: chunked\r\nConnection: close\r\nX-Device-Id: ";
+  request += deviceId();
+  request += "\r\n";
 
   // Add API Key if configured
   String apiKey = String(API_KEY);
   if (apiKey.length() > 0)
   {
-    http.addHeader("X-API-Key", apiKey);
+    request += "X-API-Key: ";
+    request += apiKey;
+    request += "\r\n";
   }
 
   // Add Cloudflare Access headers if configured
@@ -486,25 +1060,150 @@ bool NetworkManager_SendBatchData(const String &payload)
   String cfClientSecret = String(CF_ACCESS_CLIENT_SECRET);
   if (cfClientId.length() > 0 && cfClientSecret.length() > 0)
   {
-    http.addHeader("CF-Access-Client-Id", cfClientId);
-    http.addHeader("CF-Access-Client-Secret", cfClientSecret);
+    request += "CF-Access-Client-Id: ";
+    request += cfClientId;
+    request += "\r\nCF-Access-Client-Secret: ";
+    request += cfClientSecret;
+    request += "\r\n";
+  }
+  request += "\r\n";
+
+  if (client.write(reinterpret_cast<const uint8_t *>(request.c_str()), request.length()) != request.length())
+  {
+    LOGE(LogTag::NETWORK, "Error sending batch data: request header write failed");
+    client.stop();
+    return false;
   }
 
-  int httpResponseCode = http.POST(payload);
+  upload.client = &client;
+  LOGI(LogTag::NETWORK, "Streaming batch data (%s) to %s as %s", contentType, url.c_str(), deviceId());
+  return true;
+}
+
+bool NetworkManager_WriteBatchData(const void *data, size_t length)
+{
+  BatchUpload &upload = batchUpload;
+  const uint8_t *bytes = static_cast<const uint8_t *>(data);
+  if (upload.client == nullptr || upload.failed)
+  {
+    return false;
+  }
 
-  bool success = false;
-  if (httpResponseCode > 0)
+  while (length > 0)
   {
-    String response = http.getString();
-    LOGI(LogTag::NETWORK, "Batch sent! Response code: %d", httpResponseCode);
-    LOGD(LogTag::NETWORK, "Response: %s", response.c_str());
-    success = (httpResponseCode >= 200 && httpResponseCode < 300);
+    const size_t space = kUploadChunkSize - upload.used;
+    const size_t n = length < space ? length : space;
+    memcpy(upload.buffer + kChunkHeaderSize + upload.used, bytes, n);
+    upload.used += n;
+    bytes += n;
+    length -= n;
+    if (upload.used == kUploadChunkSize && !flushChunk(upload))
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool NetworkManager_EndBatchUpload(int *httpStatus)
+{
+  BatchUpload &upload = batchUpload;
+  if (httpStatus != nullptr)
+  {
+    *httpStatus = 0;
+  }
+  if (upload.client == nullptr)
+  {
+    return false;
+  }
+  WiFiClient &client = *upload.client;
+  upload.client = nullptr;
+
+  // Last data chunk, then the zero-length terminator
+  static const char kTerminator[] = "0\r\n\r\n";
+  if (upload.failed || !flushChunk(upload) ||
+      client.write(reinterpret_cast<const uint8_t *>(kTerminator), sizeof(kTerminator) - 1) != sizeof(kTerminator) - 1)
+  {
+    LOGE(LogTag::NETWORK, "Error sending batch data: write failed after %u bytes", (unsigned)upload.bodyBytes);
+    client.stop();
+    return false;
+  }
+
+  // Status line: "HTTP/1.1 200 OK"
+  String statusLine = client.readStringUntil('\n');
+  int httpResponseCode = 0;
+  if (sscanf(statusLine.c_str(), "HTTP/%*d.%*d %d", &httpResponseCode) != 1)
+  {
+    LOGE(LogTag::NETWORK, "Error sending batch data: no HTTP response");
+    client.stop();
+    return false;
+  }
+
+  // Skip the headers; keep the start of the body for debugging. readBytes() returns only
+  // after the count or the Stream timeout, so never ask for more than the server sends.
+  long contentLength = -1;
+  while (client.connected() || client.available())
+  {
+    String header = client.readStringUntil('\n');
+    if (header.length() <= 1) // "\r" or timeout
+    {
+      break;
+    }
+    if (strncasecmp(header.c_str(), "Content-Length:", 15) == 0)
+    {
+      contentLength = atol(header.c_str() + 15);
+    }
+  }
+  char response[kResponseLogBytes + 1];
+  size_t responseLength = 0;
+  if (contentLength >= 0)
+  {
+    responseLength = client.readBytes(response, min((size_t)contentLength, kResponseLogBytes));
   }
   else
   {
-    LOGE(LogTag::NETWORK, "Error sending batch data: %s", http.errorToString(httpResponseCode).c_str());
+    const unsigned long drainStart = millis();
+    while (responseLength < kResponseLogBytes && millis() - drainStart < kResponseDrainMs)
+    {
+      if (client.available())
+      {
+        const int length = client.read(reinterpret_cast<uint8_t *>(response) + responseLength,
+                                       kResponseLogBytes - responseLength);
+        if (length <= 0)
+        {
+          break;
+        }
+        responseLength += length;
+      }
+      else if (!client.connected())
+      {
+        break;
+      }
+      else
+      {
+        delay(1);
+      }
+    }
   }
+  response[responseLength] = '\0';
+  client.stop();
 
-  http.end();
-  return success;
+  if (httpStatus != nullptr)
+  {
+    *httpStatus = httpResponseCode;
+  }
+  LOGI(LogTag::NETWORK, "Batch sent (%u bytes)! Response code: %d", (unsigned)upload.bodyBytes, httpResponseCode);
+  LOGD(LogTag::NETWORK, "Response: %s", response);
+  return httpResponseCode >= 200 && httpResponseCode < 300;
+}
+
+void NetworkManager_AbortBatchUpload()
+{
+  BatchUpload &upload = batchUpload;
+  if (upload.client != nullptr)
+  {
+    upload.client->stop();
+    upload.client = nullptr;
+    LOGW(LogTag::NETWORK, "Batch upload aborted after %u bytes", (unsigned)upload.bodyBytes);
+  }
 }
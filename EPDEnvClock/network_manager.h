@@ -23,11 +23,24 @@ bool NetworkManager_SetupTimeFromRTC(); // Setup timezone and restore time from
 // Positive value = system clock is behind NTP (slow)
 // Negative value = system clock is ahead of NTP (fast)
 //
-// TEMPORARY DIAGNOSTIC FEATURE (Dec 2025):
+// DIAGNOSTIC FEATURE (Dec 2025):
 // This function is used to measure RTC drift every boot for debugging/analysis.
 // When enabled, WiFi connects every boot (~50% more battery consumption).
-// To disable: change measureDriftOnly logic in EPDEnvClock.ino
+// It is off by default (measureDriftOnly in EPDEnvClock.ino); regular syncs follow the
+// adaptive schedule in deep_sleep_manager.h.
 // See docs/RTC_DEEP_SLEEP.md for details.
 int32_t NetworkManager_MeasureNtpDrift();
 
-bool NetworkManager_SendBatchData(const String &payload);
+// Streaming batch upload to SENSOR_API_URL + SENSOR_API_ENDPOINT
+// The body is sent with chunked transfer encoding through a fixed 1 KB buffer, so memory
+// use does not depend on the batch size.
+// Begin: connect and send the request headers (returns false if WiFi/connection fails);
+//        X-Device-Id carries SENSOR_DEVICE_ID (server_config.h)
+// Write: append body bytes (returns false once a socket write failed)
+// End: finish the body and read the response; true on HTTP 2xx. Call after a successful Begin.
+//      httpStatus (optional) receives the response code, or 0 if there was no response.
+// Abort: drop the connection without finishing the body (the server discards the request)
+bool NetworkManager_BeginBatchUpload(const char *contentType = "application/json");
+bool NetworkManager_WriteBatchData(const void *data, size_t length);
+bool NetworkManager_EndBatchUpload(int *httpStatus = nullptr);
+void NetworkManager_AbortBatchUpload();
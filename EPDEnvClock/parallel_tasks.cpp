@@ -8,6 +8,8 @@
 #include "sensor_manager.h"
 #include "deep_sleep_manager.h"
 #include "logger.h"
+#include "boot_profiler.h"
+#include "power_manager.h"
 
 namespace {
 
@@ -15,10 +17,15 @@ namespace {
 constexpr EventBits_t WIFI_TASK_DONE_BIT = (1 << 0);
 constexpr EventBits_t SENSOR_TASK_DONE_BIT = (1 << 1);
 constexpr EventBits_t ALL_TASKS_DONE = WIFI_TASK_DONE_BIT | SENSOR_TASK_DONE_BIT;
+constexpr EventBits_t POST_DRAW_DONE_BIT = (1 << 2);
 
 // Task handles
 TaskHandle_t wifiTaskHandle = nullptr;
 TaskHandle_t sensorTaskHandle = nullptr;
+TaskHandle_t postDrawTaskHandle = nullptr;
+bool postDrawStarted = false;
+volatile bool postDrawCancelled = false;
+volatile bool postDrawBusy = false;
 
 // Event group for synchronization
 EventGroupHandle_t taskEventGroup = nullptr;
@@ -40,6 +47,13 @@ struct SensorTaskParams {
 WifiTaskParams wifiParams;
 SensorTaskParams sensorParams;
 
+struct PostDrawParams {
+  PostDrawWork work;
+  void* arg;
+};
+
+PostDrawParams postDrawParams;
+
 // WiFi/NTP task (runs on Core 0 - WiFi stack uses Core 0)
 void wifiNtpTask(void* pvParameters) {
   WifiTaskParams* params = static_cast<WifiTaskParams*>(pvParameters);
@@ -52,12 +66,14 @@ void wifiNtpTask(void* pvParameters) {
   if (wifiNeeded) {
     // Connect WiFi
     if (NetworkManager_ConnectWiFi(networkState, nullptr)) {
+      PROFILE_MARK(WifiConnect);
       results.wifiConnected = true;
       results.wifiConnectTime = networkState.wifiConnectTime;
 
       if (params->needWifiSync) {
         // Full NTP sync mode: sync time AND measure drift
         if (NetworkManager_SyncNtp(networkState, nullptr)) {
+          PROFILE_MARK(NtpSync);
           results.ntpSynced = true;
           results.ntpSyncTime = networkState.ntpSyncTime;
           // Save cumulative compensation BEFORE MarkNtpSynced resets it
@@ -83,6 +99,7 @@ void wifiNtpTask(void* pvParameters) {
       } else {
         // Measure drift only mode: measure drift WITHOUT setting system clock
         int32_t driftMs = NetworkManager_MeasureNtpDrift();
+        PROFILE_MARK(NtpSync);
         if (driftMs != INT32_MIN) {
           results.driftMeasured = true;
           results.ntpDriftMs = driftMs;
@@ -135,6 +152,7 @@ void sensorTask(void* pvParameters) {
     // Read sensor (5 second measurement)
     // Always use delay() mode (keepWifiAlive=true) since we're running parallel with WiFi
     if (SensorManager_ReadBlocking(6000, true)) {
+      PROFILE_MARK(SensorWait);
       results.sensorReady = true;
       LOGI(LogTag::SENSOR, "Sensor reading completed: T=%.1f, H=%.1f, CO2=%d",
            SensorManager_GetTemperature(),
@@ -160,6 +178,23 @@ void sensorTask(void* pvParameters) {
   vTaskDelete(nullptr);
 }
 
+// Post-draw I/O task (runs on Core 0 while Core 1 waits for EPD BUSY)
+void postDrawTask(void* pvParameters) {
+  PostDrawParams* params = static_cast<PostDrawParams*>(pvParameters);
+
+  LOGD(LogTag::SETUP, "Post-draw task started on core %d", xPortGetCoreID());
+  params->work(params->arg);
+  LOGD(LogTag::SETUP, "Post-draw task completed");
+
+  // Signal completion
+  postDrawBusy = false;
+  xEventGroupSetBits(taskEventGroup, POST_DRAW_DONE_BIT);
+
+  // Delete task
+  postDrawTaskHandle = nullptr;
+  vTaskDelete(nullptr);
+}
+
 }  // namespace
 
 void ParallelTasks_StartWiFiAndSensor(bool wakeFromSleep, bool needWifiSync, bool measureDriftOnly) {
@@ -243,17 +278,27 @@ bool ParallelTasks_WaitForCompletion(unsigned long timeoutMs) {
   } else {
     LOGW(LogTag::SETUP, "Parallel tasks timeout after %lu ms (bits: 0x%02X)", elapsed, bits);
 
-    // Force delete any stuck tasks
+    // Force delete any stuck tasks; whatever they had not finished counts as failed
     if (wifiTaskHandle != nullptr) {
       LOGW(LogTag::SETUP, "Deleting stuck WiFi task");
       vTaskDelete(wifiTaskHandle);
       wifiTaskHandle = nullptr;
     }
+    if (!(bits & WIFI_TASK_DONE_BIT)) {
+      results.ntpSynced = false;
+      results.driftMeasured = false;
+    }
     if (sensorTaskHandle != nullptr) {
       LOGW(LogTag::SETUP, "Deleting stuck Sensor task");
       vTaskDelete(sensorTaskHandle);
       sensorTaskHandle = nullptr;
     }
+    if (!(bits & SENSOR_TASK_DONE_BIT)) {
+      // No pre-sleep shot or other sensor traffic after this (the bus may be mid-transfer)
+      SensorManager_MarkUninitialized();
+      results.sensorInitialized = false;
+      results.sensorReady = false;
+    }
   }
 
   return allDone;
@@ -266,3 +311,97 @@ ParallelTaskResults& ParallelTasks_GetResults() {
 NetworkState& ParallelTasks_GetNetworkState() {
   return networkState;
 }
+
+bool ParallelTasks_StartPostDraw(PostDrawWork work, void* arg) {
+  if (postDrawStarted) {
+    LOGW(LogTag::SETUP, "Post-draw stage already started");
+    return false;
+  }
+
+  if (taskEventGroup == nullptr) {
+    taskEventGroup = xEventGroupCreate();
+  }
+  xEventGroupClearBits(taskEventGroup, POST_DRAW_DONE_BIT);
+
+  postDrawParams.work = work;
+  postDrawParams.arg = arg;
+  postDrawStarted = true;
+  postDrawCancelled = false;
+
+  // Core 0 (with the WiFi stack); the caller keeps Core 1 for the EPD
+  // Stack size: 12KB for SD + HTTPS operations (TLS handshake plus the record/JSON buffers
+  // of the streaming upload)
+  BaseType_t result = xTaskCreatePinnedToCore(
+    postDrawTask,
+    "PostDraw",
+    12288,
+    &postDrawParams,
+    1,  // Priority
+    &postDrawTaskHandle,
+    0   // Core 0
+  );
+
+  if (result != pdPASS) {
+    LOGE(LogTag::SETUP, "Failed to create post-draw task, running inline");
+    work(arg);
+    xEventGroupSetBits(taskEventGroup, POST_DRAW_DONE_BIT);
+  }
+  return true;
+}
+
+bool ParallelTasks_WaitForPostDraw(unsigned long timeoutMs) {
+  if (!postDrawStarted) {
+    return true;
+  }
+
+  unsigned long startTime = millis();
+
+  EventBits_t bits = xEventGroupWaitBits(
+    taskEventGroup,
+    POST_DRAW_DONE_BIT,
+    pdTRUE,   // Clear bits on exit
+    pdTRUE,   // Wait for all bits
+    pdMS_TO_TICKS(timeoutMs)
+  );
+
+  unsigned long elapsed = millis() - startTime;
+  postDrawStarted = false;
+
+  if (bits & POST_DRAW_DONE_BIT) {
+    LOGI(LogTag::SETUP, "Post-draw stage finished (waited %lu ms after refresh)", elapsed);
+    return true;
+  }
+
+  // Ask the work to stop at its next check rather than deleting it mid-transfer
+  LOGW(LogTag::SETUP, "Post-draw stage timeout after %lu ms, cancelling", elapsed);
+  postDrawCancelled = true;
+  bits = xEventGroupWaitBits(
+    taskEventGroup,
+    POST_DRAW_DONE_BIT,
+    pdTRUE,
+    pdTRUE,
+    pdMS_TO_TICKS(PARALLEL_POST_DRAW_CANCEL_WAIT_MS)
+  );
+  if (bits & POST_DRAW_DONE_BIT) {
+    LOGI(LogTag::SETUP, "Post-draw stage stopped after cancel");
+    return false;
+  }
+
+  // Still inside one transfer; deep sleep ends it. Until then keep off the buses it may own
+  // and drop any compute section it holds so the rest of the wake runs at the wait clock.
+  LOGW(LogTag::SETUP, "Post-draw stage did not stop, skipping storage until sleep");
+  postDrawBusy = true;
+  if (xEventGroupGetBits(taskEventGroup) & POST_DRAW_DONE_BIT) {
+    postDrawBusy = false; // Finished in the meantime
+  }
+  PowerManager_ResetCompute();
+  return false;
+}
+
+bool ParallelTasks_PostDrawCancelled() {
+  return postDrawCancelled;
+}
+
+bool ParallelTasks_PostDrawBusy() {
+  return postDrawBusy;
+}
@@ -34,3 +34,27 @@ ParallelTaskResults& ParallelTasks_GetResults();
 
 // Get network state (for display updates)
 NetworkState& ParallelTasks_GetNetworkState();
+
+// Post-draw I/O stage: run work(arg) on Core 0 while Core 1 waits for the EPD
+// waveform, so awake time is max(refresh, I/O) instead of their sum.
+// Only one stage can be in flight; work must not touch the EPD.
+typedef void (*PostDrawWork)(void *arg);
+bool ParallelTasks_StartPostDraw(PostDrawWork work, void *arg);
+
+// Wait for the post-draw stage (returns immediately if none was started)
+// Returns true if it completed, false on timeout. On timeout the stage is asked to stop
+// (ParallelTasks_PostDrawCancelled) and given PARALLEL_POST_DRAW_CANCEL_WAIT_MS more; the
+// task is never deleted, since it may own the storage or Wire1 lock or a compute section.
+bool ParallelTasks_WaitForPostDraw(unsigned long timeoutMs);
+
+// Grace period for a cancelled post-draw stage to reach its next check and return
+#ifndef PARALLEL_POST_DRAW_CANCEL_WAIT_MS
+#define PARALLEL_POST_DRAW_CANCEL_WAIT_MS 5000
+#endif
+
+// True once the stage has overrun: work should stop before its next upload attempt
+bool ParallelTasks_PostDrawCancelled();
+
+// True while an overrun stage is still running after the grace period: skip SD and Wire1
+// until deep sleep (the task may be inside a transfer)
+bool ParallelTasks_PostDrawBusy();
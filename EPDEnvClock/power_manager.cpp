@@ -0,0 +1,172 @@
+#include "power_manager.h"
+
+#include <esp_sleep.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#if CONFIG_PM_ENABLE
+#include <esp_pm.h>
+#endif
+
+#include "boot_profiler.h"
+#include "logger.h"
+
+namespace
+{
+SemaphoreHandle_t powerMutex = nullptr;
+uint8_t computeDepth = 0;
+uint16_t currentMhz = 0;   // Clock being accounted (0 = not started)
+int64_t currentSinceUs = 0; // esp_timer time the current clock started
+#if CONFIG_PM_ENABLE
+esp_pm_lock_handle_t computeLock = nullptr;
+bool pmConfigured = false;
+bool computeLockHeld = false; // esp_pm locks are counted: release only what was acquired
+#endif
+
+// Caller holds powerMutex
+void accountCurrent(int64_t nowUs)
+{
+  if (currentMhz != 0 && nowUs > currentSinceUs)
+  {
+    BootProfiler_AddCpuTime(currentMhz, (uint32_t)(nowUs - currentSinceUs));
+  }
+  currentSinceUs = nowUs;
+}
+
+// Caller holds powerMutex
+void switchClock(uint16_t mhz)
+{
+  accountCurrent(esp_timer_get_time());
+  currentMhz = mhz;
+#if CONFIG_PM_ENABLE
+  if (pmConfigured)
+  {
+    if (mhz == POWER_COMPUTE_CPU_MHZ && !computeLockHeld)
+    {
+      computeLockHeld = esp_pm_lock_acquire(computeLock) == ESP_OK;
+    }
+    else if (mhz != POWER_COMPUTE_CPU_MHZ && computeLockHeld)
+    {
+      esp_pm_lock_release(computeLock);
+      computeLockHeld = false;
+    }
+    return;
+  }
+#endif
+  setCpuFrequencyMhz(mhz);
+}
+
+void lockPower()
+{
+  if (powerMutex != nullptr)
+  {
+    xSemaphoreTake(powerMutex, portMAX_DELAY);
+  }
+}
+
+void unlockPower()
+{
+  if (powerMutex != nullptr)
+  {
+    xSemaphoreGive(powerMutex);
+  }
+}
+} // namespace
+
+void PowerManager_Init()
+{
+  LOGI(LogTag::SETUP, "Previous boot CPU time: %lu ms @%u MHz, %lu ms @%u MHz, %lu ms @%u MHz",
+       (unsigned long)BootProfiler_GetPreviousCpuTimeMs(0), kBootProfilerCpuMhz[0],
+       (unsigned long)BootProfiler_GetPreviousCpuTimeMs(1), kBootProfilerCpuMhz[1],
+       (unsigned long)BootProfiler_GetPreviousCpuTimeMs(2), kBootProfilerCpuMhz[2]);
+
+  if (powerMutex == nullptr)
+  {
+    powerMutex = xSemaphoreCreateMutex();
+  }
+
+  // Everything before Init ran at the boot clock
+  currentMhz = (uint16_t)getCpuFrequencyMhz();
+  currentSinceUs = 0;
+
+#if POWER_SCALING_ENABLED
+#if CONFIG_PM_ENABLE
+  esp_pm_config_esp32s3_t config = {};
+  config.max_freq_mhz = POWER_COMPUTE_CPU_MHZ;
+  config.min_freq_mhz = POWER_WAIT_CPU_MHZ;
+  config.light_sleep_enable = false; // Light sleep is entered explicitly where it is safe
+  pmConfigured = esp_pm_configure(&config) == ESP_OK &&
+                 esp_pm_lock_create(ESP_PM_CPU_FREQ_MAX, 0, "compute", &computeLock) == ESP_OK;
+  if (!pmConfigured)
+  {
+    LOGW(LogTag::SETUP, "ESP-IDF power management unavailable, using setCpuFrequencyMhz()");
+  }
+#endif
+  lockPower();
+  if (computeDepth == 0)
+  {
+    switchClock(POWER_WAIT_CPU_MHZ);
+  }
+  unlockPower();
+#endif
+}
+
+void PowerManager_BeginCompute()
+{
+#if POWER_SCALING_ENABLED
+  lockPower();
+  if (computeDepth++ == 0 && currentMhz != 0)
+  {
+    switchClock(POWER_COMPUTE_CPU_MHZ);
+  }
+  unlockPower();
+#endif
+}
+
+void PowerManager_EndCompute()
+{
+#if POWER_SCALING_ENABLED
+  lockPower();
+  if (computeDepth > 0 && --computeDepth == 0 && currentMhz != 0)
+  {
+    switchClock(POWER_WAIT_CPU_MHZ);
+  }
+  unlockPower();
+#endif
+}
+
+void PowerManager_ResetCompute()
+{
+#if POWER_SCALING_ENABLED
+  lockPower();
+  if (computeDepth > 0)
+  {
+    computeDepth = 0;
+    if (currentMhz != 0)
+    {
+      switchClock(POWER_WAIT_CPU_MHZ);
+    }
+  }
+  unlockPower();
+#endif
+}
+
+void PowerManager_Finish()
+{
+  lockPower();
+  accountCurrent(esp_timer_get_time());
+  unlockPower();
+}
+
+void PowerManager_LightSleep()
+{
+  // The other core is stalled while asleep, so holding the lock across it blocks nobody
+  lockPower();
+  const int64_t startUs = esp_timer_get_time();
+  accountCurrent(startUs);
+  esp_light_sleep_start();
+  const int64_t endUs = esp_timer_get_time();
+  BootProfiler_AddLightSleepTime((uint32_t)(endUs - startUs));
+  currentSinceUs = endUs; // Not CPU time
+  unlockPower();
+}
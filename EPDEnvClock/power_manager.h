@@ -0,0 +1,52 @@
+#pragma once
+
+#include <Arduino.h>
+
+// CPU clock scaling per boot phase
+// Most of a wake is waiting (SCD41 measurement, WiFi association, NTP replies, EPD BUSY),
+// so the CPU runs at POWER_WAIT_CPU_MHZ by default and is raised to POWER_COMPUTE_CPU_MHZ
+// only while a compute section is open (rendering, EPD SPI upload, frame codec, TLS/HTTP).
+// Sections nest and may overlap across cores; the clock stays high until the last one ends.
+// With CONFIG_PM_ENABLE the ESP-IDF power manager does the switching through a PM lock
+// (the WiFi driver holds its own locks); otherwise setCpuFrequencyMhz() is used.
+// The time at each clock is added to the boot profiler and logged on the next boot.
+
+#ifndef POWER_SCALING_ENABLED
+#define POWER_SCALING_ENABLED 1
+#endif
+
+// 80 MHz is the floor: WiFi needs it, and below it the APB clock (I2C/SPI/UART timing) drops
+#ifndef POWER_WAIT_CPU_MHZ
+#define POWER_WAIT_CPU_MHZ 80
+#endif
+
+#ifndef POWER_COMPUTE_CPU_MHZ
+#define POWER_COMPUTE_CPU_MHZ 240
+#endif
+
+// Call after Logger_Init(), before any task starts: logs the previous boot's clock times and
+// drops to the wait clock
+void PowerManager_Init();
+
+void PowerManager_BeginCompute();
+void PowerManager_EndCompute();
+
+// Close every open compute section (a task that holds one will not return before sleep);
+// its later EndCompute is ignored
+void PowerManager_ResetCompute();
+
+// Account the time since the last clock change (call right before deep sleep)
+void PowerManager_Finish();
+
+// esp_light_sleep_start() with the time asleep added to the boot profile as light sleep
+void PowerManager_LightSleep();
+
+// Keeps the compute clock for the enclosing scope
+class PowerComputeScope
+{
+public:
+  PowerComputeScope() { PowerManager_BeginCompute(); }
+  ~PowerComputeScope() { PowerManager_EndCompute(); }
+  PowerComputeScope(const PowerComputeScope &) = delete;
+  PowerComputeScope &operator=(const PowerComputeScope &) = delete;
+};
@@ -0,0 +1,126 @@
+#include "processing_time.h"
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+namespace
+{
+// Parse a number covering [start, end) up to trailing blanks; false if anything else is left
+bool parseSeconds(const char *start, const char *end, float &seconds)
+{
+  char *parsedEnd = nullptr;
+  seconds = strtof(start, &parsedEnd);
+  if (parsedEnd == start)
+  {
+    return false;
+  }
+  while (parsedEnd < end && isspace((unsigned char)*parsedEnd))
+  {
+    parsedEnd++;
+  }
+  return parsedEnd >= end && ProcessingTime_IsValid(seconds);
+}
+
+// Case-insensitive match of the trimmed key [start, end) against one of names
+bool keyIs(const char *start, const char *end, const char *const *names, size_t count)
+{
+  while (start < end && isspace((unsigned char)*start))
+  {
+    start++;
+  }
+  while (end > start && isspace((unsigned char)end[-1]))
+  {
+    end--;
+  }
+  for (size_t i = 0; i < count; i++)
+  {
+    if (strlen(names[i]) == (size_t)(end - start) && strncasecmp(start, names[i], end - start) == 0)
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+const char *const kNoWifiKeys[] = {"no_wifi", "nowifi", "no_wifi_seconds", "nowifiseconds"};
+const char *const kWifiKeys[] = {"wifi", "wifi_seconds", "wifiseconds"};
+} // namespace
+
+bool ProcessingTime_IsValid(float seconds)
+{
+  return seconds >= kProcessingTimeMinSec && seconds <= kProcessingTimeMaxSec;
+}
+
+float ProcessingTime_Clamp(float seconds)
+{
+  if (!(seconds >= kProcessingTimeMinSec))
+  {
+    return kProcessingTimeMinSec;
+  }
+  return seconds > kProcessingTimeMaxSec ? kProcessingTimeMaxSec : seconds;
+}
+
+int ProcessingTime_Format(char *buffer, size_t bufferSize, float noWifiSeconds, float wifiSeconds)
+{
+  // Simple key=value lines for easy manual inspection/editing
+  return snprintf(buffer, bufferSize, "no_wifi=%.2f\nwifi=%.2f\n", noWifiSeconds, wifiSeconds);
+}
+
+bool ProcessingTime_Parse(const char *text, float &noWifiSeconds, float &wifiSeconds)
+{
+  if (strchr(text, '=') == nullptr)
+  {
+    // Legacy: the whole file is one number, applied to both
+    while (isspace((unsigned char)*text))
+    {
+      text++;
+    }
+    float seconds;
+    if (!parseSeconds(text, text + strlen(text), seconds))
+    {
+      return false;
+    }
+    noWifiSeconds = wifiSeconds = seconds;
+    return true;
+  }
+
+  bool hasNoWifi = false;
+  bool hasWifi = false;
+  float noWifi = 0.0f;
+  float wifi = 0.0f;
+  for (const char *line = text; *line != '\0';)
+  {
+    const char *end = strchr(line, '\n');
+    if (end == nullptr)
+    {
+      end = line + strlen(line);
+    }
+    const char *eq = static_cast<const char *>(memchr(line, '=', end - line));
+    float seconds;
+    if (eq != nullptr && *line != '#' && parseSeconds(eq + 1, end, seconds))
+    {
+      if (keyIs(line, eq, kNoWifiKeys, sizeof(kNoWifiKeys) / sizeof(kNoWifiKeys[0])))
+      {
+        noWifi = seconds;
+        hasNoWifi = true;
+      }
+      else if (keyIs(line, eq, kWifiKeys, sizeof(kWifiKeys) / sizeof(kWifiKeys[0])))
+      {
+        wifi = seconds;
+        hasWifi = true;
+      }
+    }
+    line = *end != '\0' ? end + 1 : end;
+  }
+
+  if (!hasNoWifi && !hasWifi)
+  {
+    return false;
+  }
+  noWifiSeconds = hasNoWifi ? noWifi : wifi;
+  wifiSeconds = hasWifi ? wifi : noWifi;
+  return true;
+}
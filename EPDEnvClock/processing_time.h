@@ -0,0 +1,25 @@
+#pragma once
+
+#include <stddef.h>
+
+// Learned wake-to-draw processing time (s), one estimate for no-WiFi and one for WiFi boots
+// Stored in RTCState and in /processing_time.txt as "no_wifi=<s>\nwifi=<s>\n" (a file holding a
+// single number is the legacy format and applies to both). Pure code, also built by bench/.
+
+// A fast wake finishes in well under a second; the floor only rejects garbage
+constexpr float kProcessingTimeMinSec = 0.2f;
+constexpr float kProcessingTimeMaxSec = 20.0f;
+constexpr float kProcessingTimeDefaultSec = 7.5f;
+
+// True if seconds lies in [kProcessingTimeMinSec, kProcessingTimeMaxSec]
+bool ProcessingTime_IsValid(float seconds);
+
+// seconds clamped to [kProcessingTimeMinSec, kProcessingTimeMaxSec]
+float ProcessingTime_Clamp(float seconds);
+
+// Format both estimates as the file's text; returns the length (snprintf semantics)
+int ProcessingTime_Format(char *buffer, size_t bufferSize, float noWifiSeconds, float wifiSeconds);
+
+// Parse the file's text; an estimate missing (or out of range) takes the other's value
+// Returns false if neither estimate is valid
+bool ProcessingTime_Parse(const char *text, float &noWifiSeconds, float &wifiSeconds);
@@ -1,158 +1,842 @@
 #include "sensor_logger.h"
+#include "boot_profiler.h"
 #include "deep_sleep_manager.h"
 #include "logger.h"
+#include "sensor_record.h"
+#include "storage_manager.h"
 
-#include <SPI.h>
 #include <SD.h>
 
 namespace
 {
 constexpr char kLogDirectory[] = "/sensor_logs";
 constexpr size_t kMaxFilenameLength = 64;
+// Log files older than this are deleted by the daily retention sweep
+constexpr int kRetentionDays = 30;
+// One daily log file name per line, appended when the file is created
+constexpr char kIndexFilename[] = "/sensor_logs/index.txt";
+constexpr char kIndexTempFilename[] = "/sensor_logs/index.tmp";
+// 30 days of .bin + .jsonl mirror, with room for files the cap has not reached yet
+constexpr size_t kMaxIndexEntries = 128;
+// Wall clock values below this mean the time was never set
+constexpr time_t kMinValidTime = 1577836800; // 2020-01-01 00:00:00 UTC
 bool initialized = false;
-bool sdCardAvailable = false;
+bool logDirectoryChecked = false;
 
-// Check if SD card is available
-// SD card should already be initialized by DeepSleepManager_Init()
-bool checkSDCardAvailable()
+uint32_t logFileDate(const struct tm &timeinfo);
+
+// Run the retention sweep if it has not run today (the date is kept in RTC memory)
+void sweepOncePerDay()
 {
-  // Check if SD card is already initialized and accessible
-  if (SD.exists("/"))
+  const time_t now = time(nullptr);
+  if (now < kMinValidTime)
   {
-    sdCardAvailable = true;
-    return true;
+    return; // Ages cannot be judged before the clock is set
+  }
+  struct tm timeinfo;
+  localtime_r(&now, &timeinfo);
+  const uint32_t today = logFileDate(timeinfo);
+  RTCState &state = DeepSleepManager_GetRTCState();
+  if (state.lastRetentionSweepDate == today)
+  {
+    return;
   }
+  SensorLogger_DeleteOldFiles(kRetentionDays);
+  state.lastRetentionSweepDate = today;
+}
 
-  sdCardAvailable = false;
-  return false;
+// Mount the SD card on first use (storage_manager.h)
+// The first use per boot also creates the log directory and, once a day, deletes expired files.
+bool sdReady()
+{
+  if (StorageManager_Mount() != StorageMedium::Sd)
+  {
+    return false;
+  }
+  if (!logDirectoryChecked)
+  {
+    logDirectoryChecked = true;
+    // Create log directory if it doesn't exist
+    if (!SD.exists(kLogDirectory))
+    {
+      if (SD.mkdir(kLogDirectory))
+      {
+        LOGI(LogTag::SENSOR, "Sensor logger: Created directory %s", kLogDirectory);
+      }
+      else
+      {
+        LOGW(LogTag::SENSOR, "Sensor logger: Failed to create directory %s", kLogDirectory);
+      }
+    }
+    sweepOncePerDay();
+  }
+  return true;
 }
 
-// Generate filename from date: /sensor_logs/sensor_log_YYYYMMDD.jsonl
-void generateLogFilename(const struct tm &timeinfo, char *filename, size_t maxLen)
+constexpr char kJsonlExtension[] = "jsonl";
+constexpr char kBinaryExtension[] = "bin";
+// Records read per SD access when scanning binary logs
+constexpr size_t kRecordReadChunk = 16;
+
+// Timestamp of the record appended this boot (gets the boot profile in the upload payload)
+time_t loggedTimestamp = 0;
+
+// Readings staged in RTC memory across deep sleeps, written to SD in one append per file
+// when the ring is full, before an upload, or on SensorLogger_Flush()
+constexpr uint32_t kStagingMagic = 0x53545347; // "GSTS"
+constexpr uint16_t kStagingCapacity = SENSOR_LOG_STAGING_RECORDS > 1 ? SENSOR_LOG_STAGING_RECORDS : 1;
+struct StagedRecords
 {
-  int year = timeinfo.tm_year + 1900;
-  int month = timeinfo.tm_mon + 1;
-  int day = timeinfo.tm_mday;
+  uint32_t magic;
+  uint16_t count;
+  uint16_t reserved;
+  SensorRecord records[kStagingCapacity];
+};
+RTC_DATA_ATTR StagedRecords staged;
 
-  snprintf(filename, maxLen, "%s/sensor_log_%04d%02d%02d.jsonl",
-           kLogDirectory, year, month, day);
-}
-
-// Format JSON line
-// If NTP synced this boot, includes drift fields for analysis
-// batt_percent: linear percent (3.4V=0%, 4.2V=100%)
-// batt_max17048_percent: MAX17048 reported percent (for reference)
-void formatJSONLine(const struct tm &timeinfo,
-                    time_t unixTimestamp,
-                    int32_t rtcDriftMs,
-                    int64_t cumulativeCompensationMs,
-                    float driftRateMsPerMin,
-                    bool ntpSynced,
-                    float temperature,
-                    float humidity,
-                    uint16_t co2,
-                    float batteryVoltage,
-                    float batteryPercent,
-                    float batteryMax17048Percent,
-                    float batteryChargeRate,
-                    bool batteryCharging,
-                    char *buffer,
-                    size_t bufferSize)
+// Generate filename from date: /sensor_logs/sensor_log_YYYYMMDD.<extension>
+void generateLogFilename(const struct tm &timeinfo, char *filename, size_t maxLen,
+                         const char *extension = kJsonlExtension)
 {
   int year = timeinfo.tm_year + 1900;
   int month = timeinfo.tm_mon + 1;
   int day = timeinfo.tm_mday;
-  int hour = timeinfo.tm_hour;
-  int minute = timeinfo.tm_min;
-  int second = timeinfo.tm_sec;
-
-  // Format battery fields - use null for invalid values (-1.0)
-  char battVoltageStr[16];
-  char battPercentStr[16];
-  char battMax17048Str[16];
-  char battRateStr[16];
-
-  if (batteryVoltage < 0.0f) {
-    snprintf(battVoltageStr, sizeof(battVoltageStr), "null");
-    snprintf(battPercentStr, sizeof(battPercentStr), "null");
-    snprintf(battMax17048Str, sizeof(battMax17048Str), "null");
-    snprintf(battRateStr, sizeof(battRateStr), "null");
-  } else {
-    snprintf(battVoltageStr, sizeof(battVoltageStr), "%.3f", batteryVoltage);
-    snprintf(battPercentStr, sizeof(battPercentStr), "%.1f", batteryPercent);
-    snprintf(battMax17048Str, sizeof(battMax17048Str), "%.1f", batteryMax17048Percent);
-    snprintf(battRateStr, sizeof(battRateStr), "%.2f", batteryChargeRate);
-  }
-
-  if (ntpSynced)
-  {
-    // Include drift fields for analysis when NTP was synced this boot
-    // true_drift = rtc_drift_ms + cumulative_compensation_ms
-    snprintf(buffer, bufferSize,
-             "{\"date\":\"%04d.%02d.%02d\",\"time\":\"%02d:%02d:%02d\",\"unixtimestamp\":%ld,\"rtc_drift_ms\":%d,\"cumulative_comp_ms\":%lld,\"drift_rate\":%.1f,\"temp\":%.1f,\"humidity\":%.1f,\"co2\":%u,\"batt_voltage\":%s,\"batt_percent\":%s,\"batt_max17048_percent\":%s,\"batt_rate\":%s,\"charging\":%s}\n",
-             year, month, day,
-             hour, minute, second,
-             (long)unixTimestamp,
-             rtcDriftMs,
-             (long long)cumulativeCompensationMs,
-             driftRateMsPerMin,
-             temperature, humidity, co2,
-             battVoltageStr, battPercentStr, battMax17048Str, battRateStr,
-             batteryCharging ? "true" : "false");
+
+  snprintf(filename, maxLen, "%s/sensor_log_%04d%02d%02d.%s",
+           kLogDirectory, year, month, day, extension);
+}
+
+// Date key of a log file (YYYYMMDD), as stored in UploadCursor::fileDate
+uint32_t logFileDate(const struct tm &timeinfo)
+{
+  return (uint32_t)(timeinfo.tm_year + 1900) * 10000 + (uint32_t)(timeinfo.tm_mon + 1) * 100 +
+         (uint32_t)timeinfo.tm_mday;
+}
+
+// Record a newly created log file in the index (path is /sensor_logs/<name>)
+void appendToIndex(const char *filename)
+{
+  const char *name = strrchr(filename, '/');
+  name = (name != nullptr) ? name + 1 : filename;
+  File index = SD.open(kIndexFilename, FILE_APPEND);
+  if (!index)
+  {
+    LOGW(LogTag::SENSOR, "Sensor logger: Failed to open %s", kIndexFilename);
+    return;
   }
-  else
+  index.println(name);
+  index.close();
+}
+
+#if !SENSOR_LOG_BINARY
+// A cursor offset is usable if it lies inside the file and right after a line break
+// (the file may have been replaced or truncated since the cursor was saved)
+bool cursorOffsetValid(File &file, uint32_t offset)
+{
+  if (offset == 0)
   {
-    // No drift data when NTP wasn't synced this boot
-    snprintf(buffer, bufferSize,
-             "{\"date\":\"%04d.%02d.%02d\",\"time\":\"%02d:%02d:%02d\",\"unixtimestamp\":%ld,\"temp\":%.1f,\"humidity\":%.1f,\"co2\":%u,\"batt_voltage\":%s,\"batt_percent\":%s,\"batt_max17048_percent\":%s,\"batt_rate\":%s,\"charging\":%s}\n",
-             year, month, day,
-             hour, minute, second,
-             (long)unixTimestamp,
-             temperature, humidity, co2,
-             battVoltageStr, battPercentStr, battMax17048Str, battRateStr,
-             batteryCharging ? "true" : "false");
+    return true;
+  }
+  if (offset > file.size() || !file.seek(offset - 1))
+  {
+    return false;
   }
+  return file.read() == '\n';
 }
 
-} // namespace
+// Trim a JSONL line in place and parse its "unixtimestamp" field
+// Format: {"date":"...","unixtimestamp":1234567890,...}
+bool parseLineTimestamp(String &line, time_t &timestamp)
+{
+  line.trim();
+  int tsIndex = line.indexOf("\"unixtimestamp\":");
+  if (tsIndex <= 0)
+  {
+    return false;
+  }
+  int start = tsIndex + 16; // length of "unixtimestamp":
+  int end = line.indexOf(",", start);
+  if (end <= start)
+  {
+    return false;
+  }
+  timestamp = (time_t)line.substring(start, end).toInt();
+  return true;
+}
+#endif
 
-void SensorLogger_Init()
+// Previous boot's profile for the record appended this boot (boot_prof JSON array text)
+// Returns false for every other record, or when profiling is disabled/unavailable
+bool currentBootProfile(const SensorRecord &record, char *profile, size_t profileSize)
 {
-  if (initialized)
+#if SENSOR_LOG_BOOT_PROFILE
+  return loggedTimestamp != 0 && (time_t)record.timestamp == loggedTimestamp &&
+         BootProfiler_FormatPrevious(profile, profileSize);
+#else
+  (void)record;
+  (void)profile;
+  (void)profileSize;
+  return false;
+#endif
+}
+
+// Insert ,"boot_prof":[...] before the closing brace of a formatted JSON line
+void insertBootProfile(char *buffer, size_t bufferSize, const char *profile)
+{
+  const size_t len = strlen(buffer);
+  if (len < 2 || buffer[len - 2] != '}' || buffer[len - 1] != '\n')
+  {
+    return;
+  }
+  const size_t needed = (len - 2) + strlen(",\"boot_prof\":") + strlen(profile) + 2;
+  if (needed >= bufferSize)
   {
     return;
   }
+  snprintf(buffer + len - 2, bufferSize - (len - 2), ",\"boot_prof\":%s}\n", profile);
+}
+
+// Local midnight of the day in timeinfo
+time_t dayStartOf(const struct tm &timeinfo)
+{
+  struct tm midnight = timeinfo;
+  midnight.tm_hour = 0;
+  midnight.tm_min = 0;
+  midnight.tm_sec = 0;
+  midnight.tm_isdst = -1;
+  return mktime(&midnight);
+}
+
+// Format a record as a JSONL line, with the boot profile on this boot's record
+void formatRecordLine(const SensorRecord &record, char *buffer, size_t bufferSize)
+{
+  SensorRecord_FormatJson(record, buffer, bufferSize);
+  char profile[160];
+  if (currentBootProfile(record, profile, sizeof(profile)))
+  {
+    insertBootProfile(buffer, bufferSize, profile);
+  }
+}
+
+#if !SENSOR_LOG_BINARY || SENSOR_LOG_JSONL_MIRROR
+// Append records of one day as JSONL lines (one file open for all of them)
+bool appendJsonlRecords(const char *filename, const SensorRecord *records, size_t count)
+{
+  File file = SD.open(filename, FILE_APPEND);
+  if (!file)
+  {
+    LOGE(LogTag::SENSOR, "Sensor logger: Failed to open file %s", filename);
+    return false;
+  }
+
+  const bool created = file.size() == 0;
+
+  // Increased buffer for drift and boot profile fields
+  char jsonLine[576];
+  size_t total = 0;
+  for (size_t i = 0; i < count; i++)
+  {
+    formatRecordLine(records[i], jsonLine, sizeof(jsonLine));
+    const size_t written = file.print(jsonLine);
+    total += written;
+    if (written != strlen(jsonLine))
+    {
+      file.close();
+      LOGE(LogTag::SENSOR, "Sensor logger: Write incomplete (wrote %zu of %zu)", written, strlen(jsonLine));
+      return false;
+    }
+  }
+  file.close();
+  if (created)
+  {
+    appendToIndex(filename);
+  }
+  LOGD(LogTag::SENSOR, "Sensor logger: Logged %zu to %s (%zu bytes)", count, filename, total);
+  return true;
+}
+#endif
+
+#if SENSOR_LOG_BINARY
+// Append records of one day, writing the header first for a new file
+// A record torn by a power loss is zero-padded to the record boundary (its CRC then fails)
+bool appendBinaryRecords(const char *filename, const SensorRecord *records, size_t count, time_t dayStart)
+{
+  File file = SD.open(filename, FILE_APPEND);
+  if (!file)
+  {
+    LOGE(LogTag::SENSOR, "Sensor logger: Failed to open file %s", filename);
+    return false;
+  }
+
+  const size_t size = file.size();
+  const bool created = size == 0;
+  if (created)
+  {
+    SensorLogHeader header;
+    SensorLogHeader_Init(header, dayStart);
+    if (file.write(reinterpret_cast<const uint8_t *>(&header), sizeof(header)) != sizeof(header))
+    {
+      file.close();
+      LOGE(LogTag::SENSOR, "Sensor logger: Failed to write header to %s", filename);
+      return false;
+    }
+  }
+  else
+  {
+    size_t padding = 0;
+    if (size < sizeof(SensorLogHeader))
+    {
+      padding = sizeof(SensorLogHeader) - size;
+    }
+    else if ((size - sizeof(SensorLogHeader)) % sizeof(SensorRecord) != 0)
+    {
+      padding = sizeof(SensorRecord) - (size - sizeof(SensorLogHeader)) % sizeof(SensorRecord);
+    }
+    if (padding > 0)
+    {
+      LOGW(LogTag::SENSOR, "Sensor logger: %s ends with a partial entry, padding %zu bytes", filename, padding);
+      const uint8_t zeros[sizeof(SensorRecord)] = {};
+      file.write(zeros, padding);
+    }
+  }
+
+  const size_t bytes = count * sizeof(SensorRecord);
+  const size_t written = file.write(reinterpret_cast<const uint8_t *>(records), bytes);
+  file.close();
+  if (created)
+  {
+    appendToIndex(filename);
+  }
 
-  // Check if SD card is available
-  if (!checkSDCardAvailable())
+  if (written != bytes)
   {
-    LOGD(LogTag::SENSOR, "Sensor logger: SD card not available, logging disabled");
-    initialized = true; // Mark as initialized to avoid repeated messages
+    LOGE(LogTag::SENSOR, "Sensor logger: Write incomplete (wrote %zu of %zu)", written, bytes);
+    return false;
+  }
+  LOGD(LogTag::SENSOR, "Sensor logger: Logged %zu to %s (%zu bytes)", count, filename, written);
+  return true;
+}
+
+// Byte offset of record index in a binary log
+uint32_t recordOffset(uint32_t index)
+{
+  return sizeof(SensorLogHeader) + index * sizeof(SensorRecord);
+}
+
+// Timestamp of record index (0 if it cannot be read)
+uint32_t readRecordTimestamp(File &file, uint32_t index)
+{
+  uint32_t timestamp = 0;
+  if (!file.seek(recordOffset(index)) ||
+      file.read(reinterpret_cast<uint8_t *>(&timestamp), sizeof(timestamp)) != sizeof(timestamp))
+  {
+    return 0;
+  }
+  return timestamp;
+}
+
+// Index of the first record newer than afterTime (records are appended in time order)
+// The first probe assumes one record per minute since dayStart, which usually lands
+// next to the answer; the binary search bounds the worst case to ~11 reads per day.
+uint32_t findFirstRecordAfter(File &file, uint32_t count, const SensorLogHeader &header, time_t afterTime)
+{
+  uint32_t lo = 0;
+  uint32_t hi = count;
+  uint32_t probe = UINT32_MAX;
+  if (SensorLogHeader_IsValid(header) && afterTime > (time_t)header.dayStart)
+  {
+    probe = (uint32_t)((afterTime - (time_t)header.dayStart) / 60);
+  }
+
+  while (lo < hi)
+  {
+    const uint32_t mid = (probe >= lo && probe < hi) ? probe : lo + (hi - lo) / 2;
+    probe = UINT32_MAX;
+    if ((time_t)readRecordTimestamp(file, mid) > afterTime)
+    {
+      hi = mid;
+    }
+    else
+    {
+      lo = mid + 1;
+    }
+  }
+  return lo;
+}
+#endif
+
+// Write records of one local day to that day's file(s)
+bool writeDayRecords(const SensorRecord *records, size_t count)
+{
+  const time_t timestamp = (time_t)records[0].timestamp;
+  struct tm timeinfo;
+  localtime_r(&timestamp, &timeinfo);
+  char filename[kMaxFilenameLength];
+  bool success = true;
+
+#if SENSOR_LOG_BINARY
+  generateLogFilename(timeinfo, filename, sizeof(filename), kBinaryExtension);
+  success = appendBinaryRecords(filename, records, count, dayStartOf(timeinfo));
+#endif
+
+#if !SENSOR_LOG_BINARY || SENSOR_LOG_JSONL_MIRROR
+  generateLogFilename(timeinfo, filename, sizeof(filename), kJsonlExtension);
+  const bool jsonlWritten = appendJsonlRecords(filename, records, count);
+#if SENSOR_LOG_BINARY
+  // The mirror is for humans only; the binary log stays authoritative
+  if (!jsonlWritten)
+  {
+    LOGW(LogTag::SENSOR, "Sensor logger: JSONL mirror write failed");
+  }
+#else
+  success = jsonlWritten;
+#endif
+#endif
+
+  return success;
+}
+
+// Drop staged state that did not survive (power loss, or a layout from other firmware)
+void validateStaged()
+{
+  if (staged.magic != kStagingMagic || staged.count > kStagingCapacity)
+  {
+    staged.magic = kStagingMagic;
+    staged.count = 0;
     return;
   }
+  uint16_t kept = 0;
+  for (uint16_t i = 0; i < staged.count; i++)
+  {
+    if (SensorRecord_IsValid(staged.records[i]))
+    {
+      staged.records[kept++] = staged.records[i];
+    }
+  }
+  if (kept != staged.count)
+  {
+    LOGW(LogTag::SENSOR, "Sensor logger: Dropped %u corrupt staged readings", (unsigned)(staged.count - kept));
+    staged.count = kept;
+  }
+}
+
+// Write all staged records, grouped into one append per daily file
+// Records that could not be written stay staged for the next attempt
+bool flushStaged()
+{
+  if (staged.count == 0)
+  {
+    return true;
+  }
+  if (!sdReady())
+  {
+    return false;
+  }
+
+  uint16_t done = 0;
+  bool success = true;
+  while (done < staged.count)
+  {
+    const time_t first = (time_t)staged.records[done].timestamp;
+    struct tm firstDay;
+    localtime_r(&first, &firstDay);
+    const uint32_t date = logFileDate(firstDay);
+
+    uint16_t run = 1;
+    while (done + run < staged.count)
+    {
+      const time_t next = (time_t)staged.records[done + run].timestamp;
+      struct tm nextDay;
+      localtime_r(&next, &nextDay);
+      if (logFileDate(nextDay) != date)
+      {
+        break;
+      }
+      run++;
+    }
+
+    if (!writeDayRecords(&staged.records[done], run))
+    {
+      success = false;
+      break;
+    }
+    done += run;
+  }
+
+  if (done > 0)
+  {
+    memmove(staged.records, staged.records + done, (staged.count - done) * sizeof(SensorRecord));
+    staged.count -= done;
+  }
+  return success;
+}
+
+// Day of a log file date key (noon, so adding whole days is safe across DST changes)
+time_t logFileNoon(uint32_t fileDate)
+{
+  struct tm fileTime = {};
+  fileTime.tm_year = (int)(fileDate / 10000) - 1900;
+  fileTime.tm_mon = (int)((fileDate / 100) % 100) - 1;
+  fileTime.tm_mday = (int)(fileDate % 100);
+  fileTime.tm_hour = 12;
+  fileTime.tm_isdst = -1;
+  return mktime(&fileTime);
+}
+
+#if SENSOR_LOG_BINARY
+// Add the unsent records of one daily file to the plan, oldest first
+// Returns false when the plan filled up before the end of the file
+bool planBinaryFile(const struct tm &fileTime, const UploadCursor &cursor, int maxReadings,
+                    SensorLogUploadPlan &plan)
+{
+  const uint32_t fileDate = logFileDate(fileTime);
+  char filename[kMaxFilenameLength];
+  generateLogFilename(fileTime, filename, sizeof(filename), kBinaryExtension);
+  if (!SD.exists(filename))
+  {
+    return true;
+  }
+  File file = SD.open(filename, FILE_READ);
+  if (!file)
+  {
+    return true;
+  }
+
+  const size_t size = file.size();
+  if (size < sizeof(SensorLogHeader))
+  {
+    file.close();
+    return true;
+  }
+  // Records carry their own CRC, so an unreadable header only loses the index estimate
+  SensorLogHeader header;
+  memset(&header, 0, sizeof(header));
+  file.read(reinterpret_cast<uint8_t *>(&header), sizeof(header));
+  const uint32_t count = (uint32_t)((size - sizeof(SensorLogHeader)) / sizeof(SensorRecord));
 
-  // Create log directory if it doesn't exist
-  if (!SD.exists(kLogDirectory))
+  // Records are appended in time order, so every record after the start index is unsent
+  uint32_t start;
+  const bool cursorInFile = (fileDate == cursor.fileDate && cursor.offset >= sizeof(SensorLogHeader) &&
+                             (cursor.offset - sizeof(SensorLogHeader)) % sizeof(SensorRecord) == 0 &&
+                             cursor.offset <= recordOffset(count));
+  if (cursorInFile)
   {
-    if (SD.mkdir(kLogDirectory))
+    start = (cursor.offset - sizeof(SensorLogHeader)) / sizeof(SensorRecord);
+    LOGD(LogTag::SENSOR, "Sensor logger: Resuming %s at record %lu", filename, (unsigned long)start);
+  }
+  else
+  {
+    start = findFirstRecordAfter(file, count, header, plan.lastUploadedTime);
+  }
+
+  // Take the oldest records that still fit in the plan
+  const uint32_t room = (uint32_t)(maxReadings - plan.count);
+  const bool truncated = count - start > room;
+  uint32_t end = truncated ? start + room : count;
+
+  // Newest intact record gives the new lastUploadedTime. At the file tail a torn record is
+  // dropped from the range; inside a truncated range the cursor still moves past it.
+  uint32_t newest = end;
+  SensorRecord record;
+  bool found = false;
+  while (newest > start)
+  {
+    if (file.seek(recordOffset(newest - 1)) &&
+        file.read(reinterpret_cast<uint8_t *>(&record), sizeof(record)) == sizeof(record) &&
+        SensorRecord_IsValid(record) && (time_t)record.timestamp > plan.lastUploadedTime)
+    {
+      found = true;
+      break;
+    }
+    newest--;
+  }
+  file.close();
+  if (!truncated)
+  {
+    end = newest;
+  }
+
+  if (end > start)
+  {
+    SensorLogUploadRange &range = plan.ranges[plan.rangeCount++];
+    range.fileDate = fileDate;
+    range.startOffset = recordOffset(start);
+    range.endOffset = recordOffset(end);
+    plan.count += (int)(end - start);
+    if (found)
     {
-      LOGI(LogTag::SENSOR, "Sensor logger: Created directory %s", kLogDirectory);
+      plan.latestTimestamp = (time_t)record.timestamp;
+    }
+    plan.latestCursor.fileDate = fileDate;
+    plan.latestCursor.offset = range.endOffset;
+  }
+  return !truncated;
+}
+#else
+// Add the unsent lines of one daily file to the plan, oldest first
+// Returns false when the plan filled up before the end of the file
+bool planJsonlFile(const struct tm &fileTime, const UploadCursor &cursor, int maxReadings,
+                   SensorLogUploadPlan &plan)
+{
+  const uint32_t fileDate = logFileDate(fileTime);
+  char filename[kMaxFilenameLength];
+  generateLogFilename(fileTime, filename, sizeof(filename), kJsonlExtension);
+  if (!SD.exists(filename))
+  {
+    return true;
+  }
+  File file = SD.open(filename, FILE_READ);
+  if (!file)
+  {
+    return true;
+  }
+
+  // The cursor's file resumes at its offset
+  if (fileDate == cursor.fileDate && cursor.offset > 0)
+  {
+    if (cursorOffsetValid(file, cursor.offset))
+    {
+      file.seek(cursor.offset);
+      LOGD(LogTag::SENSOR, "Sensor logger: Resuming %s at byte %lu", filename, (unsigned long)cursor.offset);
     }
     else
     {
-      LOGW(LogTag::SENSOR, "Sensor logger: Failed to create directory %s", kLogDirectory);
+      file.seek(0);
+      LOGW(LogTag::SENSOR, "Sensor logger: Upload cursor %lu is stale for %s, rescanning",
+           (unsigned long)cursor.offset, filename);
     }
   }
 
-  initialized = true;
-  LOGI(LogTag::SENSOR, "Sensor logger initialized (SD card)");
+  bool full = false;
+  bool used = false;
+  uint32_t startOffset = 0;
+  uint32_t endOffset = 0;
+  while (file.available())
+  {
+    if (plan.count >= maxReadings)
+    {
+      full = true;
+      break;
+    }
+    const uint32_t lineStart = (uint32_t)file.position();
+    String line = file.readStringUntil('\n');
+    time_t ts;
+    if (!parseLineTimestamp(line, ts) || ts <= plan.lastUploadedTime)
+    {
+      continue;
+    }
+    if (!used)
+    {
+      startOffset = lineStart;
+      used = true;
+    }
+    plan.count++;
+    endOffset = (uint32_t)file.position();
+    plan.latestTimestamp = ts;
+  }
+  file.close();
+
+  if (used)
+  {
+    SensorLogUploadRange &range = plan.ranges[plan.rangeCount++];
+    range.fileDate = fileDate;
+    range.startOffset = startOffset;
+    range.endOffset = endOffset;
+    plan.latestCursor.fileDate = fileDate;
+    plan.latestCursor.offset = endOffset;
+  }
+  return !full;
+}
+#endif
+
+
+// One line of the log file index
+struct IndexEntry
+{
+  uint32_t date;  // YYYYMMDD
+  uint32_t size;  // Bytes (filled by the sweep)
+  bool binary;    // .bin (otherwise .jsonl)
+  bool removed;   // Deleted by the sweep or missing on SD
+};
+// Sweep scratch (kept off the stack)
+IndexEntry indexEntries[kMaxIndexEntries];
+
+// Parse sensor_log_YYYYMMDD.<ext> (".bin" or ".jsonl")
+bool parseLogFilename(const char *name, IndexEntry &entry)
+{
+  unsigned int date = 0;
+  char extension[8] = {};
+  if (sscanf(name, "sensor_log_%8u.%7s", &date, extension) != 2 || date < 10000101)
+  {
+    return false;
+  }
+  entry.date = date;
+  entry.size = 0;
+  entry.removed = false;
+  if (strcmp(extension, kBinaryExtension) == 0)
+  {
+    entry.binary = true;
+    return true;
+  }
+  entry.binary = false;
+  return strcmp(extension, kJsonlExtension) == 0;
+}
+
+void indexEntryName(const IndexEntry &entry, char *name, size_t nameSize)
+{
+  snprintf(name, nameSize, "sensor_log_%08lu.%s", (unsigned long)entry.date,
+           entry.binary ? kBinaryExtension : kJsonlExtension);
+}
+
+void indexEntryPath(const IndexEntry &entry, char *path, size_t pathSize)
+{
+  char name[32];
+  indexEntryName(entry, name, sizeof(name));
+  snprintf(path, pathSize, "%s/%s", kLogDirectory, name);
+}
+
+bool indexEntryBefore(const IndexEntry &a, const IndexEntry &b)
+{
+  return a.date < b.date || (a.date == b.date && a.binary && !b.binary);
+}
+
+// Read the index sorted oldest first without duplicates
+// complete: false if entries did not fit; sorted: false if the file itself was not in order
+size_t readIndex(IndexEntry *entries, size_t capacity, bool &complete, bool &sorted)
+{
+  complete = true;
+  sorted = true;
+  File index = SD.open(kIndexFilename, FILE_READ);
+  if (!index)
+  {
+    return 0;
+  }
+
+  size_t count = 0;
+  while (index.available())
+  {
+    String line = index.readStringUntil('\n');
+    line.trim();
+    IndexEntry entry;
+    if (!parseLogFilename(line.c_str(), entry))
+    {
+      sorted = false; // Drop the broken line on the next rewrite
+      continue;
+    }
+
+    // Files are appended in creation order, so this is usually a plain append
+    size_t pos = count;
+    while (pos > 0 && indexEntryBefore(entry, entries[pos - 1]))
+    {
+      pos--;
+    }
+    if (pos > 0 && entries[pos - 1].date == entry.date && entries[pos - 1].binary == entry.binary)
+    {
+      sorted = false; // Duplicate (file recreated after a hand deletion, or a rebuild race)
+      continue;
+    }
+    if (count == capacity)
+    {
+      complete = false;
+      break;
+    }
+    if (pos != count)
+    {
+      sorted = false;
+      memmove(entries + pos + 1, entries + pos, (count - pos) * sizeof(IndexEntry));
+    }
+    entries[pos] = entry;
+    count++;
+  }
+  index.close();
+  return count;
+}
 
-  // Clean up old log files (older than 30 days)
-  SensorLogger_DeleteOldFiles(30);
+// Replace the index with the entries that were not removed
+bool writeIndex(const IndexEntry *entries, size_t count)
+{
+  File index = SD.open(kIndexTempFilename, FILE_WRITE);
+  if (!index)
+  {
+    LOGW(LogTag::SENSOR, "Sensor logger: Failed to write %s", kIndexTempFilename);
+    return false;
+  }
+  char name[32];
+  for (size_t i = 0; i < count; i++)
+  {
+    if (!entries[i].removed)
+    {
+      indexEntryName(entries[i], name, sizeof(name));
+      index.println(name);
+    }
+  }
+  index.close();
+  SD.remove(kIndexFilename);
+  return SD.rename(kIndexTempFilename, kIndexFilename);
+}
+
+// Create the index from a directory scan (first boot with this firmware, or index lost)
+bool rebuildIndex()
+{
+  File dir = SD.open(kLogDirectory);
+  if (!dir || !dir.isDirectory())
+  {
+    LOGW(LogTag::SENSOR, "Sensor logger: Cannot open log directory for cleanup");
+    return false;
+  }
+  File index = SD.open(kIndexFilename, FILE_WRITE);
+  if (!index)
+  {
+    dir.close();
+    LOGW(LogTag::SENSOR, "Sensor logger: Failed to create %s", kIndexFilename);
+    return false;
+  }
+
+  size_t count = 0;
+  File entry;
+  while ((entry = dir.openNextFile()))
+  {
+    // name() returns just the filename without path
+    IndexEntry parsed;
+    if (parseLogFilename(entry.name(), parsed))
+    {
+      index.println(entry.name());
+      count++;
+    }
+    entry.close();
+  }
+  index.close();
+  dir.close();
+  LOGI(LogTag::SENSOR, "Sensor logger: Rebuilt %s (%u files)", kIndexFilename, (unsigned)count);
+  return true;
+}
+
+bool removeLogFile(const char *path)
+{
+  if (SD.remove(path))
+  {
+    LOGI(LogTag::SENSOR, "Sensor logger: Deleted old log file %s", path);
+    return true;
+  }
+  LOGW(LogTag::SENSOR, "Sensor logger: Failed to delete %s", path);
+  return false;
+}
+} // namespace
+
+void SensorLogger_Init()
+{
+  if (initialized)
+  {
+    return;
+  }
+
+  // The SD card is only mounted when staged readings are written (see sdReady)
+  validateStaged();
+  initialized = true;
+  LOGI(LogTag::SENSOR, "Sensor logger initialized (%u staged readings)", (unsigned)staged.count);
 }
 
 bool SensorLogger_LogValues(
-    const struct tm &timeinfo,
     time_t unixTimestamp,
     int32_t rtcDriftMs,
     int64_t cumulativeCompensationMs,
@@ -165,7 +849,8 @@ bool SensorLogger_LogValues(
     float batteryPercent,
     float batteryMax17048Percent,
     float batteryChargeRate,
-    bool batteryCharging)
+    bool batteryCharging,
+    float energyUAh)
 {
   if (!initialized)
   {
@@ -173,243 +858,337 @@ bool SensorLogger_LogValues(
     return false;
   }
 
-  if (!sdCardAvailable)
-  {
-    // SD card not available, silently skip logging
-    return false;
-  }
-
-  // Generate filename
-  char filename[kMaxFilenameLength];
-  generateLogFilename(timeinfo, filename, sizeof(filename));
-
-  // Format JSON line (increased buffer for drift fields)
-  char jsonLine[448];
-  formatJSONLine(timeinfo, unixTimestamp, rtcDriftMs, cumulativeCompensationMs, driftRateMsPerMin,
-                 ntpSynced, temperature, humidity, co2,
-                 batteryVoltage, batteryPercent, batteryMax17048Percent, batteryChargeRate, batteryCharging,
-                 jsonLine, sizeof(jsonLine));
+  const SensorRecord record = SensorRecord_Make(unixTimestamp, rtcDriftMs, cumulativeCompensationMs,
+                                                driftRateMsPerMin, ntpSynced, temperature, humidity, co2,
+                                                batteryVoltage, batteryPercent, batteryMax17048Percent,
+                                                batteryChargeRate, batteryCharging, energyUAh);
+  loggedTimestamp = unixTimestamp;
 
-  // Open file for append
-  File file = SD.open(filename, FILE_APPEND);
-  if (!file)
+  if (staged.count == kStagingCapacity)
   {
-    LOGE(LogTag::SENSOR, "Sensor logger: Failed to open file %s", filename);
-    return false;
+    // An earlier flush failed and the ring is still full: keep the newest readings
+    LOGW(LogTag::SENSOR, "Sensor logger: Staging full, dropping reading at %lu",
+         (unsigned long)staged.records[0].timestamp);
+    memmove(staged.records, staged.records + 1, (kStagingCapacity - 1) * sizeof(SensorRecord));
+    staged.count--;
   }
+  staged.records[staged.count++] = record;
 
-  // Write JSON line
-  size_t written = file.print(jsonLine);
-  file.close();
-
-  if (written == strlen(jsonLine))
+  if (staged.count < kStagingCapacity)
   {
-    LOGD(LogTag::SENSOR, "Sensor logger: Logged to %s (%zu bytes)", filename, written);
+    LOGD(LogTag::SENSOR, "Sensor logger: Staged reading %u/%u", (unsigned)staged.count, (unsigned)kStagingCapacity);
     return true;
   }
-  else
+  return flushStaged();
+}
+
+bool SensorLogger_Flush()
+{
+  if (!initialized)
   {
-    LOGE(LogTag::SENSOR, "Sensor logger: Write incomplete (wrote %zu of %zu)", written, strlen(jsonLine));
     return false;
   }
+  return flushStaged();
 }
 
-int SensorLogger_DeleteOldFiles(int maxAgeDays)
+int SensorLogger_DeleteOldFiles(int maxAgeDays, uint32_t maxTotalBytes)
 {
-  if (!sdCardAvailable)
+  if (!sdReady())
   {
     return 0;
   }
 
-  // Get current time
-  time_t now;
-  time(&now);
-  struct tm currentTime;
-  localtime_r(&now, &currentTime);
-
-  // Calculate cutoff date (maxAgeDays ago)
-  time_t cutoffTime = now - (maxAgeDays * 24 * 60 * 60);
-
-  File dir = SD.open(kLogDirectory);
-  if (!dir || !dir.isDirectory())
+  if (!SD.exists(kIndexFilename) && !rebuildIndex())
   {
-    LOGW(LogTag::SENSOR, "Sensor logger: Cannot open log directory for cleanup");
     return 0;
   }
 
-  int deletedCount = 0;
-  File entry;
+  IndexEntry *entries = indexEntries;
+  bool complete = true;
+  bool sorted = true;
+  const size_t count = readIndex(entries, kMaxIndexEntries, complete, sorted);
 
-  while ((entry = dir.openNextFile()))
+  // Calculate cutoff date (maxAgeDays ago) and today's key (never deleted by the size cap)
+  const time_t now = time(nullptr);
+  const time_t cutoffTime = now - (time_t)maxAgeDays * 24 * 60 * 60;
+  struct tm currentTime;
+  localtime_r(&now, &currentTime);
+  const uint32_t today = logFileDate(currentTime);
+
+  int deletedCount = 0;
+  uint64_t totalBytes = 0;
+  for (size_t i = 0; i < count; i++)
   {
-    const char *name = entry.name();
-    entry.close();
+    IndexEntry &entry = entries[i];
+    char fullPath[kMaxFilenameLength];
+    indexEntryPath(entry, fullPath, sizeof(fullPath));
 
-    // Check if filename matches pattern: sensor_log_YYYYMMDD.jsonl
-    // name() returns just the filename without path
-    if (strncmp(name, "sensor_log_", 11) != 0)
+    // Delete if older than cutoff (noon of the file's day avoids DST issues)
+    if (logFileNoon(entry.date) < cutoffTime)
     {
+      entry.removed = removeLogFile(fullPath);
+      deletedCount += entry.removed ? 1 : 0;
       continue;
     }
 
-    // Parse date from filename: sensor_log_YYYYMMDD.jsonl
-    int year, month, day;
-    if (sscanf(name, "sensor_log_%4d%2d%2d.jsonl", &year, &month, &day) != 3)
+    File file = SD.open(fullPath, FILE_READ);
+    if (!file)
     {
+      entry.removed = true; // Deleted by hand: drop it from the index
       continue;
     }
+    entry.size = (uint32_t)file.size();
+    file.close();
+    totalBytes += entry.size;
+  }
 
-    // Convert to time_t for comparison
-    struct tm fileTime = {0};
-    fileTime.tm_year = year - 1900;
-    fileTime.tm_mon = month - 1;
-    fileTime.tm_mday = day;
-    fileTime.tm_hour = 12; // Noon to avoid DST issues
-    time_t fileTimestamp = mktime(&fileTime);
-
-    // Delete if older than cutoff
-    if (fileTimestamp < cutoffTime)
+  // Size cap: the entries are sorted oldest first
+  for (size_t i = 0; maxTotalBytes > 0 && totalBytes > maxTotalBytes && i < count; i++)
+  {
+    IndexEntry &entry = entries[i];
+    if (entry.removed || entry.date >= today)
     {
-      char fullPath[kMaxFilenameLength];
-      snprintf(fullPath, sizeof(fullPath), "%s/%s", kLogDirectory, name);
-
-      if (SD.remove(fullPath))
-      {
-        LOGI(LogTag::SENSOR, "Sensor logger: Deleted old log file %s", name);
-        deletedCount++;
-      }
-      else
-      {
-        LOGW(LogTag::SENSOR, "Sensor logger: Failed to delete %s", name);
-      }
+      continue;
+    }
+    char fullPath[kMaxFilenameLength];
+    indexEntryPath(entry, fullPath, sizeof(fullPath));
+    if (removeLogFile(fullPath))
+    {
+      entry.removed = true;
+      totalBytes -= entry.size;
+      deletedCount++;
     }
   }
 
-  dir.close();
+  // Compact the index (drops deleted files, duplicates and out-of-order lines)
+  bool indexChanged = !sorted;
+  for (size_t i = 0; i < count; i++)
+  {
+    indexChanged = indexChanged || entries[i].removed;
+  }
+  if (indexChanged && complete)
+  {
+    writeIndex(entries, count);
+  }
+  else if (!complete)
+  {
+    LOGW(LogTag::SENSOR, "Sensor logger: %s has more than %u entries, sweep kept it as is",
+         kIndexFilename, (unsigned)kMaxIndexEntries);
+  }
 
   if (deletedCount > 0)
   {
-    LOGI(LogTag::SENSOR, "Sensor logger: Deleted %d old log files (>%d days)", deletedCount, maxAgeDays);
+    LOGI(LogTag::SENSOR, "Sensor logger: Deleted %d old log files (>%d days or over %lu bytes)",
+         deletedCount, maxAgeDays, (unsigned long)maxTotalBytes);
   }
+  LOGD(LogTag::SENSOR, "Sensor logger: Retention sweep kept %lu bytes", (unsigned long)totalBytes);
 
   return deletedCount;
 }
 
-int SensorLogger_GetUnsentReadings(time_t lastUploadedTime, String &payload, time_t &latestTimestamp, int maxReadings)
+int SensorLogger_PlanUpload(time_t lastUploadedTime, const UploadCursor &cursor, SensorLogUploadPlan &plan,
+                            int maxReadings)
 {
-  if (!initialized || !sdCardAvailable)
+  plan = SensorLogUploadPlan();
+  plan.lastUploadedTime = lastUploadedTime;
+  plan.latestTimestamp = lastUploadedTime;
+  plan.latestCursor = cursor;
+
+  if (!initialized || maxReadings <= 0 || !sdReady())
   {
     return 0;
   }
 
+  // Staged readings must be on SD before the files are searched
+  if (!flushStaged())
+  {
+    LOGW(LogTag::SENSOR, "Sensor logger: Could not flush staged readings before upload");
+  }
+
   // Get current time
   time_t now;
   time(&now);
   struct tm timeinfo;
   localtime_r(&now, &timeinfo);
+  const uint32_t today = logFileDate(timeinfo);
 
-  // Use a circular buffer to keep only the LATEST maxReadings entries
-  // Default is 120 readings (2 hours) to handle temporary upload failures gracefully
-  String *entries = new String[maxReadings];
-  time_t *timestamps = new time_t[maxReadings];
-  int bufferCount = 0;
-  int bufferStart = 0; // Index of oldest entry in circular buffer
+  // Walk the daily files from the cursor's day (or the last upload's day) up to today,
+  // so readings logged during a long upload outage are still sent, oldest first.
+  // Files past the retention period have been deleted anyway.
+  time_t day = (cursor.fileDate != 0) ? logFileNoon(cursor.fileDate) : lastUploadedTime;
+  const time_t oldestDay = now - (time_t)kRetentionDays * 86400;
+  if (day < oldestDay)
+  {
+    day = oldestDay;
+  }
 
-  // Helper lambda to process a log file
-  auto processFile = [&](const char *filename) {
-    if (!SD.exists(filename))
+  for (;; day += 86400)
+  {
+    struct tm fileTime;
+    localtime_r(&day, &fileTime);
+    if (logFileDate(fileTime) > today)
+    {
+      break;
+    }
+    if (plan.rangeCount == kSensorLogMaxUploadRanges)
+    {
+      plan.more = true;
+      break;
+    }
+#if SENSOR_LOG_BINARY
+    const bool fileDone = planBinaryFile(fileTime, cursor, maxReadings, plan);
+#else
+    const bool fileDone = planJsonlFile(fileTime, cursor, maxReadings, plan);
+#endif
+    if (!fileDone)
     {
-      return;
+      plan.more = true;
+      break;
     }
+  }
+
+  return plan.count;
+}
+
+#if SENSOR_LOG_BINARY
+namespace
+{
+struct JsonVisitorAdapter
+{
+  SensorReadingVisitor visitor;
+  void *context;
+  char line[576];
+};
+
+// SensorRecordVisitor that formats each record as a JSON object for a SensorReadingVisitor
+bool visitRecordAsJson(const SensorRecord &record, const char *bootProfile, void *context)
+{
+  JsonVisitorAdapter &adapter = *static_cast<JsonVisitorAdapter *>(context);
+  SensorRecord_FormatJson(record, adapter.line, sizeof(adapter.line));
+  if (bootProfile != nullptr)
+  {
+    insertBootProfile(adapter.line, sizeof(adapter.line), bootProfile);
+  }
+  // Drop the JSONL line break; readings are sent as JSON array elements
+  const size_t len = strlen(adapter.line);
+  if (len > 0 && adapter.line[len - 1] == '\n')
+  {
+    adapter.line[len - 1] = '\0';
+  }
+  return adapter.visitor(adapter.line, adapter.context);
+}
+} // namespace
+
+bool SensorLogger_ForEachPlannedRecord(const SensorLogUploadPlan &plan, SensorRecordVisitor visitor, void *context)
+{
+  if (!initialized || !sdReady())
+  {
+    return false;
+  }
+
+  char profile[160];
+  for (int r = 0; r < plan.rangeCount; r++)
+  {
+    const SensorLogUploadRange &range = plan.ranges[r];
+
+    // Rebuild the file name from the range's YYYYMMDD date
+    struct tm fileTime = {};
+    fileTime.tm_year = (int)(range.fileDate / 10000) - 1900;
+    fileTime.tm_mon = (int)((range.fileDate / 100) % 100) - 1;
+    fileTime.tm_mday = (int)(range.fileDate % 100);
+    char filename[kMaxFilenameLength];
+    generateLogFilename(fileTime, filename, sizeof(filename), kBinaryExtension);
 
     File file = SD.open(filename, FILE_READ);
-    if (!file)
+    if (!file || !file.seek(range.startOffset))
     {
-      return;
+      LOGW(LogTag::SENSOR, "Sensor logger: Cannot read %s for upload", filename);
+      return false;
     }
 
-    while (file.available())
+    SensorRecord chunk[kRecordReadChunk];
+    uint32_t offset = range.startOffset;
+    while (offset < range.endOffset)
     {
-      String line = file.readStringUntil('\n');
-      line.trim();
-      if (line.length() == 0) continue;
-
-      // Parse timestamp from JSON line
-      // Format: {"date":"...","unixtimestamp":1234567890,...}
-      int tsIndex = line.indexOf("\"unixtimestamp\":");
-      if (tsIndex > 0)
+      const uint32_t remaining = (range.endOffset - offset) / sizeof(SensorRecord);
+      const uint32_t want = remaining < kRecordReadChunk ? remaining : kRecordReadChunk;
+      const size_t bytes = file.read(reinterpret_cast<uint8_t *>(chunk), want * sizeof(SensorRecord));
+      const uint32_t got = (uint32_t)(bytes / sizeof(SensorRecord));
+      if (got == 0)
+      {
+        file.close();
+        return false;
+      }
+      for (uint32_t i = 0; i < got; i++)
       {
-        int start = tsIndex + 16; // length of "unixtimestamp":
-        int end = line.indexOf(",", start);
-        if (end > start)
+        if (!SensorRecord_IsValid(chunk[i]) || (time_t)chunk[i].timestamp <= plan.lastUploadedTime)
         {
-          String tsStr = line.substring(start, end);
-          time_t ts = (time_t)tsStr.toInt();
-
-          // Only include entries newer than lastUploadedTime
-          if (ts > lastUploadedTime)
-          {
-            if (bufferCount < maxReadings)
-            {
-              // Buffer not full yet, just add
-              int idx = (bufferStart + bufferCount) % maxReadings;
-              entries[idx] = line;
-              timestamps[idx] = ts;
-              bufferCount++;
-            }
-            else
-            {
-              // Buffer full, overwrite oldest entry (circular)
-              entries[bufferStart] = line;
-              timestamps[bufferStart] = ts;
-              bufferStart = (bufferStart + 1) % maxReadings;
-            }
-          }
+          continue;
+        }
+        const bool hasProfile = currentBootProfile(chunk[i], profile, sizeof(profile));
+        if (!visitor(chunk[i], hasProfile ? profile : nullptr, context))
+        {
+          file.close();
+          return false;
         }
       }
+      offset += got * sizeof(SensorRecord);
     }
     file.close();
-  };
-
-  // Check yesterday's file first (in case there's recent data spanning midnight)
-  time_t yesterday = now - 86400;
-  struct tm tmYesterday;
-  localtime_r(&yesterday, &tmYesterday);
-
-  char filenameYesterday[kMaxFilenameLength];
-  generateLogFilename(tmYesterday, filenameYesterday, sizeof(filenameYesterday));
+  }
+  return true;
+}
 
-  processFile(filenameYesterday);
+bool SensorLogger_ForEachPlannedReading(const SensorLogUploadPlan &plan, SensorReadingVisitor visitor, void *context)
+{
+  JsonVisitorAdapter adapter;
+  adapter.visitor = visitor;
+  adapter.context = context;
+  return SensorLogger_ForEachPlannedRecord(plan, visitRecordAsJson, &adapter);
+}
+#else
+bool SensorLogger_ForEachPlannedReading(const SensorLogUploadPlan &plan, SensorReadingVisitor visitor, void *context)
+{
+  if (!initialized || !sdReady())
+  {
+    return false;
+  }
 
-  // Check today's file
-  char filenameToday[kMaxFilenameLength];
-  generateLogFilename(timeinfo, filenameToday, sizeof(filenameToday));
-  processFile(filenameToday);
+  for (int r = 0; r < plan.rangeCount; r++)
+  {
+    const SensorLogUploadRange &range = plan.ranges[r];
 
-  // Build payload from buffer (in chronological order)
-  payload += "[";
-  latestTimestamp = lastUploadedTime;
+    // Rebuild the file name from the range's YYYYMMDD date
+    struct tm fileTime = {};
+    fileTime.tm_year = (int)(range.fileDate / 10000) - 1900;
+    fileTime.tm_mon = (int)((range.fileDate / 100) % 100) - 1;
+    fileTime.tm_mday = (int)(range.fileDate % 100);
+    char filename[kMaxFilenameLength];
+    generateLogFilename(fileTime, filename, sizeof(filename), kJsonlExtension);
 
-  for (int i = 0; i < bufferCount; i++)
-  {
-    int idx = (bufferStart + i) % maxReadings;
-    if (i > 0)
+    File file = SD.open(filename, FILE_READ);
+    if (!file || !file.seek(range.startOffset))
     {
-      payload += ",";
+      LOGW(LogTag::SENSOR, "Sensor logger: Cannot read %s for upload", filename);
+      return false;
     }
-    payload += entries[idx];
 
-    if (timestamps[idx] > latestTimestamp)
+    while (file.available() && (uint32_t)file.position() < range.endOffset)
     {
-      latestTimestamp = timestamps[idx];
+      String line = file.readStringUntil('\n');
+      time_t ts;
+      if (!parseLineTimestamp(line, ts) || ts <= plan.lastUploadedTime)
+      {
+        continue;
+      }
+      if (!visitor(line.c_str(), context))
+      {
+        file.close();
+        return false;
+      }
     }
+    file.close();
   }
-
-  payload += "]";
-
-  // Clean up
-  delete[] entries;
-  delete[] timestamps;
-
-  return bufferCount;
+  return true;
 }
+#endif
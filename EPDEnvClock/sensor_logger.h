@@ -3,10 +3,49 @@
 #include <Arduino.h>
 #include <time.h>
 
+#include "deep_sleep_manager.h"
+
+// Sensor log storage format
+// 1: fixed 32-byte binary records in sensor_log_YYYYMMDD.bin (see sensor_record.h)
+// 0: one JSON line per reading in sensor_log_YYYYMMDD.jsonl
+#ifndef SENSOR_LOG_BINARY
+#define SENSOR_LOG_BINARY 1
+#endif
+
+// With SENSOR_LOG_BINARY, also append each reading to the JSONL file for reading on a PC.
+// Opt-in: it costs the ~300-byte line write the binary format avoids.
+#ifndef SENSOR_LOG_JSONL_MIRROR
+#define SENSOR_LOG_JSONL_MIRROR 0
+#endif
+
+// Append the previous boot's phase profile ("boot_prof", see boot_profiler.h) to the
+// first JSONL line of each boot. Set to 0 to keep lines minimal.
+#ifndef SENSOR_LOG_BOOT_PROFILE
+#define SENSOR_LOG_BOOT_PROFILE 1
+#endif
+
+// Readings held in RTC memory before they are written to SD in one append
+// (~10 minutes of readings = 320 bytes of the 8 KB RTC slow memory, next to the RTC frame).
+// Staged readings are written when the ring is full, before an upload and on
+// SensorLogger_Flush(); up to this many minutes are lost if power is cut.
+// 1 writes every reading straight to SD.
+#ifndef SENSOR_LOG_STAGING_RECORDS
+#define SENSOR_LOG_STAGING_RECORDS 10
+#endif
+
+// Size-based retention: once the daily log files together exceed this many bytes, the oldest
+// days are deleted (today's file is always kept). 0 disables the cap; age-based retention
+// (30 days) applies either way.
+#ifndef SENSOR_LOG_MAX_TOTAL_BYTES
+#define SENSOR_LOG_MAX_TOTAL_BYTES (64UL * 1024 * 1024)
+#endif
+
 // Initialize sensor logger (call once in setup)
 void SensorLogger_Init();
 
-// Log sensor values to JSONL file on SD card
+// Log sensor values to the sensor log on SD card (binary and/or JSONL, see above)
+// The reading is staged in RTC memory first (see SENSOR_LOG_STAGING_RECORDS); the daily file
+// is chosen from unixTimestamp when the stage is written.
 // Returns true if successful, false otherwise
 // rtcDriftMs: RTC drift in milliseconds from last NTP sync (residual after compensation)
 // cumulativeCompensationMs: total drift compensation applied since last NTP sync
@@ -16,8 +55,8 @@ void SensorLogger_Init();
 // batteryMax17048Percent: MAX17048 reported percent - for reference/analysis
 // batteryChargeRate: battery charge/discharge rate in %/hr (positive=charging, negative=discharging)
 // batteryCharging: true if battery is currently charging (from 4054A CHRG pin)
+// energyUAh: previous wake cycle's estimated charge in µAh (EnergyModel_GetPreviousWakeUAh(), < 0 = unknown)
 bool SensorLogger_LogValues(
-    const struct tm &timeinfo,
     time_t unixTimestamp,
     int32_t rtcDriftMs,
     int64_t cumulativeCompensationMs,
@@ -30,16 +69,71 @@ bool SensorLogger_LogValues(
     float batteryPercent,
     float batteryMax17048Percent,
     float batteryChargeRate,
-    bool batteryCharging);
+    bool batteryCharging,
+    float energyUAh);
 
-// Delete log files older than specified days
+// Write staged readings to SD now (e.g. before a low-battery sleep, when a brownout
+// would clear RTC memory). Returns false if some readings are still staged.
+bool SensorLogger_Flush();
+
+// Delete log files older than maxAgeDays, then the oldest ones while all files together are
+// larger than maxTotalBytes (0 = no size cap)
+// Files are found through the append-only index (/sensor_logs/index.txt), which is rebuilt
+// from a directory scan only when it is missing. The SD card's first use each day runs this
+// automatically (tracked in RTCState::lastRetentionSweepDate).
 // Returns number of files deleted
-int SensorLogger_DeleteOldFiles(int maxAgeDays = 30);
+int SensorLogger_DeleteOldFiles(int maxAgeDays = 30, uint32_t maxTotalBytes = SENSOR_LOG_MAX_TOTAL_BYTES);
+
+// Unsent readings selected for one upload
+// Only positions are kept (no record data), so the plan is small and can be replayed
+// from SD for every retry of the upload.
+struct SensorLogUploadRange
+{
+  uint32_t fileDate = 0;    // YYYYMMDD of the log file
+  uint32_t startOffset = 0; // First byte to read
+  uint32_t endOffset = 0;   // Byte just past the last selected reading
+};
 
-// Get unsent sensor readings from log files
+// Daily files one plan can span (a catch-up batch crossing a few sparse days)
+constexpr int kSensorLogMaxUploadRanges = 4;
+
+struct SensorLogUploadPlan
+{
+  time_t lastUploadedTime = 0; // Readings at or before this time are skipped
+  int count = 0;               // Readings selected (torn binary records are skipped when read)
+  time_t latestTimestamp = 0;  // Timestamp of the newest selected reading
+  UploadCursor latestCursor;   // Log position just past the newest selected reading
+  SensorLogUploadRange ranges[kSensorLogMaxUploadRanges]; // One per daily file, oldest first
+  int rangeCount = 0;
+  bool more = false;           // Unsent readings remain after this plan (upload another batch)
+};
+
+// Select unsent sensor readings from log files
 // lastUploadedTime: timestamp of the last successfully uploaded data point
-// payload: String to append the JSON array of readings to
-// latestTimestamp: Output parameter to store the timestamp of the last reading added
-// maxReadings: maximum number of readings to retrieve (default 120 = 2 hours)
-// Returns: number of readings added to payload
-int SensorLogger_GetUnsentReadings(time_t lastUploadedTime, String &payload, time_t &latestTimestamp, int maxReadings = 120);
+// cursor: log position saved with lastUploadedTime; the matching file is read from cursor.offset,
+//         older files are skipped. An empty or stale cursor falls back to a timestamp search.
+// Every daily file from the cursor's day to today is searched (up to the 30-day retention),
+// so a backlog after a long outage is drained oldest first, one plan per batch.
+// maxReadings: maximum number of readings to select, keeping the oldest (default 120 = 2 hours)
+// Returns: number of readings selected (plan.count)
+int SensorLogger_PlanUpload(time_t lastUploadedTime, const UploadCursor &cursor, SensorLogUploadPlan &plan,
+                            int maxReadings = 120);
+
+// Called for each planned reading in chronological order with one JSON object (no newline)
+// Return false to stop.
+typedef bool (*SensorReadingVisitor)(const char *json, void *context);
+
+// Read the planned readings from SD and pass them to visitor, one at a time
+// Returns false if the visitor stopped or a log file could not be read
+bool SensorLogger_ForEachPlannedReading(const SensorLogUploadPlan &plan, SensorReadingVisitor visitor, void *context);
+
+#if SENSOR_LOG_BINARY
+struct SensorRecord;
+
+// Called for each planned record in chronological order
+// bootProfile: boot_prof JSON array text for this boot's record, nullptr otherwise
+typedef bool (*SensorRecordVisitor)(const SensorRecord &record, const char *bootProfile, void *context);
+
+// Same as SensorLogger_ForEachPlannedReading, but passes the binary records (for binary uploads)
+bool SensorLogger_ForEachPlannedRecord(const SensorLogUploadPlan &plan, SensorRecordVisitor visitor, void *context);
+#endif
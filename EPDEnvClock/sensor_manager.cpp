@@ -2,22 +2,163 @@
 
 #include <Arduino.h>
 #include <SensirionI2CScd4x.h>
-#include <Wire.h>
+#include "fuel_gauge_manager.h"
+#include "i2c_bus.h"
 #include "logger.h"
+#include "deep_sleep_manager.h"
 #include "esp_sleep.h"
+#include "power_manager.h"
 
 namespace
 {
 // constexpr uint8_t I2C_SDA_PIN = 38; // Moved to header
 // constexpr uint8_t I2C_SCL_PIN = 20; // Moved to header
 constexpr uint8_t SCD4X_I2C_ADDRESS = 0x62;
-
+// measure_single_shot takes 5s, measure_single_shot_rht_only 50ms;
+// allow 1s margin for pipelined reads (wall time has second resolution)
+constexpr uint32_t kSingleShotDurationSec = 5;
+constexpr uint32_t kRhtOnlyDurationMs = 50;
+constexpr uint32_t kPipelinedReadyAfterSec = kSingleShotDurationSec + 1;
+constexpr uint32_t kPipelinedRhtReadyAfterSec = 1;
+// Shots happen about once a minute, so accept one that is slightly early
+constexpr uint32_t kCo2DueSlackSec = 30;
+// A pre-sleep shot older than this (long sleep, skipped boot) is measured again instead
+constexpr uint32_t kPipelinedMaxAgeSec = 180;
+constexpr time_t kMinValidTime = 1577836800; // 2020-01-01 00:00:00 UTC
+
+// The sensor bus lock is held for each public call below (including measurement waits);
+// helpers in this namespace expect it to be held already
 SensirionI2CScd4x scd4x;
 
 bool sensorInitialized = false;
+bool sensorWokeFromSleep = false;
 float lastTemperature = 0.0f;
 float lastHumidity = 0.0f;
 uint16_t lastCO2 = 0;
+time_t lastMeasurementTime = 0;
+bool lastFromPreviousWake = false;
+
+bool sendSingleShot(bool rhtOnly)
+{
+  // measure_single_shot: 0x219d, measure_single_shot_rht_only: 0x2196
+  TwoWire &wire = I2CBus_Wire(I2CBusId::Sensor);
+  wire.beginTransmission(SCD4X_I2C_ADDRESS);
+  wire.write(0x21);
+  wire.write(rhtOnly ? 0x96 : 0x9d);
+  return wire.endTransmission() == 0;
+}
+
+// True if the next shot should measure CO2 (or whether an RHT-only shot will do)
+bool co2ShotDue(time_t now)
+{
+  const RTCState &rtcState = DeepSleepManager_GetRTCState();
+  if (SENSOR_CO2_INTERVAL_MIN <= 1 || rtcState.co2ChangingFast ||
+      rtcState.lastCo2Ppm == 0 || rtcState.lastCo2Time == 0 || now < (time_t)rtcState.lastCo2Time)
+  {
+    return true;
+  }
+  const time_t intervalSec = (time_t)SENSOR_CO2_INTERVAL_MIN * 60;
+  return now - (time_t)rtcState.lastCo2Time + (time_t)kCo2DueSlackSec >= intervalSec;
+}
+
+// Keep a reading; an RHT-only reading (CO2 reads 0) carries the last CO2 forward
+void storeReading(uint16_t co2, float temperature, float humidity, time_t measuredAt, bool rhtOnly)
+{
+  RTCState &rtcState = DeepSleepManager_GetRTCState();
+  if (rhtOnly)
+  {
+    co2 = rtcState.lastCo2Ppm;
+  }
+  else if (co2 != 0)
+  {
+    if (rtcState.lastCo2Ppm != 0)
+    {
+      const int delta = (int)co2 - (int)rtcState.lastCo2Ppm;
+      rtcState.co2ChangingFast = (delta < 0 ? -delta : delta) >= SENSOR_CO2_FAST_CHANGE_PPM;
+    }
+    rtcState.lastCo2Ppm = co2;
+    rtcState.lastCo2Time = measuredAt > 0 ? (uint32_t)measuredAt : 0;
+  }
+  lastTemperature = temperature;
+  lastHumidity = humidity;
+  lastCO2 = co2;
+  lastMeasurementTime = measuredAt;
+}
+
+// Wait for a measurement in progress: delay() keeps WiFi alive, light sleep saves power
+void waitForMeasurement(uint32_t waitMs, bool keepWifiAlive)
+{
+  if (keepWifiAlive)
+  {
+    delay(waitMs);
+  }
+  else
+  {
+    Serial.flush();
+    esp_sleep_enable_timer_wakeup((uint64_t)waitMs * 1000ULL);
+    PowerManager_LightSleep();
+  }
+}
+
+// Read the result of the single shot sent before deep sleep
+// Returns false if there is none (cold boot, stale, sensor error); the caller measures instead
+bool readPipelinedMeasurement(bool keepWifiAlive)
+{
+#if SENSOR_PIPELINED_READ
+  RTCState &rtcState = DeepSleepManager_GetRTCState();
+  const uint32_t shotTime = rtcState.sensorShotTime;
+  const bool rhtOnly = rtcState.sensorShotRhtOnly;
+  rtcState.sensorShotTime = 0;
+  if (shotTime == 0 || !sensorWokeFromSleep)
+  {
+    return false;
+  }
+
+  const time_t now = time(nullptr);
+  if (now < (time_t)shotTime || now - (time_t)shotTime > (time_t)kPipelinedMaxAgeSec)
+  {
+    LOGW(LogTag::SENSOR, "Pre-sleep measurement is stale (%ld s), measuring again", (long)(now - (time_t)shotTime));
+    return false;
+  }
+  const uint32_t ageSec = (uint32_t)(now - (time_t)shotTime);
+  const uint32_t readyAfterSec = rhtOnly ? kPipelinedRhtReadyAfterSec : kPipelinedReadyAfterSec;
+  if (ageSec < readyAfterSec)
+  {
+    // Woke early (e.g. button) - let the shot finish
+    waitForMeasurement((readyAfterSec - ageSec) * 1000UL, keepWifiAlive);
+  }
+
+  uint16_t co2;
+  float temperature;
+  float humidity;
+  const unsigned long readStartTime = millis();
+  uint16_t error;
+  {
+    I2CBusGuard bus(I2CBusId::Sensor);
+    if (!bus.locked())
+    {
+      return false;
+    }
+    error = scd4x.readMeasurement(co2, temperature, humidity);
+  }
+  if (error)
+  {
+    char errorMessage[256];
+    errorToString(error, errorMessage, sizeof(errorMessage));
+    LOGW(LogTag::SENSOR, "Pre-sleep measurement not readable (%s), measuring again", errorMessage);
+    return false;
+  }
+
+  storeReading(co2, temperature, humidity, (time_t)shotTime + (rhtOnly ? 0 : kSingleShotDurationSec), rhtOnly);
+  lastFromPreviousWake = true;
+  LOGI(LogTag::SENSOR, "CO2: %d ppm%s, T: %.2f °C, H: %.2f %%RH | pre-sleep shot, %lu s old (read: %lums)",
+       lastCO2, rhtOnly ? " (carried)" : "", temperature, humidity, (unsigned long)ageSec, millis() - readStartTime);
+  return true;
+#else
+  (void)keepWifiAlive;
+  return false;
+#endif
+}
 } // namespace
 
 bool SensorManager_Begin(bool wakeFromSleep)
@@ -25,11 +166,16 @@ bool SensorManager_Begin(bool wakeFromSleep)
   uint16_t error;
   char errorMessage[256];
 
-  Wire.begin(SENSOR_I2C_SDA_PIN, SENSOR_I2C_SCL_PIN);
-  Wire.setClock(100000); // Set I2C frequency to 100kHz (Standard Mode)
-  delay(100);            // Wait a bit for I2C bus to stabilize
+  // Started once per boot at I2C_BUS_CLOCK_HZ; the SCD41 is already idle after deep sleep
+  if (!I2CBus_Begin(I2CBusId::Sensor))
+  {
+    sensorInitialized = false;
+    return false;
+  }
 
-  scd4x.begin(Wire);
+  // Only binds the bus; each transaction below takes the bus lock, the waits between them do not
+  scd4x.begin(I2CBus_Wire(I2CBusId::Sensor));
+  sensorWokeFromSleep = wakeFromSleep;
 
   if (wakeFromSleep)
   {
@@ -39,10 +185,33 @@ bool SensorManager_Begin(bool wakeFromSleep)
   }
 
   LOGI(LogTag::SENSOR, "Cold boot - performing full initialization");
+  delay(100); // Power-up: the SCD41 needs up to 30ms before accepting commands
+
+#if SENSOR_PIPELINED_READ
+  // A GPIO wake can land while the pre-sleep shot is still measuring (sensor NACKs until done)
+  RTCState &rtcState = DeepSleepManager_GetRTCState();
+  if (rtcState.sensorShotTime != 0)
+  {
+    const time_t sinceShot = time(nullptr) - (time_t)rtcState.sensorShotTime;
+    if (sinceShot >= 0 && sinceShot < (time_t)kPipelinedReadyAfterSec)
+    {
+      delay((kPipelinedReadyAfterSec - (uint32_t)sinceShot) * 1000UL);
+    }
+    rtcState.sensorShotTime = 0;
+  }
+#endif
 
   // SCD41 defaults to periodic measurement mode on power-up
   // Stop it before switching to single-shot mode
-  error = scd4x.stopPeriodicMeasurement();
+  {
+    I2CBusGuard bus(I2CBusId::Sensor);
+    if (!bus.locked())
+    {
+      sensorInitialized = false;
+      return false;
+    }
+    error = scd4x.stopPeriodicMeasurement();
+  }
   if (error)
   {
     errorToString(error, errorMessage, sizeof(errorMessage));
@@ -53,6 +222,12 @@ bool SensorManager_Begin(bool wakeFromSleep)
 
   delay(1000); // Wait for sensor to fully stop periodic measurement
 
+  I2CBusGuard bus(I2CBusId::Sensor);
+  if (!bus.locked())
+  {
+    sensorInitialized = false;
+    return false;
+  }
   error = scd4x.setTemperatureOffset(4.0f);
   if (error)
   {
@@ -91,6 +266,11 @@ void SensorManager_Read()
 
   // Non-blocking read - checks if data is ready (for periodic measurement mode)
   // Note: With single-shot mode, use SensorManager_ReadBlocking() instead
+  I2CBusGuard bus(I2CBusId::Sensor);
+  if (!bus.locked())
+  {
+    return;
+  }
   uint16_t error;
   char errorMessage[256];
   bool isDataReady = false;
@@ -122,9 +302,8 @@ void SensorManager_Read()
 
   LOGI(LogTag::SENSOR, "CO2: %d ppm, T: %.2f °C, H: %.2f %%RH", co2, temperature, humidity);
 
-  lastTemperature = temperature;
-  lastHumidity = humidity;
-  lastCO2 = co2;
+  storeReading(co2, temperature, humidity, time(nullptr), false);
+  lastFromPreviousWake = false;
 }
 
 bool SensorManager_ReadBlocking(unsigned long timeoutMs, bool keepWifiAlive)
@@ -134,6 +313,15 @@ bool SensorManager_ReadBlocking(unsigned long timeoutMs, bool keepWifiAlive)
     return false;
   }
 
+  // The bus lock is taken per transaction and released across the measurement waits, so a
+  // task deleted on timeout while waiting does not leave the sensor bus locked
+
+  // The shot sent before deep sleep has been measuring while we slept
+  if (readPipelinedMeasurement(keepWifiAlive))
+  {
+    return true;
+  }
+
   uint16_t error;
   char errorMessage[256];
 
@@ -150,41 +338,49 @@ bool SensorManager_ReadBlocking(unsigned long timeoutMs, bool keepWifiAlive)
 
   // Use single-shot measurement mode (SCD41 only)
   // We manually send the command and use light sleep instead of the blocking delay(5000)
-  // measureSingleShot command: 0x219d
-  LOGD(LogTag::SENSOR, "Sending single shot command (0x219d)");
-  Wire.beginTransmission(SCD4X_I2C_ADDRESS);
-  Wire.write(0x21);
-  Wire.write(0x9d);
-  int16_t result = Wire.endTransmission();
-  LOGD(LogTag::SENSOR, "I2C transmission result: %d", result);
-
-  if (result == 0)
+  // Between CO2 shots only temperature/humidity are measured (50ms)
+  const bool rhtOnly = !co2ShotDue(time(nullptr));
+  LOGD(LogTag::SENSOR, "Sending single shot command (%s)", rhtOnly ? "0x2196, RHT only" : "0x219d");
+  bool shotSent;
   {
-    if (keepWifiAlive)
+    I2CBusGuard bus(I2CBusId::Sensor);
+    if (!bus.locked())
     {
-      // Use delay() to keep WiFi connected (saves ~0.11mAh by avoiding reconnection)
-      LOGI(LogTag::SENSOR, "Measurement started, waiting 5s (WiFi mode)...");
-      delay(5000);
-    }
-    else
-    {
-      // Use light sleep for maximum power savings (~0.8mA vs ~20mA)
-      LOGI(LogTag::SENSOR, "Measurement started, light sleeping for 5s...");
-      Serial.flush();
-      esp_sleep_enable_timer_wakeup(5000000); // 5 seconds
-      esp_light_sleep_start();
+      return false;
     }
-    LOGD(LogTag::SENSOR, "Sensor measurement wait complete");
+    shotSent = sendSingleShot(rhtOnly);
   }
+  bool measuredRhtOnly = false;
 
-  if (result != 0)
+  if (shotSent && rhtOnly)
+  {
+    delay(kRhtOnlyDurationMs);
+    measuredRhtOnly = true;
+  }
+  else if (shotSent)
   {
-    snprintf(errorMessage, sizeof(errorMessage), "I2C Error: %d", result);
-    LOGE(LogTag::SENSOR, "Manual single shot failed: %s", errorMessage);
+    // delay() keeps WiFi connected (saves ~0.11mAh by avoiding reconnection);
+    // light sleep saves the most power (~0.8mA vs ~20mA)
+    LOGI(LogTag::SENSOR, "Measurement started, %s for 5s...", keepWifiAlive ? "waiting (WiFi mode)" : "light sleeping");
+    // The fuel gauge sits on the other bus; read its logging values while the SCD41 measures
+    FuelGauge_PrefetchDetails();
+    waitForMeasurement(kSingleShotDurationSec * 1000UL, keepWifiAlive);
+    LOGD(LogTag::SENSOR, "Sensor measurement wait complete");
+  }
+  else
+  {
+    LOGE(LogTag::SENSOR, "Manual single shot failed: I2C error");
     LOGW(LogTag::SENSOR, "Falling back to periodic measurement mode");
 
     LOGD(LogTag::SENSOR, "Starting low power periodic measurement...");
-    error = scd4x.startLowPowerPeriodicMeasurement();
+    {
+      I2CBusGuard bus(I2CBusId::Sensor);
+      if (!bus.locked())
+      {
+        return false;
+      }
+      error = scd4x.startLowPowerPeriodicMeasurement();
+    }
     if (error)
     {
       errorToString(error, errorMessage, sizeof(errorMessage));
@@ -200,13 +396,20 @@ bool SensorManager_ReadBlocking(unsigned long timeoutMs, bool keepWifiAlive)
     LOGD(LogTag::SENSOR, "Waiting for data ready...");
     while (!isDataReady && (millis() - startTime < timeoutMs))
     {
-      error = scd4x.getDataReadyFlag(isDataReady);
-      if (error)
       {
-        errorToString(error, errorMessage, sizeof(errorMessage));
-        LOGE(LogTag::SENSOR, "getDataReadyFlag failed: %s", errorMessage);
-        scd4x.stopPeriodicMeasurement();
-        return false;
+        I2CBusGuard bus(I2CBusId::Sensor);
+        if (!bus.locked())
+        {
+          return false;
+        }
+        error = scd4x.getDataReadyFlag(isDataReady);
+        if (error)
+        {
+          errorToString(error, errorMessage, sizeof(errorMessage));
+          LOGE(LogTag::SENSOR, "getDataReadyFlag failed: %s", errorMessage);
+          scd4x.stopPeriodicMeasurement();
+          return false;
+        }
       }
 
       if (!isDataReady)
@@ -215,6 +418,11 @@ bool SensorManager_ReadBlocking(unsigned long timeoutMs, bool keepWifiAlive)
       }
     }
 
+    I2CBusGuard bus(I2CBusId::Sensor);
+    if (!bus.locked())
+    {
+      return false;
+    }
     if (!isDataReady)
     {
       LOGW(LogTag::SENSOR, "Timeout waiting for data ready");
@@ -235,7 +443,14 @@ bool SensorManager_ReadBlocking(unsigned long timeoutMs, bool keepWifiAlive)
 
   LOGD(LogTag::SENSOR, "Reading measurement from sensor...");
   unsigned long readStartTime = millis();
-  error = scd4x.readMeasurement(co2, temperature, humidity);
+  {
+    I2CBusGuard bus(I2CBusId::Sensor);
+    if (!bus.locked())
+    {
+      return false;
+    }
+    error = scd4x.readMeasurement(co2, temperature, humidity);
+  }
   unsigned long readTime = millis() - readStartTime;
   LOGD(LogTag::SENSOR, "Read measurement result: %d (0=success)", error);
 
@@ -247,12 +462,10 @@ bool SensorManager_ReadBlocking(unsigned long timeoutMs, bool keepWifiAlive)
   }
 
   unsigned long totalTime = millis() - totalStartTime;
-  LOGI(LogTag::SENSOR, "CO2: %d ppm, T: %.2f °C, H: %.2f %%RH | Total time: %lums (measure: %lums, read: %lums)",
-       co2, temperature, humidity, totalTime, waitTime, readTime);
-
-  lastTemperature = temperature;
-  lastHumidity = humidity;
-  lastCO2 = co2;
+  storeReading(co2, temperature, humidity, time(nullptr), measuredRhtOnly);
+  lastFromPreviousWake = false;
+  LOGI(LogTag::SENSOR, "CO2: %d ppm%s, T: %.2f °C, H: %.2f %%RH | Total time: %lums (measure: %lums, read: %lums)",
+       lastCO2, measuredRhtOnly ? " (carried)" : "", temperature, humidity, totalTime, waitTime, readTime);
   return true;
 }
 
@@ -261,6 +474,11 @@ bool SensorManager_IsInitialized()
   return sensorInitialized;
 }
 
+void SensorManager_MarkUninitialized()
+{
+  sensorInitialized = false;
+}
+
 float SensorManager_GetTemperature()
 {
   return lastTemperature;
@@ -276,6 +494,45 @@ uint16_t SensorManager_GetCO2()
   return lastCO2;
 }
 
+time_t SensorManager_GetMeasurementTime()
+{
+  return lastMeasurementTime;
+}
+
+bool SensorManager_IsFromPreviousWake()
+{
+  return lastFromPreviousWake;
+}
+
+void SensorManager_StartMeasurement()
+{
+#if SENSOR_PIPELINED_READ
+  RTCState &rtcState = DeepSleepManager_GetRTCState();
+  rtcState.sensorShotTime = 0;
+  if (!sensorInitialized)
+  {
+    return;
+  }
+
+  const time_t now = time(nullptr);
+  if (now < kMinValidTime)
+  {
+    // Without wall time the next wake cannot tell how old the result is
+    return;
+  }
+  const bool rhtOnly = !co2ShotDue(now);
+  I2CBusGuard bus(I2CBusId::Sensor);
+  if (!bus.locked() || !sendSingleShot(rhtOnly))
+  {
+    LOGW(LogTag::SENSOR, "Pre-sleep single shot failed; next wake measures instead");
+    return;
+  }
+  rtcState.sensorShotTime = (uint32_t)now;
+  rtcState.sensorShotRhtOnly = rhtOnly;
+  LOGD(LogTag::SENSOR, "%s shot sent for the next wake", rhtOnly ? "RHT-only" : "Single");
+#endif
+}
+
 void SensorManager_PowerDown()
 {
   // Note: Not used for 1-minute intervals (idle single-shot is more efficient)
@@ -286,6 +543,11 @@ void SensorManager_PowerDown()
     return;
   }
 
+  I2CBusGuard bus(I2CBusId::Sensor);
+  if (!bus.locked())
+  {
+    return;
+  }
   scd4x.stopPeriodicMeasurement(); // Ignore error - may not be running
   delay(100);
 
@@ -311,6 +573,11 @@ void SensorManager_WakeUp()
     return;
   }
 
+  I2CBusGuard bus(I2CBusId::Sensor);
+  if (!bus.locked())
+  {
+    return;
+  }
   scd4x.wakeUp(); // Ignore error - sensor may already be awake
   delay(20);      // Wait for sensor to stabilize
 }
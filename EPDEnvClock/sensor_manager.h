@@ -5,10 +5,38 @@
 constexpr uint8_t SENSOR_I2C_SDA_PIN = 38;
 constexpr uint8_t SENSOR_I2C_SCL_PIN = 20;
 
+// Pipelined readout: the single shot is sent right before deep sleep and read on the next wake,
+// so the 5s measurement runs while the ESP32 sleeps. The reading is then ~1 minute old;
+// SensorManager_GetMeasurementTime() returns when it was taken.
+// Set to 0 to measure (and wait 5s) on every wake.
+#ifndef SENSOR_PIPELINED_READ
+#define SENSOR_PIPELINED_READ 1
+#endif
+
+// CO2 cadence: a full single shot (5s) every SENSOR_CO2_INTERVAL_MIN minutes, RHT-only shots
+// (50ms, CO2 carried forward) in between. While CO2 is changing fast (last two shots differ by
+// >= SENSOR_CO2_FAST_CHANGE_PPM) CO2 is measured every minute. Set the interval to 1 to always
+// measure CO2. Note: the SCD41 ASC defaults assume single shots every 5 minutes.
+#ifndef SENSOR_CO2_INTERVAL_MIN
+#define SENSOR_CO2_INTERVAL_MIN 5
+#endif
+
+#ifndef SENSOR_CO2_FAST_CHANGE_PPM
+#define SENSOR_CO2_FAST_CHANGE_PPM 50
+#endif
+
 bool SensorManager_Begin(bool wakeFromSleep);
 void SensorManager_Read();
 bool SensorManager_ReadBlocking(unsigned long timeoutMs = 10000, bool keepWifiAlive = false);
 bool SensorManager_IsInitialized();
+// Stop using the sensor this boot (its task was deleted mid-read; the bus state is unknown)
+void SensorManager_MarkUninitialized();
+// Send the single shot for the next wake (call right before deep sleep; no-op if pipelining is off)
+void SensorManager_StartMeasurement();
+// Unix time the last reading was measured (0 = no reading)
+time_t SensorManager_GetMeasurementTime();
+// True if the last reading is the pre-sleep shot (measured during the previous sleep)
+bool SensorManager_IsFromPreviousWake();
 float SensorManager_GetTemperature();
 float SensorManager_GetHumidity();
 uint16_t SensorManager_GetCO2();
@@ -0,0 +1,248 @@
+#include "sensor_record.h"
+
+#include <math.h>
+
+namespace
+{
+// CRC-8 (poly 0x07, init 0xFF); a non-zero init makes an all-zero record invalid
+uint8_t crc8(const uint8_t *data, size_t size)
+{
+  uint8_t crc = 0xFF;
+  for (size_t i = 0; i < size; i++)
+  {
+    crc ^= data[i];
+    for (int bit = 0; bit < 8; bit++)
+    {
+      crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x07) : (uint8_t)(crc << 1);
+    }
+  }
+  return crc;
+}
+
+uint8_t recordChecksum(const SensorRecord &record)
+{
+  return crc8(reinterpret_cast<const uint8_t *>(&record), sizeof(SensorRecord) - 1);
+}
+
+// Zigzag LEB128 varint of a signed difference; returns bytes written
+size_t putZigzag(uint8_t *out, int64_t value)
+{
+  uint64_t zigzag = ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);
+  size_t n = 0;
+  do
+  {
+    uint8_t byte = zigzag & 0x7F;
+    zigzag >>= 7;
+    out[n++] = zigzag ? (uint8_t)(byte | 0x80) : byte;
+  } while (zigzag);
+  return n;
+}
+
+// Round value * scale to the nearest integer within [minValue, maxValue]
+int32_t toFixed(float value, float scale, int32_t minValue, int32_t maxValue)
+{
+  if (isnan(value))
+  {
+    return 0;
+  }
+  const float scaled = roundf(value * scale);
+  if (scaled <= (float)minValue)
+  {
+    return minValue;
+  }
+  if (scaled >= (float)maxValue)
+  {
+    return maxValue;
+  }
+  return (int32_t)scaled;
+}
+} // namespace
+
+void SensorLogHeader_Init(SensorLogHeader &header, time_t dayStart)
+{
+  header.magic = kSensorLogMagic;
+  header.version = kSensorLogVersion;
+  header.recordSize = sizeof(SensorRecord);
+  header.dayStart = (uint32_t)dayStart;
+  header.reserved = 0;
+}
+
+bool SensorLogHeader_IsValid(const SensorLogHeader &header)
+{
+  return header.magic == kSensorLogMagic && header.version == kSensorLogVersion &&
+         header.recordSize == sizeof(SensorRecord);
+}
+
+SensorRecord SensorRecord_Make(time_t unixTimestamp,
+                               int32_t rtcDriftMs,
+                               int64_t cumulativeCompensationMs,
+                               float driftRateMsPerMin,
+                               bool driftValid,
+                               float temperature,
+                               float humidity,
+                               uint16_t co2,
+                               float batteryVoltage,
+                               float batteryPercent,
+                               float batteryMax17048Percent,
+                               float batteryChargeRate,
+                               bool batteryCharging,
+                               float energyUAh)
+{
+  SensorRecord record;
+  memset(&record, 0, sizeof(record));
+
+  record.timestamp = (uint32_t)unixTimestamp;
+  record.temperatureC100 = (int16_t)toFixed(temperature, 100.0f, INT16_MIN, INT16_MAX);
+  record.humidityC100 = (uint16_t)toFixed(humidity, 100.0f, 0, UINT16_MAX);
+  record.co2 = co2;
+
+  // Invalid battery readings are logged as -1.0 (null in JSON)
+  if (batteryVoltage >= 0.0f)
+  {
+    record.flags |= kSensorRecordBattery;
+    record.batteryMv = (uint16_t)toFixed(batteryVoltage, 1000.0f, 0, UINT16_MAX);
+    record.batteryPercentC100 = (uint16_t)toFixed(batteryPercent, 100.0f, 0, UINT16_MAX);
+    record.batteryMax17048C100 = (uint16_t)toFixed(batteryMax17048Percent, 100.0f, 0, UINT16_MAX);
+    record.batteryRateC100 = (int16_t)toFixed(batteryChargeRate, 100.0f, INT16_MIN, INT16_MAX);
+  }
+  if (batteryCharging)
+  {
+    record.flags |= kSensorRecordCharging;
+  }
+
+  if (driftValid)
+  {
+    record.flags |= kSensorRecordDrift;
+    record.rtcDriftMs = rtcDriftMs;
+    const int64_t clampedComp = cumulativeCompensationMs < INT32_MIN   ? INT32_MIN
+                                : cumulativeCompensationMs > INT32_MAX ? INT32_MAX
+                                                                       : cumulativeCompensationMs;
+    record.cumulativeCompMs = (int32_t)clampedComp;
+    record.driftRateC10 = (int16_t)toFixed(driftRateMsPerMin, 10.0f, INT16_MIN, INT16_MAX);
+  }
+
+  // 0 is "unknown", so a real estimate is at least 0.1 µAh
+  if (energyUAh >= 0.0f)
+  {
+    record.energyUAhC10 = (uint16_t)toFixed(energyUAh, 10.0f, 1, UINT16_MAX);
+  }
+
+  record.check = recordChecksum(record);
+  return record;
+}
+
+void SensorBatchHeader_Init(SensorBatchHeader &header, uint8_t encoding)
+{
+  header.magic = kSensorBatchMagic;
+  header.version = kSensorBatchVersion;
+  header.encoding = encoding;
+  header.reserved = 0;
+}
+
+size_t SensorRecord_EncodeBatchItem(const SensorRecord &record, const SensorRecord &previous, uint8_t encoding,
+                                    uint8_t *out)
+{
+  size_t n = 0;
+  out[n++] = kSensorBatchTagRecord;
+  if (encoding == kSensorBatchEncodingRaw)
+  {
+    memcpy(out + n, &record, sizeof(record));
+    return n + sizeof(record);
+  }
+
+  // Field order is part of the format (see web/src/lib/batch.ts)
+  n += putZigzag(out + n, (int64_t)record.timestamp - (int64_t)previous.timestamp);
+  n += putZigzag(out + n, (int64_t)record.temperatureC100 - previous.temperatureC100);
+  n += putZigzag(out + n, (int64_t)record.humidityC100 - previous.humidityC100);
+  n += putZigzag(out + n, (int64_t)record.co2 - previous.co2);
+  n += putZigzag(out + n, (int64_t)record.batteryMv - previous.batteryMv);
+  n += putZigzag(out + n, (int64_t)record.batteryPercentC100 - previous.batteryPercentC100);
+  n += putZigzag(out + n, (int64_t)record.batteryMax17048C100 - previous.batteryMax17048C100);
+  n += putZigzag(out + n, (int64_t)record.batteryRateC100 - previous.batteryRateC100);
+  n += putZigzag(out + n, (int64_t)record.rtcDriftMs - previous.rtcDriftMs);
+  n += putZigzag(out + n, (int64_t)record.cumulativeCompMs - previous.cumulativeCompMs);
+  n += putZigzag(out + n, (int64_t)record.driftRateC10 - previous.driftRateC10);
+  out[n++] = record.flags;
+  n += putZigzag(out + n, (int64_t)record.energyUAhC10);
+  return n;
+}
+
+bool SensorRecord_IsValid(const SensorRecord &record)
+{
+  return record.check == recordChecksum(record);
+}
+
+void SensorRecord_FormatJson(const SensorRecord &record, char *buffer, size_t bufferSize)
+{
+  const time_t unixTimestamp = (time_t)record.timestamp;
+  struct tm timeinfo;
+  localtime_r(&unixTimestamp, &timeinfo);
+
+  const int year = timeinfo.tm_year + 1900;
+  const int month = timeinfo.tm_mon + 1;
+  const int day = timeinfo.tm_mday;
+
+  // Format battery fields - use null for invalid values
+  char battVoltageStr[16];
+  char battPercentStr[16];
+  char battMax17048Str[16];
+  char battRateStr[16];
+
+  if (!(record.flags & kSensorRecordBattery))
+  {
+    snprintf(battVoltageStr, sizeof(battVoltageStr), "null");
+    snprintf(battPercentStr, sizeof(battPercentStr), "null");
+    snprintf(battMax17048Str, sizeof(battMax17048Str), "null");
+    snprintf(battRateStr, sizeof(battRateStr), "null");
+  }
+  else
+  {
+    snprintf(battVoltageStr, sizeof(battVoltageStr), "%.3f", record.batteryMv / 1000.0f);
+    snprintf(battPercentStr, sizeof(battPercentStr), "%.1f", record.batteryPercentC100 / 100.0f);
+    snprintf(battMax17048Str, sizeof(battMax17048Str), "%.1f", record.batteryMax17048C100 / 100.0f);
+    snprintf(battRateStr, sizeof(battRateStr), "%.2f", record.batteryRateC100 / 100.0f);
+  }
+
+  const float temperature = record.temperatureC100 / 100.0f;
+  const float humidity = record.humidityC100 / 100.0f;
+  const char *charging = (record.flags & kSensorRecordCharging) ? "true" : "false";
+
+  char energyStr[16];
+  if (record.energyUAhC10 == 0)
+  {
+    snprintf(energyStr, sizeof(energyStr), "null");
+  }
+  else
+  {
+    snprintf(energyStr, sizeof(energyStr), "%.1f", record.energyUAhC10 / 10.0f);
+  }
+
+  if (record.flags & kSensorRecordDrift)
+  {
+    // Include drift fields for analysis when NTP was synced this boot
+    // true_drift = rtc_drift_ms + cumulative_compensation_ms
+    snprintf(buffer, bufferSize,
+             "{\"date\":\"%04d.%02d.%02d\",\"time\":\"%02d:%02d:%02d\",\"unixtimestamp\":%ld,\"rtc_drift_ms\":%ld,\"cumulative_comp_ms\":%ld,\"drift_rate\":%.1f,\"temp\":%.1f,\"humidity\":%.1f,\"co2\":%u,\"batt_voltage\":%s,\"batt_percent\":%s,\"batt_max17048_percent\":%s,\"batt_rate\":%s,\"charging\":%s,\"energy_uah\":%s}\n",
+             year, month, day,
+             timeinfo.tm_hour, timeinfo.tm_min, timeinfo.tm_sec,
+             (long)unixTimestamp,
+             (long)record.rtcDriftMs,
+             (long)record.cumulativeCompMs,
+             record.driftRateC10 / 10.0f,
+             temperature, humidity, (unsigned)record.co2,
+             battVoltageStr, battPercentStr, battMax17048Str, battRateStr,
+             charging, energyStr);
+  }
+  else
+  {
+    // No drift data when NTP wasn't synced this boot
+    snprintf(buffer, bufferSize,
+             "{\"date\":\"%04d.%02d.%02d\",\"time\":\"%02d:%02d:%02d\",\"unixtimestamp\":%ld,\"temp\":%.1f,\"humidity\":%.1f,\"co2\":%u,\"batt_voltage\":%s,\"batt_percent\":%s,\"batt_max17048_percent\":%s,\"batt_rate\":%s,\"charging\":%s,\"energy_uah\":%s}\n",
+             year, month, day,
+             timeinfo.tm_hour, timeinfo.tm_min, timeinfo.tm_sec,
+             (long)unixTimestamp,
+             temperature, humidity, (unsigned)record.co2,
+             battVoltageStr, battPercentStr, battMax17048Str, battRateStr,
+             charging, energyStr);
+  }
+}
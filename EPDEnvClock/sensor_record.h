@@ -0,0 +1,120 @@
+#pragma once
+
+#include <Arduino.h>
+#include <time.h>
+
+// Binary sensor log format
+//
+// File: SensorLogHeader followed by fixed-size SensorRecord entries appended in time order,
+// so record i lives at sizeof(SensorLogHeader) + i * sizeof(SensorRecord).
+// Values are fixed-point integers (little-endian); each record carries a CRC-8 so a record
+// torn by a power loss is skipped instead of being uploaded as garbage.
+// scripts/convert_sensor_log.py converts .bin files to JSONL.
+constexpr uint32_t kSensorLogMagic = 0x4C535045; // "EPSL" (little-endian)
+constexpr uint16_t kSensorLogVersion = 1;
+
+// SensorRecord::flags
+constexpr uint8_t kSensorRecordBattery = 0x01;  // Battery fields are valid
+constexpr uint8_t kSensorRecordCharging = 0x02; // Battery was charging (4054A CHRG pin)
+constexpr uint8_t kSensorRecordDrift = 0x04;    // NTP synced this boot: drift fields are valid
+
+struct __attribute__((packed)) SensorLogHeader
+{
+  uint32_t magic;
+  uint16_t version;
+  uint16_t recordSize;
+  uint32_t dayStart; // Local midnight of the file's date (Unix time), for index estimates
+  uint32_t reserved;
+};
+static_assert(sizeof(SensorLogHeader) == 16, "SensorLogHeader must stay 16 bytes");
+
+struct __attribute__((packed)) SensorRecord
+{
+  uint32_t timestamp;           // Unix time (s)
+  int16_t temperatureC100;      // °C x100
+  uint16_t humidityC100;        // %RH x100
+  uint16_t co2;                 // ppm
+  uint16_t batteryMv;           // Battery voltage (mV)
+  uint16_t batteryPercentC100;  // Linear percent (3.4V=0%, 4.2V=100%) x100
+  uint16_t batteryMax17048C100; // MAX17048 reported percent x100
+  int16_t batteryRateC100;      // %/hour x100 (positive = charging)
+  int32_t rtcDriftMs;           // Residual drift after compensation
+  int32_t cumulativeCompMs;     // Compensation applied since last NTP sync
+  int16_t driftRateC10;         // ms/min x10
+  uint8_t flags;                // kSensorRecord* bits
+  uint16_t energyUAhC10;        // Previous wake cycle's estimated charge, µAh x10 (0 = unknown, energy_model.h)
+  uint8_t check;                // CRC-8 of the preceding 31 bytes
+};
+static_assert(sizeof(SensorRecord) == 32, "SensorRecord must stay 32 bytes");
+
+// Binary batch upload format (Content-Type: application/x-epdenv-batch)
+//
+// Body: SensorBatchHeader, then items (tag byte + payload) until the end of the body:
+// - kSensorBatchTagRecord: one reading
+//     kSensorBatchEncodingRaw:   the 32-byte SensorRecord as stored (CRC included)
+//     kSensorBatchEncodingDelta: timestamp .. driftRateC10 as zigzag LEB128 varints of the
+//                                difference to the previous record (the first record is
+//                                relative to an all-zero record), then flags (1 byte) and
+//                                energyUAhC10 (varint) as-is. A per-minute record is ~14 bytes.
+// - kSensorBatchTagBootProfile: u8 length + boot_prof JSON text of the preceding record
+// web/src/lib/batch.ts decodes it.
+constexpr uint32_t kSensorBatchMagic = 0x42535045; // "EPSB" (little-endian)
+constexpr uint8_t kSensorBatchVersion = 1;
+constexpr char kSensorBatchContentType[] = "application/x-epdenv-batch";
+
+constexpr uint8_t kSensorBatchEncodingRaw = 0;
+constexpr uint8_t kSensorBatchEncodingDelta = 1;
+
+constexpr uint8_t kSensorBatchTagRecord = 1;
+constexpr uint8_t kSensorBatchTagBootProfile = 2;
+
+// Largest encoded record item (tag + 11 five-byte varints + flags + energyUAhC10 varint)
+constexpr size_t kSensorBatchMaxItemBytes = 64;
+
+struct __attribute__((packed)) SensorBatchHeader
+{
+  uint32_t magic;
+  uint8_t version;
+  uint8_t encoding;
+  uint16_t reserved;
+};
+static_assert(sizeof(SensorBatchHeader) == 8, "SensorBatchHeader must stay 8 bytes");
+
+// Fill a log file header
+void SensorLogHeader_Init(SensorLogHeader &header, time_t dayStart);
+
+// True if the header has the expected magic, version and record size
+bool SensorLogHeader_IsValid(const SensorLogHeader &header);
+
+// Build a record from logged values (same meaning as SensorLogger_LogValues arguments)
+// batteryVoltage < 0 means "no battery reading"; drift fields are kept only if driftValid;
+// energyUAh < 0 means "no estimate".
+SensorRecord SensorRecord_Make(time_t unixTimestamp,
+                               int32_t rtcDriftMs,
+                               int64_t cumulativeCompensationMs,
+                               float driftRateMsPerMin,
+                               bool driftValid,
+                               float temperature,
+                               float humidity,
+                               uint16_t co2,
+                               float batteryVoltage,
+                               float batteryPercent,
+                               float batteryMax17048Percent,
+                               float batteryChargeRate,
+                               bool batteryCharging,
+                               float energyUAh);
+
+// True if the record's checksum matches (false for torn or zero-filled records)
+bool SensorRecord_IsValid(const SensorRecord &record);
+
+// Fill a batch upload header
+void SensorBatchHeader_Init(SensorBatchHeader &header, uint8_t encoding);
+
+// Encode one kSensorBatchTagRecord item (tag included) into out (kSensorBatchMaxItemBytes)
+// previous is the record sent before this one (ignored for kSensorBatchEncodingRaw)
+// Returns the number of bytes written
+size_t SensorRecord_EncodeBatchItem(const SensorRecord &record, const SensorRecord &previous, uint8_t encoding,
+                                    uint8_t *out);
+
+// Format a record as one JSONL line (same fields as the JSONL log, including the trailing '\n')
+void SensorRecord_FormatJson(const SensorRecord &record, char *buffer, size_t bufferSize);
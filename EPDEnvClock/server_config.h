@@ -12,11 +12,40 @@
 #define IMAGEBW_SERVER_IP "192.168.11.9"
 #define IMAGEBW_SERVER_PORT 8080
 
+// Export format
+// 1: XOR-RLE delta stream against the last acknowledged frame (POST /imagebw/stream,
+//    see imagebw_export.h). Needs the SD card for the reference frame, otherwise every
+//    frame is a keyframe.
+// 0: full 27,200-byte frame on every export (POST /imagebw)
+#ifndef IMAGEBW_EXPORT_DELTA
+#define IMAGEBW_EXPORT_DELTA 1
+#endif
+
+// Delta mode: a keyframe at least every N frames sent
+#ifndef IMAGEBW_KEYFRAME_INTERVAL
+#define IMAGEBW_KEYFRAME_INTERVAL 30
+#endif
+
 // ============================================
 // Sensor Logger API (Cloudflare Pages)
 // ============================================
 #define SENSOR_API_ENDPOINT "/api/sensor"
 
+// Sent as X-Device-Id; the dashboard keeps each unit's readings apart (web/src/lib/device.ts)
+// Empty: "epd-" + the factory MAC in hex. Up to 64 of A-Z a-z 0-9 . _ -
+#ifndef SENSOR_DEVICE_ID
+#define SENSOR_DEVICE_ID ""
+#endif
+
+// Upload format
+// 1: binary batch (application/x-epdenv-batch, delta-encoded log records, see sensor_record.h).
+//    Falls back to JSON for a day when the server answers 415 Unsupported Media Type.
+// 0: JSON array only
+// Binary uploads need SENSOR_LOG_BINARY (sensor_logger.h).
+#ifndef SENSOR_UPLOAD_BINARY
+#define SENSOR_UPLOAD_BINARY 1
+#endif
+
 // URL and API key are in a separate file (gitignored)
 #include "secrets.h"
 
@@ -1,24 +1,138 @@
 #include "spi.h"
 
+#if EPD_USE_HW_SPI
+#include <driver/spi_master.h>
+#include <freertos/FreeRTOS.h>
+
+namespace
+{
+// SCK=12 / MOSI=11 are the native FSPI IO_MUX pins on ESP32-S3
+constexpr spi_host_device_t kEpdSpiHost = SPI2_HOST;
+// Largest single DMA transaction; longer bursts are split while CS stays low
+constexpr size_t kEpdMaxTransferBytes = 4092;
+
+spi_device_handle_t epdSpi = nullptr;
+
+// Transaction of the segment in flight (EPD_WR_DATA_Queue); must outlive the DMA
+spi_transaction_t epdQueuedTrans;
+bool epdTransQueued = false;
+
+bool epdSpiInit()
+{
+    if (epdSpi != nullptr)
+    {
+        return true;
+    }
+
+    spi_bus_config_t buscfg = {};
+    buscfg.mosi_io_num = MOSI;
+    buscfg.miso_io_num = -1;
+    buscfg.sclk_io_num = SCK;
+    buscfg.quadwp_io_num = -1;
+    buscfg.quadhd_io_num = -1;
+    buscfg.max_transfer_sz = kEpdMaxTransferBytes;
+
+    esp_err_t err = spi_bus_initialize(kEpdSpiHost, &buscfg, SPI_DMA_CH_AUTO);
+    if (err != ESP_OK && err != ESP_ERR_INVALID_STATE)
+    {
+        return false;
+    }
+
+    spi_device_interface_config_t devcfg = {};
+    devcfg.clock_speed_hz = EPD_SPI_CLOCK_HZ;
+    devcfg.mode = 0;
+    devcfg.spics_io_num = -1; // CS is driven manually so a burst is one assertion
+    devcfg.queue_size = 1; // One queued segment in flight (double buffering)
+
+    err = spi_bus_add_device(kEpdSpiHost, &devcfg, &epdSpi);
+    if (err != ESP_OK)
+    {
+        epdSpi = nullptr;
+        return false;
+    }
+    return true;
+}
+
+void epdSpiWrite(const uint8_t *data, size_t len)
+{
+    while (len > 0)
+    {
+        const size_t chunk = len > kEpdMaxTransferBytes ? kEpdMaxTransferBytes : len;
+        spi_transaction_t t = {};
+        t.length = chunk * 8;
+        if (chunk <= 4)
+        {
+            t.flags = SPI_TRANS_USE_TXDATA;
+            memcpy(t.tx_data, data, chunk);
+            spi_device_polling_transmit(epdSpi, &t);
+        }
+        else
+        {
+            t.tx_buffer = data;
+            spi_device_transmit(epdSpi, &t);
+        }
+        data += chunk;
+        len -= chunk;
+    }
+}
+
+void epdSpiWaitQueued()
+{
+    if (epdTransQueued)
+    {
+        spi_transaction_t *done = nullptr;
+        spi_device_get_trans_result(epdSpi, &done, portMAX_DELAY);
+        epdTransQueued = false;
+    }
+}
+
+// Start a DMA transfer without waiting for it; the previous one is finished first
+void epdSpiQueue(const uint8_t *data, size_t len)
+{
+    while (len > 0)
+    {
+        const size_t chunk = len > kEpdMaxTransferBytes ? kEpdMaxTransferBytes : len;
+        epdSpiWaitQueued();
+        epdQueuedTrans = spi_transaction_t();
+        epdQueuedTrans.length = chunk * 8;
+        epdQueuedTrans.tx_buffer = data;
+        epdTransQueued = spi_device_queue_trans(epdSpi, &epdQueuedTrans, portMAX_DELAY) == ESP_OK;
+        data += chunk;
+        len -= chunk;
+    }
+}
+} // namespace
+#endif
+
 void EPD_GPIOInit(void)
 {
+#if EPD_USE_HW_SPI
+    if (!epdSpiInit())
+    {
+        // Fall back to leaving the pins as plain outputs; EPD writes become no-ops
+        pinMode(SCK, OUTPUT);
+        pinMode(MOSI, OUTPUT);
+    }
+#else
     pinMode(SCK, OUTPUT);
     pinMode(MOSI, OUTPUT);
+#endif
     pinMode(RES, OUTPUT);
     pinMode(DC, OUTPUT);
     pinMode(CS, OUTPUT);
     pinMode(BUSY, INPUT);
+    EPD_CS_Set();
 }
 
+#if !EPD_USE_HW_SPI
 /**
- * @brief       IO模拟SPI发送一个字节数据
+ * @brief       IO模拟SPI移出一个字节 (不操作CS)
  * @param       dat: 需要发送的字节数据
  * @retval      无
  */
-void EPD_WR_Bus(uint8_t dat)
+static void EPD_ShiftOut(uint8_t dat)
 {
     uint8_t i;
-    EPD_CS_Clr();
     for (i = 0; i < 8; i++)
     {
         EPD_SCK_Clr();
@@ -33,6 +147,25 @@ void EPD_WR_Bus(uint8_t dat)
         EPD_SCK_Set();
         dat <<= 1;
     }
+}
+#endif
+
+/**
+ * @brief       SPI发送一个字节数据
+ * @param       dat: 需要发送的字节数据
+ * @retval      无
+ */
+void EPD_WR_Bus(uint8_t dat)
+{
+    EPD_CS_Clr();
+#if EPD_USE_HW_SPI
+    if (epdSpi != nullptr)
+    {
+        epdSpiWrite(&dat, 1);
+    }
+#else
+    EPD_ShiftOut(dat);
+#endif
     EPD_CS_Set();
 }
 
@@ -59,3 +192,81 @@ void EPD_WR_DATA8(uint8_t dat)
     EPD_WR_Bus(dat);
     EPD_DC_Set();
 }
+
+/**
+ * @brief       向液晶连续写多个字节数据 (整个突发只拉低一次CS)
+ * @param       data: 数据缓冲区 (HW SPI时最好位于内部RAM以便DMA直接读取)
+ * @param       len: 字节数
+ * @retval      无
+ */
+void EPD_WR_DATA_Buffer(const uint8_t *data, size_t len)
+{
+    if (len == 0)
+    {
+        return;
+    }
+    EPD_DC_Set();
+    EPD_CS_Clr();
+#if EPD_USE_HW_SPI
+    if (epdSpi != nullptr)
+    {
+        epdSpiWrite(data, len);
+    }
+#else
+    for (size_t i = 0; i < len; i++)
+    {
+        EPD_ShiftOut(data[i]);
+    }
+#endif
+    EPD_CS_Set();
+}
+
+/**
+ * @brief       开始分段突发: 拉低CS, 之后用EPD_WR_DATA_Queue逐段发送
+ * @retval      无
+ */
+void EPD_WR_DATA_Begin(void)
+{
+    EPD_DC_Set();
+    EPD_CS_Clr();
+}
+
+/**
+ * @brief       排队发送一段数据 (HW SPI时DMA在后台进行)
+ * @param       data: 数据缓冲区, 在下一次Queue或End返回前不得修改
+ * @param       len: 字节数
+ * @retval      无
+ */
+void EPD_WR_DATA_Queue(const uint8_t *data, size_t len)
+{
+    if (len == 0)
+    {
+        return;
+    }
+#if EPD_USE_HW_SPI
+    if (epdSpi != nullptr)
+    {
+        epdSpiQueue(data, len);
+    }
+#else
+    for (size_t i = 0; i < len; i++)
+    {
+        EPD_ShiftOut(data[i]);
+    }
+#endif
+}
+
+/**
+ * @brief       结束分段突发: 等待最后一段发送完毕后释放CS
+ * @retval      无
+ */
+void EPD_WR_DATA_End(void)
+{
+#if EPD_USE_HW_SPI
+    if (epdSpi != nullptr)
+    {
+        epdSpiWaitQueued();
+    }
+#endif
+    EPD_CS_Set();
+}
@@ -3,6 +3,18 @@
 
 #include <Arduino.h>
 
+// EPD transport
+// 1: ESP32-S3 hardware SPI (FSPI/SPI2) with DMA, CS held low for a whole burst
+// 0: legacy bit-banged GPIO transport (kept as a compile-time fallback)
+#ifndef EPD_USE_HW_SPI
+#define EPD_USE_HW_SPI 1
+#endif
+
+// SSD1683 write cycle is 50ns min (20MHz); stay below it for the flex cable
+#ifndef EPD_SPI_CLOCK_HZ
+#define EPD_SPI_CLOCK_HZ 10000000
+#endif
+
 //项目板子
 #define SCK 12
 #define MOSI 11
@@ -39,5 +51,12 @@ void EPD_GPIOInit(void);
 void EPD_WR_Bus(uint8_t dat);
 void EPD_WR_REG(uint8_t reg);
 void EPD_WR_DATA8(uint8_t dat);
+void EPD_WR_DATA_Buffer(const uint8_t *data, size_t len);
+
+// 分段异步突发 (双缓冲): Begin拉低CS, Queue排队一段DMA后返回, End等待全部完成并释放CS
+// Queue返回时上一段已发送完毕, 因此调用方可在本段传输期间填充另一块缓冲区
+void EPD_WR_DATA_Begin(void);
+void EPD_WR_DATA_Queue(const uint8_t *data, size_t len);
+void EPD_WR_DATA_End(void);
 
 #endif
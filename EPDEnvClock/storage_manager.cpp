@@ -0,0 +1,118 @@
+#include "storage_manager.h"
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <SPI.h>
+#include <SPIFFS.h>
+#include <SD.h>
+
+#include "boot_profiler.h"
+#include "logger.h"
+
+namespace
+{
+// SD card pin configuration (SPI interface)
+// Using HSPI bus (separate from EPD display which uses FSPI)
+// Based on official 5.79" E-Paper example from CrowPanel
+constexpr int SD_MOSI_PIN = 40;  // SD card MOSI
+constexpr int SD_MISO_PIN = 13;  // SD card MISO
+constexpr int SD_SCK_PIN = 39;   // SD card SCK
+constexpr int SD_CS_PIN = 10;    // SD card CS
+constexpr int SD_POWER_PIN = 42; // SD card power enable
+
+// Create an instance of SPIClass for SD card SPI communication (HSPI bus)
+SPIClass SD_SPI = SPIClass(HSPI);
+
+SemaphoreHandle_t mountMutex = nullptr;
+bool mountAttempted = false;
+StorageMedium medium = StorageMedium::None;
+
+StorageMedium mountStorage()
+{
+  const unsigned long start = millis();
+
+  // Enable SD card power (GPIO 42 must be HIGH for SD card to work)
+  pinMode(SD_POWER_PIN, OUTPUT);
+  digitalWrite(SD_POWER_PIN, HIGH);
+  delay(10); // Brief delay to ensure power stability
+
+  // Initialize HSPI bus for SD card with specified pins
+  SD_SPI.begin(SD_SCK_PIN, SD_MISO_PIN, SD_MOSI_PIN);
+
+  // Try to mount SD card with 80MHz SPI clock speed (same as official example)
+  if (SD.begin(SD_CS_PIN, SD_SPI, 80000000))
+  {
+    LOGI(LogTag::STORAGE, "SD card mounted in %lu ms", millis() - start);
+    return StorageMedium::Sd;
+  }
+
+  // Nothing to power without a working card
+  SD_SPI.end();
+  digitalWrite(SD_POWER_PIN, LOW);
+  LOGW(LogTag::STORAGE, "SD card initialization failed, falling back to SPIFFS");
+  LOGW(LogTag::STORAGE, "WARNING: Using SPIFFS fallback - Flash memory write endurance is limited!");
+  LOGW(LogTag::STORAGE, "WARNING: SPIFFS has 10,000-100,000 write cycles. Consider using SD card for better durability.");
+
+  // Fallback to SPIFFS if SD card is not available
+  if (!SPIFFS.begin(true))
+  {
+    LOGE(LogTag::STORAGE, "SPIFFS Mount Failed");
+    LOGE(LogTag::STORAGE, "ERROR: No storage available! Frame buffer will not be saved.");
+    // Frame buffer and log save/load will fail gracefully
+    return StorageMedium::None;
+  }
+  LOGI(LogTag::STORAGE, "SPIFFS Mounted (fallback)");
+  LOGI(LogTag::STORAGE, "SPIFFS Storage: %u / %u bytes used", SPIFFS.usedBytes(), SPIFFS.totalBytes());
+  return StorageMedium::Spiffs;
+}
+} // namespace
+
+void StorageManager_Init()
+{
+  if (mountMutex == nullptr)
+  {
+    mountMutex = xSemaphoreCreateMutex();
+  }
+}
+
+StorageMedium StorageManager_Mount()
+{
+  if (mountMutex != nullptr)
+  {
+    xSemaphoreTake(mountMutex, portMAX_DELAY);
+  }
+  if (!mountAttempted)
+  {
+    medium = mountStorage();
+    mountAttempted = true;
+    PROFILE_MARK(SdMount);
+  }
+  const StorageMedium result = medium;
+  if (mountMutex != nullptr)
+  {
+    xSemaphoreGive(mountMutex);
+  }
+  return result;
+}
+
+void StorageManager_PowerDown()
+{
+  if (mountMutex != nullptr)
+  {
+    xSemaphoreTake(mountMutex, portMAX_DELAY);
+  }
+  // SPIFFS lives in flash and stays mounted; a failed mount is not retried this boot
+  if (medium == StorageMedium::Sd)
+  {
+    SD.end();
+    SD_SPI.end();
+    digitalWrite(SD_POWER_PIN, LOW); // SD card can consume several mA even when idle
+    medium = StorageMedium::None;
+    mountAttempted = false;
+    LOGD(LogTag::STORAGE, "SD card powered off");
+  }
+  if (mountMutex != nullptr)
+  {
+    xSemaphoreGive(mountMutex);
+  }
+}
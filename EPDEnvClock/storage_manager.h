@@ -0,0 +1,27 @@
+#pragma once
+
+#include <Arduino.h>
+
+// File storage for the frame buffer, sensor log and settings files
+// Nothing is mounted at boot: the first file access mounts the SD card (powering it up),
+// so wakes served from RTC memory never touch the card.
+
+// Where files are stored this boot
+enum class StorageMedium : uint8_t
+{
+  None,   // SD card and SPIFFS both failed
+  Sd,     // SD card (preferred for write endurance)
+  Spiffs, // Internal flash fallback (limited write endurance)
+};
+
+// Create the mount lock (call once early in setup, before any task starts)
+void StorageManager_Init();
+
+// Mount storage on first use: power the SD card, start HSPI and mount it, or fall back to
+// SPIFFS. Later calls return the same medium without retrying. Safe to call from either core.
+StorageMedium StorageManager_Mount();
+
+// Unmount and power off the SD card once this boot's file I/O is done (end of setup, after
+// the post-draw stage; again before deep sleep if something remounted it)
+// The next StorageManager_Mount() mounts it again. No other task may be using storage.
+void StorageManager_PowerDown();
@@ -0,0 +1,366 @@
+// Host benchmark for the render + EPD upload path
+// Runs the firmware's compositor (display_layout.cpp), font renderer and EPD driver against the
+// stub SPI transport and reports per-frame cost, then compares each frame with a golden image.
+//
+//   epd_bench [--iterations N] [--golden DIR] [--update-golden] [--out DIR]
+//
+// --out writes every frame as a raw row-major ImageBW dump (27,200 bytes, whatever
+// EPD_FRAME_CONTROLLER_ORDER is), the input format of scripts/convert_imagebw.py.
+// Exit status is 1 when a frame differs from its golden image.
+
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#include "EPD.h"
+#include "EPD_Init.h"
+#include "display_layout.h"
+#include "frame_codec.h"
+#include "host_stubs.h"
+
+namespace
+{
+constexpr uint32_t kRowBytes = EPD_W / 8;
+constexpr uint32_t kFrameBytes = kRowBytes * EPD_H;
+constexpr uint16_t kDisplayWidth = 792; // Physical width (the 8px controller seam removed)
+constexpr uint16_t kSeamX = 396;
+constexpr uint16_t kSeamWidth = 8;
+constexpr uint32_t kPbmRowBytes = (kDisplayWidth + 7) / 8;
+
+const char *kStatusLine = "B:85%(3.85V) | W:OK(-50) 192.168.1.100 | N:OK | U:1m | H:182345";
+const char *kStatusLineLater = "B:85%(3.84V) | W:--     | N:-- | U:2m | H:182345";
+
+struct Scenario
+{
+  const char *name;
+  int base;        // Scenario whose frame is on the panel beforehand (-1: cold, full redraw)
+  bool fullUpdate; // EPD_Display() instead of EPD_DisplayChanged()
+  DisplayContent content;
+};
+
+DisplayContent makeContent(uint8_t hour, uint8_t minute, uint16_t year, uint8_t month, uint8_t day,
+                           const char *statusLine, float temperature, float humidity, uint16_t co2)
+{
+  DisplayContent content;
+  content.timeAvailable = true;
+  content.hour = hour;
+  content.minute = minute;
+  content.year = year;
+  content.month = month;
+  content.day = day;
+  content.statusLine = statusLine;
+  content.sensorAvailable = true;
+  content.temperature = temperature;
+  content.humidity = humidity;
+  content.co2 = co2;
+  return content;
+}
+
+std::vector<Scenario> makeScenarios()
+{
+  std::vector<Scenario> scenarios;
+  // Cold boot keyframe: every region and the icons
+  scenarios.push_back({"cold_full", -1, true, makeContent(12, 34, 2025, 11, 25, kStatusLine, 23.5f, 45.2f, 1234)});
+  // Typical wake: only the minutes change
+  scenarios.push_back({"minute_tick", 0, false, makeContent(12, 35, 2025, 11, 25, kStatusLine, 23.5f, 45.2f, 1234)});
+  // Readings and status change as well
+  scenarios.push_back({"sensor_change", 1, false, makeContent(12, 36, 2025, 11, 25, kStatusLineLater, 23.6f, 47.0f, 987)});
+  // Hour, day, month and year roll over; widest time and date glyph runs
+  scenarios.push_back({"new_year", 2, false, makeContent(0, 0, 2026, 1, 1, kStatusLineLater, 19.9f, 38.4f, 412)});
+  scenarios.push_back({"late_evening", 3, false, makeContent(23, 58, 2026, 12, 28, kStatusLineLater, 28.8f, 88.0f, 8888)});
+  // Placeholders: no time, no sensor
+  DisplayContent placeholder;
+  placeholder.statusLine = "B:ERR | W:-- | N:-- | U:0m | H:190000 | Msg:Sensor init failed";
+  scenarios.push_back({"no_time_no_sensor", -1, true, placeholder});
+  return scenarios;
+}
+
+struct Frame
+{
+  uint8_t image[kFrameBytes];
+  DisplayLayerKeys layers;
+};
+
+struct Result
+{
+  double renderNs = 0;
+  double uploadNs = 0;
+  uint32_t setPixelCalls = 0;
+  uint8_t regions = 0;
+  BenchSpiStats spi;
+};
+
+uint8_t ImageBW[kFrameBytes];
+
+int64_t nowNs()
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Put the canvas, layer keys and controller shadow in the state the scenario starts from
+void prepare(const Scenario &scenario, const std::vector<Frame> &frames, DisplayLayerKeys &layers)
+{
+  if (scenario.base < 0)
+  {
+    memset(ImageBW, WHITE, sizeof(ImageBW));
+    layers = DisplayLayerKeys();
+    EPD_Display_Clear();
+    return;
+  }
+  const Frame &base = frames[scenario.base];
+  memcpy(ImageBW, base.image, sizeof(ImageBW));
+  layers = base.layers;
+  EPD_Display(base.image); // Controller RAM (and the driver's shadow) hold the previous frame
+}
+
+// One pass of performUpdate()'s compute work: compose, then upload
+Result runOnce(const Scenario &scenario, DisplayLayerKeys &layers)
+{
+  Result result;
+  Paint_SetPixelCount = 0;
+  const int64_t start = nowNs();
+  if (scenario.fullUpdate || layers.magic != kDisplayLayerKeysMagic)
+  {
+    Paint_Clear(WHITE);
+    layers = DisplayLayerKeys();
+    layers.magic = kDisplayLayerKeysMagic;
+  }
+  result.regions = DisplayLayout_Compose(layers, scenario.content);
+  const int64_t drawn = nowNs();
+  result.setPixelCalls = Paint_SetPixelCount;
+
+  BenchSpi_Reset();
+  if (scenario.fullUpdate)
+  {
+    EPD_Display(ImageBW);
+  }
+  else
+  {
+    EPD_DisplayChanged(ImageBW);
+  }
+  const int64_t uploaded = nowNs();
+  result.spi = BenchSpi_Stats();
+  result.renderNs = (double)(drawn - start);
+  result.uploadNs = (double)(uploaded - drawn);
+  return result;
+}
+
+// Physical 792x272 bitmap (1 = black, PBM order) with the same seam removal and 180 degree
+// rotation as scripts/convert_imagebw.py
+std::vector<uint8_t> toDisplayBitmap(const uint8_t *image)
+{
+  std::vector<uint8_t> bitmap(kPbmRowBytes * EPD_H, 0);
+  for (uint32_t ySrc = 0; ySrc < EPD_H; ySrc++)
+  {
+    for (uint32_t xSrc = 0; xSrc < EPD_W; xSrc++)
+    {
+      if (xSrc >= kSeamX && xSrc < kSeamX + kSeamWidth)
+        continue;
+      const uint32_t xDisplay = xSrc < kSeamX ? xSrc : xSrc - kSeamWidth;
+      const uint32_t x = kDisplayWidth - 1 - xDisplay;
+      const uint32_t y = EPD_H - 1 - ySrc;
+      const bool white = image[EPD_FRAME_INDEX(xSrc / 8, ySrc)] & (0x80 >> (xSrc % 8));
+      if (!white)
+        bitmap[y * kPbmRowBytes + x / 8] |= 0x80 >> (x % 8);
+    }
+  }
+  return bitmap;
+}
+
+// The frame in row-major order (rows of kRowBytes)
+std::vector<uint8_t> toRowMajor(const uint8_t *image)
+{
+  std::vector<uint8_t> rows(kFrameBytes);
+  for (uint32_t line = 0; line < EPD_H; line++)
+  {
+    for (uint32_t col = 0; col < kRowBytes; col++)
+    {
+      rows[line * kRowBytes + col] = image[EPD_FRAME_INDEX(col, line)];
+    }
+  }
+  return rows;
+}
+
+bool writeFile(const std::string &path, const void *data, size_t len, const char *header = nullptr)
+{
+  FILE *file = fopen(path.c_str(), "wb");
+  if (file == nullptr)
+    return false;
+  bool ok = header == nullptr || fputs(header, file) >= 0;
+  ok = ok && fwrite(data, 1, len, file) == len;
+  return fclose(file) == 0 && ok;
+}
+
+bool readPbm(const std::string &path, std::vector<uint8_t> &bitmap)
+{
+  FILE *file = fopen(path.c_str(), "rb");
+  if (file == nullptr)
+    return false;
+  unsigned width = 0, height = 0;
+  bool ok = fscanf(file, "P4 %u %u", &width, &height) == 2 && fgetc(file) != EOF &&
+            width == kDisplayWidth && height == EPD_H;
+  bitmap.assign(kPbmRowBytes * EPD_H, 0);
+  ok = ok && fread(bitmap.data(), 1, bitmap.size(), file) == bitmap.size();
+  fclose(file);
+  return ok;
+}
+
+// Returns the number of differing pixels and their bounding box
+uint32_t compareBitmaps(const std::vector<uint8_t> &a, const std::vector<uint8_t> &b, Region &bounds)
+{
+  uint32_t diff = 0;
+  bounds = {kDisplayWidth, EPD_H, 0, 0};
+  for (uint32_t y = 0; y < EPD_H; y++)
+  {
+    for (uint32_t x = 0; x < kDisplayWidth; x++)
+    {
+      const uint32_t i = y * kPbmRowBytes + x / 8;
+      const uint8_t bit = 0x80 >> (x % 8);
+      if ((a[i] & bit) == (b[i] & bit))
+        continue;
+      diff++;
+      if (x < bounds.x0) bounds.x0 = x;
+      if (y < bounds.y0) bounds.y0 = y;
+      if (x > bounds.x1) bounds.x1 = x;
+      if (y > bounds.y1) bounds.y1 = y;
+    }
+  }
+  return diff;
+}
+
+// ImageBW export payload: XOR-RLE delta against the previous frame (keyframe: against white).
+// ok is false if the delta does not rebuild the frame.
+size_t exportDeltaSize(const uint8_t *image, const uint8_t *reference, bool &ok)
+{
+  std::vector<uint8_t> delta(kFrameBytes + kFrameDeltaSlack);
+  size_t deltaSize = 0;
+  ok = FrameCodec_EncodeXorDelta(image, reference, kFrameBytes, delta.data(), delta.size(), deltaSize);
+  std::vector<uint8_t> rebuilt(kFrameBytes, WHITE);
+  if (reference != nullptr)
+    memcpy(rebuilt.data(), reference, kFrameBytes);
+  ok = ok && FrameCodec_ApplyXorDelta(delta.data(), deltaSize, rebuilt.data(), kFrameBytes) &&
+       memcmp(rebuilt.data(), image, kFrameBytes) == 0;
+  return deltaSize;
+}
+
+void usage(const char *argv0)
+{
+  fprintf(stderr, "Usage: %s [--iterations N] [--golden DIR] [--update-golden] [--out DIR]\n", argv0);
+}
+} // namespace
+
+int main(int argc, char **argv)
+{
+  int iterations = 200;
+  std::string goldenDir;
+  std::string outDir;
+  bool updateGolden = false;
+  for (int i = 1; i < argc; i++)
+  {
+    if (strcmp(argv[i], "--iterations") == 0 && i + 1 < argc)
+      iterations = atoi(argv[++i]);
+    else if (strcmp(argv[i], "--golden") == 0 && i + 1 < argc)
+      goldenDir = argv[++i];
+    else if (strcmp(argv[i], "--out") == 0 && i + 1 < argc)
+      outDir = argv[++i];
+    else if (strcmp(argv[i], "--update-golden") == 0)
+      updateGolden = true;
+    else
+    {
+      usage(argv[0]);
+      return 2;
+    }
+  }
+  if (iterations < 1)
+    iterations = 1;
+
+  Paint_NewImage(ImageBW, EPD_W, EPD_H, Rotation, WHITE);
+
+  const std::vector<Scenario> scenarios = makeScenarios();
+  std::vector<Frame> frames(scenarios.size());
+  int failures = 0;
+
+  printf("%-18s %12s %12s %10s %7s %8s %9s %6s %8s %7s  %s\n", "scenario", "render_ns", "upload_ns", "set_pixel",
+         "regions", "spi_cmd", "spi_data", "bursts", "segments", "export", "golden");
+  for (size_t s = 0; s < scenarios.size(); s++)
+  {
+    const Scenario &scenario = scenarios[s];
+    Result total;
+    Result last;
+    for (int i = 0; i < iterations; i++)
+    {
+      DisplayLayerKeys layers;
+      prepare(scenario, frames, layers);
+      last = runOnce(scenario, layers);
+      total.renderNs += last.renderNs;
+      total.uploadNs += last.uploadNs;
+      if (i == iterations - 1)
+      {
+        memcpy(frames[s].image, ImageBW, sizeof(ImageBW));
+        frames[s].layers = layers;
+      }
+    }
+
+    bool deltaOk = false;
+    const size_t exportBytes =
+        exportDeltaSize(ImageBW, scenario.base < 0 ? nullptr : frames[scenario.base].image, deltaOk);
+    if (!deltaOk)
+    {
+      failures++;
+      fprintf(stderr, "%s: export delta does not rebuild the frame\n", scenario.name);
+    }
+
+    if (!outDir.empty())
+    {
+      const std::vector<uint8_t> rows = toRowMajor(ImageBW);
+      writeFile(outDir + "/" + scenario.name + ".bin", rows.data(), rows.size());
+    }
+
+    const char *golden = "-";
+    if (!goldenDir.empty())
+    {
+      const std::string path = goldenDir + "/" + scenario.name + ".pbm";
+      const std::vector<uint8_t> actual = toDisplayBitmap(ImageBW);
+      char header[32];
+      snprintf(header, sizeof(header), "P4\n%u %u\n", kDisplayWidth, (unsigned)EPD_H);
+      std::vector<uint8_t> expected;
+      if (updateGolden)
+      {
+        golden = writeFile(path, actual.data(), actual.size(), header) ? "updated" : "WRITE FAILED";
+      }
+      else if (!readPbm(path, expected))
+      {
+        golden = "MISSING";
+        failures++;
+      }
+      else
+      {
+        Region bounds;
+        const uint32_t diff = compareBitmaps(actual, expected, bounds);
+        golden = diff == 0 ? "ok" : "DIFF";
+        if (diff != 0)
+        {
+          failures++;
+          fprintf(stderr, "%s: %u pixels differ in (%u,%u)-(%u,%u)\n", scenario.name, diff, bounds.x0, bounds.y0,
+                  bounds.x1, bounds.y1);
+        }
+      }
+    }
+
+    printf("%-18s %12.0f %12.0f %10u %7u %8u %9u %6u %8u %7zu  %s\n", scenario.name, total.renderNs / iterations,
+           total.uploadNs / iterations, last.setPixelCalls, last.regions, last.spi.commandBytes, last.spi.dataBytes,
+           last.spi.bursts, last.spi.segments, exportBytes, golden);
+  }
+
+  if (failures > 0)
+  {
+    fprintf(stderr, "%d check(s) failed. Inspect differing frames with --out DIR and\n"
+                    "scripts/convert_imagebw.py DIR/<scenario>.bin; rerun with --update-golden if intended.\n",
+            failures);
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,96 @@
+#include "host_stubs.h"
+
+#include <chrono>
+
+#include "Arduino.h"
+#include "esp_rom_crc.h"
+#include "esp_sleep.h"
+#include "logger.h"
+#include "power_manager.h"
+#include "spi.h"
+
+HardwareSerial Serial;
+
+namespace
+{
+const auto kStart = std::chrono::steady_clock::now();
+BenchSpiStats spiStats;
+} // namespace
+
+unsigned long millis()
+{
+  return (unsigned long)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - kStart).count();
+}
+
+unsigned long micros()
+{
+  return (unsigned long)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - kStart).count();
+}
+
+uint32_t esp_rom_crc32_le(uint32_t crc, const uint8_t *buf, uint32_t len)
+{
+  crc = ~crc;
+  for (uint32_t i = 0; i < len; i++)
+  {
+    crc ^= buf[i];
+    for (int k = 0; k < 8; k++)
+      crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1)));
+  }
+  return ~crc;
+}
+
+// Logging is compiled out (LOG_MIN_LEVEL); anything left is dropped
+void Logger_Log(LogLevel, const char *, const char *, ...) {}
+
+// No boot profile on the host (power_manager.cpp)
+void PowerManager_LightSleep()
+{
+  esp_light_sleep_start();
+}
+
+// SPI transport (replaces spi.cpp): count instead of clocking bytes out
+void EPD_GPIOInit(void) {}
+
+void EPD_WR_Bus(uint8_t)
+{
+  spiStats.dataBytes++;
+}
+
+void EPD_WR_REG(uint8_t)
+{
+  spiStats.commandBytes++;
+}
+
+void EPD_WR_DATA8(uint8_t)
+{
+  spiStats.dataBytes++;
+}
+
+void EPD_WR_DATA_Buffer(const uint8_t *, size_t len)
+{
+  spiStats.dataBytes += len;
+  spiStats.bursts++;
+}
+
+void EPD_WR_DATA_Begin(void)
+{
+  spiStats.bursts++;
+}
+
+void EPD_WR_DATA_Queue(const uint8_t *, size_t len)
+{
+  spiStats.dataBytes += len;
+  spiStats.segments++;
+}
+
+void EPD_WR_DATA_End(void) {}
+
+void BenchSpi_Reset()
+{
+  spiStats = BenchSpiStats();
+}
+
+const BenchSpiStats &BenchSpi_Stats()
+{
+  return spiStats;
+}
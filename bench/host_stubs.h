@@ -0,0 +1,15 @@
+#pragma once
+
+#include <stdint.h>
+
+// What the EPD driver sent through the stub SPI transport (spi.h) since the last reset
+struct BenchSpiStats
+{
+  uint32_t commandBytes = 0; // EPD_WR_REG
+  uint32_t dataBytes = 0;    // EPD_WR_DATA8 + EPD_WR_DATA_Buffer
+  uint32_t bursts = 0;       // CS-low data bursts (EPD_WR_DATA_Buffer, EPD_WR_DATA_Begin..End)
+  uint32_t segments = 0;     // EPD_WR_DATA_Queue calls (one DMA transaction each on the device)
+};
+
+void BenchSpi_Reset();
+const BenchSpiStats &BenchSpi_Stats();
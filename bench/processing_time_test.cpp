@@ -0,0 +1,55 @@
+// Host check of the processing-time file format (EPDEnvClock/processing_time.h)
+//   processing_time_test    (exit status 0 = pass)
+
+#include <math.h>
+#include <stdio.h>
+
+#include "processing_time.h"
+
+namespace
+{
+int failures = 0;
+
+void expect(bool condition, const char *what)
+{
+  if (!condition)
+  {
+    fprintf(stderr, "FAIL: %s\n", what);
+    failures++;
+  }
+}
+
+bool near(float a, float b)
+{
+  return fabsf(a - b) < 0.005f;
+}
+} // namespace
+
+int main()
+{
+  // A sub-second estimate (fast no-WiFi wake) survives a save/load round trip
+  char text[48];
+  ProcessingTime_Format(text, sizeof(text), 0.4f, 2.35f);
+  float noWifi = 0.0f;
+  float wifi = 0.0f;
+  expect(ProcessingTime_Parse(text, noWifi, wifi), "round trip parses");
+  expect(near(noWifi, 0.4f) && near(wifi, 2.35f), "round trip keeps 0.4 s / 2.35 s");
+
+  expect(ProcessingTime_IsValid(0.4f) && !ProcessingTime_IsValid(0.1f) && !ProcessingTime_IsValid(25.0f),
+         "validity range");
+  expect(near(ProcessingTime_Clamp(0.4f), 0.4f) && near(ProcessingTime_Clamp(0.05f), kProcessingTimeMinSec) &&
+             near(ProcessingTime_Clamp(30.0f), kProcessingTimeMaxSec),
+         "clamp");
+
+  expect(ProcessingTime_Parse("3.25\n", noWifi, wifi) && near(noWifi, 3.25f) && near(wifi, 3.25f),
+         "legacy single value applies to both");
+  expect(ProcessingTime_Parse("WiFi = 4.5\n", noWifi, wifi) && near(noWifi, 4.5f) && near(wifi, 4.5f),
+         "missing estimate takes the other's value");
+  expect(!ProcessingTime_Parse("no_wifi=0.05\nwifi=abc\n", noWifi, wifi), "out-of-range values are rejected");
+
+  if (failures == 0)
+  {
+    printf("processing_time_test: all checks passed\n");
+  }
+  return failures == 0 ? 0 : 1;
+}
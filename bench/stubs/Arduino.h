@@ -0,0 +1,52 @@
+#pragma once
+
+// Minimal Arduino surface for the host benchmark (bench/)
+// Only what EPD.cpp, EPD_Init.cpp, font_renderer.cpp, display_layout.cpp, frame_codec.cpp and the
+// bitmaps/ headers use.
+
+#include <algorithm>
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/time.h>
+#include <time.h>
+
+#define PROGMEM
+#define pgm_read_byte(p) (*(const uint8_t *)(p))
+#define pgm_read_word(p) (*(const uint16_t *)(p))
+#define memcpy_P memcpy
+#define IRAM_ATTR
+#define RTC_DATA_ATTR
+#define WORD_ALIGNED_ATTR __attribute__((aligned(4)))
+
+#define HIGH 1
+#define LOW 0
+#define INPUT 0
+#define OUTPUT 1
+#define INPUT_PULLUP 2
+#define FALLING 2
+
+typedef uint8_t byte;
+using std::min;
+
+unsigned long millis();
+unsigned long micros();
+inline void delay(uint32_t) {}
+inline void delayMicroseconds(uint32_t) {}
+
+// GPIO: BUSY always reads idle, so every EPD wait returns immediately
+inline void pinMode(uint8_t, uint8_t) {}
+inline void digitalWrite(uint8_t, uint8_t) {}
+inline int digitalRead(uint8_t) { return LOW; }
+inline void attachInterrupt(uint8_t, void (*)(void), int) {}
+inline void detachInterrupt(uint8_t) {}
+#define digitalPinToInterrupt(p) (p)
+
+class HardwareSerial
+{
+public:
+  void flush() {}
+};
+extern HardwareSerial Serial;
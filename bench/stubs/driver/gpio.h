@@ -0,0 +1,9 @@
+#pragma once
+
+typedef int gpio_num_t;
+enum
+{
+  GPIO_INTR_LOW_LEVEL = 4,
+};
+inline int gpio_wakeup_enable(gpio_num_t, int) { return 0; }
+inline int gpio_wakeup_disable(gpio_num_t) { return 0; }
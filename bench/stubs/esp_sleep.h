@@ -0,0 +1,13 @@
+#pragma once
+
+#include <stdint.h>
+
+enum
+{
+  ESP_SLEEP_WAKEUP_TIMER = 4,
+  ESP_SLEEP_WAKEUP_GPIO = 7,
+};
+inline int esp_sleep_enable_gpio_wakeup() { return 0; }
+inline int esp_sleep_enable_timer_wakeup(uint64_t) { return 0; }
+inline int esp_sleep_disable_wakeup_source(int) { return 0; }
+inline int esp_light_sleep_start() { return 0; }
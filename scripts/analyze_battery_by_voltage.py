@@ -2,31 +2,17 @@
 """
 Analyze battery drain rate by voltage range.
 Higher voltage = fuller battery, lower internal resistance.
+Reads the local sensor logs through sensor_log_cache.py, one row at a time.
+
+Usage: analyze_battery_by_voltage.py [--device ID]
 """
-import json
-from pathlib import Path
-from datetime import datetime
+import argparse
 from collections import defaultdict
 
-LOGS_DIR = Path(__file__).parent.parent / "logs" / "sensor_logs"
-
-def load_all_logs():
-    """Load all log files."""
-    all_data = []
-    for filepath in sorted(LOGS_DIR.glob("sensor_log_*.jsonl")):
-        date = filepath.stem.split('_')[-1]
-        with open(filepath, 'r') as f:
-            for line in f:
-                try:
-                    entry = json.loads(line.strip())
-                    entry['_date'] = date
-                    all_data.append(entry)
-                except:
-                    continue
-    return all_data
+from sensor_log_cache import iter_readings, local_datetime, open_cache
 
 
-def analyze_by_voltage_range(data, cutoff_date="20251212"):
+def analyze_by_voltage_range(conn, device=None, cutoff_date="20251212"):
     """Analyze drain rate by voltage range, before and after cutoff."""
     
     # Voltage ranges
@@ -46,20 +32,19 @@ def analyze_by_voltage_range(data, cutoff_date="20251212"):
         drains_by_range = defaultdict(list)
         
         prev = None
+        prev_device = None
         for entry in entries:
-            v = entry.get('batt_voltage')
-            charging = entry.get('charging', False)
-            dt_str = f"{entry['date']} {entry['time']}"
+            v = entry['battery_voltage']
+            charging = entry['battery_charging']
             
+            if entry['device_id'] != prev_device:
+                prev = None
+                prev_device = entry['device_id']
             if v is None or charging or v < 3.0 or v > 4.3:
                 prev = None
                 continue
             
-            try:
-                dt = datetime.strptime(dt_str, "%Y.%m.%d %H:%M:%S")
-            except:
-                prev = None
-                continue
+            dt = local_datetime(entry['timestamp'])
             
             if prev is not None:
                 prev_v, prev_dt = prev
@@ -79,12 +64,9 @@ def analyze_by_voltage_range(data, cutoff_date="20251212"):
         
         return drains_by_range
     
-    # Split data
-    before = [e for e in data if e['_date'] < cutoff_date]
-    after = [e for e in data if e['_date'] >= cutoff_date]
-    
-    before_drains = calc_drains(before, "before")
-    after_drains = calc_drains(after, "after")
+    # Split data (streamed from the cache)
+    before_drains = calc_drains(iter_readings(conn, until_day=cutoff_date, device=device), "before")
+    after_drains = calc_drains(iter_readings(conn, since_day=cutoff_date, device=device), "after")
     
     print("=" * 90)
     print("DRAIN RATE BY VOLTAGE RANGE (mV per hour)")
@@ -148,12 +130,17 @@ def analyze_by_voltage_range(data, cutoff_date="20251212"):
 
 
 def main():
+    parser = argparse.ArgumentParser(description="Battery drain rate by voltage range")
+    parser.add_argument("--device", help="Only this device (default: all)")
+    args = parser.parse_args()
+
     print("Loading all sensor logs...")
-    data = load_all_logs()
-    print(f"Loaded {len(data)} entries")
+    conn = open_cache()
+    count = conn.execute("SELECT COUNT(*) FROM readings").fetchone()[0]
+    print(f"{count} entries in the cache")
     print()
     
-    analyze_by_voltage_range(data)
+    analyze_by_voltage_range(conn, args.device)
 
 
 if __name__ == '__main__':
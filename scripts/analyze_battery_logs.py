@@ -1,16 +1,17 @@
 #!/usr/bin/env python3
 """
-Analyze battery consumption from local sensor logs.
+Analyze battery consumption from local sensor logs (via sensor_log_cache.py).
 Compare battery drain rates before and after 2025-12-12.
+
+Usage: analyze_battery_logs.py [--device ID]
 """
-import json
-import os
-from pathlib import Path
+import argparse
 from datetime import datetime
-from typing import List, Dict, Tuple, Optional
+from itertools import groupby
+from typing import Iterable, List, Dict, Tuple, Optional
 from dataclasses import dataclass
 
-LOGS_DIR = Path(__file__).parent.parent / "logs" / "sensor_logs"
+from sensor_log_cache import iter_readings, local_datetime, open_cache
 
 
 @dataclass
@@ -25,41 +26,17 @@ class DischargeSession:
     data_points: int
 
 
-def load_log_file(filepath: Path) -> List[Dict]:
-    """Load a JSONL log file."""
-    data = []
-    with open(filepath, 'r') as f:
-        for line in f:
-            line = line.strip()
-            if line:
-                try:
-                    entry = json.loads(line)
-                    data.append(entry)
-                except json.JSONDecodeError:
-                    continue
-    return data
-
-
-def parse_datetime(entry: Dict) -> datetime:
-    """Parse datetime from log entry."""
-    date_str = entry.get('date', '')
-    time_str = entry.get('time', '')
-    if date_str and time_str:
-        return datetime.strptime(f"{date_str} {time_str}", "%Y.%m.%d %H:%M:%S")
-    return None
-
-
-def find_discharge_sessions(data: List[Dict], min_duration_hours: float = 1.0) -> List[DischargeSession]:
+def find_discharge_sessions(data: Iterable, min_duration_hours: float = 1.0) -> List[DischargeSession]:
     """Find continuous discharge sessions (not charging, valid voltage)."""
     sessions = []
     session_data = []
     
     for entry in data:
-        voltage = entry.get('batt_voltage')
-        charging = entry.get('charging', False)
-        dt = parse_datetime(entry)
+        voltage = entry['battery_voltage']
+        charging = entry['battery_charging']
+        dt = local_datetime(entry['timestamp'])
         
-        if dt is None or voltage is None or voltage < 3.0 or voltage > 4.3 or charging:
+        if voltage is None or voltage < 3.0 or voltage > 4.3 or charging:
             # End current session if we have one
             if len(session_data) > 1:
                 sessions.append(create_session(session_data))
@@ -101,9 +78,9 @@ def create_session(data: List[Tuple[datetime, float]]) -> DischargeSession:
     )
 
 
-def analyze_log_file(filepath: Path) -> Dict:
-    """Analyze a single log file."""
-    data = load_log_file(filepath)
+def analyze_day(device_id: str, day: str, readings: Iterable) -> Dict:
+    """Analyze one day of readings (one log file)."""
+    data = list(readings)
     if not data:
         return None
     
@@ -120,8 +97,8 @@ def analyze_log_file(filepath: Path) -> Dict:
     avg_drain_rate = total_drain / total_hours if total_hours > 0 else 0
     
     return {
-        'file': filepath.name,
-        'date': filepath.stem.split('_')[-1],
+        'file': day if device_id == 'default' else f"{device_id}/{day}",
+        'date': day,
         'total_entries': len(data),
         'sessions': sessions,
         'total_hours': total_hours,
@@ -131,16 +108,20 @@ def analyze_log_file(filepath: Path) -> Dict:
 
 
 def main():
-    # Find all log files
-    log_files = sorted(LOGS_DIR.glob("sensor_log_*.jsonl"))
+    parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    parser.add_argument("--device", help="Only this device (default: all)")
+    args = parser.parse_args()
+
+    conn = open_cache()
     
     print("=" * 80)
     print("BATTERY CONSUMPTION ANALYSIS")
     print("=" * 80)
     
     results = []
-    for filepath in log_files:
-        result = analyze_log_file(filepath)
+    days = groupby(iter_readings(conn, device=args.device), key=lambda r: (r['device_id'], r['day']))
+    for (device_id, day), readings in days:
+        result = analyze_day(device_id, day, readings)
         if result:
             results.append(result)
     
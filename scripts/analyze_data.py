@@ -1,8 +1,13 @@
 #!/usr/bin/env python3
 """
 Analyze latest sensor data from D1 database via wrangler
+(--local: from the local sensor logs, through sensor_log_cache.py)
+
+Usage: analyze_data.py [hours] [--local] [--device ID]
 """
+import argparse
 import json
+import re
 import sys
 import subprocess
 import os
@@ -43,15 +48,29 @@ def load_dotenv():
 load_dotenv()
 
 
-def fetch_data(hours: int = 48) -> Dict[str, Any]:
+def fetch_local_data(hours: int = 48, device: str = None) -> Dict[str, Any]:
+    """Read the last hours of readings from the local log cache"""
+    from sensor_log_cache import iter_readings, open_cache
+
+    start_ts = int(datetime.now().timestamp()) - (hours * 3600)
+    data = [dict(row) for row in iter_readings(open_cache(), device=device, since_ts=start_ts)]
+    data.sort(key=lambda d: d['timestamp'])
+    return {'success': True, 'data': data, 'count': len(data)}
+
+
+def fetch_data(hours: int = 48, device: str = None) -> Dict[str, Any]:
     """Fetch sensor data from D1 database via wrangler"""
     now_ts = int(datetime.now().timestamp())
     start_ts = now_ts - (hours * 3600)
 
+    if device is not None and not re.fullmatch(r"[A-Za-z0-9._-]{1,64}", device):
+        print(f"Invalid device id: {device}", file=sys.stderr)
+        sys.exit(1)
+    device_filter = f"AND device_id = '{device}'" if device else ""
     query = f"""
     SELECT timestamp, temperature, humidity, co2, battery_voltage, battery_percent, battery_rate, battery_charging, rtc_drift_ms
     FROM sensor_data
-    WHERE timestamp >= {start_ts}
+    WHERE timestamp >= {start_ts} {device_filter}
     ORDER BY timestamp ASC
     """
 
@@ -218,10 +237,15 @@ def analyze_wifi_skips(data: List[Dict]) -> None:
 
 
 def main():
-    hours = int(sys.argv[1]) if len(sys.argv) > 1 else 48
+    parser = argparse.ArgumentParser(description="Analyze the latest sensor data")
+    parser.add_argument("hours", nargs="?", type=int, default=48)
+    parser.add_argument("--local", action="store_true", help="Read the local sensor logs instead of D1")
+    parser.add_argument("--device", help="Only this device (default: all)")
+    args = parser.parse_args()
+    hours = args.hours
     print(f"Fetching last {hours} hours of data...")
 
-    result = fetch_data(hours)
+    result = fetch_local_data(hours, args.device) if args.local else fetch_data(hours, args.device)
 
     if not result.get('success'):
         print(f"API error: {result.get('error', 'Unknown error')}", file=sys.stderr)
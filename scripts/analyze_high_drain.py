@@ -1,15 +1,24 @@
 #!/usr/bin/env python3
 """
 Find specific high-drain periods in the 4.0V-4.1V range after 12/12.
+Reads the local sensor logs through sensor_log_cache.py.
+
+Usage: analyze_high_drain.py [--device ID]
 """
-import json
-from pathlib import Path
-from datetime import datetime
+import argparse
 from collections import defaultdict
+from itertools import groupby
+
+from sensor_log_cache import iter_readings, local_datetime, open_cache
+
 
-LOGS_DIR = Path(__file__).parent.parent / "logs" / "sensor_logs"
+def by_day(readings):
+    """(device_id, day, readings of that day) in log order"""
+    for (device_id, date), rows in groupby(readings, key=lambda r: (r['device_id'], r['day'])):
+        yield device_id, date, rows
 
-def analyze_high_drain():
+
+def analyze_high_drain(conn, device=None):
     """Find high drain periods."""
     
     # Focus on after 12/12, 4.0V-4.1V range
@@ -17,34 +26,17 @@ def analyze_high_drain():
     
     high_drain_periods = []
     
-    for filepath in sorted(LOGS_DIR.glob("sensor_log_*.jsonl")):
-        date = filepath.stem.split('_')[-1]
-        if date < cutoff_date:
-            continue
-        
-        data = []
-        with open(filepath, 'r') as f:
-            for line in f:
-                try:
-                    entry = json.loads(line.strip())
-                    data.append(entry)
-                except:
-                    continue
-        
+    for _device_id, date, data in by_day(iter_readings(conn, since_day=cutoff_date, device=device)):
         prev = None
         for entry in data:
-            v = entry.get('batt_voltage')
-            charging = entry.get('charging', False)
+            v = entry['battery_voltage']
+            charging = entry['battery_charging']
             
             if v is None or charging or v < 3.0 or v > 4.3:
                 prev = None
                 continue
             
-            try:
-                dt = datetime.strptime(f"{entry['date']} {entry['time']}", "%Y.%m.%d %H:%M:%S")
-            except:
-                prev = None
-                continue
+            dt = local_datetime(entry['timestamp'])
             
             if prev is not None:
                 prev_v, prev_dt, prev_entry = prev
@@ -59,7 +51,7 @@ def analyze_high_drain():
                     if 4.0 <= v < 4.1 and drain_per_hour > 50:
                         high_drain_periods.append({
                             'date': date,
-                            'time': entry['time'],
+                            'time': dt.strftime('%H:%M:%S'),
                             'voltage': v,
                             'prev_voltage': prev_v,
                             'drain_mV': drain_mV,
@@ -99,40 +91,25 @@ def analyze_high_drain():
         print(f"\n  Average: {avg_drain:.0f} mV/h")
 
 
-def compare_daily_drain():
+def compare_daily_drain(conn, device=None):
     """Compare daily drain rates for all log files."""
     print("\n" + "=" * 80)
     print("DAILY DRAIN RATE COMPARISON (4.0V-4.2V range only)")
     print("=" * 80)
     print()
     
-    for filepath in sorted(LOGS_DIR.glob("sensor_log_*.jsonl")):
-        date = filepath.stem.split('_')[-1]
-        
-        data = []
-        with open(filepath, 'r') as f:
-            for line in f:
-                try:
-                    entry = json.loads(line.strip())
-                    data.append(entry)
-                except:
-                    continue
-        
+    for device_id, date, data in by_day(iter_readings(conn, device=device)):
         drains = []
         prev = None
         for entry in data:
-            v = entry.get('batt_voltage')
-            charging = entry.get('charging', False)
+            v = entry['battery_voltage']
+            charging = entry['battery_charging']
             
             if v is None or charging or not (4.0 <= v <= 4.2):
                 prev = None
                 continue
             
-            try:
-                dt = datetime.strptime(f"{entry['date']} {entry['time']}", "%Y.%m.%d %H:%M:%S")
-            except:
-                prev = None
-                continue
+            dt = local_datetime(entry['timestamp'])
             
             if prev is not None:
                 prev_v, prev_dt = prev
@@ -147,10 +124,15 @@ def compare_daily_drain():
         if drains:
             avg_drain = sum(drains) / len(drains) * 60
             marker = " ⚠️" if avg_drain > 20 else ""
-            print(f"{date[:4]}-{date[4:6]}-{date[6:]}: {avg_drain:>6.1f} mV/h (n={len(drains):>4}){marker}")
+            label = "" if device_id == "default" else f"{device_id} "
+            print(f"{label}{date[:4]}-{date[4:6]}-{date[6:]}: {avg_drain:>6.1f} mV/h (n={len(drains):>4}){marker}")
 
 
 if __name__ == '__main__':
-    analyze_high_drain()
-    compare_daily_drain()
+    parser = argparse.ArgumentParser(description="Find high-drain periods in the local sensor logs")
+    parser.add_argument("--device", help="Only this device (default: all)")
+    args = parser.parse_args()
+    conn = open_cache()
+    analyze_high_drain(conn, args.device)
+    compare_daily_drain(conn, args.device)
 
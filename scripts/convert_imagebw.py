@@ -8,13 +8,26 @@ Screen size: 800x272 pixels
 from PIL import Image
 import os
 
-def convert_imagebw_to_png(imagebw_data, output_filename=None):
+def controller_order_to_row_major(imagebw_data):
+    """
+    Reorder an ImageBW buffer in controller RAM order (EPD_FRAME_CONTROLLER_ORDER=1:
+    100 byte columns of 272 lines each) into the row-major layout (272 rows of 100 bytes)
+    """
+    columns, lines = 100, 272
+    row_major = bytearray(len(imagebw_data))
+    for col in range(columns):
+        for line in range(lines):
+            row_major[line * columns + col] = imagebw_data[col * lines + line]
+    return bytes(row_major)
+
+def convert_imagebw_to_png(imagebw_data, output_filename=None, controller_order=False):
     """
     Convert ImageBW byte array to PNG image
 
     Args:
         imagebw_data: bytes or bytearray of ImageBW data (27,200 bytes)
         output_filename: Output PNG filename (optional)
+        controller_order: True if the buffer is in controller RAM order (column by column)
 
     Returns:
         Path to saved PNG file
@@ -29,6 +42,9 @@ def convert_imagebw_to_png(imagebw_data, output_filename=None):
     if len(imagebw_data) != 27200:
         raise ValueError(f"Invalid ImageBW data length: {len(imagebw_data)}, expected 27200")
 
+    if controller_order:
+        imagebw_data = controller_order_to_row_major(imagebw_data)
+
     # Screen dimensions (logical buffer size)
     EPD_W = 800  # Logical width (includes 4px gap)
     EPD_H = 272  # Height
@@ -119,18 +135,23 @@ def convert_imagebw_to_png(imagebw_data, output_filename=None):
 if __name__ == '__main__':
     import sys
 
-    if len(sys.argv) < 2:
-        print("Usage: convert_imagebw.py <input_file> [output_file]")
+    args = sys.argv[1:]
+    controller_order = '--controller-order' in args
+    args = [arg for arg in args if arg != '--controller-order']
+
+    if len(args) < 1:
+        print("Usage: convert_imagebw.py [--controller-order] <input_file> [output_file]")
+        print("  --controller-order: input is in controller RAM order (EPD_FRAME_CONTROLLER_ORDER=1)")
         print("  input_file: Binary ImageBW file (27,200 bytes)")
         print("  output_file: Output PNG filename (optional)")
         sys.exit(1)
 
-    input_file = sys.argv[1]
-    output_file = sys.argv[2] if len(sys.argv) > 2 else None
+    input_file = args[0]
+    output_file = args[1] if len(args) > 1 else None
 
     # Read ImageBW data
     with open(input_file, 'rb') as f:
         imagebw_data = f.read()
 
     # Convert to PNG
-    convert_imagebw_to_png(imagebw_data, output_file)
+    convert_imagebw_to_png(imagebw_data, output_file, controller_order)
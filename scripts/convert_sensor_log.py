@@ -0,0 +1,182 @@
+#!/usr/bin/env python3
+"""Convert EPDEnvClock sensor logs between the binary (.bin) and JSONL formats.
+
+Binary layout (see EPDEnvClock/sensor_record.h):
+  16-byte header: magic "EPSL", version, record size, local midnight (Unix), reserved
+  32-byte records: fixed-point values, flag bits, CRC-8 (records with a bad CRC are skipped)
+
+Usage:
+  convert_sensor_log.py sensor_log_20251128.bin            # -> sensor_log_20251128.jsonl
+  convert_sensor_log.py sensor_log_20251128.jsonl          # -> sensor_log_20251128.bin
+  convert_sensor_log.py sensor_log_20251128.bin -o -       # JSONL to stdout
+"""
+
+import argparse
+import json
+import struct
+import sys
+from datetime import datetime, timedelta, timezone
+from pathlib import Path
+
+MAGIC = 0x4C535045  # "EPSL"
+VERSION = 1
+HEADER = struct.Struct("<IHHII")
+RECORD = struct.Struct("<IhHHHHHhiihBHB")
+
+FLAG_BATTERY = 0x01
+FLAG_CHARGING = 0x02
+FLAG_DRIFT = 0x04
+
+# The device logs local time in JST (TZ=JST-9)
+JST = timezone(timedelta(hours=9))
+
+
+def crc8(data: bytes) -> int:
+    """CRC-8 (poly 0x07, init 0xFF), same as sensor_record.cpp."""
+    crc = 0xFF
+    for b in data:
+        crc ^= b
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x07) & 0xFF if crc & 0x80 else (crc << 1) & 0xFF
+    return crc
+
+
+def clamp_round(value: float, scale: float, lo: int, hi: int) -> int:
+    return max(lo, min(hi, round(value * scale)))
+
+
+def record_to_dict(fields: tuple) -> dict:
+    """Decode a record into the same fields as a JSONL line."""
+    (ts, temp, hum, co2, mv, pct, pct17048, rate, drift, comp, drift_rate, flags, energy, _check) = fields
+    dt = datetime.fromtimestamp(ts, JST)
+    reading = {
+        "date": dt.strftime("%Y.%m.%d"),
+        "time": dt.strftime("%H:%M:%S"),
+        "unixtimestamp": ts,
+    }
+    if flags & FLAG_DRIFT:
+        reading["rtc_drift_ms"] = drift
+        reading["cumulative_comp_ms"] = comp
+        reading["drift_rate"] = round(drift_rate / 10, 1)
+    reading["temp"] = round(temp / 100, 1)
+    reading["humidity"] = round(hum / 100, 1)
+    reading["co2"] = co2
+    battery = bool(flags & FLAG_BATTERY)
+    reading["batt_voltage"] = round(mv / 1000, 3) if battery else None
+    reading["batt_percent"] = round(pct / 100, 1) if battery else None
+    reading["batt_max17048_percent"] = round(pct17048 / 100, 1) if battery else None
+    reading["batt_rate"] = round(rate / 100, 2) if battery else None
+    reading["charging"] = bool(flags & FLAG_CHARGING)
+    reading["energy_uah"] = round(energy / 10, 1) if energy else None
+    return reading
+
+
+def dict_to_record(d: dict) -> bytes:
+    """Encode a JSONL reading as a 32-byte record."""
+    flags = 0
+    mv = pct = pct17048 = rate = 0
+    if d.get("batt_voltage") is not None:
+        flags |= FLAG_BATTERY
+        mv = clamp_round(d["batt_voltage"], 1000, 0, 0xFFFF)
+        pct = clamp_round(d.get("batt_percent") or 0, 100, 0, 0xFFFF)
+        pct17048 = clamp_round(d.get("batt_max17048_percent") or 0, 100, 0, 0xFFFF)
+        rate = clamp_round(d.get("batt_rate") or 0, 100, -0x8000, 0x7FFF)
+    if d.get("charging"):
+        flags |= FLAG_CHARGING
+    drift = comp = drift_rate = 0
+    if "rtc_drift_ms" in d:
+        flags |= FLAG_DRIFT
+        drift = int(d["rtc_drift_ms"])
+        comp = max(-0x80000000, min(0x7FFFFFFF, int(d.get("cumulative_comp_ms", 0))))
+        drift_rate = clamp_round(d.get("drift_rate", 0), 10, -0x8000, 0x7FFF)
+    energy = 0
+    if d.get("energy_uah") is not None:
+        energy = clamp_round(d["energy_uah"], 10, 1, 0xFFFF)
+    body = RECORD.pack(
+        int(d["unixtimestamp"]),
+        clamp_round(d["temp"], 100, -0x8000, 0x7FFF),
+        clamp_round(d["humidity"], 100, 0, 0xFFFF),
+        int(d["co2"]),
+        mv, pct, pct17048, rate, drift, comp, drift_rate, flags, energy, 0,
+    )
+    return body[:-1] + bytes([crc8(body[:-1])])
+
+
+def read_bin(path: Path) -> list[dict]:
+    """Read all valid records of a binary log."""
+    data = path.read_bytes()
+    if len(data) < HEADER.size:
+        return []
+    magic, version, record_size, _day_start, _ = HEADER.unpack_from(data)
+    if magic != MAGIC or version != VERSION or record_size != RECORD.size:
+        print(f"{path.name}: unexpected header, decoding as version {VERSION}", file=sys.stderr)
+    readings = []
+    skipped = 0
+    for offset in range(HEADER.size, len(data) - RECORD.size + 1, RECORD.size):
+        raw = data[offset : offset + RECORD.size]
+        if crc8(raw[:-1]) != raw[-1]:
+            skipped += 1
+            continue
+        readings.append(record_to_dict(RECORD.unpack(raw)))
+    if skipped:
+        print(f"{path.name}: skipped {skipped} corrupt records", file=sys.stderr)
+    return readings
+
+
+def read_jsonl(path: Path) -> list[dict]:
+    readings = []
+    with open(path, "r") as f:
+        for line in f:
+            line = line.strip()
+            if line:
+                readings.append(json.loads(line))
+    return readings
+
+
+def day_start_of(readings: list[dict]) -> int:
+    if not readings:
+        return 0
+    dt = datetime.fromtimestamp(readings[0]["unixtimestamp"], JST)
+    return int(dt.replace(hour=0, minute=0, second=0, microsecond=0).timestamp())
+
+
+def write_bin(readings: list[dict], out) -> None:
+    out.write(HEADER.pack(MAGIC, VERSION, RECORD.size, day_start_of(readings), 0))
+    for r in sorted(readings, key=lambda r: r["unixtimestamp"]):
+        out.write(dict_to_record(r))
+
+
+def write_jsonl(readings: list[dict], out) -> None:
+    for r in readings:
+        out.write(json.dumps(r, separators=(",", ":")) + "\n")
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Convert sensor logs between .bin and .jsonl")
+    parser.add_argument("input", help="sensor_log_YYYYMMDD.bin or .jsonl")
+    parser.add_argument("-o", "--output", help="Output file ('-' for stdout, default: swap extension)")
+    args = parser.parse_args()
+
+    src = Path(args.input)
+    to_jsonl = src.suffix == ".bin"
+    readings = read_bin(src) if to_jsonl else read_jsonl(src)
+
+    if args.output == "-":
+        if to_jsonl:
+            write_jsonl(readings, sys.stdout)
+        else:
+            write_bin(readings, sys.stdout.buffer)
+        return
+
+    dst = Path(args.output) if args.output else src.with_suffix(".jsonl" if to_jsonl else ".bin")
+    if to_jsonl:
+        with open(dst, "w") as f:
+            write_jsonl(readings, f)
+    else:
+        with open(dst, "wb") as f:
+            write_bin(readings, f)
+    print(f"{src.name} -> {dst.name}: {len(readings)} readings")
+
+
+if __name__ == "__main__":
+    main()
@@ -1,7 +1,8 @@
 #!/usr/bin/env python3
 """
 Python HTTP Server for receiving ImageBW data from Arduino
-Receives binary ImageBW array (27,200 bytes) and saves as PNG image
+Receives binary ImageBW array (27,200 bytes) or the delta-encoded export stream
+(POST /imagebw/stream, see imagebw_stream.py) and saves each frame as PNG image
 """
 
 from http.server import HTTPServer, BaseHTTPRequestHandler
@@ -16,6 +17,34 @@ if script_dir not in sys.path:
     sys.path.insert(0, script_dir)
 
 from convert_imagebw import convert_imagebw_to_png
+import imagebw_stream
+
+# Last frame of the export stream, the reference of the next delta. Kept as a keyframe
+# record in output/ so a server restart does not force the device to resend a keyframe.
+STREAM_STATE_FILE = os.path.join(os.path.dirname(script_dir), "output", "imagebw_last.stream")
+stream_decoder = imagebw_stream.StreamDecoder()
+
+
+def load_stream_state():
+    if not os.path.exists(STREAM_STATE_FILE):
+        return
+    try:
+        with open(STREAM_STATE_FILE, 'rb') as f:
+            for record in imagebw_stream.parse_records(f.read()):
+                stream_decoder.decode(record)
+        print(f"Stream reference: frame #{stream_decoder.sequence}")
+    except (OSError, imagebw_stream.StreamError) as e:
+        print(f"Ignoring stream state {STREAM_STATE_FILE}: {e}")
+
+
+def save_stream_state(layout):
+    frame = stream_decoder.frame
+    record = imagebw_stream.Record(imagebw_stream.FRAME_KEY, layout, stream_decoder.sequence, 0, 0,
+                                   imagebw_stream.crc32(frame), len(frame),
+                                   imagebw_stream.encode_delta(frame, imagebw_stream.blank_frame(len(frame))))
+    os.makedirs(os.path.dirname(STREAM_STATE_FILE), exist_ok=True)
+    with open(STREAM_STATE_FILE, 'wb') as f:
+        f.write(record.pack())
 
 class ImageBWHandler(BaseHTTPRequestHandler):
     def do_POST(self):
@@ -24,6 +53,8 @@ class ImageBWHandler(BaseHTTPRequestHandler):
             self.handle_imagebw()
         elif self.path == '/imagebw/base64':
             self.handle_imagebw_base64()
+        elif self.path == '/imagebw/stream':
+            self.handle_imagebw_stream()
         else:
             self.send_error(404, "Not Found")
 
@@ -48,8 +79,9 @@ class ImageBWHandler(BaseHTTPRequestHandler):
             timestamp = datetime.now().strftime("%Y%m%d_%H%M%S")
             filename = f"imagebw_{timestamp}.png"
 
-            # Convert ImageBW to PNG
-            output_path = convert_imagebw_to_png(imagebw_data, filename)
+            # Convert ImageBW to PNG (firmware sends its buffer layout in X-ImageBW-Layout)
+            controller_order = self.headers.get('X-ImageBW-Layout', 'row') == 'controller'
+            output_path = convert_imagebw_to_png(imagebw_data, filename, controller_order)
 
             # Send success response
             response = {
@@ -91,8 +123,9 @@ class ImageBWHandler(BaseHTTPRequestHandler):
             timestamp = datetime.now().strftime("%Y%m%d_%H%M%S")
             filename = f"imagebw_{timestamp}.png"
 
-            # Convert ImageBW to PNG
-            output_path = convert_imagebw_to_png(imagebw_data, filename)
+            # Convert ImageBW to PNG (firmware sends its buffer layout in X-ImageBW-Layout)
+            controller_order = self.headers.get('X-ImageBW-Layout', 'row') == 'controller'
+            output_path = convert_imagebw_to_png(imagebw_data, filename, controller_order)
 
             # Send success response
             response = {
@@ -112,6 +145,56 @@ class ImageBWHandler(BaseHTTPRequestHandler):
             print(f"[{datetime.now()}] Error handling ImageBW (Base64): {e}")
             self.send_error(500, f"Internal Server Error: {str(e)}")
 
+    def send_json(self, code, response):
+        self.send_response(code)
+        self.send_header('Content-Type', 'application/json')
+        self.end_headers()
+        self.wfile.write(json.dumps(response).encode('utf-8'))
+
+    def handle_imagebw_stream(self):
+        """Handle the delta-encoded export stream (one record, or a batch of historical frames)"""
+        try:
+            content_length = int(self.headers.get('Content-Length', 0))
+            body = self.rfile.read(content_length)
+            try:
+                records = imagebw_stream.parse_records(body)
+            except imagebw_stream.StreamError as e:
+                self.send_error(400, str(e))
+                return
+
+            # Records chain, so stop at the first one that cannot be rebuilt
+            filenames = []
+            for record in records:
+                if not stream_decoder.holds(record):
+                    print(f"[{datetime.now()}] Frame #{record.sequence} needs frame #{record.base_sequence}, "
+                          f"holding #{stream_decoder.sequence}: requesting a keyframe")
+                    self.send_json(409, {"status": "need_keyframe", "sequence": stream_decoder.sequence,
+                                         "stored": filenames})
+                    return
+                try:
+                    frame = stream_decoder.decode(record)
+                except imagebw_stream.StreamError as e:
+                    print(f"[{datetime.now()}] {e}: requesting a keyframe")
+                    stream_decoder.frame = None
+                    self.send_json(409, {"status": "need_keyframe", "sequence": 0, "stored": filenames})
+                    return
+
+                timestamp = datetime.now().strftime("%Y%m%d_%H%M%S")
+                filename = f"imagebw_{timestamp}_{record.sequence}.png"
+                convert_imagebw_to_png(frame, filename, record.layout == imagebw_stream.LAYOUT_CONTROLLER)
+                filenames.append(filename)
+                kind = "keyframe" if record.type == imagebw_stream.FRAME_KEY else "delta"
+                print(f"[{datetime.now()}] Received ImageBW #{record.sequence} ({kind}, "
+                      f"{len(record.payload)} bytes): {filename}")
+            if records:
+                save_stream_state(records[-1].layout)
+
+            self.send_json(200, {"status": "success", "sequence": stream_decoder.sequence, "stored": filenames})
+
+        except Exception as e:
+            print(f"[{datetime.now()}] Error handling ImageBW stream: {e}")
+            self.send_error(500, f"Internal Server Error: {str(e)}")
+
     def do_GET(self):
         """Handle GET requests for status"""
         if self.path == '/status':
@@ -123,6 +206,7 @@ class ImageBWHandler(BaseHTTPRequestHandler):
                 "endpoints": {
                     "/imagebw": "POST binary ImageBW data (27,200 bytes)",
                     "/imagebw/base64": "POST Base64 encoded ImageBW data",
+                    "/imagebw/stream": "POST delta-encoded ImageBW records (one or a batch)",
                     "/status": "GET server status"
                 }
             }
@@ -136,6 +220,7 @@ class ImageBWHandler(BaseHTTPRequestHandler):
 
 def run_server(port=8080, host='0.0.0.0'):
     """Run the HTTP server"""
+    load_stream_state()
     server_address = (host, port)
     httpd = HTTPServer(server_address, ImageBWHandler)
 
@@ -143,6 +228,7 @@ def run_server(port=8080, host='0.0.0.0'):
     print(f"Endpoints:")
     print(f"  POST /imagebw - Send binary ImageBW data")
     print(f"  POST /imagebw/base64 - Send Base64 encoded ImageBW data")
+    print(f"  POST /imagebw/stream - Send delta-encoded ImageBW records (one or a batch)")
     print(f"  GET /status - Get server status")
     print(f"\nPress Ctrl+C to stop the server")
 
@@ -0,0 +1,228 @@
+#!/usr/bin/env python3
+"""
+ImageBW export stream (application/x-imagebw-stream), see EPDEnvClock/imagebw_export.h
+
+A body is one or more records: a 32-byte little-endian header followed by an XOR-RLE
+delta (FrameCodec_EncodeXorDelta in EPDEnvClock/frame_codec.h). Keyframes are relative to
+an all-white frame, deltas to the record before them.
+
+Usage:
+  imagebw_stream.py encode [--controller-order] <out.stream> <frame.bin>...
+      Pack raw ImageBW dumps (e.g. bench/build/epd_bench --out DIR) into one batch body:
+      a keyframe, then deltas. Send it with
+      curl --data-binary @out.stream -H 'Content-Type: application/x-imagebw-stream' \\
+           http://<server>:8080/imagebw/stream
+  imagebw_stream.py decode <in.stream> <out_dir>
+      Rebuild every frame of a body as raw dumps (<sequence>.bin)
+"""
+
+import os
+import struct
+import sys
+import zlib
+
+MAGIC = 0x53495045  # "EPIS"
+VERSION = 1
+CONTENT_TYPE = 'application/x-imagebw-stream'
+FRAME_KEY = 0
+FRAME_DELTA = 1
+LAYOUT_ROW_MAJOR = 0
+LAYOUT_CONTROLLER = 1
+FRAME_SIZE = 27200
+MIN_ZERO_RUN = 3  # kFrameDeltaMinZeroRun
+
+# magic, version, type, layout, reserved, sequence, baseSequence, baseCrc32, frameCrc32, frameSize, payloadSize
+HEADER = struct.Struct('<IBBBBIIIIII')
+assert HEADER.size == 32
+
+
+class StreamError(ValueError):
+    pass
+
+
+class Record:
+    def __init__(self, frame_type, layout, sequence, base_sequence, base_crc, frame_crc, frame_size, payload):
+        self.type = frame_type
+        self.layout = layout
+        self.sequence = sequence
+        self.base_sequence = base_sequence
+        self.base_crc = base_crc
+        self.frame_crc = frame_crc
+        self.frame_size = frame_size
+        self.payload = payload
+
+    def pack(self):
+        return HEADER.pack(MAGIC, VERSION, self.type, self.layout, 0, self.sequence, self.base_sequence,
+                           self.base_crc, self.frame_crc, self.frame_size, len(self.payload)) + self.payload
+
+
+def parse_records(body):
+    """Split a request body into Records"""
+    records = []
+    pos = 0
+    while pos < len(body):
+        if len(body) - pos < HEADER.size:
+            raise StreamError(f"Truncated record header at offset {pos}")
+        (magic, version, frame_type, layout, _reserved, sequence, base_sequence, base_crc, frame_crc,
+         frame_size, payload_size) = HEADER.unpack_from(body, pos)
+        if magic != MAGIC or version != VERSION:
+            raise StreamError(f"Bad record magic/version at offset {pos}")
+        pos += HEADER.size
+        if len(body) - pos < payload_size:
+            raise StreamError(f"Truncated payload of frame #{sequence}")
+        records.append(Record(frame_type, layout, sequence, base_sequence, base_crc, frame_crc, frame_size,
+                              bytes(body[pos:pos + payload_size])))
+        pos += payload_size
+    return records
+
+
+def crc32(data):
+    return zlib.crc32(data) & 0xFFFFFFFF
+
+
+def _read_varint(data, pos):
+    value = 0
+    shift = 0
+    while True:
+        if pos >= len(data) or shift > 28:
+            raise StreamError("Truncated varint in delta")
+        byte = data[pos]
+        pos += 1
+        value |= (byte & 0x7F) << shift
+        if not byte & 0x80:
+            return value, pos
+        shift += 7
+
+
+def _write_varint(value, out):
+    while True:
+        low = value & 0x7F
+        value >>= 7
+        out.append(low | 0x80 if value else low)
+        if not value:
+            return
+
+
+def apply_delta(reference, delta):
+    """XOR an XOR-RLE delta into a copy of reference (FrameCodec_ApplyXorDelta)"""
+    frame = bytearray(reference)
+    pos = 0
+    out = 0
+    while pos < len(delta):
+        run, pos = _read_varint(delta, pos)
+        literal, pos = _read_varint(delta, pos)
+        out += run
+        if out + literal > len(frame) or pos + literal > len(delta):
+            raise StreamError("Delta runs past the frame")
+        for i in range(literal):
+            frame[out + i] ^= delta[pos + i]
+        out += literal
+        pos += literal
+    return bytes(frame)
+
+
+def encode_delta(frame, reference):
+    """XOR-RLE delta of frame against reference (FrameCodec_EncodeXorDelta)"""
+    xor = bytes(a ^ b for a, b in zip(frame, reference))
+    out = bytearray()
+    pos = 0
+    size = len(xor)
+    while True:
+        run_start = pos
+        while pos < size and xor[pos] == 0:
+            pos += 1
+        if pos == size:
+            return bytes(out)
+        literal_start = pos
+        zeros = 0
+        while pos < size and zeros < MIN_ZERO_RUN:
+            zeros = zeros + 1 if xor[pos] == 0 else 0
+            pos += 1
+        literal_end = pos - zeros
+        pos = literal_end
+        _write_varint(literal_start - run_start, out)
+        _write_varint(literal_end - literal_start, out)
+        out += xor[literal_start:literal_end]
+
+
+def blank_frame(size=FRAME_SIZE):
+    return b'\xff' * size
+
+
+class StreamDecoder:
+    """Rebuilds frames from records, keeping the last one as the next delta's reference"""
+
+    def __init__(self):
+        self.sequence = 0
+        self.frame = None
+
+    def holds(self, record):
+        """True if record can be decoded (keyframe, or delta against the frame held)"""
+        if record.type == FRAME_KEY:
+            return True
+        return (record.type == FRAME_DELTA and self.frame is not None and record.base_sequence == self.sequence
+                and record.base_crc == crc32(self.frame) and len(self.frame) == record.frame_size)
+
+    def decode(self, record):
+        """Return the frame of record; raises StreamError if it cannot be rebuilt"""
+        if not self.holds(record):
+            raise StreamError(f"Frame #{record.sequence} needs frame #{record.base_sequence}, "
+                              f"server holds #{self.sequence}")
+        reference = blank_frame(record.frame_size) if record.type == FRAME_KEY else self.frame
+        frame = apply_delta(reference, record.payload)
+        if crc32(frame) != record.frame_crc:
+            raise StreamError(f"CRC mismatch in frame #{record.sequence}")
+        self.sequence = record.sequence
+        self.frame = frame
+        return frame
+
+
+def encode_batch(frames, controller_order=False):
+    """Batch body for a list of raw frames: a keyframe, then deltas"""
+    layout = LAYOUT_CONTROLLER if controller_order else LAYOUT_ROW_MAJOR
+    body = bytearray()
+    previous = None
+    for index, frame in enumerate(frames):
+        sequence = index + 1
+        if previous is None:
+            record = Record(FRAME_KEY, layout, sequence, 0, 0, crc32(frame), len(frame),
+                            encode_delta(frame, blank_frame(len(frame))))
+        else:
+            record = Record(FRAME_DELTA, layout, sequence, sequence - 1, crc32(previous), crc32(frame), len(frame),
+                            encode_delta(frame, previous))
+        body += record.pack()
+        previous = frame
+    return bytes(body)
+
+
+def main(argv):
+    if len(argv) >= 3 and argv[0] == 'encode':
+        args = argv[1:]
+        controller_order = '--controller-order' in args
+        args = [arg for arg in args if arg != '--controller-order']
+        frames = []
+        for path in args[1:]:
+            with open(path, 'rb') as f:
+                frames.append(f.read())
+        body = encode_batch(frames, controller_order)
+        with open(args[0], 'wb') as f:
+            f.write(body)
+        print(f"{args[0]}: {len(frames)} frames, {len(body)} bytes (raw {sum(len(frame) for frame in frames)})")
+        return 0
+    if len(argv) == 3 and argv[0] == 'decode':
+        with open(argv[1], 'rb') as f:
+            records = parse_records(f.read())
+        os.makedirs(argv[2], exist_ok=True)
+        decoder = StreamDecoder()
+        for record in records:
+            frame = decoder.decode(record)
+            with open(os.path.join(argv[2], f"{record.sequence}.bin"), 'wb') as f:
+                f.write(frame)
+        print(f"{argv[1]}: {len(records)} frames")
+        return 0
+    print(__doc__)
+    return 1
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv[1:]))
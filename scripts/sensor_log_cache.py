@@ -0,0 +1,207 @@
+#!/usr/bin/env python3
+"""Shared SQLite cache of the local sensor logs, used by the analyze_*.py scripts.
+
+Every log under the logs directory (sensor_log_YYYYMMDD.bin, or .jsonl when there is no .bin
+of the same day) is parsed once into one indexed table. Later runs re-read only files whose
+mtime or size changed, so analyses over months of logs start in about a second and stream
+rows from the database instead of holding every reading in memory.
+
+Layout: logs/sensor_logs/sensor_log_*.{bin,jsonl} belong to device "default";
+logs/sensor_logs/<device_id>/sensor_log_*.{bin,jsonl} to <device_id> (same ids as the
+dashboard's X-Device-Id). Columns use the dashboard's sensor_data names (web/schema.sql).
+
+Usage:
+  sensor_log_cache.py             # update the cache and print a summary
+  sensor_log_cache.py --rebuild   # drop it and parse every file again
+Set SENSOR_LOGS_DIR to use another log directory; the cache is <logs dir>/../sensor_cache.sqlite.
+"""
+
+import argparse
+import json
+import os
+import sqlite3
+import sys
+from datetime import datetime
+from pathlib import Path
+
+from convert_sensor_log import JST, read_bin
+
+LOGS_DIR = Path(os.environ.get("SENSOR_LOGS_DIR", Path(__file__).parent.parent / "logs" / "sensor_logs"))
+DEFAULT_DEVICE = "default"
+SCHEMA_VERSION = 2
+
+# Reading columns, in insert order
+COLUMNS = (
+    "timestamp", "temperature", "humidity", "co2", "battery_voltage", "battery_percent",
+    "battery_max17048_percent", "battery_rate", "battery_charging", "rtc_drift_ms",
+    "cumulative_comp_ms", "drift_rate", "energy_uah",
+)
+
+SCHEMA = f"""
+CREATE TABLE IF NOT EXISTS sources (
+    path TEXT PRIMARY KEY,     -- relative to the logs directory
+    mtime_ns INTEGER NOT NULL,
+    size INTEGER NOT NULL,
+    readings INTEGER NOT NULL
+);
+CREATE TABLE IF NOT EXISTS readings (
+    device_id TEXT NOT NULL,
+    day TEXT NOT NULL,         -- YYYYMMDD of the log file (local date)
+    source TEXT NOT NULL,
+    timestamp INTEGER NOT NULL,
+    temperature REAL, humidity REAL, co2 INTEGER,
+    battery_voltage REAL, battery_percent REAL, battery_max17048_percent REAL, battery_rate REAL,
+    battery_charging INTEGER,  -- 1/0
+    rtc_drift_ms INTEGER, cumulative_comp_ms INTEGER, drift_rate REAL,
+    energy_uah REAL,           -- previous wake cycle's estimate (EPDEnvClock/energy_model.h)
+    PRIMARY KEY (device_id, timestamp)
+) WITHOUT ROWID;
+CREATE INDEX IF NOT EXISTS readings_source ON readings (source);
+CREATE INDEX IF NOT EXISTS readings_day ON readings (day, device_id, timestamp);
+PRAGMA user_version = {SCHEMA_VERSION};
+"""
+
+
+def cache_path(logs_dir: Path = LOGS_DIR) -> Path:
+    return logs_dir.parent / "sensor_cache.sqlite"
+
+
+def _log_files(logs_dir: Path) -> dict[str, Path]:
+    """Relative path -> file for every log to cache (.bin preferred over its .jsonl mirror)"""
+    files = {}
+    for path in sorted(logs_dir.rglob("sensor_log_*")):
+        if path.suffix == ".jsonl" and path.with_suffix(".bin").exists():
+            continue
+        if path.suffix in (".bin", ".jsonl"):
+            files[path.relative_to(logs_dir).as_posix()] = path
+    return files
+
+
+def _timestamp(entry: dict):
+    if entry.get("unixtimestamp") is not None:
+        return int(entry["unixtimestamp"])
+    if entry.get("timestamp") is not None:
+        return int(entry["timestamp"])
+    try:
+        dt = datetime.strptime(f"{entry['date']} {entry['time']}", "%Y.%m.%d %H:%M:%S")
+    except (KeyError, ValueError):
+        return None
+    return int(dt.replace(tzinfo=JST).timestamp())
+
+
+def _entries(path: Path):
+    """Readings of one log file as JSONL-style dicts (one line at a time for .jsonl)"""
+    if path.suffix == ".bin":
+        yield from read_bin(path)
+        return
+    with open(path, "r") as f:
+        for line in f:
+            line = line.strip()
+            if not line:
+                continue
+            try:
+                yield json.loads(line)
+            except json.JSONDecodeError:
+                continue
+
+
+def _rows(path: Path, device_id: str, day: str, source: str):
+    for e in _entries(path):
+        ts = _timestamp(e)
+        if ts is None:
+            continue
+        charging = e.get("charging")
+        yield (device_id, day, source, ts, e.get("temp"), e.get("humidity"), e.get("co2"),
+               e.get("batt_voltage"), e.get("batt_percent"), e.get("batt_max17048_percent"),
+               e.get("batt_rate"), None if charging is None else int(bool(charging)),
+               e.get("rtc_drift_ms"), e.get("cumulative_comp_ms"), e.get("drift_rate"),
+               e.get("energy_uah"))
+
+
+def update(conn: sqlite3.Connection, logs_dir: Path = LOGS_DIR) -> tuple[int, int]:
+    """Re-read new and changed files, drop removed ones; returns (files parsed, files removed)"""
+    files = _log_files(logs_dir)
+    known = {row[0]: (row[1], row[2]) for row in conn.execute("SELECT path, mtime_ns, size FROM sources")}
+    insert = (f"INSERT OR REPLACE INTO readings (device_id, day, source, {', '.join(COLUMNS)}) "
+              f"VALUES ({', '.join('?' * (len(COLUMNS) + 3))})")
+
+    parsed = 0
+    for source, path in files.items():
+        stat = path.stat()
+        if known.get(source) == (stat.st_mtime_ns, stat.st_size):
+            continue
+        device_id = path.parent.name if path.parent != logs_dir else DEFAULT_DEVICE
+        day = path.stem.split("_")[-1]
+        with conn:
+            conn.execute("DELETE FROM readings WHERE source = ?", (source,))
+            count = conn.executemany(insert, _rows(path, device_id, day, source)).rowcount
+            conn.execute("INSERT OR REPLACE INTO sources (path, mtime_ns, size, readings) VALUES (?, ?, ?, ?)",
+                         (source, stat.st_mtime_ns, stat.st_size, max(count, 0)))
+        parsed += 1
+
+    removed = [source for source in known if source not in files]
+    with conn:
+        for source in removed:
+            conn.execute("DELETE FROM readings WHERE source = ?", (source,))
+            conn.execute("DELETE FROM sources WHERE path = ?", (source,))
+    return parsed, len(removed)
+
+
+def open_cache(logs_dir: Path = LOGS_DIR, refresh: bool = True, rebuild: bool = False) -> sqlite3.Connection:
+    """Open (creating or migrating as needed) and, by default, update the cache"""
+    path = cache_path(logs_dir)
+    if rebuild and path.exists():
+        path.unlink()
+    conn = sqlite3.connect(path)
+    if conn.execute("PRAGMA user_version").fetchone()[0] not in (0, SCHEMA_VERSION):
+        conn.close()
+        path.unlink()
+        conn = sqlite3.connect(path)
+    conn.executescript(SCHEMA)
+    conn.row_factory = sqlite3.Row
+    if refresh:
+        parsed, removed = update(conn, logs_dir)
+        if parsed or removed:
+            print(f"Sensor log cache: {parsed} files parsed, {removed} removed", file=sys.stderr)
+    return conn
+
+
+def iter_readings(conn: sqlite3.Connection, since_day: str = None, until_day: str = None,
+                  device: str = None, since_ts: int = None):
+    """Readings (sqlite3.Row, COLUMNS plus device_id and day) ordered by device and time
+
+    since_day is inclusive, until_day exclusive (YYYYMMDD). Rows are fetched lazily.
+    """
+    where = []
+    args = []
+    for clause, value in (("day >= ?", since_day), ("day < ?", until_day), ("device_id = ?", device),
+                          ("timestamp >= ?", since_ts)):
+        if value is not None:
+            where.append(clause)
+            args.append(value)
+    query = f"SELECT device_id, day, {', '.join(COLUMNS)} FROM readings"
+    if where:
+        query += " WHERE " + " AND ".join(where)
+    query += " ORDER BY device_id, timestamp"
+    yield from conn.execute(query, args)
+
+
+def local_datetime(timestamp: int) -> datetime:
+    """Device-local (JST) time of a reading, without tzinfo like the log's date/time fields"""
+    return datetime.fromtimestamp(timestamp, JST).replace(tzinfo=None)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Update the sensor log cache")
+    parser.add_argument("--rebuild", action="store_true", help="Parse every log file again")
+    args = parser.parse_args()
+
+    conn = open_cache(rebuild=args.rebuild)
+    print(f"{cache_path()}:")
+    for row in conn.execute("SELECT device_id, COUNT(*) AS n, MIN(day) AS first, MAX(day) AS last "
+                            "FROM readings GROUP BY device_id ORDER BY device_id"):
+        print(f"  {row['device_id']}: {row['n']} readings, {row['first']} - {row['last']}")
+
+
+if __name__ == "__main__":
+    main()
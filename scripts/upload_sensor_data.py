@@ -1,5 +1,5 @@
 #!/usr/bin/env python3
-"""Upload sensor data from JSONL files to the dashboard API."""
+"""Upload sensor data from JSONL (or binary .bin) log files to the dashboard API."""
 
 import json
 import os
@@ -7,6 +7,8 @@ import sys
 import urllib.request
 from pathlib import Path
 
+from convert_sensor_log import read_bin
+
 
 def load_env_file():
     """Load environment variables from .env file if it exists."""
@@ -30,35 +32,45 @@ load_env_file()
 
 API_URL = os.environ.get("SENSOR_API_URL", "https://epd-sensor-dashboard.pages.dev/api/sensor")
 API_KEY = os.environ.get("SENSOR_API_KEY", "")
+# Device the readings belong to (X-Device-Id); the device logs its id when it uploads
+DEVICE_ID = os.environ.get("SENSOR_DEVICE_ID", "")
 # Cloudflare Access Service Token (for bypassing Cloudflare Access protection)
 CF_ACCESS_CLIENT_ID = os.environ.get("CF_ACCESS_CLIENT_ID", "")
 CF_ACCESS_CLIENT_SECRET = os.environ.get("CF_ACCESS_CLIENT_SECRET", "")
 BATCH_SIZE = 100  # Upload in batches to avoid timeout
 
 
-def load_jsonl(file_path: Path) -> list[dict]:
-    """Load data from a JSONL file."""
-    readings = []
+def iter_log_lines(file_path: Path):
+    """Yield decoded readings from a JSONL or binary sensor log."""
+    if file_path.suffix == ".bin":
+        yield from read_bin(file_path)
+        return
     with open(file_path, "r") as f:
         for line in f:
             line = line.strip()
             if line:
-                data = json.loads(line)
-                # Convert to API format
-                reading = {
-                    "timestamp": data["unixtimestamp"],
-                    "temp": data["temp"],
-                    "humidity": data["humidity"],
-                    "co2": data["co2"],
-                    "batt_voltage": data.get("batt_voltage"),
-                    "batt_percent": data.get("batt_percent"),
-                    "batt_rate": data.get("batt_rate"),
-                    "charging": data.get("charging"),
-                    "batt_adc": data.get("batt_adc"),  # legacy
-                }
-                if "rtc_drift_ms" in data:
-                    reading["rtc_drift_ms"] = data["rtc_drift_ms"]
-                readings.append(reading)
+                yield json.loads(line)
+
+
+def load_jsonl(file_path: Path) -> list[dict]:
+    """Load data from a JSONL file (or a binary .bin log)."""
+    readings = []
+    for data in iter_log_lines(file_path):
+        # Convert to API format
+        reading = {
+            "timestamp": data["unixtimestamp"],
+            "temp": data["temp"],
+            "humidity": data["humidity"],
+            "co2": data["co2"],
+            "batt_voltage": data.get("batt_voltage"),
+            "batt_percent": data.get("batt_percent"),
+            "batt_rate": data.get("batt_rate"),
+            "charging": data.get("charging"),
+            "batt_adc": data.get("batt_adc"),  # legacy
+        }
+        if "rtc_drift_ms" in data:
+            reading["rtc_drift_ms"] = data["rtc_drift_ms"]
+        readings.append(reading)
     return readings
 
 
@@ -70,6 +82,8 @@ def upload_batch(readings: list[dict]) -> bool:
     # Add API key if configured
     if API_KEY:
         headers["X-API-Key"] = API_KEY
+    if DEVICE_ID:
+        headers["X-Device-Id"] = DEVICE_ID
 
     # Add Cloudflare Access headers if configured
     if CF_ACCESS_CLIENT_ID and CF_ACCESS_CLIENT_SECRET:
@@ -89,7 +103,7 @@ def upload_batch(readings: list[dict]) -> bool:
 
 def main():
     if len(sys.argv) < 2:
-        print("Usage: upload_sensor_data.py <jsonl_file> [jsonl_file2] ...")
+        print("Usage: upload_sensor_data.py <log_file.jsonl|.bin> [log_file2] ...")
         print("\nEnvironment variables:")
         print("  SENSOR_API_URL          - API endpoint URL")
         print("  SENSOR_API_KEY          - API key for authentication")
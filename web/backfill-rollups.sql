@@ -0,0 +1,42 @@
+-- Rebuild devices, sensor_hourly and sensor_daily from sensor_data (same queries as
+-- src/lib/rollup.ts). Run once after adding the tables to an existing database:
+-- bunx wrangler d1 execute epd-sensor-db --remote --file=backfill-rollups.sql
+
+DELETE FROM devices;
+DELETE FROM sensor_hourly;
+DELETE FROM sensor_daily;
+
+INSERT INTO devices (device_id, first_timestamp, last_timestamp, last_upload)
+SELECT device_id, MIN(timestamp), MAX(timestamp), CAST(strftime('%s', 'now') AS INTEGER)
+FROM sensor_data
+GROUP BY device_id;
+
+INSERT INTO sensor_hourly (device_id, bucket, count, temperature_min, temperature_max, temperature_avg, temperature_count, humidity_min, humidity_max, humidity_avg, humidity_count, co2_min, co2_max, co2_avg, co2_count, battery_voltage_min, battery_voltage_max, battery_voltage_avg, battery_voltage_count, battery_percent_min, battery_percent_max, battery_percent_avg, battery_percent_count, battery_rate_min, battery_rate_max, battery_rate_avg, battery_rate_count, battery_charging_min, battery_charging_max, battery_charging_avg, battery_charging_count, rtc_drift_ms_min, rtc_drift_ms_max, rtc_drift_ms_avg, rtc_drift_ms_count, energy_uah_min, energy_uah_max, energy_uah_avg, energy_uah_count)
+SELECT
+    device_id, timestamp / 3600 * 3600, COUNT(*),
+    MIN(temperature), MAX(temperature), AVG(temperature), COUNT(temperature),
+    MIN(humidity), MAX(humidity), AVG(humidity), COUNT(humidity),
+    MIN(co2), MAX(co2), AVG(co2), COUNT(co2),
+    MIN(battery_voltage), MAX(battery_voltage), AVG(battery_voltage), COUNT(battery_voltage),
+    MIN(battery_percent), MAX(battery_percent), AVG(battery_percent), COUNT(battery_percent),
+    MIN(battery_rate), MAX(battery_rate), AVG(battery_rate), COUNT(battery_rate),
+    MIN(battery_charging), MAX(battery_charging), AVG(battery_charging), COUNT(battery_charging),
+    MIN(rtc_drift_ms), MAX(rtc_drift_ms), AVG(rtc_drift_ms), COUNT(rtc_drift_ms),
+    MIN(energy_uah), MAX(energy_uah), AVG(energy_uah), COUNT(energy_uah)
+FROM sensor_data
+GROUP BY 1, 2;
+
+INSERT INTO sensor_daily (device_id, bucket, count, temperature_min, temperature_max, temperature_avg, temperature_count, humidity_min, humidity_max, humidity_avg, humidity_count, co2_min, co2_max, co2_avg, co2_count, battery_voltage_min, battery_voltage_max, battery_voltage_avg, battery_voltage_count, battery_percent_min, battery_percent_max, battery_percent_avg, battery_percent_count, battery_rate_min, battery_rate_max, battery_rate_avg, battery_rate_count, battery_charging_min, battery_charging_max, battery_charging_avg, battery_charging_count, rtc_drift_ms_min, rtc_drift_ms_max, rtc_drift_ms_avg, rtc_drift_ms_count, energy_uah_min, energy_uah_max, energy_uah_avg, energy_uah_count)
+SELECT
+    device_id, bucket / 86400 * 86400, SUM(count),
+    MIN(temperature_min), MAX(temperature_max), SUM(temperature_avg * temperature_count) / SUM(temperature_count), SUM(temperature_count),
+    MIN(humidity_min), MAX(humidity_max), SUM(humidity_avg * humidity_count) / SUM(humidity_count), SUM(humidity_count),
+    MIN(co2_min), MAX(co2_max), SUM(co2_avg * co2_count) / SUM(co2_count), SUM(co2_count),
+    MIN(battery_voltage_min), MAX(battery_voltage_max), SUM(battery_voltage_avg * battery_voltage_count) / SUM(battery_voltage_count), SUM(battery_voltage_count),
+    MIN(battery_percent_min), MAX(battery_percent_max), SUM(battery_percent_avg * battery_percent_count) / SUM(battery_percent_count), SUM(battery_percent_count),
+    MIN(battery_rate_min), MAX(battery_rate_max), SUM(battery_rate_avg * battery_rate_count) / SUM(battery_rate_count), SUM(battery_rate_count),
+    MIN(battery_charging_min), MAX(battery_charging_max), SUM(battery_charging_avg * battery_charging_count) / SUM(battery_charging_count), SUM(battery_charging_count),
+    MIN(rtc_drift_ms_min), MAX(rtc_drift_ms_max), SUM(rtc_drift_ms_avg * rtc_drift_ms_count) / SUM(rtc_drift_ms_count), SUM(rtc_drift_ms_count),
+    MIN(energy_uah_min), MAX(energy_uah_max), SUM(energy_uah_avg * energy_uah_count) / SUM(energy_uah_count), SUM(energy_uah_count)
+FROM sensor_hourly
+GROUP BY 1, 2;
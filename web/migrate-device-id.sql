@@ -0,0 +1,45 @@
+-- Move a single-device database to the per-device schema (sensor_data keyed by device_id)
+-- Existing readings are assigned to the unit named below; replace 'default' with the id the
+-- device logs when it uploads ("Streaming batch data ... as <id>") to keep one history.
+-- The readings are copied with every sensor_data column, so the old table needs them all first,
+-- and a failed copy leaves the table renamed.
+--
+-- 0. Run each commented "ALTER TABLE sensor_data ADD COLUMN ..." from schema.sql that the old
+--    table lacks (a baseline database has neither boot_profile nor energy_uah), e.g.
+--    bunx wrangler d1 execute epd-sensor-db --remote --command="ALTER TABLE sensor_data ADD COLUMN boot_profile TEXT"
+-- 1. bunx wrangler d1 execute epd-sensor-db --remote --file=migrate-device-id.sql
+-- 2. bunx wrangler d1 execute epd-sensor-db --remote --file=schema.sql
+-- 3. bunx wrangler d1 execute epd-sensor-db --remote --file=backfill-rollups.sql
+
+ALTER TABLE sensor_data RENAME TO sensor_data_v1;
+
+CREATE TABLE sensor_data (
+    device_id TEXT NOT NULL DEFAULT 'default',  -- X-Device-Id of the uploading unit
+    timestamp INTEGER NOT NULL,           -- Unix timestamp
+    temperature REAL NOT NULL,            -- Temperature in Celsius
+    humidity REAL NOT NULL,               -- Humidity in %
+    co2 INTEGER NOT NULL,                 -- CO2 in ppm
+    battery_voltage REAL,                 -- Battery voltage
+    battery_percent REAL,                 -- Battery state of charge - linear (3.4V=0%, 4.2V=100%)
+    battery_max17048_percent REAL,        -- Battery state of charge - MAX17048 reported (for reference)
+    battery_rate REAL,                    -- Battery charge rate (%/hr, positive=charging)
+    battery_charging INTEGER,             -- Charging state (1=charging, 0=not charging)
+    battery_adc INTEGER,                  -- Raw ADC value (legacy, deprecated)
+    rtc_drift_ms INTEGER,                 -- RTC drift in ms (residual after compensation)
+    cumulative_comp_ms INTEGER,           -- Cumulative drift compensation applied (ms)
+    drift_rate REAL,                      -- Drift rate used for compensation (ms/min)
+    boot_profile TEXT,                    -- Previous boot's phase end times, JSON array of ms since wakeup (see boot_profiler.h)
+    energy_uah REAL,                      -- Previous wake cycle's estimated charge in µAh (see energy_model.h)
+    created_at TEXT DEFAULT CURRENT_TIMESTAMP,
+    PRIMARY KEY (device_id, timestamp)
+) WITHOUT ROWID;
+
+INSERT INTO sensor_data (device_id, timestamp, temperature, humidity, co2, battery_voltage, battery_percent, battery_max17048_percent, battery_rate, battery_charging, battery_adc, rtc_drift_ms, cumulative_comp_ms, drift_rate, boot_profile, energy_uah, created_at)
+SELECT 'default', timestamp, temperature, humidity, co2, battery_voltage, battery_percent, battery_max17048_percent, battery_rate, battery_charging, battery_adc, rtc_drift_ms, cumulative_comp_ms, drift_rate, boot_profile, energy_uah, created_at
+FROM sensor_data_v1;
+
+DROP TABLE sensor_data_v1;
+
+-- Rollups without device_id; schema.sql recreates them
+DROP TABLE IF EXISTS sensor_hourly;
+DROP TABLE IF EXISTS sensor_daily;
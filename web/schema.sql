@@ -1,7 +1,9 @@
 -- Sensor data table
+-- Clustered on (device_id, timestamp): the key rejects duplicate uploads per device, and every
+-- per-device range read is one contiguous scan of the table itself (no separate index lookups)
 CREATE TABLE IF NOT EXISTS sensor_data (
-    id INTEGER PRIMARY KEY AUTOINCREMENT,
-    timestamp INTEGER NOT NULL UNIQUE,    -- Unix timestamp (unique to prevent duplicates)
+    device_id TEXT NOT NULL DEFAULT 'default',  -- X-Device-Id of the uploading unit
+    timestamp INTEGER NOT NULL,           -- Unix timestamp
     temperature REAL NOT NULL,            -- Temperature in Celsius
     humidity REAL NOT NULL,               -- Humidity in %
     co2 INTEGER NOT NULL,                 -- CO2 in ppm
@@ -14,10 +16,61 @@ CREATE TABLE IF NOT EXISTS sensor_data (
     rtc_drift_ms INTEGER,                 -- RTC drift in ms (residual after compensation)
     cumulative_comp_ms INTEGER,           -- Cumulative drift compensation applied (ms)
     drift_rate REAL,                      -- Drift rate used for compensation (ms/min)
-    created_at TEXT DEFAULT CURRENT_TIMESTAMP
+    boot_profile TEXT,                    -- Previous boot's phase end times, JSON array of ms since wakeup (see boot_profiler.h)
+    energy_uah REAL,                      -- Previous wake cycle's estimated charge in µAh (see energy_model.h)
+    created_at TEXT DEFAULT CURRENT_TIMESTAMP,
+    PRIMARY KEY (device_id, timestamp)
+) WITHOUT ROWID;
+
+-- One row per unit, updated by every upload (reading timestamps; last_upload is server time)
+CREATE TABLE IF NOT EXISTS devices (
+    device_id TEXT PRIMARY KEY,
+    first_timestamp INTEGER NOT NULL,
+    last_timestamp INTEGER NOT NULL,
+    last_upload INTEGER NOT NULL
 );
 
--- Migration: Add columns if they don't exist
+-- Rollups for long chart ranges (see src/lib/rollup.ts), per device
+-- Per metric: min/max/avg over the readings with a value, and their count. /api/sensor
+-- recomputes the buckets of each upload; after creating the tables on an existing database,
+-- fill them once with backfill-rollups.sql
+
+-- Hourly rollup (bucket = multiple of 3600)
+CREATE TABLE IF NOT EXISTS sensor_hourly (
+    device_id TEXT NOT NULL,
+    bucket INTEGER NOT NULL,              -- Bucket start (Unix timestamp, UTC-aligned)
+    count INTEGER NOT NULL,               -- Readings in the bucket
+    temperature_min REAL, temperature_max REAL, temperature_avg REAL, temperature_count INTEGER,
+    humidity_min REAL, humidity_max REAL, humidity_avg REAL, humidity_count INTEGER,
+    co2_min REAL, co2_max REAL, co2_avg REAL, co2_count INTEGER,
+    battery_voltage_min REAL, battery_voltage_max REAL, battery_voltage_avg REAL, battery_voltage_count INTEGER,
+    battery_percent_min REAL, battery_percent_max REAL, battery_percent_avg REAL, battery_percent_count INTEGER,
+    battery_rate_min REAL, battery_rate_max REAL, battery_rate_avg REAL, battery_rate_count INTEGER,
+    battery_charging_min REAL, battery_charging_max REAL, battery_charging_avg REAL, battery_charging_count INTEGER,
+    rtc_drift_ms_min REAL, rtc_drift_ms_max REAL, rtc_drift_ms_avg REAL, rtc_drift_ms_count INTEGER,
+    energy_uah_min REAL, energy_uah_max REAL, energy_uah_avg REAL, energy_uah_count INTEGER,
+    PRIMARY KEY (device_id, bucket)
+) WITHOUT ROWID;
+
+-- Daily rollup (bucket = multiple of 86400, UTC days), built from sensor_hourly
+CREATE TABLE IF NOT EXISTS sensor_daily (
+    device_id TEXT NOT NULL,
+    bucket INTEGER NOT NULL,              -- Bucket start (Unix timestamp, UTC-aligned)
+    count INTEGER NOT NULL,               -- Readings in the bucket
+    temperature_min REAL, temperature_max REAL, temperature_avg REAL, temperature_count INTEGER,
+    humidity_min REAL, humidity_max REAL, humidity_avg REAL, humidity_count INTEGER,
+    co2_min REAL, co2_max REAL, co2_avg REAL, co2_count INTEGER,
+    battery_voltage_min REAL, battery_voltage_max REAL, battery_voltage_avg REAL, battery_voltage_count INTEGER,
+    battery_percent_min REAL, battery_percent_max REAL, battery_percent_avg REAL, battery_percent_count INTEGER,
+    battery_rate_min REAL, battery_rate_max REAL, battery_rate_avg REAL, battery_rate_count INTEGER,
+    battery_charging_min REAL, battery_charging_max REAL, battery_charging_avg REAL, battery_charging_count INTEGER,
+    rtc_drift_ms_min REAL, rtc_drift_ms_max REAL, rtc_drift_ms_avg REAL, rtc_drift_ms_count INTEGER,
+    energy_uah_min REAL, energy_uah_max REAL, energy_uah_avg REAL, energy_uah_count INTEGER,
+    PRIMARY KEY (device_id, bucket)
+) WITHOUT ROWID;
+
+-- Migration: databases created before device_id: run migrate-device-id.sql instead of this file
+-- Add columns if they don't exist
 -- Run this manually if upgrading from older schema:
 -- ALTER TABLE sensor_data ADD COLUMN battery_percent REAL;
 -- ALTER TABLE sensor_data ADD COLUMN battery_max17048_percent REAL;
@@ -25,6 +78,16 @@ CREATE TABLE IF NOT EXISTS sensor_data (
 -- ALTER TABLE sensor_data ADD COLUMN battery_charging INTEGER;
 -- ALTER TABLE sensor_data ADD COLUMN cumulative_comp_ms INTEGER;
 -- ALTER TABLE sensor_data ADD COLUMN drift_rate REAL;
+-- ALTER TABLE sensor_data ADD COLUMN boot_profile TEXT;
+-- ALTER TABLE sensor_data ADD COLUMN energy_uah REAL;
+-- ALTER TABLE sensor_hourly ADD COLUMN energy_uah_min REAL;
+-- ALTER TABLE sensor_hourly ADD COLUMN energy_uah_max REAL;
+-- ALTER TABLE sensor_hourly ADD COLUMN energy_uah_avg REAL;
+-- ALTER TABLE sensor_hourly ADD COLUMN energy_uah_count INTEGER;
+-- ALTER TABLE sensor_daily ADD COLUMN energy_uah_min REAL;
+-- ALTER TABLE sensor_daily ADD COLUMN energy_uah_max REAL;
+-- ALTER TABLE sensor_daily ADD COLUMN energy_uah_avg REAL;
+-- ALTER TABLE sensor_daily ADD COLUMN energy_uah_count INTEGER;
 
 -- Insert dummy data for testing (last 24 hours, every minute)
 -- This will be run manually for development
@@ -9,6 +9,7 @@
  *   --count=<n>       Number of data points to send (default: 60)
  *   --interval=<s>    Interval between points in seconds (default: 60)
  *   --api-key=<key>   API key for authentication (or set API_KEY env var)
+ *   --device=<id>     Device id sent as X-Device-Id (default: none, stored as 'default')
  */
 
 interface SensorReading {
@@ -20,14 +21,16 @@ interface SensorReading {
   batt_percent: number;
   batt_rate: number;
   rtc_drift_ms?: number;
+  energy_uah?: number;
 }
 
-function parseArgs(): { url: string; count: number; interval: number; apiKey: string } {
+function parseArgs(): { url: string; count: number; interval: number; apiKey: string; device: string } {
   const args = process.argv.slice(2);
   let url = 'http://localhost:4321';
   let count = 60;
   let interval = 60;
   let apiKey = process.env.API_KEY || '';
+  let device = '';
 
   for (const arg of args) {
     if (arg.startsWith('--url=')) {
@@ -38,10 +41,12 @@ function parseArgs(): { url: string; count: number; interval: number; apiKey: st
       interval = parseInt(arg.slice(11), 10);
     } else if (arg.startsWith('--api-key=')) {
       apiKey = arg.slice(10);
+    } else if (arg.startsWith('--device=')) {
+      device = arg.slice(9);
     }
   }
 
-  return { url, count, interval, apiKey };
+  return { url, count, interval, apiKey, device };
 }
 
 function generateDummyData(count: number, intervalSeconds: number): SensorReading[] {
@@ -72,12 +77,14 @@ function generateDummyData(count: number, intervalSeconds: number): SensorReadin
       batt_voltage: Math.round(batteryVoltage * 1000) / 1000,
       batt_percent: Math.round(batteryPercent * 10) / 10,
       batt_rate: Math.round((-20 / count * 60 + (Math.random() - 0.5)) * 100) / 100, // %/hr
+      energy_uah: Math.round((25 + Math.random() * 5) * 10) / 10, // Minute wake without WiFi
     };
 
     // Add RTC drift once per hour (at minute 0)
     // Simulate drift: -500ms to +500ms, with slight positive bias (clock runs fast)
     if (minuteOfHour === 0 || (intervalSeconds >= 3600)) {
       reading.rtc_drift_ms = Math.round((Math.random() - 0.4) * 1000);
+      reading.energy_uah = Math.round((250 + Math.random() * 100) * 10) / 10; // NTP/upload wake
     }
 
     data.push(reading);
@@ -86,7 +93,7 @@ function generateDummyData(count: number, intervalSeconds: number): SensorReadin
   return data;
 }
 
-async function sendData(url: string, data: SensorReading[], apiKey: string): Promise<void> {
+async function sendData(url: string, data: SensorReading[], apiKey: string, device: string): Promise<void> {
   const endpoint = `${url}/api/sensor`;
 
   console.log(`Sending ${data.length} data points to ${endpoint}...`);
@@ -99,6 +106,9 @@ async function sendData(url: string, data: SensorReading[], apiKey: string): Pro
   if (apiKey) {
     headers['X-API-Key'] = apiKey;
   }
+  if (device) {
+    headers['X-Device-Id'] = device;
+  }
 
   const response = await fetch(endpoint, {
     method: 'POST',
@@ -117,12 +127,13 @@ async function sendData(url: string, data: SensorReading[], apiKey: string): Pro
 }
 
 async function main() {
-  const { url, count, interval, apiKey } = parseArgs();
+  const { url, count, interval, apiKey, device } = parseArgs();
 
   console.log(`\n📊 Dummy Data Sender`);
   console.log(`   URL: ${url}`);
   console.log(`   Count: ${count} points`);
   console.log(`   Interval: ${interval}s`);
+  console.log(`   Device: ${device || '(default)'}`);
   console.log(`   API Key: ${apiKey ? '****' + apiKey.slice(-4) : '(none)'}\n`);
 
   const data = generateDummyData(count, interval);
@@ -134,7 +145,7 @@ async function main() {
   });
   console.log('  ...\n');
 
-  await sendData(url, data, apiKey);
+  await sendData(url, data, apiKey, device);
 }
 
 main().catch(console.error);
@@ -2,6 +2,7 @@
 /// <reference types="astro/client" />
 
 type D1Database = import('@cloudflare/workers-types').D1Database;
+type D1PreparedStatement = import('@cloudflare/workers-types').D1PreparedStatement;
 
 interface Env {
   DB: D1Database;
@@ -0,0 +1,224 @@
+// Decoder for the firmware's binary batch upload (Content-Type: application/x-epdenv-batch)
+// Format reference: EPDEnvClock/sensor_record.h
+//
+// Body: 8-byte header (magic "EPSB", version, encoding, reserved), then items until the end:
+//   tag 1: one record - raw 32-byte SensorRecord (encoding 0) or zigzag varint deltas
+//          against the previous record (encoding 1)
+//   tag 2: u8 length + boot_prof JSON text for the preceding record
+
+export const BATCH_CONTENT_TYPE = 'application/x-epdenv-batch';
+
+const MAGIC = 0x42535045; // "EPSB"
+const VERSION = 1;
+const ENCODING_RAW = 0;
+const ENCODING_DELTA = 1;
+const TAG_RECORD = 1;
+const TAG_BOOT_PROFILE = 2;
+const HEADER_SIZE = 8;
+const RECORD_SIZE = 32;
+
+const FLAG_BATTERY = 0x01;
+const FLAG_CHARGING = 0x02;
+const FLAG_DRIFT = 0x04;
+
+// Same shape as the JSON readings accepted by /api/sensor
+export interface BatchReading {
+  timestamp: number;
+  temp: number;
+  humidity: number;
+  co2: number;
+  batt_voltage?: number;
+  batt_percent?: number;
+  batt_max17048_percent?: number;
+  batt_rate?: number;
+  charging: boolean;
+  rtc_drift_ms?: number;
+  cumulative_comp_ms?: number;
+  drift_rate?: number;
+  energy_uah?: number;
+  boot_prof?: (number | null)[];
+}
+
+interface RawRecord {
+  timestamp: number;
+  temperatureC100: number;
+  humidityC100: number;
+  co2: number;
+  batteryMv: number;
+  batteryPercentC100: number;
+  batteryMax17048C100: number;
+  batteryRateC100: number;
+  rtcDriftMs: number;
+  cumulativeCompMs: number;
+  driftRateC10: number;
+  flags: number;
+  energyUAhC10: number; // 0 = no estimate
+}
+
+// Delta-encoded fields, in wire order
+const DELTA_FIELDS = [
+  'timestamp',
+  'temperatureC100',
+  'humidityC100',
+  'co2',
+  'batteryMv',
+  'batteryPercentC100',
+  'batteryMax17048C100',
+  'batteryRateC100',
+  'rtcDriftMs',
+  'cumulativeCompMs',
+  'driftRateC10',
+] as const;
+
+function emptyRecord(): RawRecord {
+  return {
+    timestamp: 0, temperatureC100: 0, humidityC100: 0, co2: 0, batteryMv: 0, batteryPercentC100: 0,
+    batteryMax17048C100: 0, batteryRateC100: 0, rtcDriftMs: 0, cumulativeCompMs: 0, driftRateC10: 0,
+    flags: 0, energyUAhC10: 0,
+  };
+}
+
+// CRC-8 (poly 0x07, init 0xFF), same as sensor_record.cpp
+function crc8(bytes: Uint8Array): number {
+  let crc = 0xff;
+  for (const b of bytes) {
+    crc ^= b;
+    for (let bit = 0; bit < 8; bit++) {
+      crc = crc & 0x80 ? ((crc << 1) ^ 0x07) & 0xff : (crc << 1) & 0xff;
+    }
+  }
+  return crc;
+}
+
+class Reader {
+  pos = 0;
+  constructor(private readonly bytes: Uint8Array) {}
+
+  get remaining(): number {
+    return this.bytes.length - this.pos;
+  }
+
+  u8(): number {
+    if (this.pos >= this.bytes.length) throw new Error('Truncated batch');
+    return this.bytes[this.pos++];
+  }
+
+  take(length: number): Uint8Array {
+    if (length > this.remaining) throw new Error('Truncated batch');
+    const out = this.bytes.subarray(this.pos, this.pos + length);
+    this.pos += length;
+    return out;
+  }
+
+  // LEB128 varint; plain arithmetic keeps values above 2^31 exact
+  varint(): number {
+    let value = 0;
+    let scale = 1;
+    for (let i = 0; i < 10; i++) {
+      const b = this.u8();
+      value += (b & 0x7f) * scale;
+      if ((b & 0x80) === 0) return value;
+      scale *= 128;
+    }
+    throw new Error('Invalid varint');
+  }
+
+  zigzag(): number {
+    const n = this.varint();
+    return n % 2 === 0 ? n / 2 : -(n + 1) / 2;
+  }
+}
+
+function readRawRecord(bytes: Uint8Array): RawRecord {
+  if (crc8(bytes.subarray(0, RECORD_SIZE - 1)) !== bytes[RECORD_SIZE - 1]) {
+    throw new Error('Record checksum mismatch');
+  }
+  const view = new DataView(bytes.buffer, bytes.byteOffset, RECORD_SIZE);
+  return {
+    timestamp: view.getUint32(0, true),
+    temperatureC100: view.getInt16(4, true),
+    humidityC100: view.getUint16(6, true),
+    co2: view.getUint16(8, true),
+    batteryMv: view.getUint16(10, true),
+    batteryPercentC100: view.getUint16(12, true),
+    batteryMax17048C100: view.getUint16(14, true),
+    batteryRateC100: view.getInt16(16, true),
+    rtcDriftMs: view.getInt32(18, true),
+    cumulativeCompMs: view.getInt32(22, true),
+    driftRateC10: view.getInt16(26, true),
+    flags: view.getUint8(28),
+    energyUAhC10: view.getUint16(29, true),
+  };
+}
+
+function toReading(r: RawRecord): BatchReading {
+  const reading: BatchReading = {
+    timestamp: r.timestamp,
+    temp: r.temperatureC100 / 100,
+    humidity: r.humidityC100 / 100,
+    co2: r.co2,
+    charging: (r.flags & FLAG_CHARGING) !== 0,
+  };
+  if (r.flags & FLAG_BATTERY) {
+    reading.batt_voltage = r.batteryMv / 1000;
+    reading.batt_percent = r.batteryPercentC100 / 100;
+    reading.batt_max17048_percent = r.batteryMax17048C100 / 100;
+    reading.batt_rate = r.batteryRateC100 / 100;
+  }
+  if (r.flags & FLAG_DRIFT) {
+    reading.rtc_drift_ms = r.rtcDriftMs;
+    reading.cumulative_comp_ms = r.cumulativeCompMs;
+    reading.drift_rate = r.driftRateC10 / 10;
+  }
+  if (r.energyUAhC10 !== 0) {
+    reading.energy_uah = r.energyUAhC10 / 10;
+  }
+  return reading;
+}
+
+// Decode a batch body into readings (throws on malformed input)
+export function decodeBatch(body: Uint8Array): BatchReading[] {
+  if (body.length < HEADER_SIZE) throw new Error('Batch too short');
+  const header = new DataView(body.buffer, body.byteOffset, HEADER_SIZE);
+  if (header.getUint32(0, true) !== MAGIC) throw new Error('Bad batch magic');
+  if (header.getUint8(4) !== VERSION) throw new Error(`Unsupported batch version ${header.getUint8(4)}`);
+  const encoding = header.getUint8(5);
+  if (encoding !== ENCODING_RAW && encoding !== ENCODING_DELTA) {
+    throw new Error(`Unsupported batch encoding ${encoding}`);
+  }
+
+  const reader = new Reader(body.subarray(HEADER_SIZE));
+  const readings: BatchReading[] = [];
+  let previous = emptyRecord();
+
+  while (reader.remaining > 0) {
+    const tag = reader.u8();
+    if (tag === TAG_RECORD) {
+      let record: RawRecord;
+      if (encoding === ENCODING_RAW) {
+        record = readRawRecord(reader.take(RECORD_SIZE));
+      } else {
+        record = emptyRecord();
+        for (const field of DELTA_FIELDS) {
+          record[field] = previous[field] + reader.zigzag();
+        }
+        record.flags = reader.u8();
+        record.energyUAhC10 = reader.zigzag();
+      }
+      readings.push(toReading(record));
+      previous = record;
+    } else if (tag === TAG_BOOT_PROFILE) {
+      const text = new TextDecoder().decode(reader.take(reader.u8()));
+      const last = readings[readings.length - 1];
+      try {
+        const profile = JSON.parse(text);
+        if (last && Array.isArray(profile)) last.boot_prof = profile;
+      } catch {
+        // A damaged profile only loses the profile, not the reading
+      }
+    } else {
+      throw new Error(`Unknown batch item tag ${tag}`);
+    }
+  }
+  return readings;
+}
@@ -0,0 +1,42 @@
+// Device identity for uploads and queries (devices table, see schema.sql)
+//
+// Each unit sends X-Device-Id with its uploads (EPDEnvClock: SENSOR_DEVICE_ID in
+// server_config.h, "epd-<MAC>" by default). Uploads without it belong to DEFAULT_DEVICE_ID,
+// which is also where a single-device database's readings go (migrate-device-id.sql).
+
+export const DEVICE_HEADER = 'X-Device-Id';
+export const DEFAULT_DEVICE_ID = 'default';
+
+const DEVICE_ID_PATTERN = /^[A-Za-z0-9._-]{1,64}$/;
+
+// Validated id, DEFAULT_DEVICE_ID when absent, null when malformed
+export function parseDeviceId(value: string | null): string | null {
+  if (value === null || value.trim() === '') return DEFAULT_DEVICE_ID;
+  const id = value.trim();
+  return DEVICE_ID_PATTERN.test(id) ? id : null;
+}
+
+export interface DeviceInfo {
+  device_id: string;
+  first_timestamp: number;
+  last_timestamp: number;
+  last_upload: number;
+}
+
+// Widen the device's reading range and stamp the upload time
+export function deviceUpsertStatement(db: D1Database, deviceId: string, timestamps: number[]): D1PreparedStatement {
+  return db.prepare(`
+    INSERT INTO devices (device_id, first_timestamp, last_timestamp, last_upload)
+    VALUES (?, ?, ?, ?)
+    ON CONFLICT(device_id) DO UPDATE SET
+      first_timestamp = MIN(first_timestamp, excluded.first_timestamp),
+      last_timestamp = MAX(last_timestamp, excluded.last_timestamp),
+      last_upload = excluded.last_upload
+  `).bind(deviceId, Math.min(...timestamps), Math.max(...timestamps), Math.floor(Date.now() / 1000));
+}
+
+// All units, most recently reporting first
+export async function listDevices(db: D1Database): Promise<DeviceInfo[]> {
+  const result = await db.prepare('SELECT device_id, first_timestamp, last_timestamp, last_upload FROM devices ORDER BY last_timestamp DESC').all();
+  return result.results as unknown as DeviceInfo[];
+}
@@ -0,0 +1,119 @@
+// Hourly and daily rollups of sensor_data (tables sensor_hourly / sensor_daily, see schema.sql)
+//
+// Each rollup row covers one device's [bucket, bucket + width) in UTC and holds, per metric, the
+// min/max/avg over the readings that have a value and their count. /api/sensor recomputes
+// the buckets its readings fall into (hourly from sensor_data, daily from sensor_hourly),
+// so duplicate uploads leave them unchanged. /api/data reads them for long ranges.
+
+export const HOUR = 3600;
+export const DAY = 86400;
+// The clock's local day (JST, as the firmware keeps it) starts this far before the UTC day.
+// It is a whole number of hours, so local days are exact sums of hourly buckets; the
+// sensor_daily buckets are UTC days and do not line up with them.
+export const LOCAL_DAY_OFFSET = 9 * HOUR;
+
+// Rolled-up sensor_data columns; the dashboard charts these
+export const ROLLUP_METRICS = [
+  'temperature',
+  'humidity',
+  'co2',
+  'battery_voltage',
+  'battery_percent',
+  'battery_rate',
+  'battery_charging',  // avg = fraction of readings taken while charging
+  'rtc_drift_ms',
+  'energy_uah',        // avg x count = estimated µAh of the bucket's wake cycles
+] as const;
+
+export type RollupMetric = typeof ROLLUP_METRICS[number];
+
+export const ROLLUP_TABLES = { hourly: 'sensor_hourly', daily: 'sensor_daily' } as const;
+
+const ROLLUP_COLUMNS = ['device_id', 'bucket', 'count', ...ROLLUP_METRICS.flatMap(m => [`${m}_min`, `${m}_max`, `${m}_avg`, `${m}_count`])].join(', ');
+
+export interface Aggregates {
+  min: string;
+  max: string;
+  avg: string;
+  count: string;
+}
+
+// SQL aggregates of a metric over raw sensor_data readings
+export function rawAggregates(m: RollupMetric): Aggregates {
+  return { min: `MIN(${m})`, max: `MAX(${m})`, avg: `AVG(${m})`, count: `COUNT(${m})` };
+}
+
+// SQL aggregates of a metric that merge rollup rows (count-weighted average)
+export function mergedAggregates(m: RollupMetric): Aggregates {
+  return {
+    min: `MIN(${m}_min)`,
+    max: `MAX(${m}_max)`,
+    avg: `SUM(${m}_avg * ${m}_count) / SUM(${m}_count)`,
+    count: `SUM(${m}_count)`,
+  };
+}
+
+// In ROLLUP_COLUMNS order
+function aggregateList(aggregates: (m: RollupMetric) => Aggregates): string {
+  return ROLLUP_METRICS.map(m => {
+    const a = aggregates(m);
+    return `${a.min}, ${a.max}, ${a.avg}, ${a.count}`;
+  }).join(', ');
+}
+
+const HOURLY_REFRESH = `
+  INSERT OR REPLACE INTO sensor_hourly (${ROLLUP_COLUMNS})
+  SELECT device_id, timestamp / ${HOUR} * ${HOUR}, COUNT(*), ${aggregateList(rawAggregates)}
+  FROM sensor_data
+  WHERE device_id = ? AND timestamp >= ? AND timestamp < ?
+  GROUP BY 1, 2
+`;
+
+const DAILY_REFRESH = `
+  INSERT OR REPLACE INTO sensor_daily (${ROLLUP_COLUMNS})
+  SELECT device_id, bucket / ${DAY} * ${DAY}, SUM(count), ${aggregateList(mergedAggregates)}
+  FROM sensor_hourly
+  WHERE device_id = ? AND bucket >= ? AND bucket < ?
+  GROUP BY 1, 2
+`;
+
+// Estimated µAh and wake cycles per local day (day = its start as a Unix time) of the hourly
+// buckets in [start, end): each hour contributes energy_uah avg x count
+export const ENERGY_DAILY_QUERY = `
+  SELECT (bucket + ${LOCAL_DAY_OFFSET}) / ${DAY} * ${DAY} - ${LOCAL_DAY_OFFSET} AS day,
+         SUM(energy_uah_avg * energy_uah_count) AS energy_uah,
+         SUM(energy_uah_count) AS wakes
+  FROM sensor_hourly
+  WHERE device_id = ? AND bucket >= ? AND bucket < ? AND energy_uah_count > 0
+  GROUP BY 1
+  ORDER BY 1
+`;
+
+// Start of the local day holding ts
+export function localDayStart(ts: number): number {
+  return Math.floor((ts + LOCAL_DAY_OFFSET) / DAY) * DAY - LOCAL_DAY_OFFSET;
+}
+
+// Contiguous [start, end) runs of the width-aligned buckets the timestamps fall into
+function bucketSpans(timestamps: number[], width: number): [number, number][] {
+  const buckets = [...new Set(timestamps.map(ts => Math.floor(ts / width) * width))].sort((a, b) => a - b);
+  const spans: [number, number][] = [];
+  for (const bucket of buckets) {
+    const last = spans[spans.length - 1];
+    if (last && last[1] === bucket) {
+      last[1] = bucket + width;
+    } else {
+      spans.push([bucket, bucket + width]);
+    }
+  }
+  return spans;
+}
+
+// Statements that recompute every bucket of the device holding one of the timestamps
+// Run them after the inserts in the same D1 batch: hourly first, daily is built from it.
+export function rollupRefreshStatements(db: D1Database, deviceId: string, timestamps: number[]): D1PreparedStatement[] {
+  return [
+    ...bucketSpans(timestamps, HOUR).map(([start, end]) => db.prepare(HOURLY_REFRESH).bind(deviceId, start, end)),
+    ...bucketSpans(timestamps, DAY).map(([start, end]) => db.prepare(DAILY_REFRESH).bind(deviceId, start, end)),
+  ];
+}
@@ -1,12 +1,100 @@
 import type { APIRoute } from 'astro';
+import { DEFAULT_DEVICE_ID, listDevices, parseDeviceId } from '../../lib/device';
+import { DAY, ENERGY_DAILY_QUERY, HOUR, ROLLUP_METRICS, ROLLUP_TABLES, localDayStart, mergedAggregates, rawAggregates, type Aggregates, type RollupMetric } from '../../lib/rollup';
 
-interface Stats {
-  temperature: { min: number | null; max: number | null };
-  humidity: { min: number | null; max: number | null };
-  co2: { min: number | null; max: number | null };
-  battery_voltage: { min: number | null; max: number | null };
-  battery_percent: { min: number | null; max: number | null };
-  battery_rate: { min: number | null; max: number | null };
+type Resolution = 'raw' | 'hourly' | 'daily';
+
+interface MinMax {
+  min: number | null;
+  max: number | null;
+}
+
+const STATS_METRICS = ['temperature', 'humidity', 'co2', 'battery_voltage', 'battery_percent', 'battery_rate'] as const;
+type Stats = Record<typeof STATS_METRICS[number], MinMax>;
+
+type Row = Record<string, unknown>;
+
+const RAW_COLUMNS = 'timestamp, temperature, humidity, co2, battery_voltage, battery_percent, battery_charging, battery_rate, rtc_drift_ms, cumulative_comp_ms, drift_rate, boot_profile, energy_uah';
+
+// Longest span read from each source; longer ranges use the next coarser one, so a request
+// reads at most ~4.3k raw rows or ~2.2k hourly rows
+const RAW_MAX_SPAN = 3 * DAY;
+const HOURLY_MAX_SPAN = 90 * DAY;
+// Nominal raw reading interval (one per minute)
+const RAW_INTERVAL = 60;
+
+// Series length cap (?points=); the default returns up to 3 days as raw rows
+const DEFAULT_POINTS = 5000;
+const MIN_POINTS = 10;
+const MAX_POINTS = 10000;
+
+// `hours` windows end on this step, so loads within it share one ETag and cache entry (the
+// newest readings are always included; the start trails by up to one step)
+const WINDOW_STEP = HOUR;
+// Browsers revalidate after a minute; the edge keeps an entry until its key goes out of use
+const CACHE_CONTROL = 'public, max-age=60, s-maxage=3600';
+
+const SOURCES: Record<Resolution, { table: string; timeColumn: string; width: number; aggregates: (m: RollupMetric) => Aggregates; count: string }> = {
+  raw: { table: 'sensor_data', timeColumn: 'timestamp', width: RAW_INTERVAL, aggregates: rawAggregates, count: 'COUNT(*)' },
+  hourly: { table: ROLLUP_TABLES.hourly, timeColumn: 'bucket', width: HOUR, aggregates: mergedAggregates, count: 'SUM(count)' },
+  daily: { table: ROLLUP_TABLES.daily, timeColumn: 'bucket', width: DAY, aggregates: mergedAggregates, count: 'SUM(count)' },
+};
+
+function chooseResolution(span: number): Resolution {
+  if (span <= RAW_MAX_SPAN) return 'raw';
+  if (span <= HOURLY_MAX_SPAN) return 'hourly';
+  return 'daily';
+}
+
+// Buckets of `width` seconds (a multiple of the source's), one row each:
+// timestamp = bucket start, count, and per metric the average plus <metric>_min / <metric>_max
+function bucketedQuery(resolution: Resolution, width: number): string {
+  const source = SOURCES[resolution];
+  const columns = ROLLUP_METRICS.map(m => {
+    const a = source.aggregates(m);
+    return `${a.avg} AS ${m}, ${a.min} AS ${m}_min, ${a.max} AS ${m}_max`;
+  }).join(', ');
+  return `
+    SELECT ${source.timeColumn} / ${width} * ${width} AS timestamp, ${source.count} AS count, ${columns}
+    FROM ${source.table}
+    WHERE device_id = ? AND ${source.timeColumn} >= ? AND ${source.timeColumn} <= ?
+    GROUP BY 1
+    ORDER BY 1
+  `;
+}
+
+// If-None-Match (or, without it, If-Modified-Since) says the client's copy is current
+function notModified(request: Request, etag: string, lastModified: number): boolean {
+  const ifNoneMatch = request.headers.get('If-None-Match');
+  if (ifNoneMatch !== null) {
+    return ifNoneMatch.split(',').some(tag => {
+      const value = tag.trim();
+      return value === '*' || value.replace(/^W\//, '') === etag;
+    });
+  }
+  const ifModifiedSince = request.headers.get('If-Modified-Since');
+  if (ifModifiedSince !== null) {
+    const since = Date.parse(ifModifiedSince);
+    return !Number.isNaN(since) && Math.floor(since / 1000) >= lastModified;
+  }
+  return false;
+}
+
+// Min/max over the series (bucketed rows carry the extremes in <metric>_min / <metric>_max)
+function seriesStats(rows: Row[], bucketed: boolean): Stats {
+  const stats = {} as Stats;
+  for (const m of STATS_METRICS) {
+    let min: number | null = null;
+    let max: number | null = null;
+    for (const row of rows) {
+      const low = (bucketed ? row[`${m}_min`] : row[m]) as number | null;
+      const high = (bucketed ? row[`${m}_max`] : row[m]) as number | null;
+      if (low !== null && low !== undefined && (min === null || low < min)) min = low;
+      if (high !== null && high !== undefined && (max === null || high > max)) max = high;
+    }
+    stats[m] = { min, max };
+  }
+  return stats;
 }
 
 // CORS headers for cross-origin requests (allows local dev with production API)
@@ -14,6 +102,7 @@ const corsHeaders = {
   'Access-Control-Allow-Origin': '*',
   'Access-Control-Allow-Methods': 'GET, OPTIONS',
   'Access-Control-Allow-Headers': 'Content-Type',
+  'Access-Control-Expose-Headers': 'ETag, Last-Modified',
 };
 
 // Handle preflight OPTIONS request
@@ -29,110 +118,167 @@ export const OPTIONS: APIRoute = async () => {
 //   hours: number of hours to fetch (default: 24)
 //   from: unix timestamp start
 //   to: unix timestamp end
-export const GET: APIRoute = async ({ url, locals }) => {
+//   points: maximum series length (default: 5000)
+//   device: device id (default: the most recently reporting device)
+// The series comes from sensor_data for spans up to 3 days, else from the hourly (up to 90 days)
+// or daily rollups (buckets starting in the range). When the span holds more than `points`
+// source rows, rows are merged into buckets of bucket_seconds: the metric fields are averages,
+// with <metric>_min / <metric>_max.
+// `latest` is the newest raw reading in the range; `devices` lists every unit.
+// `energy_daily` sums energy_uah per local (JST) day, whole days from the one holding `from`
+// to the one holding `to`; `complete` is false for today.
+// Responses carry an ETag and Last-Modified built from the range and the last-ingest watermark
+// (devices table, updated by every upload), answer 304 to matching conditional requests, and
+// are kept in the edge cache under that ETag, so an upload invalidates them.
+export const GET: APIRoute = async ({ request, url, locals }) => {
   try {
     const db = locals.runtime.env.DB;
     const params = url.searchParams;
 
-    let dataQuery: string;
-    let statsQuery: string;
-    let bindings: (number | null)[];
-
-    const fromTs = params.get('from');
-    const toTs = params.get('to');
+    const fromParam = params.get('from');
+    const toParam = params.get('to');
     const hours = params.get('hours');
+    const pointsParam = params.get('points');
+    const deviceParam = params.get('device');
 
-    if (fromTs && toTs) {
+    let fromTs: number;
+    let toTs: number;
+    let span: number;
+    let windowEnd = 0;
+    if (fromParam && toParam) {
       // Specific time range
-      dataQuery = `
-        SELECT timestamp, temperature, humidity, co2, battery_voltage, battery_percent, battery_charging, battery_rate, rtc_drift_ms, cumulative_comp_ms, drift_rate
-        FROM sensor_data
-        WHERE timestamp >= ? AND timestamp <= ?
-        ORDER BY timestamp ASC
-      `;
-      statsQuery = `
-        SELECT
-          MIN(temperature) as temp_min, MAX(temperature) as temp_max,
-          MIN(humidity) as hum_min, MAX(humidity) as hum_max,
-          MIN(co2) as co2_min, MAX(co2) as co2_max,
-          MIN(battery_voltage) as bat_min, MAX(battery_voltage) as bat_max,
-          MIN(battery_percent) as bat_pct_min, MAX(battery_percent) as bat_pct_max,
-          MIN(battery_rate) as bat_rate_min, MAX(battery_rate) as bat_rate_max
-        FROM sensor_data
-        WHERE timestamp >= ? AND timestamp <= ?
-      `;
-      bindings = [parseInt(fromTs), parseInt(toTs)];
+      fromTs = parseInt(fromParam);
+      toTs = parseInt(toParam);
+      span = toTs - fromTs;
     } else {
-      // Last N hours (default 24)
+      // Last N hours (default 24), including readings stamped slightly ahead of the server clock
       const hoursNum = hours ? parseInt(hours) : 24;
-      const nowTs = Math.floor(Date.now() / 1000);
-      const startTs = nowTs - (hoursNum * 60 * 60);
+      span = hoursNum * HOUR;
+      windowEnd = Math.floor(Date.now() / 1000 / WINDOW_STEP) * WINDOW_STEP;
+      fromTs = windowEnd - span;
+      toTs = Number.MAX_SAFE_INTEGER;
+    }
+    if (!Number.isFinite(fromTs) || !Number.isFinite(toTs) || !(span >= 0)) {
+      return new Response(JSON.stringify({ error: 'Invalid time range' }), {
+        status: 400,
+        headers: {
+          'Content-Type': 'application/json',
+          ...corsHeaders,
+        },
+      });
+    }
+
+    const requestedPoints = pointsParam ? parseInt(pointsParam) : DEFAULT_POINTS;
+    const points = Number.isFinite(requestedPoints)
+      ? Math.min(Math.max(requestedPoints, MIN_POINTS), MAX_POINTS)
+      : DEFAULT_POINTS;
 
-      dataQuery = `
-        SELECT timestamp, temperature, humidity, co2, battery_voltage, battery_percent, battery_charging, battery_rate, rtc_drift_ms, cumulative_comp_ms, drift_rate
+    const devices = await listDevices(db);
+    const deviceId = deviceParam ? parseDeviceId(deviceParam) : (devices[0]?.device_id ?? DEFAULT_DEVICE_ID);
+    if (deviceId === null) {
+      return new Response(JSON.stringify({ error: 'Invalid device' }), {
+        status: 400,
+        headers: {
+          'Content-Type': 'application/json',
+          ...corsHeaders,
+        },
+      });
+    }
+
+    // Any upload changes the watermark (the response lists every device)
+    const lastUpload = Math.max(0, ...devices.map(d => d.last_upload));
+    const lastReading = Math.max(0, ...devices.map(d => d.last_timestamp));
+    const etag = `"v2-${deviceId}-${fromTs}-${toTs}-${points}-${lastUpload}-${lastReading}"`;
+    const lastModified = Math.max(lastUpload, windowEnd);
+    const cacheHeaders = {
+      'Cache-Control': CACHE_CONTROL,
+      'ETag': etag,
+      'Last-Modified': new Date(lastModified * 1000).toUTCString(),
+    };
+    if (notModified(request, etag, lastModified)) {
+      return new Response(null, {
+        status: 304,
+        headers: {
+          ...cacheHeaders,
+          ...corsHeaders,
+        },
+      });
+    }
+
+    const cache = locals.runtime.caches?.default;
+    const cacheKey = new Request(`${url.origin}/api/data?etag=${encodeURIComponent(etag)}`);
+    const cached = cache ? await cache.match(cacheKey) : undefined;
+    if (cached) {
+      return cached;
+    }
+
+    const resolution = chooseResolution(span);
+    const sourceWidth = SOURCES[resolution].width;
+    const bucketSeconds = Math.max(Math.ceil(Math.ceil(span / points) / sourceWidth), 1) * sourceWidth;
+    // Raw readings already fit: return them as they are (0 = not bucketed)
+    const bucketed = resolution !== 'raw' || bucketSeconds > RAW_INTERVAL;
+
+    let data: Row[];
+    let latest: Row | null;
+    if (bucketed) {
+      const [dataResult, latestResult] = await Promise.all([
+        db.prepare(bucketedQuery(resolution, bucketSeconds)).bind(deviceId, fromTs, toTs).all(),
+        db.prepare(`SELECT ${RAW_COLUMNS} FROM sensor_data WHERE device_id = ? AND timestamp >= ? AND timestamp <= ? ORDER BY timestamp DESC LIMIT 1`)
+          .bind(deviceId, fromTs, toTs).first(),
+      ]);
+      data = dataResult.results as Row[];
+      latest = latestResult as Row | null;
+    } else {
+      const dataResult = await db.prepare(`
+        SELECT ${RAW_COLUMNS}
         FROM sensor_data
-        WHERE timestamp >= ?
+        WHERE device_id = ? AND timestamp >= ? AND timestamp <= ?
         ORDER BY timestamp ASC
-      `;
-      statsQuery = `
-        SELECT
-          MIN(temperature) as temp_min, MAX(temperature) as temp_max,
-          MIN(humidity) as hum_min, MAX(humidity) as hum_max,
-          MIN(co2) as co2_min, MAX(co2) as co2_max,
-          MIN(battery_voltage) as bat_min, MAX(battery_voltage) as bat_max,
-          MIN(battery_percent) as bat_pct_min, MAX(battery_percent) as bat_pct_max,
-          MIN(battery_rate) as bat_rate_min, MAX(battery_rate) as bat_rate_max
-        FROM sensor_data
-        WHERE timestamp >= ?
-      `;
-      bindings = [startTs];
+      `).bind(deviceId, fromTs, toTs).all();
+      data = dataResult.results as Row[];
+      latest = data.length > 0 ? data[data.length - 1] : null;
     }
 
-    const [dataResult, statsResult] = await Promise.all([
-      db.prepare(dataQuery).bind(...bindings).all(),
-      db.prepare(statsQuery).bind(...bindings).first()
-    ]);
-
-    const stats: Stats = {
-      temperature: {
-        min: statsResult?.temp_min as number | null,
-        max: statsResult?.temp_max as number | null
-      },
-      humidity: {
-        min: statsResult?.hum_min as number | null,
-        max: statsResult?.hum_max as number | null
-      },
-      co2: {
-        min: statsResult?.co2_min as number | null,
-        max: statsResult?.co2_max as number | null
-      },
-      battery_voltage: {
-        min: statsResult?.bat_min as number | null,
-        max: statsResult?.bat_max as number | null
-      },
-      battery_percent: {
-        min: statsResult?.bat_pct_min as number | null,
-        max: statsResult?.bat_pct_max as number | null
-      },
-      battery_rate: {
-        min: statsResult?.bat_rate_min as number | null,
-        max: statsResult?.bat_rate_max as number | null
-      },
-    };
+    // Whole local days around the range, today included (the firmware's own daily total is only logged)
+    const nowTs = Math.floor(Date.now() / 1000);
+    const energyStart = localDayStart(fromTs);
+    const energyEnd = localDayStart(Math.min(toTs, nowTs)) + DAY;
+    const energyResult = await db.prepare(ENERGY_DAILY_QUERY).bind(deviceId, energyStart, energyEnd).all();
+    const energyDaily = (energyResult.results as Row[]).map(row => {
+      const day = row.day as number;
+      return {
+        day,
+        energy_uah: row.energy_uah as number,
+        wakes: row.wakes as number,
+        complete: day + DAY <= nowTs,
+      };
+    });
 
-    return new Response(JSON.stringify({
+    const response = new Response(JSON.stringify({
       success: true,
-      count: dataResult.results.length,
-      data: dataResult.results,
-      stats,
+      device_id: deviceId,
+      devices,
+      count: data.length,
+      resolution,
+      bucket_seconds: bucketed ? bucketSeconds : 0,
+      data,
+      latest,
+      stats: seriesStats(data, bucketed),
+      energy_daily: energyDaily,
     }), {
       status: 200,
       headers: {
         'Content-Type': 'application/json',
-        'Cache-Control': 'public, max-age=60', // Cache for 1 minute
+        ...cacheHeaders,
         ...corsHeaders,
       },
     });
+    if (cache) {
+      locals.runtime.ctx.waitUntil(cache.put(cacheKey, response.clone()).catch(error => {
+        console.error('Error caching sensor data:', error);
+      }));
+    }
+    return response;
 
   } catch (error) {
     console.error('Error fetching sensor data:', error);
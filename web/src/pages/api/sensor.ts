@@ -1,4 +1,7 @@
 import type { APIRoute } from 'astro';
+import { BATCH_CONTENT_TYPE, decodeBatch } from '../../lib/batch';
+import { DEVICE_HEADER, deviceUpsertStatement, parseDeviceId } from '../../lib/device';
+import { rollupRefreshStatements } from '../../lib/rollup';
 
 interface SensorReading {
   timestamp?: number;
@@ -15,9 +18,21 @@ interface SensorReading {
   rtc_drift_ms?: number;
   cumulative_comp_ms?: number;  // Cumulative drift compensation applied (ms)
   drift_rate?: number;          // Drift rate used for compensation (ms/min)
+  boot_prof?: (number | null)[]; // Previous boot's phase end times (ms since wakeup)
+  energy_uah?: number;          // Previous wake cycle's estimated charge (µAh)
 }
 
+const INSERT_PREFIX = 'INSERT OR IGNORE INTO sensor_data (device_id, timestamp, temperature, humidity, co2, battery_voltage, battery_percent, battery_max17048_percent, battery_rate, battery_charging, rtc_drift_ms, cumulative_comp_ms, drift_rate, boot_profile, energy_uah)';
+const COLUMN_COUNT = 15;
+const ROW_PLACEHOLDERS = `(${new Array(COLUMN_COUNT).fill('?').join(', ')})`;
+// D1 allows at most 100 bound parameters per statement
+const ROWS_PER_STATEMENT = Math.floor(100 / COLUMN_COUNT);
+// One day of minute readings; larger backlogs arrive as several requests
+const MAX_READINGS_PER_REQUEST = 1440;
+
 // POST /api/sensor - Receive sensor data batch from ESP32
+// Body: JSON (application/json) or the firmware's binary batch (application/x-epdenv-batch)
+// Readings are stored under the X-Device-Id header (see lib/device.ts)
 export const POST: APIRoute = async ({ request, locals }) => {
   try {
     const env = locals.runtime.env;
@@ -39,10 +54,43 @@ export const POST: APIRoute = async ({ request, locals }) => {
     }
 
     const db = env.DB;
-    const data = await request.json() as SensorReading | SensorReading[];
 
-    // Handle both single reading and batch
-    const readings = Array.isArray(data) ? data : [data];
+    const deviceId = parseDeviceId(request.headers.get(DEVICE_HEADER));
+    if (deviceId === null) {
+      return new Response(JSON.stringify({ error: `Invalid ${DEVICE_HEADER} (1-64 of A-Z a-z 0-9 . _ -)` }), {
+        status: 400,
+        headers: { 'Content-Type': 'application/json' },
+      });
+    }
+
+    // Content negotiation: unknown types get 415 so the device falls back to JSON
+    const contentType = (request.headers.get('Content-Type') ?? '').split(';')[0].trim().toLowerCase();
+    let readings: SensorReading[];
+    if (contentType === BATCH_CONTENT_TYPE) {
+      try {
+        readings = decodeBatch(new Uint8Array(await request.arrayBuffer()));
+      } catch (error) {
+        return new Response(JSON.stringify({
+          error: 'Invalid batch',
+          details: error instanceof Error ? error.message : 'Unknown error'
+        }), {
+          status: 400,
+          headers: { 'Content-Type': 'application/json' },
+        });
+      }
+    } else if (contentType === '' || contentType === 'application/json') {
+      const data = await request.json() as SensorReading | SensorReading[];
+      // Handle both single reading and batch
+      readings = Array.isArray(data) ? data : [data];
+    } else {
+      return new Response(JSON.stringify({ error: `Unsupported Content-Type: ${contentType}` }), {
+        status: 415,
+        headers: {
+          'Content-Type': 'application/json',
+          'Accept-Post': `application/json, ${BATCH_CONTENT_TYPE}`,
+        },
+      });
+    }
 
     if (readings.length === 0) {
       return new Response(JSON.stringify({ error: 'No data provided' }), {
@@ -51,13 +99,15 @@ export const POST: APIRoute = async ({ request, locals }) => {
       });
     }
 
-    // Validate and insert all readings (ignore duplicates)
-    const stmt = db.prepare(`
-      INSERT OR IGNORE INTO sensor_data (timestamp, temperature, humidity, co2, battery_voltage, battery_percent, battery_max17048_percent, battery_rate, battery_charging, rtc_drift_ms, cumulative_comp_ms, drift_rate)
-      VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)
-    `);
+    if (readings.length > MAX_READINGS_PER_REQUEST) {
+      return new Response(JSON.stringify({ error: `Too many readings (max ${MAX_READINGS_PER_REQUEST})` }), {
+        status: 413,
+        headers: { 'Content-Type': 'application/json' },
+      });
+    }
 
-    const batch = readings.map((r, i) => {
+    // Validate all readings first so a bad record rejects the whole batch
+    const rows = readings.map((r, i) => {
       const ts = r.timestamp ?? r.unixtimestamp;
 
       // Validate required fields
@@ -77,14 +127,36 @@ export const POST: APIRoute = async ({ request, locals }) => {
       // Convert boolean charging to integer (1/0) for SQLite
       const chargingInt = r.charging === true ? 1 : (r.charging === false ? 0 : null);
 
-      return stmt.bind(ts, r.temp, r.humidity, r.co2, r.batt_voltage ?? null, r.batt_percent ?? null, r.batt_max17048_percent ?? null, r.batt_rate ?? null, chargingInt, r.rtc_drift_ms ?? null, r.cumulative_comp_ms ?? null, r.drift_rate ?? null);
+      // Boot profile is stored as its JSON text (only present once per boot)
+      const bootProfile = Array.isArray(r.boot_prof) ? JSON.stringify(r.boot_prof) : null;
+
+      return [deviceId, ts, r.temp, r.humidity, r.co2, r.batt_voltage ?? null, r.batt_percent ?? null, r.batt_max17048_percent ?? null, r.batt_rate ?? null, chargingInt, r.rtc_drift_ms ?? null, r.cumulative_comp_ms ?? null, r.drift_rate ?? null, bootProfile, r.energy_uah ?? null];
     });
 
-    await db.batch(batch);
+    // Multi-row INSERTs (ignore duplicates), all sent in one D1 batch (a single transaction)
+    // A catch-up upload of several hundred readings is then a few dozen statements, not one per row
+    const statements: ReturnType<D1Database['prepare']>[] = [];
+    for (let start = 0; start < rows.length; start += ROWS_PER_STATEMENT) {
+      const chunk = rows.slice(start, start + ROWS_PER_STATEMENT);
+      const placeholders = chunk.map(() => ROW_PLACEHOLDERS).join(', ');
+      statements.push(db.prepare(`${INSERT_PREFIX} VALUES ${placeholders}`).bind(...chunk.flat()));
+    }
+    const insertCount = statements.length;
+    // Device registry and the hourly/daily rollups of the buckets touched, in the same transaction
+    // The devices row is also /api/data's cache watermark, so this invalidates cached responses
+    const timestamps = rows.map(row => row[1] as number);
+    statements.push(deviceUpsertStatement(db, deviceId, timestamps));
+    statements.push(...rollupRefreshStatements(db, deviceId, timestamps));
+
+    const results = await db.batch(statements);
+    // Rows skipped as duplicates (already uploaded by an earlier, unacknowledged attempt) are not counted
+    const inserted = results.slice(0, insertCount).reduce((sum, result) => sum + (result.meta?.changes ?? 0), 0);
 
     return new Response(JSON.stringify({
       success: true,
-      inserted: readings.length
+      device_id: deviceId,
+      inserted,
+      received: readings.length
     }), {
       status: 200,
       headers: { 'Content-Type': 'application/json' },